@@ -0,0 +1,232 @@
+// Copyright (c) 2020 Run Jump Labs LLC.  All right reserved.
+// This code is licensed under MIT license (see license.txt for details)
+
+#include "dreammakerfx.h"
+#include "dm_fx_adc.h"
+
+#if defined (__SAMD51__) && !defined (DM_FX_POT_ADC_NO_DMA)
+  #include "wiring_private.h"
+  #define POT_ADC_DMA
+#endif
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+
+/************************************************************************
+ *
+ *                        Pot / expression pedal ADC scan
+ *
+ ***********************************************************************/
+
+static const int pot_adc_pins[POT_ADC_CHANNELS] = { A0, A1, A2, A3, A4, A5 };
+
+// Inputs that are read with analogRead() (set for every input without DMA);
+// each is converted at most once per millisecond
+static bool pot_adc_blocking[POT_ADC_CHANNELS];
+static uint16_t pot_adc_last_value[POT_ADC_CHANNELS];
+static uint32_t pot_adc_last_ms[POT_ADC_CHANNELS];
+
+#if defined (POT_ADC_DMA)
+
+// DMA channels of the scan, taken from the free channels on the first 
+// pot_adc_init() and kept after that
+static int8_t pot_adc_dma_ch_seq = -1;
+static int8_t pot_adc_dma_ch_result = -1;
+
+// Descriptor tables, used only when the scan is the first user of the DMA
+// controller; otherwise the descriptors go in the tables already set up.  
+// The controller fetches the first descriptor of channel n from entry n.
+static DmacDescriptor pot_adc_dma_base[DMAC_CH_NUM] __attribute__ ((aligned (16)));
+static DmacDescriptor pot_adc_dma_writeback[DMAC_CH_NUM] __attribute__ ((aligned (16)));
+
+// INPUTCTRL value of each conversion in the scan, and the scan results
+static uint32_t pot_adc_sequence[POT_ADC_CHANNELS];
+static volatile uint16_t pot_adc_results[POT_ADC_CHANNELS];
+static int pot_adc_sequence_len = 0;
+static int8_t pot_adc_slot[POT_ADC_CHANNELS];
+
+/**
+ * @brief      Returns the first descriptor of a DMA channel
+ */
+static DmacDescriptor * pot_adc_dma_first_desc(int ch) {
+  return &((DmacDescriptor *) DMAC->BASEADDR.reg)[ch];
+}
+
+/**
+ * @brief      Finds the lowest DMA channel that nothing else has set up (a 
+ *             table set up by another library may not have room for every 
+ *             channel, so the lowest ones are the safest)
+ *
+ * @return     The channel or -1 if none are free
+ */
+static int pot_adc_dma_alloc(void) {
+  for (int ch=0;ch<DMAC_CH_NUM;ch++) {
+    if (ch == pot_adc_dma_ch_seq || ch == pot_adc_dma_ch_result) {
+      continue;
+    }
+    if (DMAC->Channel[ch].CHCTRLA.reg != 0 || pot_adc_dma_first_desc(ch)->BTCTRL.bit.VALID) {
+      continue;
+    }
+    return ch;
+  }
+  return -1;
+}
+
+/**
+ * @brief      Sets up a DMA channel with a single descriptor that links to
+ *             itself
+ */
+static void pot_adc_dma_channel(int ch, uint8_t trigger, uint16_t btctrl, uint32_t src, uint32_t dst) {
+
+  DMAC->Channel[ch].CHCTRLA.reg &= ~DMAC_CHCTRLA_ENABLE;
+  while (DMAC->Channel[ch].CHCTRLA.reg & DMAC_CHCTRLA_ENABLE);
+  DMAC->Channel[ch].CHCTRLA.reg = DMAC_CHCTRLA_SWRST;
+  while (DMAC->Channel[ch].CHCTRLA.reg & DMAC_CHCTRLA_SWRST);
+
+  // One beat per trigger
+  DMAC->Channel[ch].CHCTRLA.reg = DMAC_CHCTRLA_TRIGSRC(trigger) | DMAC_CHCTRLA_TRIGACT_BURST;
+
+  DmacDescriptor * d = pot_adc_dma_first_desc(ch);
+  d->BTCTRL.reg = btctrl | DMAC_BTCTRL_VALID | DMAC_BTCTRL_BLOCKACT_NOACT;
+  d->BTCNT.reg = pot_adc_sequence_len;
+  d->SRCADDR.reg = src;       // End addresses for incrementing sides
+  d->DSTADDR.reg = dst;
+  d->DESCADDR.reg = (uint32_t) d;
+
+  DMAC->Channel[ch].CHCTRLA.reg |= DMAC_CHCTRLA_ENABLE;
+}
+
+#endif  // POT_ADC_DMA
+
+
+void pot_adc_init(void) {
+
+  for (int i=0;i<POT_ADC_CHANNELS;i++) {
+    pot_adc_blocking[i] = true;
+    pot_adc_last_ms[i] = millis() - 1;
+  }
+
+  #if defined (POT_ADC_DMA)
+
+    // Build the scan from the inputs on ADC0
+    pot_adc_sequence_len = 0;
+    for (int i=0;i<POT_ADC_CHANNELS;i++) {
+      const PinDescription * pin = &g_APinDescription[pot_adc_pins[i]];
+      pot_adc_slot[i] = -1;
+      if (!(pin->ulPinAttribute & PIN_ATTR_ANALOG)) {
+        continue;
+      }
+      pinPeripheral(pot_adc_pins[i], PIO_ANALOG);
+      pot_adc_sequence[pot_adc_sequence_len] = ADC_INPUTCTRL_MUXPOS(pin->ulADCChannelNumber) | ADC_INPUTCTRL_MUXNEG_GND;
+      pot_adc_results[pot_adc_sequence_len] = 0;
+      pot_adc_slot[i] = pot_adc_sequence_len++;
+      pot_adc_blocking[i] = false;
+    }
+    if (pot_adc_sequence_len == 0) {
+      return;
+    }
+
+    // DMA controller: set it up only if nothing else has, and never reset
+    // it, as channels of other libraries may be running
+    MCLK->AHBMASK.reg |= MCLK_AHBMASK_DMAC;
+    if (!DMAC->CTRL.bit.DMAENABLE) {
+      DMAC->BASEADDR.reg = (uint32_t) pot_adc_dma_base;
+      DMAC->WRBADDR.reg = (uint32_t) pot_adc_dma_writeback;
+      DMAC->CTRL.reg = DMAC_CTRL_DMAENABLE | DMAC_CTRL_LVLEN(0xF);
+    }
+    if (pot_adc_dma_ch_seq < 0) {
+      pot_adc_dma_ch_seq = pot_adc_dma_alloc();
+    }
+    if (pot_adc_dma_ch_result < 0) {
+      pot_adc_dma_ch_result = pot_adc_dma_alloc();
+    }
+    if (pot_adc_dma_ch_seq < 0 || pot_adc_dma_ch_result < 0) {
+      DEBUG_MSG("No free DMA channels for the pot scan, reading pots with analogRead()", MSG_WARN);
+      for (int i=0;i<POT_ADC_CHANNELS;i++) {
+        pot_adc_blocking[i] = true;
+      }
+      return;
+    }
+
+    // ADC0 (clocked by the core): 16 bit accumulation of POT_ADC_SAMPLES
+    // conversions shifted back down to 12 bits, input taken from DMA
+    ADC0->CTRLA.bit.ENABLE = 0;
+    while (ADC0->SYNCBUSY.bit.ENABLE);
+    ADC0->CTRLA.bit.PRESCALER = ADC_CTRLA_PRESCALER_DIV32_Val;
+    ADC0->CTRLB.reg = ADC_CTRLB_RESSEL_16BIT;
+    while (ADC0->SYNCBUSY.bit.CTRLB);
+    ADC0->AVGCTRL.reg = ADC_AVGCTRL_SAMPLENUM_16 | ADC_AVGCTRL_ADJRES(4);
+    while (ADC0->SYNCBUSY.bit.AVGCTRL);
+    ADC0->SAMPCTRL.reg = ADC_SAMPCTRL_SAMPLEN(5);
+    while (ADC0->SYNCBUSY.bit.SAMPCTRL);
+    ADC0->DSEQCTRL.reg = ADC_DSEQCTRL_INPUTCTRL | ADC_DSEQCTRL_AUTOSTART;
+    while (ADC0->SYNCBUSY.reg);
+
+    // Sequence: next input -> DSEQDATA each time the ADC asks for one
+    pot_adc_dma_channel(pot_adc_dma_ch_seq, ADC0_DMAC_ID_SEQ,
+                        DMAC_BTCTRL_BEATSIZE_WORD | DMAC_BTCTRL_SRCINC,
+                        (uint32_t) &pot_adc_sequence[pot_adc_sequence_len],
+                        (uint32_t) &ADC0->DSEQDATA.reg);
+
+    // Results: RESULT -> buffer each time a conversion completes
+    pot_adc_dma_channel(pot_adc_dma_ch_result, ADC0_DMAC_ID_RESRDY,
+                        DMAC_BTCTRL_BEATSIZE_HWORD | DMAC_BTCTRL_DSTINC,
+                        (uint32_t) &ADC0->RESULT.reg,
+                        (uint32_t) &pot_adc_results[pot_adc_sequence_len]);
+
+    ADC0->CTRLA.bit.ENABLE = 1;
+    while (ADC0->SYNCBUSY.bit.ENABLE);
+
+  #endif  // POT_ADC_DMA
+}
+
+
+uint16_t pot_adc_read(int channel) {
+
+  if (channel < 0 || channel >= POT_ADC_CHANNELS) {
+    return 0;
+  }
+
+  #if defined (POT_ADC_DMA)
+    if (!pot_adc_blocking[channel]) {
+      return pot_adc_results[pot_adc_slot[channel]];
+    }
+  #endif
+
+  uint32_t now = millis();
+  if (now != pot_adc_last_ms[channel]) {
+    pot_adc_last_ms[channel] = now;
+
+    // analogRead() returns 10 bits
+    pot_adc_last_value[channel] = (uint16_t) ((analogRead(pot_adc_pins[channel]) * POT_ADC_FULL_SCALE) / 1023);
+  }
+  return pot_adc_last_value[channel];
+}
+
+
+// log10(1 + 9x)
+static const float pot_log_curve_table[POT_LOG_CURVE_POINTS] = {
+  0.0000, 0.0571, 0.1076, 0.1529, 0.1938, 0.2312, 0.2657, 0.2976,
+  0.3274, 0.3552, 0.3813, 0.4060, 0.4293, 0.4515, 0.4726, 0.4927,
+  0.5119, 0.5303, 0.5479, 0.5649, 0.5812, 0.5969, 0.6121, 0.6268,
+  0.6410, 0.6547, 0.6680, 0.6810, 0.6935, 0.7057, 0.7176, 0.7291,
+  0.7404, 0.7513, 0.7620, 0.7725, 0.7827, 0.7926, 0.8023, 0.8119,
+  0.8212, 0.8303, 0.8392, 0.8480, 0.8566, 0.8650, 0.8732, 0.8813,
+  0.8893, 0.8971, 0.9048, 0.9123, 0.9197, 0.9270, 0.9342, 0.9412,
+  0.9482, 0.9550, 0.9617, 0.9683, 0.9749, 0.9813, 0.9876, 0.9938,
+  1.0000
+};
+
+float pot_log_curve(float x) {
+  if (x <= 0.0f) {
+    return 0.0f;
+  }
+  float pos = x * (float) (POT_LOG_CURVE_POINTS - 1);
+  int indx = (int) pos;
+  if (indx >= POT_LOG_CURVE_POINTS - 1) {
+    return 1.0f;
+  }
+  return pot_log_curve_table[indx] + (pot_log_curve_table[indx + 1] - pot_log_curve_table[indx]) * (pos - (float) indx);
+}
+
+#endif  // DOXYGEN_SHOULD_SKIP_THIS
@@ -0,0 +1,64 @@
+// Copyright (c) 2020 Run Jump Labs LLC.  All right reserved.
+// This code is licensed under MIT license (see license.txt for details)
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+#ifndef DM_FX_ADC_H
+#define DM_FX_ADC_H
+
+
+/************************************************************************
+ *
+ *                        Pot / expression pedal ADC scan
+ *
+ * ADC0 converts the pot inputs (A0 - A5) one after the other without the
+ * CPU: one DMA channel feeds the ADC the input of each conversion (ADC DMA
+ * sequencing) and a second DMA channel copies each result into a buffer.
+ * Both descriptors link back to themselves so the scan never stops.  Each
+ * result is the hardware average of POT_ADC_SAMPLES conversions, and a scan
+ * of all inputs takes about POT_ADC_SCAN_US, so reading a pot is a load
+ * from memory and the value is never more than one scan old.
+ *
+ * The scan takes the two lowest free DMA channels and shares the DMA 
+ * controller: if a sketch or library enabled it first, the scan's 
+ * descriptors go in its tables, otherwise the scan sets the controller up.  
+ * Only the scan's own channels are reset, but a library that resets the 
+ * whole controller later stops the scan.  With no free channels the pots are 
+ * read with analogRead().  The scan owns ADC0, so analogRead() of another 
+ * ADC0 pin stops it.  Define DM_FX_POT_ADC_NO_DMA in the build flags to 
+ * always read the pots with analogRead().  Pots on ADC1 are always read with 
+ * analogRead().
+ *
+ ***********************************************************************/
+
+#define POT_ADC_CHANNELS        (6)
+#define POT_ADC_FULL_SCALE      (4095)    // Results are 12 bits
+#define POT_ADC_SAMPLES         (16)      // Hardware averaging per result
+#define POT_ADC_SCAN_US         (1200)
+
+/**
+ * @brief      Starts the free running scan of the pot inputs
+ */
+void      pot_adc_init(void);
+
+/**
+ * @brief      Returns the latest value of a pot input
+ *
+ * @param[in]  channel  The input (0 for A0 through 5 for A5)
+ *
+ * @return     The value (0 to POT_ADC_FULL_SCALE)
+ */
+uint16_t  pot_adc_read(int channel);
+
+#define POT_LOG_CURVE_POINTS    (65)
+
+/**
+ * @brief      Looks up the pot log curve, log10(1 + 9x), in a table
+ *
+ * @param[in]  x     The pot value (0.0 to 1.0)
+ *
+ * @return     The curve value (0.0 to 1.0, within 0.001 of log10())
+ */
+float     pot_log_curve(float x);
+
+
+#endif    // DM_FX_ADC_H
+#endif    // DOXYGEN_SHOULD_SKIP_THIS
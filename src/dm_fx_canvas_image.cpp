@@ -0,0 +1,725 @@
+// Copyright (c) 2020 Run Jump Labs LLC.  All right reserved.
+// This code is licensed under MIT license (see license.txt for details)
+
+#include "dreammakerfx.h"
+#include "dm_fx_canvas_image.h"
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+/************************************************************************
+ *
+ *                        Canvas image reader / writer
+ *
+ ***********************************************************************/
+
+static const uint8_t canvas_image_magic[4] = {'D', 'M', 'F', 'X'};
+
+// Parameter block being assembled by the reader (header + payload)
+static uint16_t canvas_param_block[MAX_PARMS_PER_FX];
+
+// Chunks fed to a reader, kept until the whole image has been checked
+static uint8_t  canvas_image_staging[CANVAS_IMAGE_STAGING_SIZE];
+
+
+/**
+ * @brief      Updates a CRC-16/CCITT (0x1021, init 0xFFFF) with one byte
+ */
+uint16_t canvas_image_crc16(uint16_t crc, uint8_t b) {
+  crc ^= (uint16_t) b << 8;
+  for (int i=0;i<8;i++) {
+    if (crc & 0x8000) {
+      crc = (crc << 1) ^ 0x1021;
+    } else {
+      crc <<= 1;
+    }
+  }
+  return crc;
+}
+
+
+/**
+ * Small helper used to write an image into a caller supplied buffer
+ */
+typedef struct {
+  uint8_t * buf;
+  uint32_t  max_len;
+  uint32_t  len;
+  uint16_t  crc;
+  bool      overflow;
+} CANVAS_IMAGE_WRITER;
+
+static void canvas_put_8(CANVAS_IMAGE_WRITER * w, uint8_t val) {
+  if (w->len >= w->max_len) {
+    w->overflow = true;
+    return;
+  }
+  w->crc = canvas_image_crc16(w->crc, val);
+  w->buf[w->len++] = val;
+}
+
+static void canvas_put_16(CANVAS_IMAGE_WRITER * w, uint16_t val) {
+  canvas_put_8(w, val & 0xFF);
+  canvas_put_8(w, val >> 8);
+}
+
+static void canvas_put_float(CANVAS_IMAGE_WRITER * w, float val) {
+  uint32_t part_32;
+  memcpy(&part_32, &val, sizeof(part_32));
+  canvas_put_16(w, part_32 & 0xFFFF);
+  canvas_put_16(w, part_32 >> 16);
+}
+
+static float canvas_get_float(const uint8_t * b) {
+  uint32_t part_32 = (uint32_t) b[0] | ((uint32_t) b[1] << 8) | ((uint32_t) b[2] << 16) | ((uint32_t) b[3] << 24);
+  float val;
+  memcpy(&val, &part_32, sizeof(val));
+  return val;
+}
+
+
+/**
+ * @brief      Sizes of the parameter block of an effect class: the words of the 
+ *             fixed entries of its parameter table and of one repeat of its 
+ *             group (0 if it has none)
+ */
+template<class FX> static bool canvas_class_param_layout(uint16_t * fixed_words, uint16_t * group_words) {
+  uint8_t len;
+  const FX_PARAM_DESC * table = FX::get_class_param_table(&len);
+  uint8_t group_first = FX::get_class_param_group_first();
+
+  *fixed_words = 0;
+  *group_words = 0;
+  for (int i=0;i<len;i++) {
+    if (table[i].wire_offset == FX_WIRE_NONE) {
+      continue;
+    }
+    if (i < group_first) {
+      *fixed_words += fx_param_words(table[i].type);
+    } else {
+      *group_words += fx_param_words(table[i].type);
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief      Looks up the parameter block layout of an effect type
+ *
+ * @return     False if the type is not an effect this library knows
+ */
+static bool canvas_param_layout(uint8_t type, uint16_t * fixed_words, uint16_t * group_words) {
+  switch (type) {
+    case FX_ADSR_ENVELOPE:        return canvas_class_param_layout<fx_adsr_envelope>(fixed_words, group_words);
+    case FX_ALLPASS_FILTER:       return canvas_class_param_layout<fx_allpass_filter>(fixed_words, group_words);
+    case FX_ARPEGGIATOR:          return canvas_class_param_layout<fx_arpeggiator>(fixed_words, group_words);
+    case FX_AMPLITUDE_MODULATOR:  return canvas_class_param_layout<fx_amplitude_mod>(fixed_words, group_words);
+    case FX_BIQUAD_FILTER:        return canvas_class_param_layout<fx_biquad_filter>(fixed_words, group_words);
+    case FX_COMPRESSOR:           return canvas_class_param_layout<fx_compressor>(fixed_words, group_words);
+    case FX_DELAY:                return canvas_class_param_layout<fx_delay>(fixed_words, group_words);
+    case FX_DELAY_MULTITAP:       return canvas_class_param_layout<fx_multitap_delay>(fixed_words, group_words);
+    case FX_DESTRUCTOR:           return canvas_class_param_layout<fx_destructor>(fixed_words, group_words);
+    case FX_ENVELOPE_TRACKER:     return canvas_class_param_layout<fx_envelope_tracker>(fixed_words, group_words);
+    case FX_GAIN:                 return canvas_class_param_layout<fx_gain>(fixed_words, group_words);
+    case FX_HARMONIZER:           return canvas_class_param_layout<fx_harmonizer>(fixed_words, group_words);
+    case FX_IMPULSE_RESPONSE:     return canvas_class_param_layout<fx_impulse_response>(fixed_words, group_words);
+    case FX_LOOPER:               return canvas_class_param_layout<fx_looper>(fixed_words, group_words);
+    case FX_MIXER_2:              return canvas_class_param_layout<fx_mixer_2>(fixed_words, group_words);
+    case FX_MIXER_3:              return canvas_class_param_layout<fx_mixer_3>(fixed_words, group_words);
+    case FX_MIXER_4:              return canvas_class_param_layout<fx_mixer_4>(fixed_words, group_words);
+    case FX_OSCILLATOR:           return canvas_class_param_layout<fx_oscillator>(fixed_words, group_words);
+    case FX_INSTRUMENT_SYNTH:     return canvas_class_param_layout<fx_instrument_synth>(fixed_words, group_words);
+    case FX_PHASE_SHIFTER:        return canvas_class_param_layout<fx_phase_shifter>(fixed_words, group_words);
+    case FX_PITCH_SHIFT:          return canvas_class_param_layout<fx_pitch_shift>(fixed_words, group_words);
+    case FX_RING_MOD:             return canvas_class_param_layout<fx_ring_mod>(fixed_words, group_words);
+    case FX_SLICER:               return canvas_class_param_layout<fx_slicer>(fixed_words, group_words);
+    case FX_SPECTRALIZER:         return canvas_class_param_layout<fx_pitch_shift_fd>(fixed_words, group_words);
+    case FX_VARIABLE_DELAY:       return canvas_class_param_layout<fx_variable_delay>(fixed_words, group_words);
+    default:                      return false;
+  }
+}
+
+#endif  // DOXYGEN_SHOULD_SKIP_THIS
+
+
+/**
+ * @brief      Saves the current canvas (effects, routing and parameters) to a binary image
+ *
+ * The image can be stored (e.g. in flash) and later restored with `load_canvas()`
+ * without the sketch having to construct and route the effects again.
+ *
+ * ``` CPP
+ * uint8_t  image[1024];
+ * uint32_t image_len = pedal.save_canvas(image, sizeof(image));
+ * ```
+ *
+ * A canvas that was itself loaded with `load_canvas()` or `preload_canvas()` 
+ * has no effect objects to read the parameters from, so it cannot be saved 
+ * again (this returns 0); keep the image it was loaded from instead.
+ *
+ * @param      image    Buffer to write the image to
+ * @param[in]  max_len  The size of the buffer in bytes
+ *
+ * @return     Number of bytes written, or 0 if the image did not fit in the buffer
+ *             or the canvas was loaded from an image
+ */
+uint32_t fx_pedal::save_canvas(uint8_t * image, uint32_t max_len) {
+
+  DEBUG_MSG("Starting", MSG_DEBUG);
+
+  if (!check_canvas_capacity()) {
+    return 0;
+  }
+
+  CANVAS_IMAGE_WRITER w = {image, max_len, 0, 0xFFFF, false};
+  uint16_t   size;
+
+  // Header
+  for (int i=0;i<4;i++) {
+    canvas_put_8(&w, canvas_image_magic[i]);
+  }
+  canvas_put_8(&w, CANVAS_IMAGE_VERSION);
+  canvas_put_8(&w, 0);
+  canvas_put_16(&w, API_VERSION);
+  canvas_put_8(&w, total_instances);
+  canvas_put_8(&w, total_audio_routes);
+  canvas_put_8(&w, total_control_routes);
+  canvas_put_8(&w, 0);
+
+  // Instance stack
+  for (int i=0;i<total_instances;i++) {
+    canvas_put_8(&w, instance_stack[i].id);
+    canvas_put_8(&w, (uint8_t) instance_stack[i].type);
+  }
+
+  // Audio routing stack
+  for (int i=0;i<total_audio_routes;i++) {
+    canvas_put_8(&w, audio_routing_stack[i].src_id);
+    canvas_put_8(&w, audio_routing_stack[i].src_node_indx);
+    canvas_put_8(&w, audio_routing_stack[i].dest_id);
+    canvas_put_8(&w, audio_routing_stack[i].dest_node_indx);
+  }
+
+  // Control routing stack
+  for (int i=0;i<total_control_routes;i++) {
+    canvas_put_8(&w, control_routing_stack[i].src_id);
+    canvas_put_8(&w, control_routing_stack[i].src_node_indx);
+    canvas_put_8(&w, control_routing_stack[i].src_param_id);
+    canvas_put_8(&w, control_routing_stack[i].dest_id);
+    canvas_put_8(&w, control_routing_stack[i].dest_node_indx);
+    canvas_put_8(&w, control_routing_stack[i].dest_param_id);
+    canvas_put_float(&w, control_routing_stack[i].scale);
+    canvas_put_float(&w, control_routing_stack[i].offset);
+    canvas_put_8(&w, (uint8_t) control_routing_stack[i].type);
+  }
+
+  // Parameter blocks
+  uint16_t   mark = scratch_mark();
+  uint16_t * param_block = scratch_alloc(SCRATCH_WORDS_PARAMS);
+  if (param_block == NULL) {
+    return 0;
+  }
+  for (int i=1;i<total_instances;i++) {
+    fx_effect * effect = (fx_effect *) instance_stack[i].address;
+    if (effect == NULL) {
+      DEBUG_MSG("Instance has no effect object (was this canvas loaded from an image?)", MSG_ERROR);
+      scratch_release(mark);
+      return 0;
+    }
+    size = 0;
+    effect->serialize_params(param_block, &size);
+
+    canvas_put_8(&w, instance_stack[i].id);
+    canvas_put_8(&w, (uint8_t) instance_stack[i].type);
+    canvas_put_16(&w, size);
+    for (int j=0;j<size;j++) {
+      canvas_put_16(&w, param_block[j]);
+    }
+  }
+  scratch_release(mark);
+
+  // Trailer
+  uint16_t crc = w.crc;
+  canvas_put_8(&w, crc & 0xFF);
+  canvas_put_8(&w, crc >> 8);
+
+  if (w.overflow) {
+    DEBUG_MSG("Canvas image does not fit in buffer", MSG_ERROR);
+    return 0;
+  }
+
+  DEBUG_MSG("Complete", MSG_DEBUG);
+
+  return w.len;
+}
+
+
+/**
+ * @brief      Loads a canvas image created by `save_canvas()` and runs it on the DSP
+ *
+ * This replaces the current instance and routing stacks, so it is called
+ * instead of `route_audio()` / `route_control()` / `run()`.  The whole image 
+ * (including its CRC) is checked before anything is sent to the DSP.
+ *
+ * ``` CPP
+ * void setup() {
+ *   pedal.init();
+ *   pedal.load_canvas(stored_image, stored_image_len);
+ * }
+ * ```
+ *
+ * @param[in]  image  The image
+ * @param[in]  len    The length of the image in bytes
+ *
+ * @return     True if the image was valid and the canvas is running, false if not
+ */
+bool fx_pedal::load_canvas(const uint8_t * image, uint32_t len) {
+
+  fx_canvas_reader reader(this);
+
+  reader.begin();
+  CANVAS_IMAGE_STATUS res = reader.load(image, len);
+
+  return res == CANVAS_IMAGE_COMPLETE && dsp_status.state_canvas_running;
+}
+
+
+/**
+ * @brief      Loads a canvas image into the shadow slot on the DSP while the 
+ *             current canvas keeps running
+ *
+ * Call `swap_canvas()` once this returns true to switch to the new canvas.
+ *
+ * Like `preload()`, this needs DSP firmware with a shadow canvas slot and 
+ * returns false with older firmware.
+ *
+ * @param[in]  image  The image
+ * @param[in]  len    The length of the image in bytes
+ *
+ * @return     True if the image was valid and is ready to be swapped in, false if not
+ */
+bool fx_pedal::preload_canvas(const uint8_t * image, uint32_t len) {
+
+  if (!check_canvas_slots()) {
+    return false;
+  }
+
+  fx_canvas_reader reader(this);
+
+  reader.begin(true);
+  CANVAS_IMAGE_STATUS res = reader.load(image, len);
+
+  return res == CANVAS_IMAGE_COMPLETE && shadow_canvas_loaded;
+}
+
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+fx_canvas_reader::fx_canvas_reader(fx_pedal * p) {
+  pedal = p;
+  param_block = canvas_param_block;
+  begin();
+}
+
+/**
+ * @brief      Resets the reader so it is ready for a new image
+ */
+void fx_canvas_reader::begin(void) {
+  begin(false);
+}
+
+/**
+ * @brief      Resets the reader so it is ready for a new image
+ *
+ * @param[in]  to_shadow  True to load the image into the shadow canvas slot
+ */
+void fx_canvas_reader::begin(bool to_shadow) {
+  preload = to_shadow;
+
+  // Inspecting an image just prints it, so there is nothing to hold back
+  stage = (pedal != NULL);
+  staged_len = 0;
+  reset(pedal == NULL);
+
+  // Without a shadow slot the records would land in the running canvas
+  if (preload && pedal && !pedal->check_canvas_slots()) {
+    fail(CANVAS_IMAGE_ERR_NO_SLOTS);
+  }
+}
+
+/**
+ * @brief      Starts a pass over an image
+ *
+ * @param[in]  apply_records  True to apply the records to the pedal (or print 
+ *                            them), false to only check them
+ */
+void fx_canvas_reader::reset(bool apply_records) {
+  apply = apply_records;
+  shadow_selected = false;
+  state = CANVAS_RD_HEADER;
+  status = CANVAS_IMAGE_OK;
+  crc = 0xFFFF;
+  rec_len = 0;
+  rec_indx = 0;
+  total_instances = total_audio = total_control = 0;
+}
+
+/**
+ * @brief      Feeds the next chunk of an image to the reader
+ *
+ * @param[in]  data  The data
+ * @param[in]  len   The length of the data in bytes
+ *
+ * @return     CANVAS_IMAGE_OK if more data is needed, CANVAS_IMAGE_COMPLETE when
+ *             the image has been read, or an error code
+ */
+CANVAS_IMAGE_STATUS fx_canvas_reader::feed(const uint8_t * data, uint32_t len) {
+
+  if (state == CANVAS_RD_DONE || state == CANVAS_RD_ERROR) {
+    if (len) {
+      fail(CANVAS_IMAGE_ERR_STATE);
+    }
+    return status;
+  }
+
+  for (uint32_t i=0;i<len && state != CANVAS_RD_ERROR;i++) {
+    if (state == CANVAS_RD_DONE) {
+      fail(CANVAS_IMAGE_ERR_STATE);
+      break;
+    }
+    if (stage) {
+      if (staged_len >= CANVAS_IMAGE_STAGING_SIZE) {
+        DEBUG_MSG("Canvas image is larger than CANVAS_IMAGE_STAGING_SIZE", MSG_ERROR);
+        fail(CANVAS_IMAGE_ERR_CAPACITY);
+        break;
+      }
+      canvas_image_staging[staged_len++] = data[i];
+    }
+    process_byte(data[i]);
+  }
+
+  // The image checked out, so now build the canvas from the staged copy
+  if (stage && state == CANVAS_RD_DONE) {
+    stage = false;
+    replay(canvas_image_staging, staged_len);
+  }
+  return status;
+}
+
+/**
+ * @brief      Loads a complete image that is already in memory: the image is 
+ *             checked first and then applied straight from the caller's buffer
+ */
+CANVAS_IMAGE_STATUS fx_canvas_reader::load(const uint8_t * image, uint32_t len) {
+
+  stage = false;
+  reset(false);
+  if (read_all(image, len) != CANVAS_IMAGE_COMPLETE) {
+    return status;
+  }
+  return replay(image, len);
+}
+
+/**
+ * @brief      Makes a second pass over an image that has been checked and 
+ *             applies its records
+ */
+CANVAS_IMAGE_STATUS fx_canvas_reader::replay(const uint8_t * image, uint32_t len) {
+  reset(true);
+  return read_all(image, len);
+}
+
+/**
+ * @brief      Runs a complete image through the reader
+ */
+CANVAS_IMAGE_STATUS fx_canvas_reader::read_all(const uint8_t * image, uint32_t len) {
+
+  uint32_t i;
+  for (i=0;i<len && state != CANVAS_RD_ERROR && state != CANVAS_RD_DONE;i++) {
+    process_byte(image[i]);
+  }
+  if (state == CANVAS_RD_DONE && i < len) {
+    fail(CANVAS_IMAGE_ERR_STATE);
+  } else if (status == CANVAS_IMAGE_OK) {
+    DEBUG_MSG("Canvas image is truncated", MSG_ERROR);
+  }
+  return status;
+}
+
+/**
+ * @brief      Collects bytes of the current record, returns true when complete
+ */
+bool fx_canvas_reader::take(uint8_t b, uint8_t len) {
+  rec[rec_len++] = b;
+  if (rec_len >= len) {
+    rec_len = 0;
+    return true;
+  }
+  return false;
+}
+
+void fx_canvas_reader::fail(CANVAS_IMAGE_STATUS err) {
+  state = CANVAS_RD_ERROR;
+  status = err;
+  if (shadow_selected) {
+    pedal->spi_transmit_canvas_slot(CANVAS_SLOT_ACTIVE);
+    shadow_selected = false;
+  }
+  DEBUG_MSG("Invalid canvas image", MSG_ERROR);
+}
+
+void fx_canvas_reader::process_byte(uint8_t b) {
+
+  if (state != CANVAS_RD_TRAILER) {
+    crc = canvas_image_crc16(crc, b);
+  }
+
+  switch (state) {
+    case CANVAS_RD_HEADER:
+      if (take(b, CANVAS_IMAGE_HEADER_SIZE)) process_record();
+      break;
+    case CANVAS_RD_INSTANCES:
+      if (take(b, CANVAS_IMAGE_INSTANCE_SIZE)) process_record();
+      break;
+    case CANVAS_RD_AUDIO_ROUTES:
+      if (take(b, CANVAS_IMAGE_AUDIO_SIZE)) process_record();
+      break;
+    case CANVAS_RD_CONTROL_ROUTES:
+      if (take(b, CANVAS_IMAGE_CONTROL_SIZE)) process_record();
+      break;
+    case CANVAS_RD_PARAM_HEADER:
+      if (take(b, CANVAS_IMAGE_PARAM_HDR_SIZE)) process_record();
+      break;
+    case CANVAS_RD_PARAM_WORDS:
+      if (take(b, 2)) {
+        param_block[3 + param_words_read++] = (uint16_t) rec[0] | ((uint16_t) rec[1] << 8);
+        if (param_words_read >= param_words) {
+          process_record();
+        }
+      }
+      break;
+    case CANVAS_RD_TRAILER:
+      if (take(b, CANVAS_IMAGE_TRAILER_SIZE)) process_record();
+      break;
+    default:
+      break;
+  }
+}
+
+/**
+ * @brief      Moves on to the next parameter record (or the trailer after the last one)
+ */
+void fx_canvas_reader::next_param_record(void) {
+  rec_indx++;
+  if (rec_indx >= total_instances) {
+    state = CANVAS_RD_TRAILER;
+  } else {
+    state = CANVAS_RD_PARAM_HEADER;
+  }
+}
+
+void fx_canvas_reader::process_record(void) {
+  char buf[96];
+
+  switch (state) {
+
+    case CANVAS_RD_HEADER: {
+      if (memcmp(rec, canvas_image_magic, 4)) {
+        fail(CANVAS_IMAGE_ERR_MAGIC);
+        return;
+      }
+      if (rec[4] != CANVAS_IMAGE_VERSION) {
+        fail(CANVAS_IMAGE_ERR_VERSION);
+        return;
+      }
+      uint16_t api_version = (uint16_t) rec[6] | ((uint16_t) rec[7] << 8);
+      if (api_version != API_VERSION && !apply) {
+        DEBUG_MSG("Canvas image was saved with a different library version", MSG_WARN);
+      }
+      total_instances = rec[8];
+      total_audio = rec[9];
+      total_control = rec[10];
+      if (total_instances == 0) {
+        fail(CANVAS_IMAGE_ERR_CORRUPT);
+        return;
+      }
+      if (total_instances > MAX_INSTANCES || total_audio > MAX_ROUTES || total_control > MAX_ROUTES) {
+        fail(CANVAS_IMAGE_ERR_CAPACITY);
+        return;
+      }
+
+      if (apply && pedal) {
+        pedal->reset_canvas_stacks();
+      } else if (apply) {
+        sprintf(buf, "Canvas image v%d (API %d): %d instances, %d audio routes, %d control routes",
+                rec[4], api_version, total_instances, total_audio, total_control);
+        Serial.println(buf);
+      }
+      rec_indx = 0;
+      state = CANVAS_RD_INSTANCES;
+      break;
+    }
+
+    case CANVAS_RD_INSTANCES: {
+      uint8_t id = rec[0];
+      EFFECT_TYPE type = (EFFECT_TYPE) rec[1];
+      uint16_t fixed_words, group_words;
+
+      // Instance IDs are their index in the instance stack
+      if (id != rec_indx || (rec_indx == 0) != (type == FX_CANVAS)) {
+        fail(CANVAS_IMAGE_ERR_CORRUPT);
+        return;
+      }
+      if (rec_indx && !canvas_param_layout(type, &fixed_words, &group_words)) {
+        fail(CANVAS_IMAGE_ERR_CORRUPT);
+        return;
+      }
+      instance_types[rec_indx] = type;
+
+      if (apply && pedal) {
+        pedal->instance_stack[rec_indx].id = id;
+        pedal->instance_stack[rec_indx].type = type;
+        pedal->instance_stack[rec_indx].address = NULL;
+        pedal->total_instances = rec_indx + 1;
+      } else if (apply) {
+        sprintf(buf, " Instance %d: %s (%d)", id, ::pedal.get_effect_type(type), (int) type);
+        Serial.println(buf);
+      }
+      if (++rec_indx >= total_instances) {
+        rec_indx = 0;
+        state = CANVAS_RD_AUDIO_ROUTES;
+        if (total_audio == 0) {
+          state = CANVAS_RD_CONTROL_ROUTES;
+        }
+      }
+      break;
+    }
+
+    case CANVAS_RD_AUDIO_ROUTES:
+      if (rec[0] >= total_instances || rec[2] >= total_instances ||
+          rec[1] >= MAX_NODES_PER_FX || rec[3] >= MAX_NODES_PER_FX) {
+        fail(CANVAS_IMAGE_ERR_CORRUPT);
+        return;
+      }
+      if (apply && pedal) {
+        pedal->add_audio_route_to_stack(rec[0], rec[1], rec[2], rec[3]);
+      } else if (apply) {
+        sprintf(buf, " Audio route: %d.%d -> %d.%d", rec[0], rec[1], rec[2], rec[3]);
+        Serial.println(buf);
+      }
+      if (++rec_indx >= total_audio) {
+        rec_indx = 0;
+        state = CANVAS_RD_CONTROL_ROUTES;
+      }
+      break;
+
+    case CANVAS_RD_CONTROL_ROUTES:
+      if (rec[0] >= total_instances || rec[3] >= total_instances ||
+          rec[1] >= MAX_NODES_PER_FX || rec[4] >= MAX_NODES_PER_FX || rec[14] > NODE_NOTE) {
+        fail(CANVAS_IMAGE_ERR_CORRUPT);
+        return;
+      }
+      if (apply && pedal) {
+        pedal->add_control_route_to_stack(rec[0], rec[1], rec[2], rec[3], rec[4], rec[5],
+                                          canvas_get_float(&rec[6]),
+                                          canvas_get_float(&rec[10]),
+                                          (CTRL_NODE_TYPE) rec[14]);
+      } else if (apply) {
+        // Enough digits to give back the same float
+        snprintf(buf, sizeof(buf), " Control route: %d.%d -> %d.%d (x %.9g + %.9g)", rec[0], rec[1], rec[3], rec[4],
+                 (double) canvas_get_float(&rec[6]), (double) canvas_get_float(&rec[10]));
+        Serial.println(buf);
+      }
+      rec_indx++;
+      break;
+
+    case CANVAS_RD_PARAM_HEADER: {
+      uint16_t fixed_words, group_words;
+
+      param_instance = rec[0];
+      param_words = (uint16_t) rec[2] | ((uint16_t) rec[3] << 8);
+      param_words_read = 0;
+      if (param_instance == 0 || param_instance >= total_instances) {
+        fail(CANVAS_IMAGE_ERR_CORRUPT);
+        return;
+      }
+      if (param_words > MAX_PARMS_PER_FX - 3) {
+        fail(CANVAS_IMAGE_ERR_CAPACITY);
+        return;
+      }
+
+      // The block must be for the effect at that instance and have the size 
+      // its parameter table gives (fixed entries plus whole repeats of the group)
+      canvas_param_layout(instance_types[param_instance], &fixed_words, &group_words);
+      if (rec[1] != instance_types[param_instance] || param_words < fixed_words ||
+          (group_words == 0 && param_words != fixed_words) ||
+          (group_words != 0 && (param_words - fixed_words) % group_words != 0)) {
+        fail(CANVAS_IMAGE_ERR_PARAMS);
+        return;
+      }
+
+      param_block[0] = HEADER_PARAMETER_BLOCK;
+      param_block[1] = rec[1];
+      param_block[2] = param_instance;
+      if (param_words) {
+        state = CANVAS_RD_PARAM_WORDS;
+        return;
+      }
+    }
+      // Fall through - send an empty block
+    case CANVAS_RD_PARAM_WORDS:
+      if (apply && pedal) {
+        spi_fifo_insert_block(param_block, param_words + 3);
+        display_data_from_sharc();
+      } else if (apply) {
+        sprintf(buf, " Parameters for instance %d: %d words", param_instance, param_words);
+        Serial.println(buf);
+      }
+      next_param_record();
+      break;
+
+    case CANVAS_RD_TRAILER: {
+      uint16_t image_crc = (uint16_t) rec[0] | ((uint16_t) rec[1] << 8);
+      if (image_crc != crc) {
+        fail(CANVAS_IMAGE_ERR_CRC);
+        return;
+      }
+      state = CANVAS_RD_DONE;
+      status = CANVAS_IMAGE_COMPLETE;
+      if (apply && pedal && preload) {
+        pedal->finish_preload();
+        shadow_selected = false;
+      } else if (apply && pedal) {
+        pedal->start_canvas();
+      } else if (apply) {
+        Serial.println(" CRC OK");
+      }
+      break;
+    }
+
+    default:
+      break;
+  }
+
+  // Once the routing stacks are complete, send the canvas topology ahead of the parameters
+  if (state == CANVAS_RD_CONTROL_ROUTES && rec_indx >= total_control) {
+    if (apply && pedal) {
+      pedal->valid_audio_routes = true;
+      pedal->valid_control_routes = true;
+      if (preload) {
+        pedal->spi_transmit_canvas_slot(CANVAS_SLOT_SHADOW);
+        shadow_selected = true;
+      }
+      if (!pedal->spi_transmit_canvas_topology()) {
+        fail(CANVAS_IMAGE_ERR_CAPACITY);
+        return;
+      }
+      if (!preload) {
+        pedal->commit_instance_ids();
+      }
+    }
+    rec_indx = 0;
+    next_param_record();
+  }
+}
+
+#endif  // DOXYGEN_SHOULD_SKIP_THIS
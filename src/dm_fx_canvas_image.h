@@ -0,0 +1,166 @@
+// Copyright (c) 2020 Run Jump Labs LLC.  All right reserved.
+// This code is licensed under MIT license (see license.txt for details)
+#ifndef DM_FX_CANVAS_IMAGE_H
+#define DM_FX_CANVAS_IMAGE_H
+
+/************************************************************************
+ *
+ *                        Canvas image format
+ *
+ * A canvas image is a compact binary snapshot of a canvas: the instance
+ * stack, the audio and control routing stacks and the serialized parameter
+ * block of every effect.  All multi-byte fields are little-endian.
+ *
+ *  Header (12 bytes)
+ *    magic       "DMFX"
+ *    version     u8   (CANVAS_IMAGE_VERSION)
+ *    flags       u8   (reserved, 0)
+ *    api_version u16  (API_VERSION of the library that wrote the image)
+ *    instances   u8   (including the canvas itself at index 0)
+ *    audio       u8   (number of audio routes)
+ *    control     u8   (number of control routes)
+ *    reserved    u8
+ *
+ *  Instance record (2 bytes):       id, type
+ *  Audio route record (4 bytes):    src_id, src_node, dest_id, dest_node
+ *  Control route record (15 bytes): src_id, src_node, src_param, dest_id,
+ *                                   dest_node, dest_param, scale (f32),
+ *                                   offset (f32), type
+ *  Parameter record (4 + 2n bytes): id, type, n (u16), n x u16 words
+ *                                   (one per effect instance, in order)
+ *  Trailer (2 bytes):               CRC-16/CCITT over everything before it
+ *
+ ***********************************************************************/
+
+#define CANVAS_IMAGE_VERSION          (1)
+#define CANVAS_IMAGE_HEADER_SIZE      (12)
+#define CANVAS_IMAGE_INSTANCE_SIZE    (2)
+#define CANVAS_IMAGE_AUDIO_SIZE       (4)
+#define CANVAS_IMAGE_CONTROL_SIZE     (15)
+#define CANVAS_IMAGE_PARAM_HDR_SIZE   (4)
+#define CANVAS_IMAGE_TRAILER_SIZE     (2)
+
+// Largest image fx_canvas_reader can take in chunks; the chunks are kept 
+// until the trailer has been checked and only then sent to the DSP.  Can 
+// be changed in the build flags (load_canvas() does not need this buffer).
+#ifndef CANVAS_IMAGE_STAGING_SIZE
+  #define CANVAS_IMAGE_STAGING_SIZE   (4096)
+#endif
+
+/**
+ * Result of feeding data to a canvas image reader
+ */
+typedef enum {
+  CANVAS_IMAGE_OK,              /**< Data consumed, more data expected */
+  CANVAS_IMAGE_COMPLETE,        /**< Image has been fully read and verified */
+  CANVAS_IMAGE_ERR_MAGIC,       /**< Data is not a canvas image */
+  CANVAS_IMAGE_ERR_VERSION,     /**< Image was written with an unsupported format version */
+  CANVAS_IMAGE_ERR_CAPACITY,    /**< Image has more instances / routes / parameters (or bytes) than this build supports */
+  CANVAS_IMAGE_ERR_CORRUPT,     /**< A record references an instance, node or node type that does not exist */
+  CANVAS_IMAGE_ERR_CRC,         /**< Checksum mismatch */
+  CANVAS_IMAGE_ERR_STATE,       /**< Data fed after image was complete or after an error */
+  CANVAS_IMAGE_ERR_PARAMS,      /**< A parameter record does not match the parameter table of its effect */
+  CANVAS_IMAGE_ERR_NO_SLOTS,    /**< Image was to be preloaded but the DSP firmware has no shadow canvas slot */
+} CANVAS_IMAGE_STATUS;
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+typedef enum {
+  CANVAS_RD_HEADER,
+  CANVAS_RD_INSTANCES,
+  CANVAS_RD_AUDIO_ROUTES,
+  CANVAS_RD_CONTROL_ROUTES,
+  CANVAS_RD_PARAM_HEADER,
+  CANVAS_RD_PARAM_WORDS,
+  CANVAS_RD_TRAILER,
+  CANVAS_RD_DONE,
+  CANVAS_RD_ERROR
+} CANVAS_READER_STATE;
+
+/**
+ * @brief      Updates a CRC-16/CCITT (0x1021, init 0xFFFF) with one byte
+ */
+uint16_t canvas_image_crc16(uint16_t crc, uint8_t b);
+
+#endif  // DOXYGEN_SHOULD_SKIP_THIS
+
+
+/**
+ * @brief      Streaming reader for canvas images
+ *
+ * The reader decodes an image in arbitrary sized chunks so it can be fed
+ * straight from a serial port, an SPI flash page or an SD card block.  The
+ * chunks are checked as they arrive and kept in a staging buffer (up to 
+ * CANVAS_IMAGE_STAGING_SIZE bytes); nothing is sent to the DSP until the 
+ * trailer CRC checks out, so a corrupt or truncated image leaves the running 
+ * canvas alone.  The instance and routing stacks of the pedal are then 
+ * rebuilt from the image (effect constructors are never called) and the 
+ * parameter blocks are sent to the DSP.  Each parameter block must have the 
+ * size given by the parameter table of its effect.
+ *
+ * ``` CPP
+ * fx_canvas_reader reader(&pedal);
+ *
+ * reader.begin();
+ * while (chunk_available()) {
+ *   if (reader.feed(chunk, chunk_len) > CANVAS_IMAGE_COMPLETE) {
+ *     // handle error
+ *   }
+ * }
+ * ```
+ *
+ * Calling `begin(true)` loads the image into the shadow canvas slot instead so 
+ * it can be swapped in with `fx_pedal::swap_canvas()`.  If the DSP firmware 
+ * has no shadow slot, the reader fails straight away with 
+ * CANVAS_IMAGE_ERR_NO_SLOTS.
+ *
+ * Constructing the reader with a NULL pedal decodes the image and prints its
+ * contents to the Serial console instead, which is handy for inspecting a
+ * stored image.
+ */
+class fx_canvas_reader {
+
+  private:
+    friend class fx_pedal;
+
+    fx_pedal *          pedal;
+    CANVAS_READER_STATE state;
+    CANVAS_IMAGE_STATUS status;
+    uint8_t             rec[CANVAS_IMAGE_CONTROL_SIZE];
+    uint8_t             rec_len;
+    uint16_t            crc;
+    uint8_t             total_instances, total_audio, total_control;
+    uint8_t             rec_indx;
+    uint8_t             instance_types[MAX_INSTANCES];
+    uint8_t             param_instance;
+    uint16_t            param_words, param_words_read;
+    uint16_t *          param_block;
+    bool                preload, shadow_selected;
+
+    // Records are only applied to the pedal (or printed) when apply is set;
+    // otherwise the image is just checked and, if stage is set, kept in the 
+    // staging buffer until it is complete
+    bool                apply, stage;
+    uint32_t            staged_len;
+
+    void  reset(bool apply_records);
+    CANVAS_IMAGE_STATUS load(const uint8_t * image, uint32_t len);
+    CANVAS_IMAGE_STATUS replay(const uint8_t * image, uint32_t len);
+    CANVAS_IMAGE_STATUS read_all(const uint8_t * image, uint32_t len);
+    bool  take(uint8_t b, uint8_t len);
+    void  fail(CANVAS_IMAGE_STATUS err);
+    void  process_byte(uint8_t b);
+    void  process_record(void);
+    void  next_param_record(void);
+
+  public:
+
+    fx_canvas_reader(fx_pedal * p);
+
+    void                begin(void);
+    void                begin(bool to_shadow);
+    CANVAS_IMAGE_STATUS feed(const uint8_t * data, uint32_t len);
+    CANVAS_IMAGE_STATUS get_status(void) { return status; }
+};
+
+#endif  // DM_FX_CANVAS_IMAGE_H
@@ -370,13 +370,13 @@ void adau1761_initialize(void) {
 
   uint8_t * init_ptr = (uint8_t *) adau1761_tx_buffer;
 
-  for (int row=0;row<sizeof(adau1761_num_bytes)/sizeof(uint16_t);row++) {
+  for (int row=0;row<(int) (sizeof(adau1761_num_bytes)/sizeof(uint16_t));row++) {
     uint16_t size = adau1761_num_bytes[row];
     Wire2.beginTransmission(0x38);
     for (int i=0;i<size;i++) {
       Wire2.write(*init_ptr++);      
     }
-    uint8_t res = Wire2.endTransmission();
+    Wire2.endTransmission();
 
     delay(10);
   }
@@ -83,6 +83,40 @@ void reset_into_bootloader(void) {
     *DBL_TAP_PTR = DBL_TAP_MAGIC;
     NVIC_SystemReset();
 }
+
+
+#if defined (__arm__)
+  extern "C" char * sbrk(int incr);
+#else
+  #include <unistd.h>
+#endif
+
+// First address after .bss, i.e. the bottom of the heap
+extern "C" char end;
+
+/**
+ * @brief      Returns the number of bytes the heap has grown to since boot
+ * 
+ * The heap is never given back to the system so this is also the heap high 
+ * water mark.
+ */
+uint32_t debug_heap_used(void) {
+  return (uint32_t) ((char *) sbrk(0) - &end);
+}
+
+/**
+ * @brief      Returns the number of bytes between the top of the heap and the
+ *             current stack pointer
+ */
+uint32_t debug_stack_free(void) {
+#if defined (__arm__)
+  char top;
+  return (uint32_t) (&top - (char *) sbrk(0));
+#else
+  // Heap and stack are not adjacent on a host build
+  return 0;
+#endif
+}
 #endif 
 
 
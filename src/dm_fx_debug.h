@@ -49,6 +49,17 @@ void  display_error_status(uint8_t error_number);
  */
 void reset_into_bootloader(void);
 
+/**
+ * @brief      Returns the number of bytes the heap has grown to since boot
+ */
+uint32_t debug_heap_used(void);
+
+/**
+ * @brief      Returns the number of bytes between the top of the heap and the
+ *             current stack pointer (0 on hosts where the two are not adjacent)
+ */
+uint32_t debug_stack_free(void);
+
 #endif 
 
 #endif 	// DM_FX_DEBUG_H
\ No newline at end of file
@@ -87,7 +87,7 @@ bool wait_for_canvas_to_start(void) {
   while (!dsp_status.state_canvas_running && timeout_cntr_1s) {
     spi_fifo_push_emptry_frame();  
     spi_transmit_buffered_frames(false);    
-    int now = millis();
+    uint32_t now = millis();
     while (millis() < now + delay) {
       display_data_from_sharc();
     }
@@ -104,6 +104,42 @@ bool wait_for_canvas_to_start(void) {
 } 
 
 
+/**
+ * @brief      Waits for the DSP to report that a change to the shadow canvas has 
+ *             taken effect (i.e. a preload is ready or a swap has completed)
+ *
+ * Unlike wait_for_canvas_to_start(), a timeout here is not fatal since the 
+ * active canvas keeps running.
+ *
+ * @param[in]  ready  The shadow ready state to wait for
+ *
+ * @return     True if the DSP reached this state, false if it timed out
+ */
+bool wait_for_shadow_canvas(bool ready) {
+
+  DEBUG_MSG("Starting", MSG_DEBUG); 
+
+  int delay = 25;
+  int timeout_cntr_1s = 1000/delay;
+
+  while (dsp_status.state_shadow_ready != ready && timeout_cntr_1s) {
+    spi_fifo_push_emptry_frame();  
+    spi_transmit_buffered_frames(false);    
+    uint32_t now = millis();
+    while (millis() < now + delay) {
+      display_data_from_sharc();
+    }
+    timeout_cntr_1s--;
+  }
+  if (!timeout_cntr_1s) {
+    DEBUG_MSG("DSP did not respond to shadow canvas request", MSG_WARN); 
+    return false;
+  }
+
+  DEBUG_MSG("Complete", MSG_DEBUG); 
+
+  return true;
+} 
 
 
 
@@ -200,7 +236,7 @@ void  wait_for_dsp_to_be_ready(void) {
     while ((dsp_status.state_flags & 0x70) != 0x70 && timeout_cntr_3s) {
       spi_fifo_push_emptry_frame();  
       spi_transmit_buffered_frames(false);    
-      int now = millis();
+      uint32_t now = millis();
       while (millis() < now + delay) {
         display_data_from_sharc();
       }
@@ -255,6 +291,7 @@ void report_canvas_errors(void) {
  * @brief      Reads any serial telemetry data from the DSP and displays it
  */
 void display_data_from_sharc(void) {
+  FX_PROFILE_ZONE("telemetry");
   static int line_indx = 0;
   static char line[256];
 
@@ -268,7 +305,7 @@ void display_data_from_sharc(void) {
       line_indx = 0;
     } else {
       line[line_indx++] = b;
-      if (line_indx >= sizeof(line)) {
+      if (line_indx >= (int) sizeof(line)) {
         line_indx = sizeof(line) - 1;
       }
     }
@@ -293,6 +330,12 @@ void display_data_from_sharc(void) {
 #define SPI_STATUS_BUSY         (0x1)
 #define SPI_STATUS_WRITE_EN     (0x2)
 
+#define SPI_FLASH_PAGE_SIZE     (256)
+#define SPI_FLASH_SECTOR_SIZE   (4096)
+
+// Results of the last firmware update
+DSP_FIRMWARE_UPDATE_STATS dsp_firmware_update_stats;
+
 
 /**
  * @brief Asserts the reset line on the DSP
@@ -374,21 +417,20 @@ static bool spi_flash_check_busy(void) {
 
 
 /**
- * @brief Erases the entire flash memory
+ * @brief Erases the 4 KB sector that contains an address
  */
-static void    spi_flash_erase_chip(void) {
+static void    spi_flash_erase_sector(uint32_t address) {
 
-    if (Serial && dmfx_debug_mode) {
-      Serial.print(" - Firmware update: erasing flash...");
-    }
     spi_flash_send_byte(CMD_SPI_WRITE_EN);
-    spi_flash_send_byte(CMD_SPI_CHIP_ERASE);
-    while (spi_flash_check_busy());
 
-    if (Serial && dmfx_debug_mode) {
-      Serial.println(" complete");
-    }
+    spi_flash_start_transfer();
+    SPI.transfer(CMD_SPI_SECTOR_ERASE);
+    SPI.transfer((address >> 16) & 0xFF);
+    SPI.transfer((address >> 8) & 0xFF);
+    SPI.transfer((address >> 0) & 0xFF);
+    spi_flash_end_transfer();
 
+    while (spi_flash_check_busy());
 }
 
 /**
@@ -481,19 +523,70 @@ static bool    spi_flash_page_write(uint32_t address, const uint8_t * vals, uint
 }
 
 
+/**
+ * @brief Compares flash memory with a block of the firmware image
+ * 
+ * The flash holds the image with the bit order of each byte flipped (see 
+ * flip_bit_order()).  The read stops at the first byte that differs.
+ *
+ * @return     True if the flash matches
+ */
+static bool    spi_flash_compare(uint32_t address, const uint8_t * vals, uint32_t count) {
+
+    spi_flash_start_transfer();
+    SPI.transfer(CMD_SPI_READ);
+    SPI.transfer((address >> 16) & 0xFF);
+    SPI.transfer((address >> 8) & 0xFF);
+    SPI.transfer((address >> 0) & 0xFF);
+
+    bool match = true;
+    for (uint32_t i=0;i<count && match;i++) {
+      match = (SPI.transfer(0x0) == flip_bit_order(vals[i]));
+    }
+    spi_flash_end_transfer();
+
+    return match;
+}
+
+/**
+ * @brief Erases and programs one sector of the firmware image and checks it
+ *
+ * @return     True if the sector reads back correctly
+ */
+static bool    spi_flash_program_sector(uint32_t address, const uint8_t * vals, uint32_t count) {
+
+    spi_flash_erase_sector(address);
+    for (uint32_t offset=0;offset<count;offset+=SPI_FLASH_PAGE_SIZE) {
+      uint32_t page = count - offset;
+      if (page > SPI_FLASH_PAGE_SIZE) {
+        page = SPI_FLASH_PAGE_SIZE;
+      }
+      spi_flash_page_write(address + offset, &vals[offset], page);
+    }
+    return spi_flash_compare(address, vals, count);
+}
+
+
 const PROGMEM uint8_t firmware_image[] = {
     #include "dm_fx_dsp_firmware_image.dat"
 };
 
 /**
  * @brief      Flashes the DSP boot flash and then resets the DSP
+ * 
+ * Each 4 KB sector of the flash is read back and compared with the image;
+ * only the sectors that differ are erased and programmed, so an update that
+ * changes a few sectors is much faster than a full reprogram.  The results
+ * are left in dsp_firmware_update_stats.
  *
- * @return     True if successful, false if not
+ * @return     True if successful, false if a sector did not read back 
+ *             correctly after programming
  */
 bool dsp_update_firmware_image(void) {
 
   uint8_t * vals = (uint8_t *) firmware_image;
   uint32_t count = sizeof(firmware_image);
+  uint32_t start = millis();
 
   // Set up SPI select pin
   pinMode(SPI_SHARC_SELECT, OUTPUT); 
@@ -509,22 +602,35 @@ bool dsp_update_firmware_image(void) {
   dsp_assert_reset();
 
   spi_flash_clear_protect();
-  spi_flash_erase_chip();
-
-  uint32_t page_count = (count >> 8) + 1;
-  uint32_t address = 0;
 
   if (Serial && dmfx_debug_mode) {
-    Serial.print(" - Firmware update: programming...");
+    Serial.print(" - Firmware update: programming changed sectors...");
   }
 
   turn_on_right_footsw_led();
   turn_off_left_footsw_led();
 
-  uint32_t byte_cnt = 0;
-  for (int i=0;i<page_count;i++) {    
-    spi_flash_page_write(address, &vals[address], 256); 
-    address += 256;
+  dsp_firmware_update_stats.sectors = 0;
+  dsp_firmware_update_stats.sectors_written = 0;
+  dsp_firmware_update_stats.bytes_written = 0;
+  dsp_firmware_update_stats.sectors_failed = 0;
+
+  bool success = true;
+  for (uint32_t address=0;address<count;address+=SPI_FLASH_SECTOR_SIZE) {
+    uint32_t size = count - address;
+    if (size > SPI_FLASH_SECTOR_SIZE) {
+      size = SPI_FLASH_SECTOR_SIZE;
+    }
+    dsp_firmware_update_stats.sectors++;
+    if (spi_flash_compare(address, &vals[address], size)) {
+      continue;
+    }
+    if (!spi_flash_program_sector(address, &vals[address], size)) {
+      dsp_firmware_update_stats.sectors_failed++;
+      success = false;
+    }
+    dsp_firmware_update_stats.sectors_written++;
+    dsp_firmware_update_stats.bytes_written += size;
   }
 
   turn_on_right_footsw_led();
@@ -534,10 +640,14 @@ bool dsp_update_firmware_image(void) {
   pinMode(SPI_SHARC_SELECT, INPUT); 
   SPI.end(); 
 
+  dsp_firmware_update_stats.elapsed_ms = millis() - start;
 
 	if (Serial && dmfx_debug_mode) {
 	  Serial.println(" complete");
 	}
+  if (!success) {
+    DEBUG_MSG("DSP boot flash did not verify after programming", MSG_ERROR);
+  }
   
 
   turn_off_right_footsw_led();
@@ -545,7 +655,7 @@ bool dsp_update_firmware_image(void) {
 
   dsp_deassert_reset();
 
-  return true;
+  return success;
   
 }
 
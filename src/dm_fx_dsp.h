@@ -4,6 +4,8 @@
 #ifndef DM_FX_DSP_H
 #define DM_FX_DSP_H
 
+// Parameter values the DSP can return in one status frame
+#define SPI_READBACK_SLOTS  (4)
 
 typedef struct {
   uint16_t  index;
@@ -27,11 +29,18 @@ typedef struct {
   bool      state_lf_audio_running;
   bool      state_hf_audio_running;
   bool      state_canvas_running;
+  bool      state_shadow_ready;
+  bool      cap_canvas_slots;   // Firmware supports preloading into a shadow canvas slot
   bool      state_err_allocation;
   bool      state_err_param;
   bool      state_err_corrupt;
   bool      state_err_other;
   uint16_t  state_flags;
+  uint32_t  block_count;        // Audio blocks processed by the DSP (0 if not reported)
+  uint32_t  block_count_us;     // micros() when block_count was received
+  uint16_t  readback_count;     // Parameter values returned in the last status frame
+  uint16_t  readback_key[SPI_READBACK_SLOTS];     // instance id << 8 | parameter id
+  uint32_t  readback_value[SPI_READBACK_SLOTS];   // Raw bits of the value
 } DSP_STATUS;
 
 // Global DSP status variable
@@ -77,6 +86,16 @@ void  wait_for_dsp_to_boot(void);
  */
 bool wait_for_canvas_to_start(void);
 
+/**
+ * @brief      Waits for the DSP to report that a change to the shadow canvas has 
+ *             taken effect (i.e. a preload is ready or a swap has completed)
+ *
+ * @param[in]  ready  The shadow ready state to wait for
+ *
+ * @return     True if the DSP reached this state, false if it timed out
+ */
+bool wait_for_shadow_canvas(bool ready);
+
 /**
  * @brief      Resets the DSP and waits for it to stop booting
  */
@@ -92,10 +111,23 @@ void display_data_from_sharc(void);
  */
 void report_canvas_errors(void) ;
 
+// Results of the last dsp_update_firmware_image()
+typedef struct {
+  uint32_t  sectors;            // Sectors of the boot flash the image covers
+  uint32_t  sectors_written;    // Sectors that differed and were reprogrammed
+  uint32_t  sectors_failed;     // Reprogrammed sectors that did not read back correctly
+  uint32_t  bytes_written;
+  uint32_t  elapsed_ms;
+} DSP_FIRMWARE_UPDATE_STATS;
+
+extern DSP_FIRMWARE_UPDATE_STATS dsp_firmware_update_stats;
+
 /**
- * @brief      Flashes the DSP boot flash and then resets the DSP
+ * @brief      Reprograms the sectors of the DSP boot flash that differ from
+ *             the firmware image and then resets the DSP
  *
- * @return     True if successful, false if not
+ * @return     True if successful, false if a sector did not verify (calling
+ *             it again retries just the sectors that still differ)
  */
 bool dsp_update_firmware_image(void);
 
@@ -0,0 +1,115 @@
+// Copyright (c) 2020 Run Jump Labs LLC.  All right reserved.
+// This code is licensed under MIT license (see license.txt for details)
+
+#include "dreammakerfx.h"
+#include "dm_fx_gesture.h"
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+
+/************************************************************************
+ *
+ *                        Footswitch gestures
+ *
+ ***********************************************************************/
+
+#define GESTURE_BIT(g)    (1 << (g))
+
+// Times are compared as differences so they survive micros() wrapping
+static inline bool gesture_time_reached(uint32_t now, uint32_t t) {
+  return (int32_t) (now - t) >= 0;
+}
+
+static int gesture_add(FX_GESTURE_EVENT * events, int n, uint8_t gesture, uint32_t time_us) {
+  events[n].gesture = gesture;
+  events[n].time_us = time_us;
+  return n + 1;
+}
+
+
+void gesture_init(FX_GESTURE_DECODER * g, uint8_t enabled) {
+  g->state = GESTURE_STATE_IDLE;
+  g->enabled = enabled;
+  g->down = false;
+  g->edge_us = 0;
+  g->next_us = 0;
+}
+
+
+int gesture_poll(FX_GESTURE_DECODER * g, uint32_t now_us, FX_GESTURE_EVENT * events) {
+
+  uint32_t long_us = GESTURE_LONG_PRESS_MS * 1000;
+  uint32_t repeat_us = GESTURE_HOLD_REPEAT_MS * 1000;
+  int n = 0;
+
+  if (g->state == GESTURE_STATE_WAIT_SECOND) {
+    uint32_t due = g->edge_us + GESTURE_DOUBLE_TAP_MS * 1000;
+    if (gesture_time_reached(now_us, due)) {
+      g->state = GESTURE_STATE_IDLE;
+      n = gesture_add(events, n, GESTURE_TAP, due);
+    }
+    return n;
+  }
+
+  if (g->state == GESTURE_STATE_DOWN) {
+    uint32_t due = g->edge_us + long_us;
+    if ((g->enabled & (GESTURE_BIT(GESTURE_LONG_PRESS) | GESTURE_BIT(GESTURE_HOLD))) &&
+        gesture_time_reached(now_us, due)) {
+      g->state = GESTURE_STATE_HELD;
+      g->next_us = due + repeat_us;
+      n = gesture_add(events, n, GESTURE_LONG_PRESS, due);
+    }
+  }
+
+  if (g->state == GESTURE_STATE_HELD && (g->enabled & GESTURE_BIT(GESTURE_HOLD)) &&
+      gesture_time_reached(now_us, g->next_us)) {
+    uint32_t due = g->next_us;
+    // Repeats missed by a late poll are dropped rather than sent together
+    while (gesture_time_reached(now_us, g->next_us)) {
+      g->next_us += repeat_us;
+    }
+    n = gesture_add(events, n, GESTURE_HOLD, due);
+  }
+  return n;
+}
+
+
+int gesture_edge(FX_GESTURE_DECODER * g, bool pressed, uint32_t time_us, FX_GESTURE_EVENT * events) {
+
+  if (pressed == g->down) {
+    return 0;
+  }
+
+  // Anything that was due before this edge happened first
+  int n = gesture_poll(g, time_us, events);
+  g->down = pressed;
+
+  if (pressed) {
+    if (g->state == GESTURE_STATE_WAIT_SECOND) {
+      g->state = GESTURE_STATE_DONE;
+      return gesture_add(events, n, GESTURE_DOUBLE_TAP, time_us);
+    }
+    g->edge_us = time_us;
+    if (!(g->enabled & (GESTURE_BIT(GESTURE_DOUBLE_TAP) | GESTURE_BIT(GESTURE_LONG_PRESS) | GESTURE_BIT(GESTURE_HOLD)))) {
+      // Nothing else a press could become
+      g->state = GESTURE_STATE_DONE;
+      return gesture_add(events, n, GESTURE_TAP, time_us);
+    }
+    g->state = GESTURE_STATE_DOWN;
+    return n;
+  }
+
+  if (g->state == GESTURE_STATE_DOWN) {
+    if (g->enabled & GESTURE_BIT(GESTURE_DOUBLE_TAP)) {
+      g->state = GESTURE_STATE_WAIT_SECOND;
+      g->edge_us = time_us;
+      return n;
+    }
+    g->state = GESTURE_STATE_IDLE;
+    return gesture_add(events, n, GESTURE_TAP, time_us);
+  }
+  g->state = GESTURE_STATE_IDLE;
+  return n;
+}
+
+#endif  // DOXYGEN_SHOULD_SKIP_THIS
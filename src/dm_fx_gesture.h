@@ -0,0 +1,100 @@
+// Copyright (c) 2020 Run Jump Labs LLC.  All right reserved.
+// This code is licensed under MIT license (see license.txt for details)
+#ifndef DM_FX_GESTURE_H
+#define DM_FX_GESTURE_H
+
+/************************************************************************
+ *
+ *                        Footswitch gestures
+ *
+ * Each footswitch has a decoder that is fed the press and release edges
+ * timestamped by the footswitch interrupts, and turns them into gestures:
+ *
+ *   GESTURE_TAP          A press shorter than GESTURE_LONG_PRESS_MS
+ *   GESTURE_DOUBLE_TAP   A second press within GESTURE_DOUBLE_TAP_MS of
+ *                        the end of a tap
+ *   GESTURE_LONG_PRESS   A press held for GESTURE_LONG_PRESS_MS
+ *   GESTURE_HOLD         Every GESTURE_HOLD_REPEAT_MS after a long press
+ *                        while the footswitch is still held
+ *
+ * A tap is reported as soon as it can no longer become anything else: on
+ * the press when no long press, hold or double tap handler is added for
+ * that footswitch, on the release when only long press or hold handlers
+ * are, and GESTURE_DOUBLE_TAP_MS after the release when a double tap
+ * handler is.
+ *
+ ***********************************************************************/
+
+/**
+ * Footswitch gestures (see `fx_pedal::add_gesture_handler()`)
+ */
+typedef enum {
+  GESTURE_TAP,          /**< Footswitch pressed and released */
+  GESTURE_DOUBLE_TAP,   /**< Footswitch tapped twice quickly */
+  GESTURE_LONG_PRESS,   /**< Footswitch held down */
+  GESTURE_HOLD,         /**< Repeats while the footswitch is held after a long press */
+  GESTURE_TOTAL
+} FOOTSWITCH_GESTURE;
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+typedef enum {
+  GESTURE_STATE_IDLE,
+  GESTURE_STATE_DOWN,         // Pressed, not decided yet
+  GESTURE_STATE_WAIT_SECOND,  // Released, a second press would be a double tap
+  GESTURE_STATE_HELD,         // Long press reported, hold repeats follow
+  GESTURE_STATE_DONE          // Gesture reported, waiting for the release
+} GESTURE_STATE;
+
+typedef struct {
+  uint8_t     gesture;        // FOOTSWITCH_GESTURE
+  uint32_t    time_us;        // When the gesture could first be told apart
+} FX_GESTURE_EVENT;
+
+typedef struct {
+  uint8_t     state;          // GESTURE_STATE
+  uint8_t     enabled;        // Gestures with handlers (1 << FOOTSWITCH_GESTURE)
+  bool        down;
+  uint32_t    edge_us;        // Last press, or last release in GESTURE_STATE_WAIT_SECOND
+  uint32_t    next_us;        // Next hold repeat
+} FX_GESTURE_DECODER;
+
+// A late poll can find a long press and a hold due, and an edge adds its own
+#define GESTURE_MAX_EVENTS    (3)
+
+/**
+ * @brief      Resets a decoder
+ *
+ * @param      g        The decoder
+ * @param[in]  enabled  Gestures to tell apart (1 << FOOTSWITCH_GESTURE)
+ */
+void      gesture_init(FX_GESTURE_DECODER * g, uint8_t enabled);
+
+/**
+ * @brief      Feeds a press or release to a decoder (edges that do not change
+ *             the state of the footswitch are ignored)
+ *
+ * @param      g        The decoder
+ * @param[in]  pressed  True for a press
+ * @param[in]  time_us  When it happened (micros())
+ * @param      events   Gestures decoded (output, GESTURE_MAX_EVENTS)
+ *
+ * @return     The number of gestures decoded
+ */
+int       gesture_edge(FX_GESTURE_DECODER * g, bool pressed, uint32_t time_us, FX_GESTURE_EVENT * events);
+
+/**
+ * @brief      Decodes gestures that are due by a time without a new edge
+ *             (long press, hold, a tap with no second press)
+ *
+ * @param      g        The decoder
+ * @param[in]  now_us   The time (micros())
+ * @param      events   Gestures decoded (output, GESTURE_MAX_EVENTS)
+ *
+ * @return     The number of gestures decoded
+ */
+int       gesture_poll(FX_GESTURE_DECODER * g, uint32_t now_us, FX_GESTURE_EVENT * events);
+
+#endif  // DOXYGEN_SHOULD_SKIP_THIS
+
+#endif  // DM_FX_GESTURE_H
@@ -0,0 +1,111 @@
+// Copyright (c) 2020 Run Jump Labs LLC.  All right reserved.
+// This code is licensed under MIT license (see license.txt for details)
+
+#include <math.h>
+#include "dm_fx_midi.h"
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+
+/************************************************************************
+ *
+ *                        MIDI parser
+ *
+ ***********************************************************************/
+
+// Data bytes that follow a status byte
+static uint8_t midi_data_length(uint8_t status) {
+  switch (status & 0xF0) {
+    case MIDI_PROGRAM_CHANGE:
+    case MIDI_CHANNEL_PRESSURE:
+      return 1;
+    case 0xF0:
+      break;
+    default:
+      return 2;
+  }
+  if (status == 0xF1 || status == 0xF3) {     // Time code quarter frame, song select
+    return 1;
+  }
+  if (status == 0xF2) {                       // Song position
+    return 2;
+  }
+  return 0;
+}
+
+
+void midi_parser_init(FX_MIDI_PARSER * p) {
+  p->status = 0;
+  p->count = 0;
+  p->sysex = false;
+  p->stray_bytes = 0;
+}
+
+
+bool midi_parse_byte(FX_MIDI_PARSER * p, uint8_t b, FX_MIDI_MSG * msg) {
+
+  // Real-time bytes can arrive anywhere and leave the message being
+  // assembled alone
+  if (b >= MIDI_CLOCK) {
+    if (b == 0xFD) {
+      return false;
+    }
+    msg->status = b;
+    msg->data1 = 0;
+    msg->data2 = 0;
+    return true;
+  }
+
+  if (b & 0x80) {
+    p->count = 0;
+    p->sysex = (b == MIDI_SYSEX_START);
+    if (b < 0xF0 || midi_data_length(b) > 0) {
+      p->status = b;
+      return false;
+    }
+
+    // System common messages cancel running status
+    p->status = 0;
+    if (b != 0xF6) {              // Only tune request stands alone
+      return false;
+    }
+    msg->status = b;
+    msg->data1 = 0;
+    msg->data2 = 0;
+    return true;
+  }
+
+  if (p->sysex) {
+    return false;
+  }
+  if (p->status == 0) {
+    p->stray_bytes++;
+    return false;
+  }
+
+  p->data[p->count++] = b;
+  if (p->count < midi_data_length(p->status)) {
+    return false;
+  }
+
+  msg->status = p->status;
+  msg->data1 = p->data[0];
+  msg->data2 = (p->count > 1) ? p->data[1] : 0;
+  p->count = 0;
+
+  // Only channel messages keep running status
+  if (p->status >= 0xF0) {
+    p->status = 0;
+  }
+  if ((msg->status & 0xF0) == MIDI_NOTE_ON && msg->data2 == 0) {
+    msg->status = MIDI_NOTE_OFF | (msg->status & 0x0F);
+  }
+  return true;
+}
+
+
+float midi_note_to_hz(uint8_t note) {
+  return 440.0f * powf(2.0f, ((float) note - 69.0f) * (1.0f / 12.0f));
+}
+
+#endif  // DOXYGEN_SHOULD_SKIP_THIS
@@ -0,0 +1,86 @@
+// Copyright (c) 2020 Run Jump Labs LLC.  All right reserved.
+// This code is licensed under MIT license (see license.txt for details)
+#ifndef DM_FX_MIDI_H
+#define DM_FX_MIDI_H
+
+#include <stdint.h>
+
+
+/************************************************************************
+ *
+ *                        MIDI parser
+ *
+ * Turns the bytes of a MIDI 1.0 stream into messages one byte at a time,
+ * with no buffering beyond the message being assembled.  Handles running
+ * status, real-time bytes (clock, start, stop) in the middle of other
+ * messages, and skips system exclusive data.  A note on with velocity 0 is
+ * reported as a note off.
+ *
+ * The parser only needs <stdint.h>, so it can be built on a desktop and fed
+ * byte streams recorded from an instrument or extracted from .mid files.
+ *
+ ***********************************************************************/
+
+/**
+ * MIDI channel that matches messages on every channel (channels are 1 - 16)
+ */
+#define MIDI_CHANNEL_ANY          (0)
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+// Status bytes (channel messages have the channel in the low nibble)
+#define MIDI_NOTE_OFF             (0x80)
+#define MIDI_NOTE_ON              (0x90)
+#define MIDI_POLY_PRESSURE        (0xA0)
+#define MIDI_CONTROL_CHANGE       (0xB0)
+#define MIDI_PROGRAM_CHANGE       (0xC0)
+#define MIDI_CHANNEL_PRESSURE     (0xD0)
+#define MIDI_PITCH_BEND           (0xE0)
+#define MIDI_SYSEX_START          (0xF0)
+#define MIDI_SYSEX_END            (0xF7)
+#define MIDI_CLOCK                (0xF8)
+#define MIDI_START                (0xFA)
+#define MIDI_CONTINUE             (0xFB)
+#define MIDI_STOP                 (0xFC)
+
+#define MIDI_CLOCKS_PER_BEAT      (24)
+
+typedef struct {
+  uint8_t     status;             // Status byte (MIDI_NOTE_ON | channel, MIDI_CLOCK, ...)
+  uint8_t     data1;              // Note or controller number
+  uint8_t     data2;              // Velocity or controller value
+} FX_MIDI_MSG;
+
+typedef struct {
+  uint8_t     status;             // Running status (0 if none)
+  uint8_t     data[2];
+  uint8_t     count;              // Data bytes received for the current message
+  bool        sysex;              // Inside a system exclusive message
+  uint32_t    stray_bytes;        // Data bytes that belonged to no message
+} FX_MIDI_PARSER;
+
+/**
+ * @brief      Resets a parser
+ */
+void      midi_parser_init(FX_MIDI_PARSER * p);
+
+/**
+ * @brief      Feeds one byte to a parser
+ *
+ * @param      p     The parser
+ * @param[in]  b     The byte
+ * @param      msg   The message the byte completed (output)
+ *
+ * @return     True if the byte completed a message
+ */
+bool      midi_parse_byte(FX_MIDI_PARSER * p, uint8_t b, FX_MIDI_MSG * msg);
+
+/**
+ * @brief      Returns the frequency of a MIDI note in Hz (note 69 is A 440)
+ */
+float     midi_note_to_hz(uint8_t note);
+
+
+#endif    // DOXYGEN_SHOULD_SKIP_THIS
+
+#endif    // DM_FX_MIDI_H
@@ -0,0 +1,313 @@
+// Copyright (c) 2020 Run Jump Labs LLC.  All right reserved.
+// This code is licensed under MIT license (see license.txt for details)
+
+#include "dreammakerfx.h"
+#include "dm_fx_mod_matrix.h"
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+/************************************************************************
+ *
+ *                        Modulation matrix
+ *
+ ***********************************************************************/
+
+static const float mod_curve_linear[MOD_CURVE_POINTS] = {
+  0.0000, 0.0625, 0.1250, 0.1875, 0.2500, 0.3125, 0.3750, 0.4375, 0.5000,
+  0.5625, 0.6250, 0.6875, 0.7500, 0.8125, 0.8750, 0.9375, 1.0000
+};
+
+static const float mod_curve_inv[MOD_CURVE_POINTS] = {
+  1.0000, 0.9375, 0.8750, 0.8125, 0.7500, 0.6875, 0.6250, 0.5625, 0.5000,
+  0.4375, 0.3750, 0.3125, 0.2500, 0.1875, 0.1250, 0.0625, 0.0000
+};
+
+// log10(1 + 9x)
+static const float mod_curve_log[MOD_CURVE_POINTS] = {
+  0.0000, 0.1938, 0.3274, 0.4293, 0.5119, 0.5812, 0.6410, 0.6935, 0.7404,
+  0.7827, 0.8212, 0.8566, 0.8893, 0.9197, 0.9482, 0.9749, 1.0000
+};
+
+// 1 - log10(1 + 9(1 - x))
+static const float mod_curve_log_inv[MOD_CURVE_POINTS] = {
+  0.0000, 0.0251, 0.0518, 0.0803, 0.1107, 0.1434, 0.1788, 0.2173, 0.2596,
+  0.3065, 0.3590, 0.4188, 0.4881, 0.5707, 0.6726, 0.8062, 1.0000
+};
+
+static const float * mod_curve_table(MOD_CURVE curve) {
+  if (curve == MOD_CURVE_INV) return mod_curve_inv;
+  else if (curve == MOD_CURVE_LOG) return mod_curve_log;
+  else if (curve == MOD_CURVE_LOG_INV) return mod_curve_log_inv;
+  return mod_curve_linear;
+}
+
+/**
+ * @brief      Looks up a normalized source value in a curve, interpolating
+ *             between points
+ */
+static inline float mod_curve_lookup(const float * curve, float x) {
+  if (x <= 0.0) {
+    return curve[0];
+  }
+  float pos = x * (float) (MOD_CURVE_POINTS - 1);
+  int indx = (int) pos;
+  if (indx >= MOD_CURVE_POINTS - 1) {
+    return curve[MOD_CURVE_POINTS - 1];
+  }
+  return curve[indx] + (curve[indx + 1] - curve[indx]) * (pos - (float) indx);
+}
+
+#endif  // DOXYGEN_SHOULD_SKIP_THIS
+
+
+fx_mod_matrix::fx_mod_matrix(void) {
+  total_mappings = 0;
+  eval_us = 0;
+  max_eval_us = 0;
+}
+
+/**
+ * @brief      Adds a mapping, keeping mappings to the same parameter next to
+ *             each other so service() can sum them in one pass
+ */
+bool fx_mod_matrix::add_mapping(fx_pot * pot, MOD_SOURCE source, fx_control_node * dest, float min, float max, const float * curve) {
+
+  fx_effect * effect = dest->parent_effect;
+  if (effect == NULL || dest->node_direction != NODE_IN || dest->node_type != NODE_FLOAT) {
+    DEBUG_MSG("Modulation destination must be a float control input of an effect", MSG_ERROR);
+    display_error_status(ERROR_CODE_ILLEGAL_ROUTING);
+    return false;
+  }
+
+  float * param = NULL;
+  for (int i=0;i<effect->param_table_len;i++) {
+    if (effect->param_table[i].param_id == dest->param_id && effect->param_table[i].type == T_FLOAT) {
+      param = (float *) ((uint8_t *) effect + effect->param_table[i].member_offset);
+      break;
+    }
+  }
+  if (param == NULL) {
+    DEBUG_MSG("Modulation destination has no float parameter", MSG_ERROR);
+    display_error_status(ERROR_CODE_ILLEGAL_ROUTING);
+    return false;
+  }
+
+  if (total_mappings >= MAX_MOD_MAPPINGS) {
+    DEBUG_MSG("Too many modulation mappings - define MAX_MOD_MAPPINGS to allow more", MSG_ERROR);
+    display_error_status(ERROR_CODE_ILLEGAL_ROUTING);
+    return false;
+  }
+
+  // Insert after the last mapping to the same parameter
+  int indx = total_mappings;
+  for (int i=0;i<total_mappings;i++) {
+    if (mappings[i].param == param) {
+      indx = i + 1;
+    }
+  }
+  for (int i=total_mappings;i>indx;i--) {
+    mappings[i] = mappings[i-1];
+  }
+
+  FX_MOD_MAPPING * m = &mappings[indx];
+  m->pot = pot;
+  m->source = (uint8_t) source;
+  m->curve = curve;
+  m->min = min;
+  m->range = max - min;
+  m->dest = dest;
+  m->param = param;
+  total_mappings++;
+
+  return true;
+}
+
+/**
+ * @brief      Maps a pot or the expression pedal to an effect parameter
+ *
+ * ``` CPP
+ * mods.map(&pedal.pot_left, delay.feedback, 0.0, 0.9);
+ * ```
+ *
+ * @param      pot   The pot (e.g. `&pedal.pot_left` or `&pedal.exp_pedal`)
+ * @param      dest  The control node of the parameter (e.g. `delay.feedback`)
+ * @param[in]  min   The parameter value with the pot all the way down
+ * @param[in]  max   The parameter value with the pot all the way up
+ *
+ * @return     True on success
+ */
+bool fx_mod_matrix::map(fx_pot * pot, fx_control_node * dest, float min, float max) {
+  return add_mapping(pot, MOD_SRC_POT, dest, min, max, mod_curve_linear);
+}
+
+/**
+ * @brief      Maps a pot or the expression pedal to an effect parameter
+ *             through one of the built-in curves
+ *
+ * @param      pot    The pot
+ * @param      dest   The control node of the parameter
+ * @param[in]  min    The parameter value at the start of the curve
+ * @param[in]  max    The parameter value at the end of the curve
+ * @param[in]  curve  The curve (e.g. `MOD_CURVE_LOG`)
+ *
+ * @return     True on success
+ */
+bool fx_mod_matrix::map(fx_pot * pot, fx_control_node * dest, float min, float max, MOD_CURVE curve) {
+  return add_mapping(pot, MOD_SRC_POT, dest, min, max, mod_curve_table(curve));
+}
+
+/**
+ * @brief      Maps a pot or the expression pedal to an effect parameter
+ *             through a custom curve
+ *
+ * @param      pot    The pot
+ * @param      dest   The control node of the parameter
+ * @param[in]  min    The parameter value for a curve value of 0.0
+ * @param[in]  max    The parameter value for a curve value of 1.0
+ * @param[in]  curve  Array of `MOD_CURVE_POINTS` curve values
+ *
+ * @return     True on success
+ */
+bool fx_mod_matrix::map(fx_pot * pot, fx_control_node * dest, float min, float max, const float * curve) {
+  return add_mapping(pot, MOD_SRC_POT, dest, min, max, curve);
+}
+
+/**
+ * @brief      Maps tap tempo or DSP telemetry to an effect parameter
+ *
+ * ``` CPP
+ * mods.map(MOD_SRC_TAP_RATE, tremolo.rate_hz, 0.0, MOD_TAP_RATE_MAX_HZ);
+ * ```
+ *
+ * @param[in]  source  The source (e.g. `MOD_SRC_TAP_INTERVAL`)
+ * @param      dest    The control node of the parameter
+ * @param[in]  min     The parameter value for a source value of 0.0
+ * @param[in]  max     The parameter value for a source value of 1.0
+ *
+ * @return     True on success
+ */
+bool fx_mod_matrix::map(MOD_SOURCE source, fx_control_node * dest, float min, float max) {
+  return map(source, dest, min, max, mod_curve_linear);
+}
+
+/**
+ * @brief      Maps tap tempo or DSP telemetry to an effect parameter through
+ *             one of the built-in curves
+ *
+ * @param[in]  source  The source
+ * @param      dest    The control node of the parameter
+ * @param[in]  min     The parameter value at the start of the curve
+ * @param[in]  max     The parameter value at the end of the curve
+ * @param[in]  curve   The curve
+ *
+ * @return     True on success
+ */
+bool fx_mod_matrix::map(MOD_SOURCE source, fx_control_node * dest, float min, float max, MOD_CURVE curve) {
+  return map(source, dest, min, max, mod_curve_table(curve));
+}
+
+/**
+ * @brief      Maps tap tempo or DSP telemetry to an effect parameter through
+ *             a custom curve
+ *
+ * @param[in]  source  The source
+ * @param      dest    The control node of the parameter
+ * @param[in]  min     The parameter value for a curve value of 0.0
+ * @param[in]  max     The parameter value for a curve value of 1.0
+ * @param[in]  curve   Array of `MOD_CURVE_POINTS` curve values
+ *
+ * @return     True on success
+ */
+bool fx_mod_matrix::map(MOD_SOURCE source, fx_control_node * dest, float min, float max, const float * curve) {
+  if (source == MOD_SRC_POT || source >= MOD_SRC_TOTAL) {
+    DEBUG_MSG("Invalid modulation source - pass the pot itself to map pots", MSG_ERROR);
+    display_error_status(ERROR_CODE_ILLEGAL_ROUTING);
+    return false;
+  }
+  return add_mapping(NULL, source, dest, min, max, curve);
+}
+
+/**
+ * @brief      Removes all mappings (parameters keep their current values)
+ */
+void fx_mod_matrix::clear(void) {
+  total_mappings = 0;
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+/**
+ * @brief      Reads a system source, normalized to 0.0 -> 1.0
+ */
+float fx_mod_matrix::read_source(MOD_SOURCE source) {
+  float x;
+  if (source == MOD_SRC_TAP_INTERVAL) x = pedal.get_tap_interval_ms() * (1.0 / MOD_TAP_INTERVAL_MAX_MS);
+  else if (source == MOD_SRC_TAP_RATE) x = pedal.get_tap_freq_hz() * (1.0 / MOD_TAP_RATE_MAX_HZ);
+  else if (source == MOD_SRC_INPUT_LEVEL) x = dsp_status.amplitude;
+  else if (source == MOD_SRC_NOTE_FREQ) x = dsp_status.notes.freq * (1.0 / MOD_NOTE_FREQ_MAX_HZ);
+  else if (source == MOD_SRC_NEW_NOTE) x = dsp_status.new_note ? 1.0 : 0.0;
+  else x = 0.0;
+
+  if (x > 1.0) {
+    x = 1.0;
+  }
+  return x;
+}
+
+/**
+ * @brief      Writes the summed value of a destination and queues it for
+ *             the DSP
+ */
+void fx_mod_matrix::write_param(FX_MOD_MAPPING * m, float value, float range_lo, float range_hi) {
+
+  // Parameters routed from the DSP side are not written by the host
+  if (m->dest->connected) {
+    return;
+  }
+
+  fx_effect * effect = m->dest->parent_effect;
+  if (effect->float_within_deadband(m->param, value, range_lo, range_hi)) {
+    return;
+  }
+  effect->stop_ramp(m->param);
+  *m->param = value;
+  effect->transmit_param(m->param);
+}
+
+/**
+ * @brief      Evaluates every mapping; called from `fx_pedal::service()`
+ *             before the parameter update scheduler runs
+ */
+void fx_mod_matrix::service(void) {
+
+  uint32_t start = micros();
+
+  // Read each system source once per tick
+  float sources[MOD_SRC_TOTAL];
+  sources[MOD_SRC_POT] = 0.0;
+  for (int i=MOD_SRC_POT+1;i<MOD_SRC_TOTAL;i++) {
+    sources[i] = read_source((MOD_SOURCE) i);
+  }
+
+  float sum = 0.0, sum_lo = 0.0, sum_hi = 0.0;
+  for (int i=0;i<total_mappings;i++) {
+    FX_MOD_MAPPING * m = &mappings[i];
+    float x = (m->pot != NULL) ? m->pot->val : sources[m->source];
+    sum += m->min + m->range * mod_curve_lookup(m->curve, x);
+    sum_lo += (m->range < 0.0) ? m->min + m->range : m->min;
+    sum_hi += (m->range < 0.0) ? m->min : m->min + m->range;
+
+    // Mappings to one parameter are adjacent; write once the last is summed
+    if (i + 1 == total_mappings || mappings[i + 1].param != m->param) {
+      write_param(m, sum, sum_lo, sum_hi);
+      sum = sum_lo = sum_hi = 0.0;
+    }
+  }
+
+  eval_us = micros() - start;
+  if (eval_us > max_eval_us) {
+    max_eval_us = eval_us;
+  }
+}
+
+#endif  // DOXYGEN_SHOULD_SKIP_THIS
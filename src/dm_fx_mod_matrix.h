@@ -0,0 +1,141 @@
+// Copyright (c) 2020 Run Jump Labs LLC.  All right reserved.
+// This code is licensed under MIT license (see license.txt for details)
+#ifndef DM_FX_MOD_MATRIX_H
+#define DM_FX_MOD_MATRIX_H
+
+/************************************************************************
+ *
+ *                        Modulation matrix
+ *
+ * A mapping connects a source (a pot, the expression pedal, the tap tempo
+ * or the note telemetry from the DSP) through a curve to a control node of
+ * an effect.  Every mapping is evaluated once per service() tick; mappings
+ * to the same destination are added together and the result goes to the
+ * parameter update scheduler, which sends all changed parameters of that
+ * tick as one batch.
+ *
+ * Sources are normalized to 0.0 -> 1.0 before the curve is applied:
+ *   pots / expression pedal   position
+ *   MOD_SRC_TAP_INTERVAL      interval / MOD_TAP_INTERVAL_MAX_MS
+ *   MOD_SRC_TAP_RATE          rate / MOD_TAP_RATE_MAX_HZ
+ *   MOD_SRC_INPUT_LEVEL       input amplitude reported by the DSP
+ *   MOD_SRC_NOTE_FREQ         note frequency / MOD_NOTE_FREQ_MAX_HZ
+ *   MOD_SRC_NEW_NOTE          1.0 while the DSP reports a new note
+ *
+ ***********************************************************************/
+
+class fx_pot;
+class fx_control_node;
+
+#ifndef MAX_MOD_MAPPINGS
+  #define MAX_MOD_MAPPINGS      (32)
+#endif
+
+#define MOD_CURVE_POINTS        (17)
+
+#define MOD_TAP_INTERVAL_MAX_MS (2000.0)
+#define MOD_TAP_RATE_MAX_HZ     (10.0)
+#define MOD_NOTE_FREQ_MAX_HZ    (2000.0)
+
+/**
+ * Modulation sources other than pots
+ */
+typedef enum {
+  MOD_SRC_POT,            /**< A pot or the expression pedal (use the `fx_pot` version of `map()`) */
+  MOD_SRC_TAP_INTERVAL,   /**< Tap tempo interval */
+  MOD_SRC_TAP_RATE,       /**< Tap tempo rate */
+  MOD_SRC_INPUT_LEVEL,    /**< Instrument input level */
+  MOD_SRC_NOTE_FREQ,      /**< Frequency of the current note */
+  MOD_SRC_NEW_NOTE,       /**< New note event */
+  MOD_SRC_TOTAL
+} MOD_SOURCE;
+
+/**
+ * Built-in curves applied to a normalized source
+ */
+typedef enum {
+  MOD_CURVE_LINEAR,       /**< 0.0 -> 1.0 */
+  MOD_CURVE_INV,          /**< 1.0 -> 0.0 */
+  MOD_CURVE_LOG,          /**< Log curve, same as `fx_pot::val_log` */
+  MOD_CURVE_LOG_INV,      /**< Inverse log curve, same as `fx_pot::val_log_inv` */
+} MOD_CURVE;
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+typedef struct {
+  fx_pot *          pot;        // NULL when the source is not a pot
+  const float *     curve;      // MOD_CURVE_POINTS values, evenly spaced over 0.0 -> 1.0
+  float             min;
+  float             range;      // max - min
+  fx_control_node * dest;
+  float *           param;      // Parameter member behind dest
+  uint8_t           source;     // MOD_SOURCE
+} FX_MOD_MAPPING;
+
+#endif  // DOXYGEN_SHOULD_SKIP_THIS
+
+
+/**
+ * @brief      Maps pots, the expression pedal, tap tempo and note telemetry
+ *             to effect parameters
+ *
+ * Instead of checking each pot in `loop()` and calling setters, list the
+ * mappings once in `setup()` and let `pedal.service()` evaluate them:
+ *
+ * ``` CPP
+ * fx_mod_matrix mods;
+ *
+ * void setup() {
+ *   pedal.init();
+ *   ...
+ *   mods.map(&pedal.pot_left, delay.feedback, 0.0, 0.9);
+ *   mods.map(&pedal.pot_center, delay.wet_mix, 0.0, 1.0, MOD_CURVE_LOG);
+ *   mods.map(MOD_SRC_TAP_INTERVAL, delay.length_ms, 0.0, MOD_TAP_INTERVAL_MAX_MS);
+ *   pedal.add_mod_matrix(&mods);
+ *   pedal.run();
+ * }
+ * ```
+ *
+ * Several mappings to one destination are added together, so a second
+ * mapping with a minimum of 0.0 modulates around the first, e.g. the
+ * expression pedal adding up to 0.3 on top of a pot.  Custom curves are
+ * arrays of `MOD_CURVE_POINTS` values evenly spaced over the source range
+ * and must stay in scope while the matrix is used.
+ *
+ * Destinations are float control nodes.  A destination that is also the
+ * target of `pedal.route_control()` is left to the DSP, and a mapping
+ * cancels any ramp running on its parameter once it changes the value.
+ */
+class fx_mod_matrix {
+
+  private:
+    FX_MOD_MAPPING  mappings[MAX_MOD_MAPPINGS];
+    uint8_t         total_mappings;
+    uint32_t        eval_us, max_eval_us;
+
+    bool  add_mapping(fx_pot * pot, MOD_SOURCE source, fx_control_node * dest, float min, float max, const float * curve);
+    float read_source(MOD_SOURCE source);
+    void  write_param(FX_MOD_MAPPING * m, float value, float range_lo, float range_hi);
+
+  public:
+
+    fx_mod_matrix(void);
+
+    bool  map(fx_pot * pot, fx_control_node * dest, float min, float max);
+    bool  map(fx_pot * pot, fx_control_node * dest, float min, float max, MOD_CURVE curve);
+    bool  map(fx_pot * pot, fx_control_node * dest, float min, float max, const float * curve);
+    bool  map(MOD_SOURCE source, fx_control_node * dest, float min, float max);
+    bool  map(MOD_SOURCE source, fx_control_node * dest, float min, float max, MOD_CURVE curve);
+    bool  map(MOD_SOURCE source, fx_control_node * dest, float min, float max, const float * curve);
+    void  clear(void);
+
+    uint8_t  get_total_mappings(void) { return total_mappings; }
+    uint32_t get_eval_time_us(void) { return eval_us; }
+    uint32_t get_max_eval_time_us(void) { return max_eval_us; }
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+    void  service(void);
+#endif  // DOXYGEN_SHOULD_SKIP_THIS
+};
+
+#endif  // DM_FX_MOD_MATRIX_H
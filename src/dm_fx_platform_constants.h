@@ -8,13 +8,170 @@
 #define PI2 (3.14159265358979323846*2)
 #endif 
 
-#define MAX_INSTANCES                 (100)
-#define MAX_ROUTES                    (100)
+// Canvas capacity.  The instance and routing stacks in fx_pedal are sized 
+// at compile time from MAX_INSTANCES and MAX_ROUTES.  The default profile 
+// covers typical canvases; define DM_FX_LARGE_CANVAS in the build flags for 
+// very large canvases, or define MAX_INSTANCES / MAX_ROUTES directly.
+#if defined (DM_FX_LARGE_CANVAS)
+  #define DM_FX_CANVAS_PROFILE        "large"
+  #ifndef MAX_INSTANCES
+    #define MAX_INSTANCES             (100)
+  #endif
+  #ifndef MAX_ROUTES
+    #define MAX_ROUTES                (100)
+  #endif
+#else
+  #define DM_FX_CANVAS_PROFILE        "default"
+  #ifndef MAX_INSTANCES
+    #define MAX_INSTANCES             (32)
+  #endif
+  #ifndef MAX_ROUTES
+    #define MAX_ROUTES                (48)
+  #endif
+#endif
+
+// Stack sizes of the large profile, used to report the SRAM saved by smaller ones
+#define MAX_INSTANCES_LARGE           (100)
+#define MAX_ROUTES_LARGE              (100)
+
+#if MAX_INSTANCES > 254 || MAX_ROUTES > 254
+  #error "MAX_INSTANCES and MAX_ROUTES must be less than 255 (instance IDs are 8-bit)"
+#endif
 #define MAX_NODES_PER_FX              (10)
 #define MAX_PARMS_PER_FX              (256)
-#define MAX_NODE_NAME                 (32)
 #define UNDEFINED                     (0xff)
 
+// DSP audio format, used to estimate the size of delay / loop buffers on the DSP
+#define DSP_SAMPLE_RATE_HZ            (48000)
+#define DSP_BYTES_PER_SAMPLE          (4)
+#define CANVAS_SWAP_CROSSFADE_BLOCKS  (16)
+
+// fx_pedal::service() runs pots, parameter ramps and the SPI link this often
+#define SERVICE_INTERVAL_MS           (33)
+
+// fx_pedal::service() task scheduler.  Each call runs the tasks that are due
+// (earliest deadline first) for up to SERVICE_SLICE_US; the periods of the 
+// pedal's own tasks are below (the LEDs use LED_UPDATE_RATE_MS and the SPI 
+// link SERVICE_INTERVAL_MS), and each budget is the expected run time.  A
+// task should finish within SERVICE_DEADLINE_MS of being due (or within its 
+// period if that is shorter).
+#define SERVICE_SLICE_US              (2000)
+#define SERVICE_DEADLINE_MS           (5)
+#define POT_SERVICE_INTERVAL_MS       (2)
+#define UI_SERVICE_INTERVAL_MS        (5)
+#define BUTTON_SCAN_INTERVAL_MS       (20)
+#define MIDI_SERVICE_INTERVAL_MS      (1)
+#define POT_SERVICE_BUDGET_US         (100)
+#define UI_SERVICE_BUDGET_US          (200)
+#define LED_SERVICE_BUDGET_US         (500)
+#define BUTTON_SCAN_BUDGET_US         (20)
+#define MIDI_SERVICE_BUDGET_US        (100)
+#define LINK_SERVICE_BUDGET_US        (1500)
+#define USER_TASK_BUDGET_US           (200)
+
+// Parameter ramps.  All active ramps share RAMP_LINK_BUDGET_WORDS_PER_SEC of 
+// the SPI link, so each ramp is updated less often as more ramps run, but 
+// never more than once per service interval.
+#define MAX_PARAM_RAMPS               (8)
+#define RAMP_LINK_BUDGET_WORDS_PER_SEC  (1000)
+
+// Parameter update scheduler.  Non-boolean parameter updates are queued (only
+// the latest value of each parameter is kept) and service() sends the most 
+// urgent ones each tick within a word budget.  The budget can be changed at 
+// run time with fx_pedal::set_param_update_budget().
+#define MAX_PARAM_UPDATES             (32)
+#ifndef PARAM_UPDATE_BUDGET_WORDS
+  #define PARAM_UPDATE_BUDGET_WORDS   (8 * SPI_SINGLE_PARAM_FRAME_WORDS)
+#endif
+
+// How many milliseconds of staleness a full scale change is worth when 
+// ranking queued updates
+#define PARAM_UPDATE_DISTANCE_MS      (100)
+
+// Scheduled parameter updates.  Updates that should land on a DSP block (or 
+// a tap tempo beat) are held until they are SCHEDULED_PARAM_LEAD_MS from 
+// their block and then sent with the block number so the DSP applies them 
+// exactly there.  The lead covers a service tick plus the SPI flush.
+#define MAX_SCHEDULED_PARAMS          (16)
+#define SCHEDULED_PARAM_LEAD_MS       (3 * SERVICE_INTERVAL_MS)
+
+// Footswitch gestures (see dm_fx_gesture.h).  A press held for 
+// GESTURE_LONG_PRESS_MS is a long press, then repeats every 
+// GESTURE_HOLD_REPEAT_MS while held; a press within GESTURE_DOUBLE_TAP_MS of
+// the end of a tap is a double tap.
+#define GESTURE_LONG_PRESS_MS         (500)
+#define GESTURE_HOLD_REPEAT_MS        (150)
+#define GESTURE_DOUBLE_TAP_MS         (300)
+
+// Tap tempo.  The beat grid is fitted to the last TAP_HISTORY_LEN taps.  A 
+// pause longer than TAP_TIMEOUT_MS starts a new sequence, as do two intervals 
+// in a row that are both more than TAP_TEMPO_CHANGE (as a fraction) longer, 
+// or both shorter, than the tempo.  When a grid fitted to at least 
+// TAP_DRIFT_MIN_TAPS taps has the last three taps off it on the same side, 
+// each further off than the one before and the last two by more than 
+// TAP_TEMPO_DRIFT of a beat, only the new taps are kept (unless all the taps 
+// fit one grid with a steady change of period).  Taps further than 
+// 3 robust standard deviations (and at least TAP_OUTLIER_MIN_MS) from the 
+// grid are left out of the fit, so a lone sloppy tap never restarts it; 
+// with fewer than TAP_OUTLIER_MIN_TAPS taps every tap is fitted.  From 
+// TAP_TREND_MIN_TAPS taps on, a tempo that keeps speeding up or slowing down 
+// is followed by fitting the change of period as well.
+#define TAP_HISTORY_LEN               (16)
+#define TAP_TIMEOUT_MS                (2000)
+#define TAP_TEMPO_CHANGE              (0.25)
+#define TAP_TEMPO_DRIFT               (0.15)
+#define TAP_DRIFT_MIN_TAPS            (6)
+#define TAP_OUTLIER_MIN_MS            (40.0)
+#define TAP_OUTLIER_MIN_TAPS          (5)
+#define TAP_TREND_MIN_TAPS            (10)
+
+// Parameter readback.  Control-routed parameters are only known to the DSP, 
+// so the host asks for their values: at most SPI_READBACK_SLOTS parameters 
+// every READBACK_INTERVAL_MS, taking turns, so the link cost stays the same 
+// however many parameters are read back.
+#define MAX_PARAM_READBACKS           (16)
+#define READBACK_INTERVAL_MS          (100)
+
+// Host model of the DSP block clock.  DSP_BLOCK_SAMPLES only seeds the rate;
+// the model tracks the rate the DSP actually reports.
+#define DSP_BLOCK_SAMPLES             (128)
+#define DSP_CLOCK_PHASE_GAIN          (0.1)
+#define DSP_CLOCK_FREQ_GAIN           (0.005)
+#define DSP_CLOCK_MAX_ERROR_BLOCKS    (64)
+#define DSP_CLOCK_ACQUIRE_MS          (1000)
+
+// Control streams (see fx_pedal::stream_control()).  The pot is sampled on a
+// CONTROL_STREAM_SAMPLE_US grid and CONTROL_STREAM_FRAME_POINTS points go in
+// each frame, so a frame fills one 10 ms SPI flush slot.  Every point lands
+// on the DSP CONTROL_STREAM_DELAY_MS after it was sampled, which covers
+// filling the frame plus a flush slot.  Frames whose points are all within
+// CONTROL_STREAM_DEADBAND (of full travel) of the last point sent are not 
+// sent.  Sampling starts over after a gap of CONTROL_STREAM_MAX_GAP_MS 
+// between readings (e.g. while a canvas loads).
+#define CONTROL_STREAM_SAMPLE_US      (2000)
+#define CONTROL_STREAM_FRAME_POINTS   (5)
+#define CONTROL_STREAM_DELAY_MS       (25)
+#define CONTROL_STREAM_DEADBAND       (0.0005)
+#define CONTROL_STREAM_MAX_GAP_MS     (100)
+
+// MIDI input (see fx_pedal::set_midi_input()).  Each run of the MIDI task 
+// reads up to MIDI_MAX_BYTES_PER_RUN bytes and sends the values of all the 
+// routes they changed in one frame.  MIDI clock sets the tempo from a fit 
+// over the last MIDI_CLOCK_HISTORY clocks; new_tap_interval() reports a 
+// change of more than MIDI_CLOCK_TEMPO_CHANGE (as a fraction), and the fit 
+// starts over when no clock arrives for MIDI_CLOCK_TIMEOUT_MS.
+#define MAX_MIDI_ROUTES               (16)
+#define MIDI_MAX_BYTES_PER_RUN        (64)
+#define MIDI_CLOCK_HISTORY            (24)
+#define MIDI_CLOCK_TEMPO_CHANGE       (0.005)
+#define MIDI_CLOCK_TIMEOUT_MS         (500)
+
+// DSP firmware update.  A sector of the boot flash that does not read back
+// correctly after programming is retried (only the sectors that still differ
+// from the image are reprogrammed) up to DSP_FIRMWARE_UPDATE_ATTEMPTS times 
+// in all before init() gives up.
+#define DSP_FIRMWARE_UPDATE_ATTEMPTS  (3)
+
 #if defined (DM_FX)
 
   #define PIN_FOOTSW_1                  (0)
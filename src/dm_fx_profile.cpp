@@ -0,0 +1,200 @@
+// Copyright (c) 2020 Run Jump Labs LLC.  All right reserved.
+// This code is licensed under MIT license (see license.txt for details)
+
+#include "dreammakerfx.h"
+#include "dm_fx_profile.h"
+
+#if defined (DM_FX_PROFILE)
+
+#if !defined (__arm__)
+  #include <chrono>
+#endif
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+
+/************************************************************************
+ *
+ *                        Loop profiler
+ *
+ ***********************************************************************/
+
+static FX_PROFILE_ZONE_STATS profile_zones[MAX_PROFILE_ZONES];
+static int profile_total_zones = 0;
+static uint32_t profile_start_ms;
+
+// Zones of service() and of the sketch between calls
+static int profile_service_zone = -1;
+static int profile_sketch_zone = -1;
+static uint32_t profile_service_start;
+static uint32_t profile_service_end;
+static bool profile_service_ran = false;
+
+#if defined (__arm__)
+static uint32_t profile_ms(void) {
+  return millis();
+}
+#else
+uint32_t profile_cycles(void) {
+  return (uint32_t) std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Same clock as the zones, as millis() may be simulated on a host build
+static uint32_t profile_ms(void) {
+  return (uint32_t) std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+static void profile_clear(FX_PROFILE_ZONE_STATS * z) {
+  z->count = 0;
+  z->min_cycles = 0xFFFFFFFF;
+  z->max_cycles = 0;
+  z->total_cycles = 0;
+  for (int i=0;i<PROFILE_HIST_BINS;i++) {
+    z->hist[i] = 0;
+  }
+}
+
+static int profile_bin(uint32_t cycles) {
+  if (cycles < (1 << PROFILE_HIST_SUB_BITS)) {
+    return cycles;
+  }
+  int octave = 31 - __builtin_clz(cycles);
+  int sub = (cycles >> (octave - PROFILE_HIST_SUB_BITS)) & ((1 << PROFILE_HIST_SUB_BITS) - 1);
+  return (octave << PROFILE_HIST_SUB_BITS) + sub;
+}
+
+// Largest value that falls in a bin
+static uint32_t profile_bin_top(int bin) {
+  if (bin < (1 << PROFILE_HIST_SUB_BITS)) {
+    return bin;
+  }
+  int octave = bin >> PROFILE_HIST_SUB_BITS;
+  int sub = bin & ((1 << PROFILE_HIST_SUB_BITS) - 1);
+  uint32_t width = (uint32_t) 1 << (octave - PROFILE_HIST_SUB_BITS);
+  return (((1 << PROFILE_HIST_SUB_BITS) + sub) * width) + width - 1;
+}
+
+static uint32_t profile_percentile(const FX_PROFILE_ZONE_STATS * z, float pct) {
+  uint32_t rank = (uint32_t) ceilf((float) z->count * pct);
+  uint32_t seen = 0;
+  for (int i=0;i<PROFILE_HIST_BINS;i++) {
+    seen += z->hist[i];
+    if (seen >= rank) {
+      uint32_t top = profile_bin_top(i);
+      return (top > z->max_cycles) ? z->max_cycles : top;
+    }
+  }
+  return z->max_cycles;
+}
+
+
+int profile_add_zone(const char * name) {
+
+  if (profile_total_zones >= MAX_PROFILE_ZONES) {
+    return -1;
+  }
+
+  if (profile_total_zones == 0) {
+    #if defined (__arm__)
+      CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+      DWT->CYCCNT = 0;
+      DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    #endif
+    profile_start_ms = profile_ms();
+  }
+
+  FX_PROFILE_ZONE_STATS * z = &profile_zones[profile_total_zones];
+  z->name = name;
+  profile_clear(z);
+
+  return profile_total_zones++;
+}
+
+
+void profile_record(int zone, uint32_t cycles) {
+  if (zone < 0) {
+    return;
+  }
+  FX_PROFILE_ZONE_STATS * z = &profile_zones[zone];
+  z->count++;
+  z->total_cycles += cycles;
+  if (cycles < z->min_cycles) {
+    z->min_cycles = cycles;
+  }
+  if (cycles > z->max_cycles) {
+    z->max_cycles = cycles;
+  }
+  z->hist[profile_bin(cycles)]++;
+}
+
+
+void profile_service_enter(void) {
+  if (profile_service_zone < 0) {
+    profile_service_zone = profile_add_zone("service");
+    profile_sketch_zone = profile_add_zone("sketch");
+  }
+  profile_service_start = profile_cycles();
+  if (profile_service_ran) {
+    profile_record(profile_sketch_zone, profile_service_start - profile_service_end);
+  }
+}
+
+
+void profile_service_exit(void) {
+  profile_service_end = profile_cycles();
+  profile_record(profile_service_zone, profile_service_end - profile_service_start);
+  profile_service_ran = true;
+}
+
+
+void profile_reset(void) {
+  for (int i=0;i<profile_total_zones;i++) {
+    profile_clear(&profile_zones[i]);
+  }
+  profile_service_ran = false;
+  profile_start_ms = profile_ms();
+}
+
+
+// Appends a time column in microseconds with one decimal (printf has no
+// floats on the board)
+static char * profile_print_us(char * p, uint64_t cycles) {
+  unsigned long tenths = (unsigned long) ((cycles * 10 + PROFILE_CYCLES_PER_US / 2) / PROFILE_CYCLES_PER_US);
+  return p + sprintf(p, " %8lu.%lu", tenths / 10, tenths % 10);
+}
+
+void profile_print(void) {
+
+  char buf[120];
+  uint32_t elapsed_ms = profile_ms() - profile_start_ms;
+
+  Serial.println();
+  sprintf(buf, "Profile over %lu ms (times in us, zones nest):", (unsigned long) elapsed_ms);
+  Serial.println(buf);
+  Serial.println(" zone                count        min       mean        p99        max  time");
+  for (int i=0;i<profile_total_zones;i++) {
+    const FX_PROFILE_ZONE_STATS * z = &profile_zones[i];
+    if (z->count == 0) {
+      continue;
+    }
+    char * p = buf + sprintf(buf, " %-16s %8lu", z->name, (unsigned long) z->count);
+    p = profile_print_us(p, z->min_cycles);
+    p = profile_print_us(p, z->total_cycles / z->count);
+    p = profile_print_us(p, profile_percentile(z, 0.99));
+    p = profile_print_us(p, z->max_cycles);
+
+    // Share of the elapsed time in tenths of a percent
+    uint64_t elapsed_cycles = (uint64_t) elapsed_ms * 1000 * PROFILE_CYCLES_PER_US;
+    unsigned long share = elapsed_cycles ? (unsigned long) (z->total_cycles * 1000 / elapsed_cycles) : 0;
+    sprintf(p, " %3lu.%lu%%", share / 10, share % 10);
+    Serial.println(buf);
+  }
+  Serial.println();
+}
+
+#endif  // DOXYGEN_SHOULD_SKIP_THIS
+
+#endif  // DM_FX_PROFILE
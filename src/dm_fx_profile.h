@@ -0,0 +1,118 @@
+// Copyright (c) 2020 Run Jump Labs LLC.  All right reserved.
+// This code is licensed under MIT license (see license.txt for details)
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+#ifndef DM_FX_PROFILE_H
+#define DM_FX_PROFILE_H
+
+
+/************************************************************************
+ *
+ *                        Loop profiler
+ *
+ * Define DM_FX_PROFILE in the build flags to time zones of code with the
+ * Cortex-M4 DWT cycle counter (std::chrono on a host build).  Each zone
+ * keeps min / mean / max and a log histogram for percentiles, and
+ * fx_pedal::print_profile() sends a report over Serial.
+ *
+ * The pedal times service(), each service task, the SPI link, telemetry
+ * parsing and the LED controller writes, plus the time spent in the sketch
+ * between calls to service().  A sketch can time its own code with:
+ *
+ *   {
+ *     FX_PROFILE_ZONE("my code");
+ *     ...                          // Timed until the end of the block
+ *   }
+ *
+ * Without DM_FX_PROFILE the macros are empty and nothing is compiled in.
+ *
+ ***********************************************************************/
+
+#if defined (DM_FX_PROFILE)
+
+#define MAX_PROFILE_ZONES       (16)
+
+// Histogram bins: exact for 0-3 cycles, then 4 bins per power of two
+#define PROFILE_HIST_SUB_BITS   (2)
+#define PROFILE_HIST_BINS       (32 << PROFILE_HIST_SUB_BITS)
+
+typedef struct {
+  const char * name;
+  uint32_t    count;
+  uint32_t    min_cycles;
+  uint32_t    max_cycles;
+  uint64_t    total_cycles;
+  uint32_t    hist[PROFILE_HIST_BINS];
+} FX_PROFILE_ZONE_STATS;
+
+/**
+ * @brief      Adds a zone (the cycle counter is started with the first one)
+ *
+ * @param[in]  name  The zone name
+ *
+ * @return     The zone ID, or -1 if there are already MAX_PROFILE_ZONES zones
+ */
+int       profile_add_zone(const char * name);
+
+/**
+ * @brief      Adds a run of a zone
+ *
+ * @param[in]  zone    The zone ID
+ * @param[in]  cycles  The cycles it took
+ */
+void      profile_record(int zone, uint32_t cycles);
+
+/**
+ * @brief      Time between the end of one service() call and the start of
+ *             the next is recorded as the "sketch" zone
+ */
+void      profile_service_enter(void);
+void      profile_service_exit(void);
+
+void      profile_reset(void);
+void      profile_print(void);
+
+#if defined (__arm__)
+  // DWT cycle counter
+  static inline uint32_t profile_cycles(void) {
+    return DWT->CYCCNT;
+  }
+  #define PROFILE_CYCLES_PER_US   (F_CPU / 1000000)
+#else
+  // Nanoseconds on a host build
+  uint32_t  profile_cycles(void);
+  #define PROFILE_CYCLES_PER_US   (1000)
+#endif
+
+/**
+ * @brief      Times the block it is declared in
+ */
+class fx_profile_scope {
+  private:
+    int       zone;
+    uint32_t  start;
+
+  public:
+    fx_profile_scope(int zone_id) : zone(zone_id), start(profile_cycles()) {}
+    ~fx_profile_scope() {
+      profile_record(zone, profile_cycles() - start);
+    }
+};
+
+#define FX_PROFILE_CONCAT2(a, b)  a ## b
+#define FX_PROFILE_CONCAT(a, b)   FX_PROFILE_CONCAT2(a, b)
+#define FX_PROFILE_ZONE(name)     static int FX_PROFILE_CONCAT(fx_profile_zone_, __LINE__) = profile_add_zone(name); \
+                                  fx_profile_scope FX_PROFILE_CONCAT(fx_profile_scope_, __LINE__)(FX_PROFILE_CONCAT(fx_profile_zone_, __LINE__))
+#define FX_PROFILE_SERVICE_ENTER()  profile_service_enter()
+#define FX_PROFILE_SERVICE_EXIT()   profile_service_exit()
+
+#else
+
+#define FX_PROFILE_ZONE(name)
+#define FX_PROFILE_SERVICE_ENTER()
+#define FX_PROFILE_SERVICE_EXIT()
+
+#endif  // DM_FX_PROFILE
+
+
+#endif    // DM_FX_PROFILE_H
+#endif    // DOXYGEN_SHOULD_SKIP_THIS
@@ -0,0 +1,161 @@
+// Copyright (c) 2020 Run Jump Labs LLC.  All right reserved.
+// This code is licensed under MIT license (see license.txt for details)
+
+#include "dreammakerfx.h"
+#include "dm_fx_sched.h"
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+
+/************************************************************************
+ *
+ *                        Service task scheduler
+ *
+ ***********************************************************************/
+
+static FX_TASK sched_tasks[MAX_SCHED_TASKS];
+static int sched_total_tasks = 0;
+
+// Times are compared as differences so they survive micros() wrapping
+static inline bool sched_time_reached(uint32_t now, uint32_t t) {
+  return (int32_t) (now - t) >= 0;
+}
+
+static void sched_clear_stats(FX_TASK * t) {
+  t->runs = 0;
+  t->deadline_misses = 0;
+  t->budget_overruns = 0;
+  t->skipped = 0;
+  t->max_run_us = 0;
+  t->max_jitter_us = 0;
+  t->sum_jitter_us = 0;
+}
+
+
+int sched_add_task(const char * name, void (*fn)(void * arg), void * arg, void (*fn_void)(void),
+                   uint32_t period_us, uint32_t deadline_us, uint32_t budget_us) {
+
+  if (sched_total_tasks >= MAX_SCHED_TASKS || period_us == 0 || (fn == NULL && fn_void == NULL)) {
+    return -1;
+  }
+
+  FX_TASK * t = &sched_tasks[sched_total_tasks];
+  t->name = name;
+  t->fn = fn;
+  t->arg = arg;
+  t->fn_void = fn_void;
+  t->period_us = period_us;
+  t->deadline_us = deadline_us;
+  t->budget_us = budget_us;
+  t->started = false;
+  #if defined (DM_FX_PROFILE)
+    t->profile_zone = profile_add_zone(name);
+  #endif
+
+  sched_clear_stats(t);
+
+  sched_total_tasks++;
+
+  return sched_total_tasks - 1;
+}
+
+
+void sched_run(uint32_t slice_us) {
+
+  uint32_t slice_start = micros();
+  bool ran = false;
+
+  for (int i=0;i<sched_total_tasks;i++) {
+    if (!sched_tasks[i].started) {
+      sched_tasks[i].started = true;
+      sched_tasks[i].release_us = slice_start;
+    }
+  }
+
+  while (true) {
+
+    // Earliest deadline first among the released tasks.  The first task of
+    // a call always runs so nothing starves; after that only tasks whose 
+    // budget fits in what is left of the slice
+    uint32_t now = micros();
+    uint32_t used_us = now - slice_start;
+    FX_TASK * next = NULL;
+    uint32_t next_deadline = 0;
+    for (int i=0;i<sched_total_tasks;i++) {
+      FX_TASK * t = &sched_tasks[i];
+      if (!sched_time_reached(now, t->release_us)) {
+        continue;
+      }
+      if (ran && used_us + t->budget_us > slice_us) {
+        continue;
+      }
+      uint32_t deadline = t->release_us + t->deadline_us;
+      if (next == NULL || (int32_t) (deadline - next_deadline) < 0) {
+        next = t;
+        next_deadline = deadline;
+      }
+    }
+    if (next == NULL) {
+      return;
+    }
+
+    #if defined (DM_FX_PROFILE)
+      uint32_t start_cycles = profile_cycles();
+    #endif
+    if (next->fn != NULL) {
+      next->fn(next->arg);
+    } else {
+      next->fn_void();
+    }
+    #if defined (DM_FX_PROFILE)
+      profile_record(next->profile_zone, profile_cycles() - start_cycles);
+    #endif
+    ran = true;
+
+    uint32_t end = micros();
+    uint32_t run_us = end - now;
+    uint32_t jitter_us = now - next->release_us;
+
+    next->runs++;
+    next->sum_jitter_us += (float) jitter_us;
+    if (jitter_us > next->max_jitter_us) {
+      next->max_jitter_us = jitter_us;
+    }
+    if (run_us > next->max_run_us) {
+      next->max_run_us = run_us;
+    }
+    if (run_us > next->budget_us) {
+      next->budget_overruns++;
+    }
+    if (!sched_time_reached(next_deadline, end)) {
+      next->deadline_misses++;
+    }
+
+    // Next release on the period grid; releases that are already a whole
+    // period in the past are dropped rather than run back to back
+    next->release_us += next->period_us;
+    int32_t behind = (int32_t) (end - next->release_us);
+    if (behind >= (int32_t) next->period_us) {
+      uint32_t missed = (uint32_t) behind / next->period_us;
+      next->release_us += missed * next->period_us;
+      next->skipped += missed;
+    }
+  }
+}
+
+
+const FX_TASK * sched_get_task(int id) {
+  if (id < 0 || id >= sched_total_tasks) {
+    return NULL;
+  }
+  return &sched_tasks[id];
+}
+
+
+void sched_reset_stats(void) {
+  for (int i=0;i<sched_total_tasks;i++) {
+    sched_clear_stats(&sched_tasks[i]);
+  }
+}
+
+#endif  // DOXYGEN_SHOULD_SKIP_THIS
@@ -0,0 +1,82 @@
+// Copyright (c) 2020 Run Jump Labs LLC.  All right reserved.
+// This code is licensed under MIT license (see license.txt for details)
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+#ifndef DM_FX_SCHED_H
+#define DM_FX_SCHED_H
+
+
+/************************************************************************
+ *
+ *                        Service task scheduler
+ *
+ * fx_pedal::service() runs the pedal's periodic work as tasks.  Each task
+ * is released on a fixed grid (release += period, so periods do not drift
+ * with loop() timing), has a deadline relative to its release, and a budget
+ * for how long one run is expected to take.  Each call to sched_run() runs
+ * the released tasks earliest deadline first until the next task's budget
+ * no longer fits in the slice, and leaves the rest for the next call.
+ *
+ ***********************************************************************/
+
+#define MAX_SCHED_TASKS         (12)
+
+typedef struct {
+  const char * name;
+  void        (*fn)(void * arg);      // Either fn(arg) ...
+  void *      arg;
+  void        (*fn_void)(void);       // ... or fn_void() is called
+  uint32_t    period_us;
+  uint32_t    deadline_us;
+  uint32_t    budget_us;
+  uint32_t    release_us;             // Release time of the next run
+  bool        started;                // Release time set on the first sched_run()
+#if defined (DM_FX_PROFILE)
+  int         profile_zone;
+#endif
+
+  // Statistics
+  uint32_t    runs;
+  uint32_t    deadline_misses;
+  uint32_t    budget_overruns;
+  uint32_t    skipped;
+  uint32_t    max_run_us;
+  uint32_t    max_jitter_us;
+  float       sum_jitter_us;
+} FX_TASK;
+
+/**
+ * @brief      Adds a task to the scheduler
+ *
+ * @param[in]  name         Name shown in statistics
+ * @param[in]  fn           Function called with arg (or NULL to use fn_void)
+ * @param      arg          The argument
+ * @param[in]  fn_void      Function called without an argument
+ * @param[in]  period_us    The period
+ * @param[in]  deadline_us  The deadline after each release
+ * @param[in]  budget_us    The expected run time
+ *
+ * @return     The task ID, or -1 if there are already MAX_SCHED_TASKS tasks
+ */
+int       sched_add_task(const char * name, void (*fn)(void * arg), void * arg, void (*fn_void)(void),
+                         uint32_t period_us, uint32_t deadline_us, uint32_t budget_us);
+
+/**
+ * @brief      Runs released tasks until the slice is used up
+ *
+ * @param[in]  slice_us  Run time available to this call
+ */
+void      sched_run(uint32_t slice_us);
+
+/**
+ * @brief      Returns a task (NULL if the ID is not valid)
+ */
+const FX_TASK * sched_get_task(int id);
+
+/**
+ * @brief      Clears the statistics of all tasks
+ */
+void      sched_reset_stats(void);
+
+
+#endif    // DM_FX_SCHED_H
+#endif    // DOXYGEN_SHOULD_SKIP_THIS
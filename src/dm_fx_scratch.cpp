@@ -0,0 +1,53 @@
+// Copyright (c) 2020 Run Jump Labs LLC.  All right reserved. 
+// This code is licensed under MIT license (see license.txt for details)
+
+#include "dreammakerfx.h"
+#include "dm_fx_scratch.h"
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+/************************************************************************
+ *
+ *                        Scratch arena
+ *
+ ***********************************************************************/
+
+static uint16_t scratch_arena[SCRATCH_ARENA_WORDS];
+static uint16_t scratch_top = 0;
+static uint16_t scratch_peak = 0;
+
+
+uint16_t * scratch_alloc(uint16_t words) {
+
+  if (words > SCRATCH_ARENA_WORDS - scratch_top) {
+    DEBUG_MSG("Scratch arena exhausted", MSG_ERROR);
+    return NULL;
+  }
+
+  uint16_t * buf = &scratch_arena[scratch_top];
+  scratch_top += words;
+  if (scratch_top > scratch_peak) {
+    scratch_peak = scratch_top;
+  }
+  return buf;
+}
+
+uint16_t scratch_mark(void) {
+  return scratch_top;
+}
+
+void scratch_release(uint16_t mark) {
+  if (mark <= scratch_top) {
+    scratch_top = mark;
+  }
+}
+
+uint16_t scratch_in_use(void) {
+  return scratch_top;
+}
+
+uint16_t scratch_high_water(void) {
+  return scratch_peak;
+}
+
+#endif  // DOXYGEN_SHOULD_SKIP_THIS
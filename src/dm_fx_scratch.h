@@ -0,0 +1,87 @@
+#ifndef DM_FX_SCRATCH_H
+#define DM_FX_SCRATCH_H
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+/************************************************************************
+ *
+ *                        Scratch arena
+ *
+ * Transient serialization buffers (routing blocks, instance blocks,
+ * parameter blocks) are carved out of one statically sized arena instead 
+ * of the stack or the heap.  Allocation is a bump of the top pointer; a 
+ * caller takes a mark before allocating and releases back to it when the 
+ * buffer has been copied into the SPI FIFO, so the arena is empty again 
+ * once each frame has been queued.
+ *
+ * ``` CPP
+ * uint16_t   mark  = scratch_mark();
+ * uint16_t * block = scratch_alloc(words);
+ * ...
+ * spi_fifo_insert_block(block, words);
+ * scratch_release(mark);
+ * ```
+ *
+ ***********************************************************************/
+
+// Largest buffers serialized from the canvas (in 16-bit words)
+#define SCRATCH_WORDS_CONTROL_ROUTES  (MAX_ROUTES * 9 + 1)
+#define SCRATCH_WORDS_AUDIO_ROUTES    (MAX_ROUTES * 2 + 1)
+#define SCRATCH_WORDS_INSTANCES       (MAX_INSTANCES + 1)
+#define SCRATCH_WORDS_PARAMS          (MAX_PARMS_PER_FX)
+
+#define SCRATCH_MAX(a, b)             ((a) > (b) ? (a) : (b))
+
+// Arena size in words; buffers are never nested so it only needs to hold 
+// the largest one.  Can be overridden in the build flags.
+#ifndef SCRATCH_ARENA_WORDS
+  #define SCRATCH_ARENA_WORDS         SCRATCH_MAX(SCRATCH_MAX(SCRATCH_WORDS_CONTROL_ROUTES, SCRATCH_WORDS_AUDIO_ROUTES), \
+                                                  SCRATCH_MAX(SCRATCH_WORDS_INSTANCES, SCRATCH_WORDS_PARAMS))
+#endif
+
+#if SCRATCH_ARENA_WORDS < SCRATCH_WORDS_CONTROL_ROUTES || SCRATCH_ARENA_WORDS < SCRATCH_WORDS_AUDIO_ROUTES || \
+    SCRATCH_ARENA_WORDS < SCRATCH_WORDS_INSTANCES || SCRATCH_ARENA_WORDS < SCRATCH_WORDS_PARAMS
+  #error "SCRATCH_ARENA_WORDS is too small for the canvas profile"
+#endif
+#if SCRATCH_ARENA_WORDS > 0xFFFF
+  #error "SCRATCH_ARENA_WORDS must fit in 16 bits"
+#endif
+
+
+/**
+ * @brief      Allocates a buffer from the scratch arena
+ * 
+ * The arena is sized at compile time for the largest canvas, so running out 
+ * of space is an internal error.  It is reported and NULL is returned, and 
+ * the caller fails whatever it was serializing.
+ *
+ * @param[in]  words  Number of 16-bit words
+ *
+ * @return     Pointer to the buffer, or NULL if the arena is full
+ */
+uint16_t * scratch_alloc(uint16_t words);
+
+/**
+ * @brief      Returns the current top of the arena to release back to later
+ */
+uint16_t  scratch_mark(void);
+
+/**
+ * @brief      Releases everything allocated since a mark was taken
+ *
+ * @param[in]  mark  Value returned by scratch_mark()
+ */
+void      scratch_release(uint16_t mark);
+
+/**
+ * @brief      Returns the number of words currently allocated
+ */
+uint16_t  scratch_in_use(void);
+
+/**
+ * @brief      Returns the largest number of words ever allocated at once
+ */
+uint16_t  scratch_high_water(void);
+
+#endif  // DOXYGEN_SHOULD_SKIP_THIS
+#endif 	// DM_FX_SCRATCH_H
@@ -18,7 +18,15 @@
 
 
 #define MAX_SPI_BLOCK_SIZE      (2048)
-#define SPI_FIFO_SIZE           (2048)
+
+// SPI transmit FIFO size in words; can be raised in the build flags to use 
+// SRAM freed up by a smaller canvas profile
+#ifndef SPI_FIFO_SIZE
+  #define SPI_FIFO_SIZE         (2048)
+#endif
+#if (SPI_FIFO_SIZE & (SPI_FIFO_SIZE - 1)) != 0
+  #error "SPI_FIFO_SIZE must be a power of two"
+#endif
 #define SPI_FIFO_MASK           (SPI_FIFO_SIZE-1)
 
 #define SPI_RX_FRAME_SIZE       (SPI_DSP_STAT_FRAME_SIZE + 3)
@@ -29,6 +37,9 @@
 #define FRAME_HEADER_2                (0x80FE)
 #define FRAME_TERMINATOR              (0x80FF)
 
+// Shortest time between two flushes of the transmit FIFO
+#define SPI_SERVICE_HOLDOFF_MS        (10)
+
 
 // SPI Interface
 uint16_t    spi_tx_fifo[SPI_FIFO_SIZE];
@@ -44,7 +55,7 @@ uint16_t  spi_tx_wr_ptr = 0;
 uint16_t  spi_tx_rd_ptr = 0;
 int16_t   spi_rx_wr_ptr = 0;
 SPI_RX_STATE  spi_rx_state = SPI_RX_WAITING;
-uint16_t  spi_service_last_millis = 0;
+uint32_t  spi_service_last_millis = 0;
 
 
 
@@ -92,7 +103,7 @@ void 	spi_fifo_reset(void) {
   */ 
 static bool spi_fifo_push(uint16_t val) {
 
-  if (SPI_FIFO_MASK & (spi_tx_wr_ptr+1) == spi_tx_rd_ptr) {
+  if (((spi_tx_wr_ptr+1) & SPI_FIFO_MASK) == spi_tx_rd_ptr) {
     DEBUG_MSG("Not enough room in FIFO", MSG_WARN);
     return false;
   }
@@ -178,12 +189,35 @@ bool  spi_fifo_insert_block(uint16_t * data, int size) {
   // 4. Add frame terminator
   spi_fifo_push(FRAME_TERMINATOR);
 
+  return true;
 }
 
+/**
+ * @brief      Returns true when every frame in the SPI FIFO has been sent
+ */
+bool  spi_fifo_empty(void) {
+  return spi_tx_wr_ptr == spi_tx_rd_ptr;
+}
+
+/**
+ * @brief      Returns true when frames added to the SPI FIFO now would be 
+ *             sent by the next spi_transmit_buffered_frames()
+ */
+bool  spi_transmit_ready(void) {
+  return !(spi_service_last_millis + SPI_SERVICE_HOLDOFF_MS > millis());
+}
 
 
 
-void spi_process_received_frame(uint16_t * rx_frame) {
+
+/**
+ * @brief      Updates dsp_status from a status frame
+ *
+ * @param      rx_frame  Payload of the frame (between the header and the terminator)
+ * @param[in]  len       Number of payload words received; older firmware sends
+ *                       a shorter frame without the block count or readbacks
+ */
+void spi_process_received_frame(uint16_t * rx_frame, uint16_t len) {
   
 
   #if 0
@@ -203,6 +237,32 @@ void spi_process_received_frame(uint16_t * rx_frame) {
   dsp_status.amplitude =  ((float) rx_frame[SPI_DSP_STAT_AMPLITUDE]) / 65536.0;
   dsp_status.new_note = rx_frame[SPI_DSP_STAT_NEW_NOTE];
 
+  // Block counter for the host's model of the DSP clock
+  dsp_status.block_count = 0;
+  if (len > SPI_DSP_STAT_BLOCK_COUNT_LO) {
+    dsp_status.block_count = ((uint32_t) rx_frame[SPI_DSP_STAT_BLOCK_COUNT_HI] << 16) | rx_frame[SPI_DSP_STAT_BLOCK_COUNT_LO];
+  }
+  dsp_status.block_count_us = micros();
+
+  // Parameter values requested with HEADER_PARAM_READBACK; only the values 
+  // that actually arrived in this frame are used
+  uint16_t readbacks = 0;
+  if (len > SPI_DSP_STAT_READBACK_COUNT) {
+    readbacks = rx_frame[SPI_DSP_STAT_READBACK_COUNT];
+  }
+  if (readbacks > SPI_READBACK_SLOTS) {
+    readbacks = SPI_READBACK_SLOTS;
+  }
+  if (readbacks > 0 && len < SPI_DSP_STAT_READBACK_START + readbacks * 3) {
+    readbacks = (len - SPI_DSP_STAT_READBACK_START) / 3;
+  }
+  for (int i=0;i<readbacks;i++) {
+    uint16_t * rb = &rx_frame[SPI_DSP_STAT_READBACK_START + i * 3];
+    dsp_status.readback_key[i] = rb[0];
+    dsp_status.readback_value[i] = ((uint32_t) rb[1] << 16) | rb[2];
+  }
+  dsp_status.readback_count = readbacks;
+
   // Get system state
   uint16_t sys_state = rx_frame[SPI_DSP_STAT_SYS_STATE];
   dsp_status.state_flags = sys_state;
@@ -211,6 +271,8 @@ void spi_process_received_frame(uint16_t * rx_frame) {
   dsp_status.state_lf_audio_running = (sys_state & SYS_LF_AUDIO)?true:false;
   dsp_status.state_hf_audio_running = (sys_state & SYS_HF_AUDIO)?true:false;
   dsp_status.state_canvas_running  = (sys_state & SYS_CANVAS_OK)?true:false;
+  dsp_status.state_shadow_ready  = (sys_state & SYS_SHADOW_OK)?true:false;
+  dsp_status.cap_canvas_slots  = (sys_state & SYS_CAP_CANVAS_SLOTS)?true:false;
 
 
 
@@ -228,12 +290,8 @@ void spi_process_received_frame(uint16_t * rx_frame) {
  */
 void spi_transmit_buffered_frames(bool reset_state) {
 
-  static uint8_t  rx_frame_state = 0;
-  static uint16_t rx_frame_ptr = 0;
-  static uint16_t rx_frame_buf[16];
-
   if (reset_state) {
-    rx_frame_state = SPI_RX_WAITING;
+    spi_rx_state = SPI_RX_WAITING;
     return;
   }
 
@@ -245,7 +303,7 @@ void spi_transmit_buffered_frames(bool reset_state) {
 
   // If we last serviced the spi port less than 10 milliseconds ago, hold off
   uint32_t now = millis();
-  if (spi_service_last_millis + 10 > now) {
+  if (spi_service_last_millis + SPI_SERVICE_HOLDOFF_MS > now) {
     return;
   }
   spi_service_last_millis = now;
@@ -268,13 +326,10 @@ void spi_transmit_buffered_frames(bool reset_state) {
     // SPI process received frame
     if (spi_rx_state == SPI_RX_RECEIVING && rx_word == FRAME_TERMINATOR) {
       spi_rx_state = SPI_RX_WAITING;
-      spi_process_received_frame(spi_rx_frame);
+      spi_process_received_frame(spi_rx_frame, spi_rx_wr_ptr);
     } else if (spi_rx_state == SPI_RX_RECEIVING) {
-      spi_rx_frame[spi_rx_wr_ptr++] = rx_word;
-
-      // if we've received a complete frame, set state to ready
-      if (spi_rx_wr_ptr >= SPI_RX_PAYLOAD_SIZE) {
-        spi_rx_wr_ptr = SPI_RX_PAYLOAD_SIZE - 1;
+      if (spi_rx_wr_ptr < SPI_RX_PAYLOAD_SIZE) {
+        spi_rx_frame[spi_rx_wr_ptr++] = rx_word;
       }
     }
     else if (spi_rx_state == SPI_RX_WAITING && rx_word == FRAME_HEADER_1) {
@@ -283,6 +338,7 @@ void spi_transmit_buffered_frames(bool reset_state) {
     else if (spi_rx_state == SPI_RX_HEADER_1_RX && rx_word == FRAME_HEADER_2) {
       spi_rx_state = SPI_RX_RECEIVING;
       spi_rx_wr_ptr = 0;
+      memset(spi_rx_frame, 0, sizeof(spi_rx_frame));
 
     } 
     
@@ -294,4 +350,12 @@ void spi_transmit_buffered_frames(bool reset_state) {
 
 
 }
+
+/**
+ * @brief      Returns the number of bytes used by the SPI transmit FIFO and 
+ *             receive frame buffer
+ */
+uint32_t spi_buffer_bytes(void) {
+  return sizeof(spi_tx_fifo) + sizeof(spi_rx_frame);
+}
 #endif // DOXYGEN_SHOULD_SKIP_THIS
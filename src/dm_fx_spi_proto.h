@@ -11,6 +11,43 @@
 #define HEADER_SINGLE_PARAMETER       (0x8005)
 #define HEADER_SET_BYPASS             (0x8006)
 #define HEADER_GET_STATUS             (0x8007)
+#define HEADER_CANVAS_SLOT            (0x8008)
+#define HEADER_SWAP_CANVAS            (0x8009)
+#define HEADER_SCHEDULED_PARAMETER    (0x800A)
+#define HEADER_PARAM_READBACK         (0x800B)
+#define HEADER_CONTROL_STREAM_BIND    (0x800C)
+#define HEADER_CONTROL_STREAM         (0x800D)
+#define HEADER_CONTROL_VALUES         (0x800E)
+
+// Words a frame adds around its payload (two headers, size, terminator)
+#define SPI_FRAME_OVERHEAD_WORDS      (4)
+
+// Words of a HEADER_SINGLE_PARAMETER frame on the link
+#define SPI_SINGLE_PARAM_FRAME_WORDS  (7 + SPI_FRAME_OVERHEAD_WORDS)
+
+// Words of a HEADER_SCHEDULED_PARAMETER frame: a single parameter frame 
+// followed by the DSP block to apply it at (high word first)
+#define SPI_SCHEDULED_PARAM_FRAME_WORDS  (9 + SPI_FRAME_OVERHEAD_WORDS)
+
+// HEADER_CONTROL_STREAM_BIND: instance type (UNDEFINED stops the stream), 
+// instance id, parameter id, the values of point 0 and point 0xFFFF as 
+// floats (high word first) and the spacing of the points in samples
+#define SPI_CONTROL_STREAM_BIND_WORDS (9)
+
+// Words of a HEADER_CONTROL_STREAM frame: the DSP block (high word first) 
+// and sample within it where the first point lands, the number of points, 
+// then the points.  The DSP ramps to each point over the spacing before it.
+#define SPI_CONTROL_STREAM_FRAME_WORDS(POINTS)  (5 + (POINTS) + SPI_FRAME_OVERHEAD_WORDS)
+
+// HEADER_CONTROL_VALUES: the number of values, then for each the instance 
+// id (0 for the canvas) in the high byte and the parameter id in the low 
+// byte, and the value as a float (high word first).  Canvas values drive 
+// the note outputs in place of the pitch tracker.
+#define SPI_CONTROL_VALUE_WORDS       (3)
+
+// Canvas slots selected with HEADER_CANVAS_SLOT
+#define CANVAS_SLOT_ACTIVE            (0)
+#define CANVAS_SLOT_SHADOW            (1)
 
 
 
@@ -47,10 +84,27 @@ void 	spi_fifo_push_emptry_frame(void);
  */
 bool  spi_fifo_insert_block(uint16_t * data, int size);
 
+/**
+ * @brief      Returns true when every frame in the SPI FIFO has been sent
+ */
+bool  spi_fifo_empty(void);
+
+/**
+ * @brief      Returns true when frames added to the SPI FIFO now would be 
+ *             sent by the next spi_transmit_buffered_frames()
+ */
+bool  spi_transmit_ready(void);
+
 /**
  * @brief      Transmits any frames to the DSP
  */
 void spi_transmit_buffered_frames(bool reset_state);
 
+/**
+ * @brief      Returns the number of bytes used by the SPI transmit FIFO and 
+ *             receive frame buffer
+ */
+uint32_t spi_buffer_bytes(void);
+
 #endif  // DOXYGEN_SHOULD_SKIP_THIS
 #endif 	// DM_FX_SPI_PROTO_H
\ No newline at end of file
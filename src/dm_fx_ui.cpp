@@ -14,56 +14,139 @@
  *
  ***********************************************************************/
 
-bool footswitch_right_pressed_event = false;
-bool footswitch_left_pressed_event = false;
+/************************************************************************
+ *
+ * Footswitch interrupts fire on both edges and only read the switch, 
+ * timestamp the edge and push it into a queue; service() pops the edges and
+ * does the rest (bypass, tap tempo, gestures, debug messages).  The 
+ * interrupts do not track whether the switch is up or down, so a bounce 
+ * that is read wrong cannot make them drop the next real edge; service() 
+ * ignores edges that do not change the state.  Each footswitch has its own ring with one writer (its
+ * interrupt handler) and one reader (service()), so neither side needs to
+ * disable interrupts: the writer fills the slot before publishing it by
+ * moving head, and the reader copies the slot out before freeing it by
+ * moving tail.
+ *
+ ***********************************************************************/
 
+typedef struct {
+  FX_INPUT_EVENT    events[INPUT_EVENT_QUEUE_LEN];
+  volatile uint8_t  head;       // Written only by the interrupt handler
+  volatile uint8_t  tail;       // Written only by service()
+  uint32_t          last_us;    // Debounce (interrupt handler only)
+} FX_INPUT_QUEUE;
 
-/**
- * @brief      Right footswitch interrupt handler
- */
-void footswitch_right_pressed_isr(void) {
+static FX_INPUT_QUEUE input_queue_right;
+static FX_INPUT_QUEUE input_queue_left;
+
+// Interrupt handler timing; only the handlers write these
+static volatile FX_INPUT_ISR_STATS input_isr;
 
-  static int last_press = 0;
-  if (millis() < last_press + 150) {
+#define INPUT_BARRIER()   __asm__ volatile ("" ::: "memory")
+
+static void input_event_push(FX_INPUT_QUEUE * q, uint8_t footswitch, int pin) {
+
+  uint32_t now = micros();
+
+  if (now - q->last_us < INPUT_DEBOUNCE_US) {
     return;
   }
-  last_press = millis();
-
-  DEBUG_MSG("Right pressed", MSG_DEBUG);
+  q->last_us = now;
+
+  uint8_t head = q->head;
+  if ((uint8_t) (head - q->tail) >= INPUT_EVENT_QUEUE_LEN) {
+    input_isr.dropped++;
+  } else {
+    FX_INPUT_EVENT * ev = &q->events[head & (INPUT_EVENT_QUEUE_LEN - 1)];
+    ev->time_us = now;
+    ev->footswitch = footswitch;
+    ev->pressed = !digitalRead(pin);
+    INPUT_BARRIER();
+    q->head = head + 1;
+    input_isr.events++;
+  }
 
-  footswitch_right_pressed_event = true;
+  uint32_t isr_us = micros() - now;
+  input_isr.isr_total_us += isr_us;
+  if (isr_us > input_isr.isr_max_us) {
+    input_isr.isr_max_us = isr_us;
+  }
+}
 
-  if (pedal.tap_control_enabled && pedal.tap_footswitch == FOOTSWITCH_RIGHT) {
-    DEBUG_MSG("Tap registered", MSG_DEBUG);
-    pedal.register_tap();
+static bool input_event_peek(FX_INPUT_QUEUE * q, FX_INPUT_EVENT * event) {
+  uint8_t tail = q->tail;
+  if (q->head == tail) {
+    return false;
   }
+  INPUT_BARRIER();
+  *event = q->events[tail & (INPUT_EVENT_QUEUE_LEN - 1)];
+  return true;
+}
 
-  
+static void input_event_drop(FX_INPUT_QUEUE * q) {
+  INPUT_BARRIER();
+  q->tail = q->tail + 1;
+}
 
+/**
+ * @brief      Takes the oldest footswitch edge out of the queues
+ *
+ * @param      event  The edge (output)
+ *
+ * @return     False if no edges are waiting
+ */
+bool input_event_pop(FX_INPUT_EVENT * event) {
+  FX_INPUT_EVENT right, left;
+  bool have_right = input_event_peek(&input_queue_right, &right);
+  bool have_left = input_event_peek(&input_queue_left, &left);
+
+  if (have_right && (!have_left || (int32_t) (right.time_us - left.time_us) <= 0)) {
+    *event = right;
+    input_event_drop(&input_queue_right);
+    return true;
+  }
+  if (have_left) {
+    *event = left;
+    input_event_drop(&input_queue_left);
+    return true;
+  }
+  return false;
 }
 
 /**
- * @brief      Left footswitch interrupt handler
+ * @brief      Gets the interrupt handler statistics
  */
-void footswitch_left_pressed_isr(void){
+void input_isr_stats(FX_INPUT_ISR_STATS * stats) {
+  stats->events = input_isr.events;
+  stats->dropped = input_isr.dropped;
+  stats->isr_max_us = input_isr.isr_max_us;
+  stats->isr_total_us = input_isr.isr_total_us;
+}
 
-  static int last_press = 0;
-  if (millis() < last_press + 150) {
-    return;
-  }
-  last_press = millis();
+void input_isr_stats_reset(void) {
+  input_isr.events = 0;
+  input_isr.dropped = 0;
+  input_isr.isr_max_us = 0;
+  input_isr.isr_total_us = 0;
+}
 
-  DEBUG_MSG("Left pressed", MSG_DEBUG);
 
-  footswitch_left_pressed_event = true;
+/**
+ * @brief      Right footswitch interrupt handler
+ */
+void footswitch_right_pressed_isr(void) {
+  input_event_push(&input_queue_right, FOOTSWITCH_RIGHT, PIN_FOOTSW_RIGHT);
+}
 
-  if (pedal.tap_control_enabled && pedal.tap_footswitch == FOOTSWITCH_LEFT) {
-    DEBUG_MSG("Tap registered", MSG_DEBUG);
-    pedal.register_tap();
-  }
+/**
+ * @brief      Left footswitch interrupt handler
+ */
+void footswitch_left_pressed_isr(void){
+  input_event_push(&input_queue_left, FOOTSWITCH_LEFT, PIN_FOOTSW_LEFT);
 }
 
 
+#if defined (DM_FX_TWO)
 /**
  * @brief      Writes a value to the LP5569 RGB LED controller
  *
@@ -76,25 +159,20 @@ static void    lp5569_write(int addr, int val) {
   Wire2.write(val); 
   Wire2.endTransmission();
 }
+#endif 
 
-/**
- * @brief      Reads a value from the LP5569 RGB LED controller
- *
- * @param[in]  addr  The address
- *
- * @return     Register value read
- */
-static int    lp5569_read(int addr) {
-  Wire2.beginTransmission(0x40);
-  Wire2.write(addr);  
-  Wire2.endTransmission();
-  Wire2.requestFrom(0x40, 1); 
-  while(Wire2.available() == 0);
-  int v = Wire2.read();   
-  return v;  
-  
-}
 
+// LP5569 registers
+#define LP5569_REG_CONFIG       (0x00)
+#define LP5569_REG_PWM_FIRST    (0x16)      // D0 PWM; D0-D8 are consecutive
+#define LP5569_REG_MISC         (0x2F)
+#define LP5569_MISC_AUTO_INCR   (0x40)
+#define LP5569_OUTPUTS          (9)
+
+// Shadow of the PWM registers (three outputs per LED in LED_POS order) and a
+// mask of the ones that differ from the chip
+static uint8_t rgb_pwm_shadow[LP5569_OUTPUTS];
+static uint16_t rgb_pwm_dirty = 0;
 
 /**
  * @brief      Initialize the RGB LED controller
@@ -109,52 +187,71 @@ void    rgb_leds_init(void) {
     digitalWrite(RGB_LED_ENABLE, HIGH);
     delay(10);
 
-    // Set up charge pump and clock
-    lp5569_write(0x2F, B00011001);  
+    // Set up charge pump and clock, and have the register address
+    // auto-increment so all PWM registers can be written in one transaction
+    lp5569_write(LP5569_REG_MISC, B00011001 | LP5569_MISC_AUTO_INCR);  
 
     // Enable the LP5569
-    lp5569_write(0, 0x40);    
+    lp5569_write(LP5569_REG_CONFIG, 0x40);    
+
+    for (int i=0;i<LP5569_OUTPUTS;i++) {
+      rgb_pwm_shadow[i] = 0;
+    }
+    rgb_pwm_dirty = 0;
 
   #endif 
 
 }
 
-#if 0
-#define LED_RIGHT     0
-#define LED_CENTER    1
-#define LED_LEFT      2
-#endif 
+/**
+ * @brief      Sets the color of an RGB LED.  Only the register shadow is
+ *             updated; the color reaches the LED on the next call to
+ *             rgb_leds_flush().
+ *
+ * @param[in]  led_num  The LED (LED_RIGHT, LED_CENTER or LED_LEFT)
+ * @param[in]  r        Red value (0-255)
+ * @param[in]  g        Green value (0-255)
+ * @param[in]  b        Blue value (0-255)
+ */
 void    rgb_write(int led_num, int r, int g, int b) {
 
-#if 0
-  Serial.print("LED: ");
-  Serial.print(led_num);
-  Serial.print(" : ");
-  Serial.println(r);
-#endif
-  switch (led_num) {
-    case 0:
-      lp5569_write(0x16, r);
-      lp5569_write(0x17, g);
-      lp5569_write(0x18, b);
-      break;
-
-    case 1:
-      lp5569_write(0x19, r);
-      lp5569_write(0x1A, g);
-      lp5569_write(0x1B, b);
-      break;
-
-    case 2:
-      lp5569_write(0x1C, r);
-      lp5569_write(0x1D, g);
-      lp5569_write(0x1E, b);
-      break;
-    default:
-      break;
+  if (led_num < 0 || led_num > 2) {
+    return;
+  }
+
+  int vals[3] = {r, g, b};
+  for (int i=0;i<3;i++) {
+    int out = led_num * 3 + i;
+    if (rgb_pwm_shadow[out] != (uint8_t) vals[i]) {
+      rgb_pwm_shadow[out] = (uint8_t) vals[i];
+      rgb_pwm_dirty |= (1 << out);
+    }
   }
+}
 
+/**
+ * @brief      Writes the PWM registers that changed since the last flush to
+ *             the LP5569 in a single auto-increment transaction
+ */
+void    rgb_leds_flush(void) {
+  FX_PROFILE_ZONE("led i2c");
+
+  if (!rgb_pwm_dirty) {
+    return;
+  }
+
+  #if defined (DM_FX_TWO)
+    int first = 0, last = LP5569_OUTPUTS - 1;
+    while (!(rgb_pwm_dirty & (1 << first))) first++;
+    while (!(rgb_pwm_dirty & (1 << last))) last--;
+
+    Wire2.beginTransmission(0x40);
+    Wire2.write(LP5569_REG_PWM_FIRST + first);
+    Wire2.write(&rgb_pwm_shadow[first], last - first + 1);
+    Wire2.endTransmission();
+  #endif 
 
+  rgb_pwm_dirty = 0;
 }
 
 static bool left_led_state = false;
@@ -174,6 +271,7 @@ void    turn_on_left_footsw_led(void) {
     turn_on_left_footsw_led();
   #elif defined (DM_FX_TWO)
     rgb_write(LED_LEFT, 150, 0, 0);
+    rgb_leds_flush();
   #endif 
 }
 
@@ -188,6 +286,7 @@ void    turn_off_left_footsw_led(void) {
     turn_off_left_footsw_led();
   #elif defined (DM_FX_TWO)
     rgb_write(LED_LEFT, 0, 0, 0);
+    rgb_leds_flush();
   #endif 
 }
 
@@ -203,6 +302,7 @@ void    turn_on_right_footsw_led(void) {
     turn_on_right_footsw_led();
   #elif defined (DM_FX_TWO)
     rgb_write(LED_RIGHT, 150, 0, 0);
+    rgb_leds_flush();
   #endif 
 }
 
@@ -217,6 +317,7 @@ void    turn_off_right_footsw_led(void) {
     turn_off_right_footsw_led();
   #elif defined (DM_FX_TWO)
     rgb_write(LED_RIGHT, 0, 0, 0);
+    rgb_leds_flush();
   #endif 
 }
 
@@ -229,6 +330,7 @@ void    turn_on_center_footsw_led(void) {
 
   #if defined (DM_FX_TWO)
     rgb_write(LED_CENTER, 150, 0, 0);
+    rgb_leds_flush();
   #endif 
 }
 
@@ -241,6 +343,7 @@ void    turn_off_center_footsw_led(void) {
 
   #if defined (DM_FX_TWO)
     rgb_write(LED_CENTER, 0, 0, 0);
+    rgb_leds_flush();
   #endif 
 }
 
@@ -256,9 +359,11 @@ void    turn_on_left_footsw_led_rgb(uint8_t r, uint8_t g, uint8_t b) {
   left_led_state = true;
 
   #if defined (DM_FX)
+    (void) r; (void) g; (void) b;
     turn_on_left_footsw_led();
   #elif defined (DM_FX_TWO)
     rgb_write(LED_LEFT, r, g, b);
+    rgb_leds_flush();
   #endif 
 }
 
@@ -274,9 +379,11 @@ void    turn_on_right_footsw_led_rgb(uint8_t r, uint8_t g, uint8_t b) {
   right_led_state = true;
 
   #if defined (DM_FX)
+    (void) r; (void) g; (void) b;
     turn_on_right_footsw_led();
   #elif defined (DM_FX_TWO)
     rgb_write(LED_RIGHT, r, g, b);
+    rgb_leds_flush();
   #endif 
 }
 
@@ -292,6 +399,9 @@ void    turn_on_center_footsw_led_rgb(uint8_t r, uint8_t g, uint8_t b) {
   center_led_state = true;
   #if defined (DM_FX_TWO)
     rgb_write(LED_CENTER, r, g, b);
+    rgb_leds_flush();
+  #else
+    (void) r; (void) g; (void) b;
   #endif 
 }
 
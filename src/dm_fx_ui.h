@@ -4,8 +4,32 @@
 #ifndef DM_FX_UI_H
 #define DM_FX_UI_H
 
-extern bool footswitch_right_pressed_event;
-extern bool footswitch_left_pressed_event;
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+// Footswitch presses and releases are timestamped by the interrupt handlers
+// and queued for service() (see dm_fx_ui.cpp).  Edges closer than 
+// INPUT_DEBOUNCE_US to the previous one are contact bounce.
+#define INPUT_EVENT_QUEUE_LEN   (8)     // Per footswitch, power of two
+#define INPUT_DEBOUNCE_US       (20000)
+
+typedef struct {
+  uint32_t    time_us;      // micros() when the interrupt fired
+  uint8_t     footswitch;   // FOOTSWITCH_RIGHT or FOOTSWITCH_LEFT
+  bool        pressed;      // Press or release
+} FX_INPUT_EVENT;
+
+typedef struct {
+  uint32_t    events;       // Edges queued
+  uint32_t    dropped;      // Edges lost because a queue was full
+  uint32_t    isr_max_us;   // Longest interrupt handler run
+  uint32_t    isr_total_us;
+} FX_INPUT_ISR_STATS;
+
+bool    input_event_pop(FX_INPUT_EVENT * event);
+void    input_isr_stats(FX_INPUT_ISR_STATS * stats);
+void    input_isr_stats_reset(void);
+
+#endif  // DOXYGEN_SHOULD_SKIP_THIS
 
 #ifdef __cplusplus
 extern "C" {
@@ -16,6 +40,7 @@ void 	footswitch_left_pressed_isr(void) __attribute__((weak));
 
 void    rgb_leds_init(void);
 void    rgb_write(int led_num, int r, int g, int b);
+void    rgb_leds_flush(void);
 void    turn_on_left_footsw_led(void);
 void    turn_off_left_footsw_led(void);
 void    turn_on_right_footsw_led(void);
@@ -8,6 +8,33 @@
 
 fx_pedal pedal;
 
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+/************************************************************************
+ *  Memory report
+ *
+ *  Define DM_FX_MEMORY_REPORT in the build flags to have the compiler 
+ *  show the canvas profile and init() print the memory report, which 
+ *  includes how much SRAM the profile saves compared to the large one.
+ ***********************************************************************/
+#if defined (DM_FX_MEMORY_REPORT)
+
+  #define DM_FX_STR_(x) #x
+  #define DM_FX_STR(x)  DM_FX_STR_(x)
+
+  #pragma message ("DreamMaker FX canvas profile: " DM_FX_CANVAS_PROFILE \
+                   ", MAX_INSTANCES=" DM_FX_STR(MAX_INSTANCES) \
+                   ", MAX_ROUTES=" DM_FX_STR(MAX_ROUTES))
+
+#endif  // DM_FX_MEMORY_REPORT
+
+// SRAM used by the instance and routing stacks of fx_pedal for a capacity
+#define FX_PEDAL_STACK_BYTES(instances, routes) \
+  ((instances) * sizeof(FX_INSTANCE) + (routes) * (sizeof(AUDIO_ROUTE) + sizeof(CTRL_ROUTE)))
+
+#endif  // DOXYGEN_SHOULD_SKIP_THIS
+
 /************************************************************************
  *  Initialization
  ***********************************************************************/
@@ -43,8 +70,10 @@ void fx_pedal::init(bool debug_enable) {
 void fx_pedal::init(bool debug_enable, bool dsp_telem) {
   if (dsp_telem) {
     init(MSG_DEBUG);    
+  } else if (debug_enable) {
+    init(MSG_INFO);
   } else {
-
+    init();
   }
 }
 
@@ -97,11 +126,14 @@ void fx_pedal::init(DEBUG_MSG_LEVEL debug_level, bool dsp_no_reset) {
   // Initialize the RGB LEDs if present
 
   rgb_leds_init();
+
+  // Start scanning the pots
+  pot_adc_init();
   turn_on_left_footsw_led_rgb(0, 0, 200);
   turn_on_center_footsw_led_rgb(0, 0, 200);
   turn_on_right_footsw_led_rgb(0, 0, 200);
 
-  int now = millis();
+  uint32_t now = millis();
   bool timeout = false;
   while ( !Serial && !timeout) {
     if (millis() > now + 2000) {
@@ -120,6 +152,10 @@ void fx_pedal::init(DEBUG_MSG_LEVEL debug_level, bool dsp_no_reset) {
   Serial.print(package_str);    
   Serial.println(")");
 
+  #if defined (DM_FX_MEMORY_REPORT)
+    print_memory_report();
+  #endif
+
   #if defined (DM_FX)
     // Initialize the WM8731
     wm8731_initialize();
@@ -134,8 +170,8 @@ void fx_pedal::init(DEBUG_MSG_LEVEL debug_level, bool dsp_no_reset) {
   turn_on_right_footsw_led_rgb(100, 0, 100);
 
 
-  attachInterrupt(digitalPinToInterrupt(PIN_FOOTSW_1), footswitch_right_pressed_isr, FALLING);
-  attachInterrupt(digitalPinToInterrupt(PIN_FOOTSW_2), footswitch_left_pressed_isr, FALLING);
+  attachInterrupt(digitalPinToInterrupt(PIN_FOOTSW_1), footswitch_right_pressed_isr, CHANGE);
+  attachInterrupt(digitalPinToInterrupt(PIN_FOOTSW_2), footswitch_left_pressed_isr, CHANGE);
   
   if (!dsp_no_reset) {
     // Reset the DSP
@@ -174,7 +210,23 @@ void fx_pedal::init(DEBUG_MSG_LEVEL debug_level, bool dsp_no_reset) {
   }
   if (!firmware_match) {
     Serial.println(" The Arduino package version does not match the DSP firmware version, updating firmware...");
-    dsp_update_firmware_image();
+    // Each attempt only reprograms the sectors that still differ from the 
+    // image, so a retry rewrites just the sectors that failed to verify
+    bool updated = false;
+    for (int attempt=0;attempt<DSP_FIRMWARE_UPDATE_ATTEMPTS && !updated;attempt++) {
+      updated = dsp_update_firmware_image();
+      char msg[96];
+      sprintf(msg, " Rewrote %u of %u flash sectors (%u bytes, %u did not verify) in %u ms", 
+              (unsigned) dsp_firmware_update_stats.sectors_written, (unsigned) dsp_firmware_update_stats.sectors,
+              (unsigned) dsp_firmware_update_stats.bytes_written, (unsigned) dsp_firmware_update_stats.sectors_failed,
+              (unsigned) dsp_firmware_update_stats.elapsed_ms);
+      Serial.println(msg);
+    }
+    if (!updated) {
+      // Booting a partly written image would leave the DSP in an unknown state
+      DEBUG_MSG("DSP firmware update failed: boot flash does not match the firmware image", MSG_ERROR);
+      display_error_status(ERROR_CODE_FIRMWARE_MISMATCH);
+    }
     dsp_reset();
     wait_for_dsp_spi_flash_access_to_cease();
     wait_for_dsp_to_boot();
@@ -203,15 +255,17 @@ void fx_pedal::init(DEBUG_MSG_LEVEL debug_level, bool dsp_no_reset) {
 
 /**
  * @brief      Transmits the control routing stack to the DSP
+ *
+ * @return     True if the stack was queued, false if no buffer was available
  */
-void  fx_pedal::spi_transmit_control_routing_stack(void) {
+bool  fx_pedal::spi_transmit_control_routing_stack(void) {
 
   DEBUG_MSG("Starting", MSG_DEBUG);
 
-  uint16_t * routing_block = (uint16_t *) malloc(total_control_routes*8*sizeof(uint16_t));
+  uint16_t   mark = scratch_mark();
+  uint16_t * routing_block = scratch_alloc(total_control_routes*9 + 1);
   if (routing_block == NULL) {
-      DEBUG_MSG("Could not allocate space for routing block", MSG_ERROR);
-      display_error_status(ERROR_INTERNAL);    
+    return false;
   }
 
   // serialize routing data
@@ -224,10 +278,11 @@ void  fx_pedal::spi_transmit_control_routing_stack(void) {
     routing_block[indx++] = control_routing_stack[i].dest_param_id; 
     float scale = control_routing_stack[i].scale;
     float offset = control_routing_stack[i].offset;
-    uint32_t part_32 = * (uint32_t *) &scale;
+    uint32_t part_32;
+    memcpy(&part_32, &scale, sizeof(part_32));
     routing_block[indx++] = (uint16_t) (part_32 >> 16);
     routing_block[indx++] = (uint16_t) (part_32 & 0xFFFF);
-    part_32 = * (uint32_t *) &offset;
+    memcpy(&part_32, &offset, sizeof(part_32));
     routing_block[indx++] = (uint16_t) (part_32 >> 16);
     routing_block[indx++] = (uint16_t) (part_32 & 0xFFFF);
     routing_block[indx++] = (uint16_t) control_routing_stack[i].type;
@@ -237,23 +292,25 @@ void  fx_pedal::spi_transmit_control_routing_stack(void) {
   // Copy to SPI transmit fifo
   spi_fifo_insert_block(routing_block, indx);
 
-  free (routing_block);
+  scratch_release(mark);
 
   DEBUG_MSG("Complete", MSG_DEBUG);
-
+  return true;
 }
 
 /**
  * @brief  Transmits the routing stack to the DSP
+ *
+ * @return True if the stack was queued, false if no buffer was available
  */
-void  fx_pedal::spi_transmit_audio_routing_stack(void) {
+bool  fx_pedal::spi_transmit_audio_routing_stack(void) {
 
   DEBUG_MSG("Starting", MSG_DEBUG);
 
-  uint16_t * routing_block = (uint16_t *) malloc(total_audio_routes*2*sizeof(uint16_t));
+  uint16_t   mark = scratch_mark();
+  uint16_t * routing_block = scratch_alloc(total_audio_routes*2 + 1);
   if (routing_block == NULL) {
-      DEBUG_MSG("Could not allocate space for routing block", MSG_ERROR);
-      display_error_status(ERROR_INTERNAL);    
+    return false;
   }
  
   // serialize routing data
@@ -267,23 +324,26 @@ void  fx_pedal::spi_transmit_audio_routing_stack(void) {
   // Copy to SPI transmit fifo
   spi_fifo_insert_block(routing_block, indx);
 
-  DEBUG_MSG("Complete", MSG_DEBUG);
-
+  scratch_release(mark);
 
+  DEBUG_MSG("Complete", MSG_DEBUG);
+  return true;
 }
 
 
 /**
  * @brief  Transmits the instance stack to the DSP
+ *
+ * @return True if the stack was queued, false if no buffer was available
  */
-void fx_pedal::spi_transmit_instance_stack(void) {
+bool fx_pedal::spi_transmit_instance_stack(void) {
 
   DEBUG_MSG("Starting", MSG_DEBUG);
 
-  uint16_t * spi_instance_block = (uint16_t *) malloc((total_instances + 1)*sizeof(uint16_t));
+  uint16_t   mark = scratch_mark();
+  uint16_t * spi_instance_block = scratch_alloc(total_instances + 1);
   if (spi_instance_block == NULL) {
-      DEBUG_MSG("Could not allocate space for routing block", MSG_ERROR);
-      display_error_status(ERROR_INTERNAL);    
+    return false;
   }
 
   // serialize instance data
@@ -296,14 +356,18 @@ void fx_pedal::spi_transmit_instance_stack(void) {
   // Copy to SPI transmit fifo
   spi_fifo_insert_block(spi_instance_block, indx);
 
-  free(spi_instance_block);
+  scratch_release(mark);
 
   DEBUG_MSG("Complete", MSG_DEBUG);
-
+  return true;
 }
 
 /**
- * @brief      Transmits an updated parameter to the DSP
+ * @brief      Sends an updated parameter to the DSP
+ *
+ * Boolean parameters (enable, start / stop, triggers) are sent right away.
+ * Other parameters are queued for the parameter update scheduler which 
+ * sends the latest value of each from service() (see service_param_updates()).
  *
  * @param[in]  instance_type  The instance type
  * @param[in]  instance_id    The instance identifier
@@ -313,33 +377,66 @@ void fx_pedal::spi_transmit_instance_stack(void) {
  */
 void fx_pedal::spi_transmit_param(EFFECT_TYPE instance_type, uint32_t instance_id, PARAM_TYPES param_type, uint8_t param_id, void * value) {
   
-  DEBUG_MSG("Starting", MSG_DEBUG);  
+  uint32_t raw;
 
-  static uint16_t param_block[7] = {HEADER_SINGLE_PARAMETER};
+  // The preloaded canvas got its parameters when it was sent; it is brought up 
+  // to date at the swap
+  if (shadow_canvas_loaded) {
+    shadow_params_stale = true;
+  }
 
-  uint16_t part_16;
-  uint32_t part_32;
+  // Effect isn't part of a running canvas; its parameters are sent when the canvas is
+  if (instance_id == 0xFF) {
+    return;
+  }
+
+  if (param_type == T_BOOL) {
+    raw = * (uint8_t *) value;
+  }
+  else if (param_type == T_INT16) {
+    raw = * (uint16_t *) value;
+  }
+  else {
+    memcpy(&raw, value, sizeof(raw));
+  }
+
+  if (schedule_active) {
+    schedule_param_update(instance_type, instance_id, param_type, param_id, raw);
+  } else if (param_type == T_BOOL) {
+    spi_transmit_param_frame(instance_type, instance_id, param_type, param_id, raw);
+  } else {
+    queue_param_update(instance_type, instance_id, param_type, param_id, raw);
+  }
+}
+
+/**
+ * @brief      Adds a single parameter frame to the SPI FIFO
+ *
+ * @param[in]  instance_type  The instance type
+ * @param[in]  instance_id    The instance identifier
+ * @param[in]  param_type     The parameter type
+ * @param[in]  param_id       The parameter identifier
+ * @param[in]  raw            The raw bits of the value
+ */
+void fx_pedal::spi_transmit_param_frame(EFFECT_TYPE instance_type, uint8_t instance_id, uint8_t param_type, uint8_t param_id, uint32_t raw) {
+  
+  DEBUG_MSG("Starting", MSG_DEBUG);  
 
+  uint16_t param_block[7];
+
+  param_block[0] = HEADER_SINGLE_PARAMETER;
   param_block[1] = (uint16_t) instance_type;
   param_block[2] = (uint16_t) instance_id;
   param_block[3] = (uint16_t) param_type;
   param_block[4] = param_id;
 
-  if (param_type == T_BOOL) {
-    part_16 = * (uint8_t *) value;
-    param_block[5] = part_16;
-  }
-  else if (param_type == T_INT16) {
-    param_block[5] = (uint16_t) (* (uint16_t *) value);
+  if (param_type == T_BOOL || param_type == T_INT16) {
+    param_block[5] = (uint16_t) raw;
+    param_block[6] = 0;
   }
-  else if (param_type == T_INT32) {
-    param_block[5] = (uint16_t)((* (uint32_t *) value) >> 16);
-    param_block[6] = (uint16_t)((* (uint32_t *) value) & 0xFFFF);
-  }
-  else if (param_type == T_FLOAT) {
-    part_32 = * (uint32_t *) value;
-    param_block[5] = (uint16_t) (part_32 >> 16);
-    param_block[6] = (uint16_t) (part_32 & 0xFFFF);
+  else {
+    param_block[5] = (uint16_t) (raw >> 16);
+    param_block[6] = (uint16_t) (raw & 0xFFFF);
   }     
 
   // Add to transmit FIFO
@@ -349,6 +446,36 @@ void fx_pedal::spi_transmit_param(EFFECT_TYPE instance_type, uint32_t instance_i
 
 }
 
+/**
+ * @brief      Adds a scheduled parameter frame to the SPI FIFO; the DSP holds 
+ *             the value until it reaches the block in the frame
+ *
+ * @param      event  The scheduled update
+ */
+void fx_pedal::spi_transmit_scheduled_param_frame(FX_SCHEDULED_PARAM * event) {
+
+  uint16_t param_block[9];
+
+  param_block[0] = HEADER_SCHEDULED_PARAMETER;
+  param_block[1] = (uint16_t) event->type;
+  param_block[2] = (uint16_t) event->instance_id;
+  param_block[3] = (uint16_t) event->param_type;
+  param_block[4] = event->param_id;
+
+  if (event->param_type == T_BOOL || event->param_type == T_INT16) {
+    param_block[5] = (uint16_t) event->value;
+    param_block[6] = 0;
+  }
+  else {
+    param_block[5] = (uint16_t) (event->value >> 16);
+    param_block[6] = (uint16_t) (event->value & 0xFFFF);
+  }
+  param_block[7] = (uint16_t) (event->block >> 16);
+  param_block[8] = (uint16_t) (event->block & 0xFFFF);
+
+  spi_fifo_insert_block(param_block, sizeof(param_block)/sizeof(uint16_t));
+}
+
 /**
  * @brief   Set pedal bypass state
  */
@@ -367,9 +494,43 @@ void fx_pedal::spi_transmit_bypass(uint16_t bypass_state) {
 
 }
 
-void fx_pedal::spi_get_status(void) {
+/**
+ * @brief   Selects which canvas slot on the DSP subsequent instance, routing 
+ *          and parameter blocks are written to
+ */
+void fx_pedal::spi_transmit_canvas_slot(uint16_t slot) {
 
-  uint16_t param_block[1];
+  uint16_t param_block[2];
+
+  param_block[0] = HEADER_CANVAS_SLOT;
+  param_block[1] = slot; 
+ 
+  spi_fifo_insert_block(param_block, 2);
+}
+
+/**
+ * @brief   Makes the shadow canvas active, crossfading over a number of audio blocks
+ */
+void fx_pedal::spi_transmit_swap(uint16_t crossfade_blocks) {
+
+  uint16_t param_block[2];
+
+  param_block[0] = HEADER_SWAP_CANVAS;
+  param_block[1] = crossfade_blocks; 
+ 
+  spi_fifo_insert_block(param_block, 2);
+}
+
+void fx_pedal::spi_get_status(void) {
+  FX_PROFILE_ZONE("dsp status");
+
+  // The DSP clocks its status frame out while this request is clocked in, so
+  // the request is padded to the full frame.  The readback area cannot be 
+  // left off when no readbacks are pending: the DSP always sends the whole 
+  // frame and the tail would only arrive with the next transfer, after the 
+  // block count has been time stamped.
+  uint16_t param_block[SPI_DSP_STAT_FRAME_SIZE];
+  memset(param_block, 0, sizeof(param_block));
   param_block[0] = HEADER_GET_STATUS;
 
   spi_fifo_insert_block(param_block, SPI_DSP_STAT_FRAME_SIZE);
@@ -378,13 +539,19 @@ void fx_pedal::spi_get_status(void) {
 
 /**
  * @brief   Transmits one set of parameters to the DSP
+ *
+ * @return  True if the parameters were queued, false if no buffer was available
  */
-void fx_pedal::spi_transmit_params(uint16_t node_index) {
+bool fx_pedal::spi_transmit_params(uint16_t node_index) {
 
   DEBUG_MSG("Starting", MSG_DEBUG);  
   
-  uint16_t param_block[MAX_PARMS_PER_FX];
-  uint16_t size;
+  uint16_t   mark = scratch_mark();
+  uint16_t * param_block = scratch_alloc(SCRATCH_WORDS_PARAMS);
+  uint16_t   size;
+  if (param_block == NULL) {
+    return false;
+  }
 
   if (!node_index) {
     DEBUG_MSG("This instance is not part of a canvas", MSG_ERROR);  
@@ -412,19 +579,27 @@ void fx_pedal::spi_transmit_params(uint16_t node_index) {
   // Copy to SPI transmit fifo
   spi_fifo_insert_block(param_block, size);
 
-  DEBUG_MSG("Complete", MSG_DEBUG);  
+  scratch_release(mark);
 
+  DEBUG_MSG("Complete", MSG_DEBUG);  
+  return true;
 }
 
 /**
  * @brief   Transmits all initial parameters to the DSP
+ *
+ * @return  True if the parameters were queued, false if no buffer was available
  */
-void fx_pedal::spi_transmit_all_params(void) {
+bool fx_pedal::spi_transmit_all_params(void) {
 
   DEBUG_MSG("Starting", MSG_DEBUG);  
 
-  uint16_t param_block[MAX_PARMS_PER_FX];
-  uint16_t size;
+  uint16_t   mark = scratch_mark();
+  uint16_t * param_block = scratch_alloc(SCRATCH_WORDS_PARAMS);
+  uint16_t   size;
+  if (param_block == NULL) {
+    return false;
+  }
 
   param_block[0] = HEADER_PARAMETER_BLOCK;
 
@@ -463,16 +638,47 @@ void fx_pedal::spi_transmit_all_params(void) {
     }
   }
 
+  scratch_release(mark);
+
   DEBUG_MSG("Complete", MSG_DEBUG);  
+  return true;
 }
 
 
 
 
+/**
+ * @brief   Transmits the routing stacks and the instance stack to the DSP
+ *
+ * @return  True if all three were queued, false if not
+ */
+bool fx_pedal::spi_transmit_canvas_topology(void) {
+
+  // Send routing stack to DSP
+  if (!spi_transmit_audio_routing_stack()) {
+    return false;
+  }
+  display_data_from_sharc();
+
+  if (!spi_transmit_control_routing_stack()) {
+    return false;
+  }
+  display_data_from_sharc();
+
+  // Send instance stack to DSP
+  if (!spi_transmit_instance_stack()) {
+    return false;
+  }
+  display_data_from_sharc();
+  return true;
+}
+
+
 /**
  * @brief Check if any SPI transactions need to happen
  */
 void  fx_pedal::spi_service(void) {
+  FX_PROFILE_ZONE("spi drain");
   spi_transmit_buffered_frames(false);
 }
 
@@ -490,6 +696,83 @@ void  fx_pedal::spi_service(void) {
  *****************************************************************************/
 
 
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+/**
+ * @brief      Clears the instance and routing stacks so only the canvas itself 
+ *             (instance 0) remains
+ */
+void  fx_pedal::reset_canvas_stacks(void) {
+
+  // Add canvas as instance 0
+  total_instances = 1;
+  instance_stack[0].id = 0;
+  instance_stack[0].type = FX_CANVAS;
+  instance_stack[0].address = NULL;
+
+  // Init the remaining slots in the instance stack
+  for (int i=1;i<MAX_INSTANCES;i++) {
+    instance_stack[i].id = UNDEFINED;
+    instance_stack[i].address = NULL;       
+    instance_stack[i].type = FX_UNDEFINED; 
+  }
+
+  // Init the slots in the audio and control routing stacks
+  total_audio_routes = 0;
+  total_control_routes = 0;
+  for (int i=0;i<MAX_ROUTES;i++) {
+    audio_routing_stack[i].src_id = UNDEFINED;
+    audio_routing_stack[i].src_node_indx = UNDEFINED;       
+    audio_routing_stack[i].dest_id = UNDEFINED; 
+    audio_routing_stack[i].dest_node_indx = UNDEFINED;       
+
+    control_routing_stack[i].src_id = UNDEFINED;
+    control_routing_stack[i].src_node_indx = UNDEFINED;       
+    control_routing_stack[i].dest_id = UNDEFINED; 
+    control_routing_stack[i].dest_node_indx = UNDEFINED;            
+  }  
+
+  valid_audio_routes = false;
+  valid_control_routes = false;
+  valid_canvas = false;
+  canvas_over_capacity = false;
+
+  // Readbacks belong to the routes of the old canvas
+  total_param_readbacks = 0;
+  param_readback_next = 0;
+}
+
+/**
+ * @brief      Gives the effects the instance IDs of the canvas in the instance 
+ *             stack once it is the one running on the DSP
+ *
+ * Until then parameter writes keep going to the instances of the old canvas.
+ * Effects that are not part of the new canvas get no ID.  Updates still 
+ * queued for the old IDs are dropped as their values are in the parameter 
+ * blocks of the new canvas.
+ */
+void  fx_pedal::commit_instance_ids(void) {
+
+  for (int i=1;i<total_live_instances;i++) {
+    if (live_instances[i] != NULL) {
+      ((fx_effect *) live_instances[i])->instance_id = 0xFF;
+    }
+  }
+  for (int i=1;i<total_instances;i++) {
+    live_instances[i] = instance_stack[i].address;
+    if (live_instances[i] != NULL) {
+      ((fx_effect *) live_instances[i])->instance_id = i;
+    }
+  }
+  total_live_instances = total_instances;
+
+  clear_param_updates();
+  clear_scheduled_params();
+}
+
+#endif  // DOXYGEN_SHOULD_SKIP_THIS
+
+
 /**
  * @brief      Adds a new audio route
  *
@@ -504,6 +787,12 @@ bool  fx_pedal::add_audio_route_to_stack(uint8_t src_id,
                                           uint8_t src_node_indx, 
                                           uint8_t dest_id, 
                                           uint8_t dest_node_indx) {
+  if (total_audio_routes >= MAX_ROUTES) {
+    DEBUG_MSG("Too many audio routes - define DM_FX_LARGE_CANVAS to allow more", MSG_ERROR);
+    canvas_over_capacity = true;
+    return false;
+  }
+
   audio_routing_stack[total_audio_routes].src_id = src_id;
   audio_routing_stack[total_audio_routes].src_node_indx = src_node_indx;
   audio_routing_stack[total_audio_routes].dest_id = dest_id;
@@ -533,6 +822,12 @@ bool  fx_pedal::add_control_route_to_stack(uint8_t src_id,
                                             float offset,
                                             CTRL_NODE_TYPE type) {
 
+  if (total_control_routes >= MAX_ROUTES) {
+    DEBUG_MSG("Too many control routes - define DM_FX_LARGE_CANVAS to allow more", MSG_ERROR);
+    canvas_over_capacity = true;
+    return false;
+  }
+
   control_routing_stack[total_control_routes].src_id = src_id;
   control_routing_stack[total_control_routes].src_node_indx = src_node_indx;
   control_routing_stack[total_control_routes].src_param_id = src_param_id;
@@ -559,7 +854,6 @@ bool  fx_pedal::add_control_route_to_stack(uint8_t src_id,
  */
 bool fx_pedal::route_audio(fx_audio_node * src, fx_audio_node * dest) {
 
-  bool local_debug = false;
   // Ensure inputs and outputs are valid
   if (src->node_direction != NODE_OUT || dest->node_direction != NODE_IN) {
     DEBUG_MSG("Source node is not an output, or destination node is not an input", MSG_ERROR);
@@ -567,7 +861,7 @@ bool fx_pedal::route_audio(fx_audio_node * src, fx_audio_node * dest) {
     return false;
   }
 
-  uint8_t src_id, dest_id;
+  uint8_t src_id = 0, dest_id = 0;
 
   // Set to false in case we bail mid-way through due to error
   valid_audio_routes = false;
@@ -582,6 +876,11 @@ bool fx_pedal::route_audio(fx_audio_node * src, fx_audio_node * dest) {
       }
     }
     if (!found) {
+      if (total_instances >= MAX_INSTANCES) {
+        DEBUG_MSG("Too many effects in canvas - define DM_FX_LARGE_CANVAS to allow more", MSG_ERROR);
+        canvas_over_capacity = true;
+        return false;
+      }
       instance_stack[total_instances].address = src->parent_effect; 
       instance_stack[total_instances].type = src->parent_effect->get_type(); 
       instance_stack[total_instances].id = total_instances; 
@@ -594,10 +893,6 @@ bool fx_pedal::route_audio(fx_audio_node * src, fx_audio_node * dest) {
         Serial.println((uint32_t) instance_stack[total_instances].address, HEX);
       #endif
 
-
-      // Set instance ID in this effect instance too
-      src->parent_effect->instance_id = total_instances;
-
       total_instances++;
 
     }
@@ -614,6 +909,11 @@ bool fx_pedal::route_audio(fx_audio_node * src, fx_audio_node * dest) {
       }
     }
     if (!found) {
+      if (total_instances >= MAX_INSTANCES) {
+        DEBUG_MSG("Too many effects in canvas - define DM_FX_LARGE_CANVAS to allow more", MSG_ERROR);
+        canvas_over_capacity = true;
+        return false;
+      }
       instance_stack[total_instances].address = dest->parent_effect; 
       instance_stack[total_instances].type = dest->parent_effect->get_type(); 
       instance_stack[total_instances].id = total_instances; 
@@ -626,9 +926,6 @@ bool fx_pedal::route_audio(fx_audio_node * src, fx_audio_node * dest) {
         Serial.println((uint32_t) instance_stack[total_instances].address, HEX);
       #endif
 
-      // Set instance ID in this effect instance too
-      dest->parent_effect->instance_id = total_instances;
-
       total_instances++;
     }
   } else if (dest->parent_canvas != NULL) {
@@ -636,7 +933,7 @@ bool fx_pedal::route_audio(fx_audio_node * src, fx_audio_node * dest) {
   }
 
   // Add routes to our routing table
-  uint8_t src_node_indx, dest_node_indx;
+  uint8_t src_node_indx = 0, dest_node_indx = 0;
   bool res;
 
   // Look up source node
@@ -680,7 +977,9 @@ bool fx_pedal::route_audio(fx_audio_node * src, fx_audio_node * dest) {
   dest->connected = true;
 
   // Add route to routing table
-  add_audio_route_to_stack(src_id, src_node_indx, dest_id, dest_node_indx);
+  if (!add_audio_route_to_stack(src_id, src_node_indx, dest_id, dest_node_indx)) {
+    return false;
+  }
 
   // Check routing table for any outputs that are being written to twice
   for (int i=0;i<total_audio_routes;i++) {
@@ -710,7 +1009,7 @@ bool fx_pedal::route_audio(fx_audio_node * src, fx_audio_node * dest) {
  * @return     True is successful, false if not
  */
 bool fx_pedal::route_control(fx_control_node * src, fx_control_node * dest) {
-  route_control(src, dest, 1.0, 0.0);
+  return route_control(src, dest, 1.0, 0.0);
 }
 
 /**
@@ -735,7 +1034,7 @@ bool fx_pedal::route_control(fx_control_node * src, fx_control_node * dest, floa
     return false;
   }
 
-  uint8_t src_id, dest_id;
+  uint8_t src_id = 0, dest_id = 0;
 
   // Check to see if inputs and outputs are in our stack, and add if not
   if (src->parent_effect != NULL) {
@@ -747,11 +1046,15 @@ bool fx_pedal::route_control(fx_control_node * src, fx_control_node * dest, floa
       }
     }
     if (!found) {
+      if (total_instances >= MAX_INSTANCES) {
+        DEBUG_MSG("Too many effects in canvas - define DM_FX_LARGE_CANVAS to allow more", MSG_ERROR);
+        canvas_over_capacity = true;
+        return false;
+      }
       instance_stack[total_instances].address = src->parent_effect; 
       instance_stack[total_instances].type = src->parent_effect->get_type(); 
       instance_stack[total_instances].id = total_instances; 
       src_id = total_instances;
-      src->parent_effect->instance_id = total_instances;
       total_instances++;
 
       #if 0
@@ -771,11 +1074,15 @@ bool fx_pedal::route_control(fx_control_node * src, fx_control_node * dest, floa
       }
     }
     if (!found) {
+      if (total_instances >= MAX_INSTANCES) {
+        DEBUG_MSG("Too many effects in canvas - define DM_FX_LARGE_CANVAS to allow more", MSG_ERROR);
+        canvas_over_capacity = true;
+        return false;
+      }
       instance_stack[total_instances].address = dest->parent_effect; 
       instance_stack[total_instances].type = dest->parent_effect->get_type(); 
       instance_stack[total_instances].id = total_instances; 
       dest_id = total_instances;
-      dest->parent_effect->instance_id = total_instances;
       total_instances++;
     }
   } else if (src->parent_canvas != NULL) {
@@ -789,7 +1096,7 @@ bool fx_pedal::route_control(fx_control_node * src, fx_control_node * dest, floa
   }
 
   // Add routes to our routing table
-  uint8_t src_node_indx, dest_node_indx;
+  uint8_t src_node_indx = 0, dest_node_indx = 0;
   bool res;
 
   // Look up source node
@@ -835,7 +1142,9 @@ bool fx_pedal::route_control(fx_control_node * src, fx_control_node * dest, floa
   dest->connected = true;
 
   // Add route to routing table
-  add_control_route_to_stack(src_id, src_node_indx, src->param_id, dest_id, dest_node_indx, dest->param_id, scale, offset, dest->node_type);
+  if (!add_control_route_to_stack(src_id, src_node_indx, src->param_id, dest_id, dest_node_indx, dest->param_id, scale, offset, dest->node_type)) {
+    return false;
+  }
 
   // Check routing table for any outputs that are being written to twice
 
@@ -851,6 +1160,11 @@ bool fx_pedal::route_control(fx_control_node * src, fx_control_node * dest, floa
     }
   }
 
+  // The DSP now owns this parameter, so keep the host's copy in step with it
+  if (dest->parent_effect != NULL) {
+    add_param_readback(dest);
+  }
+
   // Happy days, we made it
   valid_control_routes = true;
   return true;
@@ -892,6 +1206,16 @@ void fx_pedal::add_tap_interval_button(FOOTSWITCH footswitch, bool enable_led_fl
 
 }
 
+/**
+ * @brief      Attaches a modulation matrix so its mappings are evaluated 
+ *             each time `service()` runs
+ *
+ * @param      matrix  The modulation matrix (NULL to detach)
+ */
+void fx_pedal::add_mod_matrix(fx_mod_matrix * matrix) {
+  mod_matrix = matrix;
+}
+
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 
@@ -905,7 +1229,7 @@ void fx_pedal::add_tap_interval_button(FOOTSWITCH footswitch, bool enable_led_fl
  */
 bool  fx_pedal::get_audio_node_index(fx_audio_node * node, uint8_t * node_index) {
 
-  for (int i=0;i<MAX_NODES_PER_FX;i++) {
+  for (int i=0;i<(int) (sizeof(audio_node_stack)/sizeof(fx_audio_node *));i++) {
 
     if (node == audio_node_stack[i]) {
       *node_index = i;
@@ -926,7 +1250,7 @@ bool  fx_pedal::get_audio_node_index(fx_audio_node * node, uint8_t * node_index)
  */
 bool  fx_pedal::get_control_node_index(fx_control_node * node, uint8_t * node_index) {
 
-  for (int i=0;i<MAX_NODES_PER_FX;i++) {
+  for (int i=0;i<(int) (sizeof(control_node_stack)/sizeof(fx_control_node *));i++) {
 
     if (node == control_node_stack[i]) {
       *node_index = i;
@@ -951,9 +1275,70 @@ bool  fx_pedal::get_control_node_index(fx_control_node * node, uint8_t * node_in
 
 /**
  * @brief      Pedal service function that should be called in the Arduino loop() function
+ * 
+ * Each call runs the pedal's periodic work (pots, LEDs, footswitches and the
+ * link to the DSP) that is due, along with any tasks added with `add_task()`.
+ * Work that does not fit in one call runs in the next one, so call this as
+ * often as possible.
  */
 void fx_pedal::service(void) {
+  FX_PROFILE_SERVICE_ENTER();
+  sched_run(SERVICE_SLICE_US);
+  FX_PROFILE_SERVICE_EXIT();
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+/**
+ * @brief      Adds a task that should finish within SERVICE_DEADLINE_MS of 
+ *             each release (or within its period if that is shorter)
+ */
+static int add_service_task(const char * name, void (*fn)(void * arg), void * arg, void (*fn_void)(void),
+                            uint32_t period_ms, uint32_t budget_us) {
+  uint32_t deadline_ms = (period_ms < SERVICE_DEADLINE_MS) ? period_ms : SERVICE_DEADLINE_MS;
+  return sched_add_task(name, fn, arg, fn_void, period_ms * 1000, deadline_ms * 1000, budget_us);
+}
+
+/**
+ * @brief      Registers the pedal's periodic work with the task scheduler
+ */
+void fx_pedal::add_service_tasks(void) {
+  add_service_task("ui", service_task_ui, this, NULL, UI_SERVICE_INTERVAL_MS, UI_SERVICE_BUDGET_US);
+  add_service_task("pots", service_task_pots, this, NULL, POT_SERVICE_INTERVAL_MS, POT_SERVICE_BUDGET_US);
+  add_service_task("leds", service_task_leds, this, NULL, LED_UPDATE_RATE_MS, LED_SERVICE_BUDGET_US);
+  add_service_task("buttons", service_task_buttons, this, NULL, BUTTON_SCAN_INTERVAL_MS, BUTTON_SCAN_BUDGET_US);
+  add_service_task("link", service_task_link, this, NULL, SERVICE_INTERVAL_MS, LINK_SERVICE_BUDGET_US);
+  add_service_task("midi", service_task_midi, this, NULL, MIDI_SERVICE_INTERVAL_MS, MIDI_SERVICE_BUDGET_US);
+}
+
+void fx_pedal::service_task_ui(void * arg) {
+  ((fx_pedal *) arg)->service_ui();
+}
+
+void fx_pedal::service_task_pots(void * arg) {
+  ((fx_pedal *) arg)->service_pots();
+}
+
+void fx_pedal::service_task_leds(void * arg) {
+  ((fx_pedal *) arg)->service_leds();
+}
+
+void fx_pedal::service_task_buttons(void * arg) {
+  ((fx_pedal *) arg)->button_press_check();
+}
+
+void fx_pedal::service_task_link(void * arg) {
+  ((fx_pedal *) arg)->service_link();
+}
+
+void fx_pedal::service_task_midi(void * arg) {
+  ((fx_pedal *) arg)->service_midi();
+}
 
+/**
+ * @brief      Tap tempo LED, footswitch events and DSP telemetry
+ */
+void fx_pedal::service_ui(void) {
   if (tap_control_enabled) {
     if (tap_footswitch == FOOTSWITCH_LEFT) {
       if (millis() < tap_led_flash_cntr + 50) {
@@ -972,8 +1357,9 @@ void fx_pedal::service(void) {
   }
 
   if ((tap_blink_only_enabled || tap_control_enabled) && tap_locked) {
-    if (millis() > tap_led_flash_cntr + tap_interval_ms) {
-      tap_led_flash_cntr = millis();
+    uint32_t beat_ms = get_tap_beat_ms(millis());
+    if (beat_ms != tap_led_flash_cntr) {
+      tap_led_flash_cntr = beat_ms;
       if (tap_footswitch == FOOTSWITCH_LEFT) {
         turn_on_left_footsw_led();
       } else if (tap_footswitch == FOOTSWITCH_RIGHT) {
@@ -994,24 +1380,17 @@ void fx_pedal::service(void) {
     delay(1000);
   }
 
-  // Service LEDs
-  led_left.service();
-  #if defined (DM_FX_TWO)
-    led_center.service();
-  #endif
-  led_right.service();
-
-  button_press_check();
   service_button_events();
 
   // Read in telemetry data from the DSP
   display_data_from_sharc();
+}
 
-  // Run the remainder of service loop ~30 times / second
-  if (millis() < last_service_ts + 33) return;
-  last_service_ts = millis();
-
-  // Read the pots and switches
+/**
+ * @brief      Reads the pots and samples the control stream; the ADC scan 
+ *             keeps their latest values so this does not wait on conversions
+ */
+void fx_pedal::service_pots(void) {
   #if defined (DM_FX)
     pot_right.read_pot();
     pot_center.read_pot();
@@ -1024,42 +1403,1898 @@ void fx_pedal::service(void) {
     pot_bot_center.read_pot();
     pot_bot_right.read_pot();
     exp_pedal.read_pot();
+
+  #endif
+
+  service_control_stream();
+}
+
+/**
+ * @brief      Steps LED fades and sends the changes to the LED controller
+ */
+void fx_pedal::service_leds(void) {
+  led_left.service();
+  #if defined (DM_FX_TWO)
+    led_center.service();
+  #endif
+  led_right.service();
+
+  // Send whatever the LEDs changed to the LED controller in one transaction
+  rgb_leds_flush();
+}
+
+/**
+ * @brief      Toggle switches, DSP status, modulation, parameter traffic and
+ *             the SPI link
+ */
+void fx_pedal::service_link(void) {
+
+  // Read the switches
+  #if defined (DM_FX_TWO)
     toggle_left.read_switch();
     toggle_right.read_switch();
-
   #endif 
 
   // Get status data from the DSP
   spi_get_status();
 
-  // Service any parameter updates
-  spi_service();
+  // Evaluate the modulation matrix with the pot values just read
+  if (mod_matrix != NULL) {
+    mod_matrix->service();
+  }
 
-}
+  // Take in parameter values returned by the DSP and ask for the next batch
+  apply_param_readbacks();
+  if (millis() - param_readback_last_ms >= READBACK_INTERVAL_MS) {
+    param_readback_last_ms = millis();
+    spi_transmit_readback_request();
+  }
 
-void    fx_pedal::bypass_fx(void) {
-  DEBUG_MSG("Bypass", MSG_DEBUG);
-  spi_transmit_bypass((uint16_t) 1);
-}
+  // Follow the DSP block counter
+  if (dsp_status.block_count_us != dsp_clock.last_count_us) {
+    dsp_clock.last_count_us = dsp_status.block_count_us;
+    update_dsp_clock(dsp_status.block_count, dsp_status.block_count_us);
+  }
 
+  // Send the next step of any parameter ramps, then the scheduled updates 
+  // that are due (a ramp's last step can be one) and queued parameter updates
+  service_param_ramps();
+  service_scheduled_params();
+  service_param_updates();
 
-void    fx_pedal::enable_fx(void) {
-  DEBUG_MSG("Enable", MSG_DEBUG);
-  spi_transmit_bypass((uint16_t) 0);
+  // MIDI values waiting for the link go out with this flush
+  if (midi_values_pending && !midi_frame_pending && spi_transmit_ready()) {
+    send_midi_values();
+  }
+
+  // Service any parameter updates
+  spi_service();
 }
 
+#endif  // DOXYGEN_SHOULD_SKIP_THIS
 
 /**
- * @brief      Runs the current canvas (i.e. compiles and downloads to the DSP)
+ * @brief      Adds a function that `service()` calls periodically
+ * 
+ * The function runs alongside the pedal's own work (pots, LEDs, DSP link) 
+ * and should return quickly; long work delays the other tasks.
+ * 
+ * ``` CPP
+ * void blink() {
+ *   // Called every 500 ms
+ * }
+ * 
+ * void setup() {
+ *   pedal.init();
+ *   pedal.add_task(blink, 500);
+ *   ...
+ * }
+ * ```
+ *
+ * @param[in]  task       The function to call
+ * @param[in]  period_ms  How often to call it in milliseconds
+ *
+ * @return     The task ID (used with `get_task_stats()`), or -1 if no more 
+ *             tasks can be added
+ */
+int fx_pedal::add_task(void (*task)(void), uint32_t period_ms) {
+  return add_task(task, period_ms, USER_TASK_BUDGET_US);
+}
+
+/**
+ * @brief      Adds a function that `service()` calls periodically
+ *
+ * @param[in]  task       The function to call
+ * @param[in]  period_ms  How often to call it in milliseconds
+ * @param[in]  budget_us  How long the function is expected to take in 
+ *                        microseconds; runs that take longer are counted as 
+ *                        budget overruns
+ *
+ * @return     The task ID (used with `get_task_stats()`), or -1 if no more 
+ *             tasks can be added
+ */
+int fx_pedal::add_task(void (*task)(void), uint32_t period_ms, uint32_t budget_us) {
+  if (task == NULL || period_ms == 0) {
+    DEBUG_MSG("Task needs a function and a period", MSG_ERROR);
+    return -1;
+  }
+  int id = add_service_task("user", NULL, NULL, task, period_ms, budget_us);
+  if (id < 0) {
+    DEBUG_MSG("No free tasks (MAX_SCHED_TASKS)", MSG_ERROR);
+  }
+  return id;
+}
+
+/**
+ * @brief      Gets the statistics of a task run by `service()`
+ * 
+ * The pedal's own tasks come first, followed by the tasks added with 
+ * `add_task()`.
+ *
+ * @param[in]  task_id  The task ID
+ * @param      stats    The statistics (output)
+ *
+ * @return     False if there is no task with that ID
+ */
+bool fx_pedal::get_task_stats(int task_id, FX_TASK_STATS * stats) {
+  const FX_TASK * t = sched_get_task(task_id);
+  if (t == NULL) {
+    return false;
+  }
+  stats->name = t->name;
+  stats->period_us = t->period_us;
+  stats->budget_us = t->budget_us;
+  stats->runs = t->runs;
+  stats->deadline_misses = t->deadline_misses;
+  stats->budget_overruns = t->budget_overruns;
+  stats->skipped = t->skipped;
+  stats->max_run_us = t->max_run_us;
+  stats->max_jitter_us = t->max_jitter_us;
+  stats->mean_jitter_us = t->runs ? t->sum_jitter_us / (float) t->runs : 0.0;
+  return true;
+}
+
+/**
+ * @brief      Clears the statistics of all tasks
+ */
+void fx_pedal::reset_task_stats(void) {
+  sched_reset_stats();
+}
+
+/**
+ * @brief      Prints the statistics of all tasks run by `service()` to the 
+ *             serial port
+ */
+void fx_pedal::print_task_stats(void) {
+
+  char buf[200];
+  FX_TASK_STATS stats;
+
+  Serial.println();
+  Serial.println("Service tasks:");
+  for (int i=0;get_task_stats(i, &stats);i++) {
+    sprintf(buf, " %-8s every %lu us: %lu runs, jitter mean %lu us max %lu us, run max %lu us (budget %lu), %lu late, %lu over budget, %lu skipped",
+            stats.name, (unsigned long) stats.period_us, (unsigned long) stats.runs, 
+            (unsigned long) stats.mean_jitter_us, (unsigned long) stats.max_jitter_us,
+            (unsigned long) stats.max_run_us, (unsigned long) stats.budget_us,
+            (unsigned long) stats.deadline_misses, (unsigned long) stats.budget_overruns,
+            (unsigned long) stats.skipped);
+    Serial.println(buf);
+  }
+
+  FX_INPUT_STATS input;
+  get_input_stats(&input);
+  sprintf(buf, " footswitch presses: %lu (%lu dropped), interrupt max %lu us, press to action mean %lu us max %lu us",
+          (unsigned long) input.events, (unsigned long) input.dropped, (unsigned long) input.isr_max_us,
+          (unsigned long) input.latency_mean_us, (unsigned long) input.latency_max_us);
+  Serial.println(buf);
+  sprintf(buf, " footswitch gestures: %lu, decode to handler mean %lu us max %lu us",
+          (unsigned long) input.gestures, (unsigned long) input.gesture_latency_mean_us,
+          (unsigned long) input.gesture_latency_max_us);
+  Serial.println(buf);
+  sprintf(buf, " taps: %lu, %lu sequences cut short by a tempo change",
+          (unsigned long) input.taps, (unsigned long) input.tap_restarts);
+  Serial.println(buf);
+  Serial.println();
+}
+
+/**
+ * @brief      Gets how long the footswitch interrupt handlers take and how 
+ *             long presses and gestures wait before `service()` acts on them
+ *
+ * @param      stats  The statistics (output)
+ */
+void fx_pedal::get_input_stats(FX_INPUT_STATS * stats) {
+  FX_INPUT_ISR_STATS isr;
+  input_isr_stats(&isr);
+  stats->events = isr.events;
+  stats->dropped = isr.dropped;
+  stats->isr_max_us = isr.isr_max_us;
+  stats->isr_mean_us = isr.events ? (float) isr.isr_total_us / (float) isr.events : 0.0;
+  stats->latency_max_us = input_latency_max_us;
+  stats->latency_mean_us = input_events_handled ? (float) input_latency_total_us / (float) input_events_handled : 0.0;
+  stats->gestures = gesture_events;
+  stats->gesture_latency_max_us = gesture_latency_max_us;
+  stats->gesture_latency_mean_us = gesture_events ? (float) gesture_latency_total_us / (float) gesture_events : 0.0;
+  stats->taps = tap_count;
+  stats->tap_restarts = tap_restarts;
+}
+
+/**
+ * @brief      Clears the footswitch timing statistics
+ */
+void fx_pedal::reset_input_stats(void) {
+  input_isr_stats_reset();
+  input_events_handled = 0;
+  input_latency_total_us = 0;
+  input_latency_max_us = 0;
+  gesture_events = 0;
+  gesture_latency_total_us = 0;
+  gesture_latency_max_us = 0;
+  tap_count = 0;
+  tap_restarts = 0;
+}
+
+/**
+ * @brief      Prints how long `service()`, its tasks, the DSP link, the LED 
+ *             controller, the sketch's own code between calls to `service()` 
+ *             and any `FX_PROFILE_ZONE()` blocks take (min, mean, 99th 
+ *             percentile and max) to the serial port
+ * 
+ * Profiling is only built in when `DM_FX_PROFILE` is defined in the build 
+ * flags, so it costs nothing otherwise.
+ * 
+ * ``` CPP
+ * void loop() {
+ *   {
+ *     FX_PROFILE_ZONE("my code");
+ *     // Code to time...
+ *   }
+ *   pedal.service();
+ * 
+ *   if (pedal.button_pressed(FOOTSWITCH_LEFT, true)) {
+ *     pedal.print_profile();
+ *     pedal.reset_profile();
+ *   }
+ * }
+ * ```
+ */
+void fx_pedal::print_profile(void) {
+  #if defined (DM_FX_PROFILE)
+    profile_print();
+  #else
+    DEBUG_MSG("Profiling is not built in (define DM_FX_PROFILE)", MSG_WARN);
+  #endif
+}
+
+/**
+ * @brief      Clears the profile so the next report starts from now
+ */
+void fx_pedal::reset_profile(void) {
+  #if defined (DM_FX_PROFILE)
+    profile_reset();
+  #endif
+}
+
+void    fx_pedal::bypass_fx(void) {
+  DEBUG_MSG("Bypass", MSG_DEBUG);
+  spi_transmit_bypass((uint16_t) 1);
+}
+
+
+void    fx_pedal::enable_fx(void) {
+  DEBUG_MSG("Enable", MSG_DEBUG);
+  spi_transmit_bypass((uint16_t) 0);
+}
+
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+/******************************************************************************
+ *  Parameter ramps
+ *
+ *  Ramps are stepped from service() and each step is sent to the DSP as a
+ *  single parameter frame.  The step interval is picked so all active ramps 
+ *  together stay within RAMP_LINK_BUDGET_WORDS_PER_SEC, and the DSP smooths
+ *  between steps with the effect's own transition speed.
+ *
+ *  Steps go out on link ticks (every SERVICE_INTERVAL_MS), so the end of a 
+ *  ramp rarely falls on one.  When the DSP clock is synced, the last tick 
+ *  before the end sends the target as a scheduled update for the block at 
+ *  the end; otherwise the target goes out on the first tick after it, up to 
+ *  one link period late.
+ *****************************************************************************/
+
+/**
+ * @brief      Starts ramping a float parameter of an effect to a new value
+ *
+ * If the parameter is already being ramped, the ramp continues from its 
+ * current value toward the new target.  
+ *
+ * @param      effect       The effect
+ * @param      param        The parameter member in the effect
+ * @param[in]  param_id     The parameter ID used to send single updates
+ * @param[in]  target       The value to ramp to
+ * @param[in]  duration_ms  The duration of the ramp in milliseconds
+ *
+ * @return     True if the ramp was started, false if the value was set 
+ *             immediately (zero duration or no free ramp slots)
+ */
+bool fx_pedal::start_param_ramp(fx_effect * effect, float * param, uint8_t param_id, float target, uint32_t duration_ms) {
+
+  FX_PARAM_RAMP * ramp = NULL;
+  uint32_t now = millis();
+
+  // Reuse the slot if this parameter is already ramping, otherwise find a free one
+  for (int i=0;i<MAX_PARAM_RAMPS;i++) {
+    if (param_ramps[i].effect != NULL && param_ramps[i].param == param) {
+      ramp = &param_ramps[i];
+      break;
+    }
+    if (param_ramps[i].effect == NULL && ramp == NULL) {
+      ramp = &param_ramps[i];
+    }
+  }
+
+  if (ramp == NULL || duration_ms == 0) {
+    if (ramp == NULL) {
+      DEBUG_MSG("No free parameter ramps (MAX_PARAM_RAMPS), setting value immediately", MSG_WARN);
+    }
+    cancel_param_ramp(param);
+    *param = target;
+    spi_transmit_param(effect->type, effect->instance_id, T_FLOAT, param_id, param);
+    return false;
+  }
+
+  ramp->effect = effect;
+  ramp->param = param;
+  ramp->param_id = param_id;
+  ramp->start = *param;
+  ramp->target = target;
+  ramp->start_ms = now;
+  ramp->duration_ms = duration_ms;
+  ramp->next_ms = now;
+
+  return true;
+}
+
+/**
+ * @brief      Stops any ramp running on a parameter (the parameter keeps the 
+ *             value it has reached)
+ *
+ * @param      param  The parameter member in the effect
+ */
+void fx_pedal::cancel_param_ramp(float * param) {
+  for (int i=0;i<MAX_PARAM_RAMPS;i++) {
+    if (param_ramps[i].param == param) {
+      param_ramps[i].effect = NULL;
+      param_ramps[i].param = NULL;
+    }
+  }
+}
+
+/**
+ * @brief      Returns how often each ramp is updated given the number of ramps
+ *             currently running
+ *
+ * @return     Interval in milliseconds
+ */
+uint32_t fx_pedal::get_ramp_interval_ms(void) {
+
+  uint32_t active = 0;
+  for (int i=0;i<MAX_PARAM_RAMPS;i++) {
+    if (param_ramps[i].effect != NULL) {
+      active++;
+    }
+  }
+
+  uint32_t interval_ms = (active * SPI_SINGLE_PARAM_FRAME_WORDS * 1000 + RAMP_LINK_BUDGET_WORDS_PER_SEC - 1) / 
+                          RAMP_LINK_BUDGET_WORDS_PER_SEC;
+  if (interval_ms < SERVICE_INTERVAL_MS) {
+    interval_ms = SERVICE_INTERVAL_MS;
+  }
+  return interval_ms;
+}
+
+/**
+ * @brief      Sends the next step of each ramp that is due
+ */
+void fx_pedal::service_param_ramps(void) {
+
+  uint32_t now = millis();
+  uint32_t interval_ms = get_ramp_interval_ms();
+
+  for (int i=0;i<MAX_PARAM_RAMPS;i++) {
+    FX_PARAM_RAMP * ramp = &param_ramps[i];
+    if (ramp->effect == NULL) {
+      continue;
+    }
+
+    // On the last link tick before the end of the ramp the target is sent 
+    // for the DSP block at the end
+    uint32_t end_ms = ramp->start_ms + ramp->duration_ms;
+    int32_t until_end_ms = (int32_t) (end_ms - now);
+    bool end_scheduled = dsp_clock.synced && until_end_ms > 0 && until_end_ms < SERVICE_INTERVAL_MS;
+    if (!end_scheduled && (int32_t) (now - ramp->next_ms) < 0) {
+      continue;
+    }
+
+    uint32_t elapsed = now - ramp->start_ms;
+    bool last_step = end_scheduled || elapsed >= ramp->duration_ms;
+    float value;
+    if (last_step) {
+      value = ramp->target;
+    } else {
+      value = ramp->start + (ramp->target - ramp->start) * ((float) elapsed / (float) ramp->duration_ms);
+    }
+
+    if (value != *ramp->param) {
+      *ramp->param = value;
+      if (end_scheduled) {
+        bool was_active = schedule_active;
+        uint32_t was_block = schedule_block;
+        schedule_params_at_block(get_dsp_block(micros() + (uint32_t) until_end_ms * 1000));
+        spi_transmit_param(ramp->effect->type, ramp->effect->instance_id, T_FLOAT, ramp->param_id, ramp->param);
+        schedule_active = was_active;
+        schedule_block = was_block;
+      } else {
+        spi_transmit_param(ramp->effect->type, ramp->effect->instance_id, T_FLOAT, ramp->param_id, ramp->param);
+      }
+    }
+
+    if (last_step) {
+      ramp->effect = NULL;
+      ramp->param = NULL;
+    } else {
+      // Steps stay on a grid so a link tick that runs a little early does 
+      // not skip one; a ramp that fell behind steps again on the next tick
+      ramp->next_ms += interval_ms;
+      if ((int32_t) (now - ramp->next_ms) > 0) {
+        ramp->next_ms = now;
+      }
+    }
+  }
+}
+
+
+/******************************************************************************
+ *  Parameter update scheduler
+ *
+ *  Setters queue their new value rather than sending it.  Only the latest 
+ *  value of each parameter is kept, so a pot sweeping a parameter costs one 
+ *  frame per tick at most.  Each service() tick sends the most urgent updates
+ *  until the word budget is used up.  Urgency is how long an update has been
+ *  waiting plus how far the new value is from the value the DSP has, so a 
+ *  large change goes out first but every update is eventually sent as its 
+ *  wait keeps growing.
+ *****************************************************************************/
+
+/**
+ * @brief      Queues a parameter update, replacing any queued value for the 
+ *             same parameter
+ */
+void fx_pedal::queue_param_update(EFFECT_TYPE instance_type, uint8_t instance_id, uint8_t param_type, uint8_t param_id, uint32_t raw) {
+
+  FX_PARAM_UPDATE * update = NULL;
+  FX_PARAM_UPDATE * unused = NULL;
+  FX_PARAM_UPDATE * idle = NULL;
+  uint32_t now = millis();
+
+  for (int i=0;i<MAX_PARAM_UPDATES;i++) {
+    FX_PARAM_UPDATE * u = &param_updates[i];
+    if (!u->in_use) {
+      if (unused == NULL) {
+        unused = u;
+      }
+    } else if (u->instance_id == instance_id && u->param_id == param_id && u->type == instance_type) {
+      update = u;
+      break;
+    } else if (!u->pending && (idle == NULL || (int32_t) (u->since_ms - idle->since_ms) < 0)) {
+      idle = u;
+    }
+  }
+
+  // Prefer an unused slot, otherwise recycle the one that was sent longest ago
+  if (unused != NULL) {
+    idle = unused;
+  }
+
+  if (update == NULL) {
+    if (idle == NULL) {
+      // Every slot is waiting: send the most urgent one now to make room
+      uint32_t best_priority = 0;
+      for (int i=0;i<MAX_PARAM_UPDATES;i++) {
+        uint32_t priority = get_param_update_priority(&param_updates[i], now);
+        if (idle == NULL || priority > best_priority) {
+          idle = &param_updates[i];
+          best_priority = priority;
+        }
+      }
+      send_param_update(idle, now);
+      param_update_stats.forced++;
+    }
+    update = idle;
+    update->in_use = true;
+    update->pending = false;
+    update->sent = false;
+    update->type = instance_type;
+    update->instance_id = instance_id;
+    update->param_id = param_id;
+    update->param_type = param_type;
+  }
+
+  if (update->pending) {
+    param_update_stats.coalesced++;
+  } else {
+    // Nothing to do if the DSP already has this value
+    if (update->sent && update->last_value == raw) {
+      return;
+    }
+    update->pending = true;
+    update->since_ms = now;
+    param_update_stats.pending++;
+  }
+  update->value = raw;
+}
+
+/**
+ * @brief      Returns how urgent a queued update is (staleness in milliseconds
+ *             plus the size of the change)
+ */
+uint32_t fx_pedal::get_param_update_priority(FX_PARAM_UPDATE * update, uint32_t now) {
+
+  if (!update->pending) {
+    return 0;
+  }
+
+  uint32_t age_ms = now - update->since_ms;
+  float distance = 1.0;
+
+  // Floats: relative change for large values, absolute change for values 
+  // around 0 -> 1 (mixes, gains, depths).  Integers are enumerations or 
+  // counts so any change is a full scale change.
+  if (update->sent && update->param_type == T_FLOAT) {
+    float v_new, v_old;
+    memcpy(&v_new, &update->value, sizeof(v_new));
+    memcpy(&v_old, &update->last_value, sizeof(v_old));
+    float scale = fmaxf(fmaxf(fabsf(v_new), fabsf(v_old)), 1.0);
+    distance = fminf(fabsf(v_new - v_old) / scale, 1.0);
+  }
+  return age_ms + (uint32_t) (distance * PARAM_UPDATE_DISTANCE_MS) + 1;
+}
+
+/**
+ * @brief      Sends a queued update and updates the metrics
+ */
+void fx_pedal::send_param_update(FX_PARAM_UPDATE * update, uint32_t now) {
+
+  spi_transmit_param_frame(update->type, update->instance_id, update->param_type, update->param_id, update->value);
+
+  uint32_t age_ms = now - update->since_ms;
+  if (age_ms > param_update_stats.max_staleness_ms) {
+    param_update_stats.max_staleness_ms = age_ms;
+  }
+  param_update_stats.sent++;
+  param_update_stats.pending--;
+
+  update->last_value = update->value;
+  update->sent = true;
+  update->pending = false;
+  update->since_ms = now;
+}
+
+/**
+ * @brief      Sends the most urgent queued updates within the per-tick budget
+ */
+void fx_pedal::service_param_updates(void) {
+
+  uint32_t now = millis();
+  uint32_t words = 0;
+
+  // Always send at least one update per tick so a budget smaller than a 
+  // frame still makes progress
+  while (param_update_stats.pending && 
+        (words == 0 || words + SPI_SINGLE_PARAM_FRAME_WORDS <= param_update_stats.budget_words)) {
+
+    FX_PARAM_UPDATE * best = NULL;
+    uint32_t best_priority = 0;
+    for (int i=0;i<MAX_PARAM_UPDATES;i++) {
+      uint32_t priority = get_param_update_priority(&param_updates[i], now);
+      if (priority > best_priority) {
+        best = &param_updates[i];
+        best_priority = priority;
+      }
+    }
+    if (best == NULL) {
+      break;
+    }
+
+    send_param_update(best, now);
+    words += SPI_SINGLE_PARAM_FRAME_WORDS;
+  }
+
+  // Smoothed share of the budget used per tick
+  float used = (float) words / (float) param_update_stats.budget_words;
+  param_update_stats.link_utilization += 0.1 * (fminf(used, 1.0) - param_update_stats.link_utilization);
+}
+
+/**
+ * @brief      Drops all queued updates (used once the full parameter blocks 
+ *             have been sent to the DSP)
+ */
+void fx_pedal::clear_param_updates(void) {
+  for (int i=0;i<MAX_PARAM_UPDATES;i++) {
+    param_updates[i].in_use = false;
+    param_updates[i].pending = false;
+  }
+  param_update_stats.pending = 0;
+}
+
+#endif  // DOXYGEN_SHOULD_SKIP_THIS
+
+
+/**
+ * @brief      Sets how many words of parameter updates may be sent to the DSP
+ *             each time `service()` runs
+ *
+ * Each parameter update takes 11 words.  Lower values leave more of the link 
+ * for other traffic; updates that don't fit wait for the next tick.
+ *
+ * @param[in]  words_per_tick  The budget in 16-bit words
+ */
+void fx_pedal::set_param_update_budget(uint16_t words_per_tick) {
+  if (words_per_tick == 0) {
+    words_per_tick = 1;
+  }
+  param_update_stats.budget_words = words_per_tick;
+}
+
+/**
+ * @brief      Gets the parameter update scheduler metrics
+ *
+ * @param      stats  The metrics (output)
+ */
+void fx_pedal::get_param_update_stats(FX_PARAM_UPDATE_STATS * stats) {
+  *stats = param_update_stats;
+}
+
+/**
+ * @brief      Resets the parameter update scheduler metrics
+ */
+void fx_pedal::reset_param_update_stats(void) {
+  param_update_stats.link_utilization = 0.0;
+  param_update_stats.max_staleness_ms = 0;
+  param_update_stats.sent = 0;
+  param_update_stats.coalesced = 0;
+  param_update_stats.forced = 0;
+  param_update_stats.suppressed = 0;
+}
+
+
+/******************************************************************************
+ *  Parameter readback
+ *
+ *  A setter returns early when its parameter is driven by a control route, 
+ *  so the member in the effect keeps whatever value it had when the route 
+ *  was made.  Parameters registered for readback (every control route 
+ *  destination is) are requested from the DSP a batch at a time and their 
+ *  members are updated from the values in the status frame, so LEDs, 
+ *  read_param() and save_canvas() see what the DSP is actually using.
+ *****************************************************************************/
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+/**
+ * @brief      Finds the parameter behind a control node in the effect's 
+ *             parameter table
+ *
+ * @param      node  The control node
+ * @param      rb    Filled in with the effect, parameter and member
+ *
+ * @return     False if the node is not an effect parameter
+ */
+bool fx_pedal::get_param_readback_desc(fx_control_node * node, FX_PARAM_READBACK * rb) {
+  fx_effect * effect = node->parent_effect;
+  if (effect == NULL || node->node_direction != NODE_IN) {
+    return false;
+  }
+  for (int i=0;i<effect->param_table_len;i++) {
+    if (effect->param_table[i].param_id == node->param_id) {
+      rb->effect = effect;
+      rb->param_id = node->param_id;
+      rb->param_type = effect->param_table[i].type;
+      rb->member_offset = effect->param_table[i].member_offset;
+      rb->updated_ms = 0;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief      Returns the readback entry of a control node (NULL if none)
+ */
+FX_PARAM_READBACK * fx_pedal::find_param_readback(fx_control_node * node) {
+  for (int i=0;i<total_param_readbacks;i++) {
+    if (param_readbacks[i].effect == node->parent_effect && param_readbacks[i].param_id == node->param_id) {
+      return &param_readbacks[i];
+    }
+  }
+  return NULL;
+}
+
+/**
+ * @brief      Asks the DSP for the values of the next batch of readback 
+ *             parameters; the values come back in a later status frame
+ */
+void fx_pedal::spi_transmit_readback_request(void) {
+
+  if (total_param_readbacks == 0 || !valid_canvas) {
+    return;
+  }
+
+  uint16_t request[2 + SPI_READBACK_SLOTS];
+  uint16_t count = 0;
+
+  request[0] = HEADER_PARAM_READBACK;
+  for (int i=0;i<total_param_readbacks && count < SPI_READBACK_SLOTS;i++) {
+    FX_PARAM_READBACK * rb = &param_readbacks[param_readback_next];
+    if (++param_readback_next >= total_param_readbacks) {
+      param_readback_next = 0;
+    }
+    if (rb->effect->instance_id != 0xFF) {
+      request[2 + count++] = ((uint16_t) rb->effect->instance_id << 8) | rb->param_id;
+    }
+  }
+  if (count == 0) {
+    return;
+  }
+  request[1] = count;
+
+  spi_fifo_insert_block(request, 2 + count);
+}
+
+/**
+ * @brief      Copies parameter values returned in the last status frame into 
+ *             the effects
+ */
+void fx_pedal::apply_param_readbacks(void) {
+
+  for (int i=0;i<dsp_status.readback_count;i++) {
+    uint16_t key = dsp_status.readback_key[i];
+    uint32_t raw = dsp_status.readback_value[i];
+
+    for (int j=0;j<total_param_readbacks;j++) {
+      FX_PARAM_READBACK * rb = &param_readbacks[j];
+      if (rb->effect->instance_id != (key >> 8) || rb->param_id != (key & 0xFF)) {
+        continue;
+      }
+
+      // A newer value from a setter is on its way to the DSP
+      bool pending = false;
+      for (int k=0;k<MAX_PARAM_UPDATES;k++) {
+        FX_PARAM_UPDATE * u = &param_updates[k];
+        if (u->pending && u->instance_id == rb->effect->instance_id && u->param_id == rb->param_id) {
+          pending = true;
+        }
+      }
+      if (pending) {
+        break;
+      }
+      uint8_t * member = (uint8_t *) rb->effect + rb->member_offset;
+      if (rb->param_type == T_BOOL) {
+        * (bool *) member = (raw != 0);
+      } else if (rb->param_type == T_INT16) {
+        * (uint16_t *) member = (uint16_t) raw;
+      } else {
+        memcpy(member, &raw, sizeof(raw));
+      }
+      rb->updated_ms = millis();
+      break;
+    }
+  }
+  dsp_status.readback_count = 0;
+}
+
+#endif  // DOXYGEN_SHOULD_SKIP_THIS
+
+
+/**
+ * @brief      Keeps the host's copy of a parameter in step with the value the 
+ *             DSP is using
+ *
+ * Parameters driven by `route_control()` are added automatically; use this 
+ * for other parameters the DSP may change on its own.
+ *
+ * @param      node  The control node of the parameter (e.g. `delay.feedback`)
+ *
+ * @return     False if the node is not an effect parameter or there are 
+ *             already MAX_PARAM_READBACKS parameters being read back
+ */
+bool fx_pedal::add_param_readback(fx_control_node * node) {
+
+  if (find_param_readback(node) != NULL) {
+    return true;
+  }
+
+  FX_PARAM_READBACK rb;
+  if (!get_param_readback_desc(node, &rb)) {
+    DEBUG_MSG("Readback requires a control input of an effect", MSG_WARN);
+    return false;
+  }
+  if (total_param_readbacks >= MAX_PARAM_READBACKS) {
+    DEBUG_MSG("Too many parameter readbacks", MSG_WARN);
+    return false;
+  }
+  param_readbacks[total_param_readbacks++] = rb;
+  return true;
+}
+
+/**
+ * @brief      Reads the current value of a parameter
+ *
+ * For a parameter driven by a control route this is the value last read 
+ * back from the DSP; otherwise it is the value last set.
+ *
+ * ``` CPP
+ * float feedback;
+ * if (pedal.read_param(delay.feedback, &feedback)) {
+ *   pedal.led_center.turn_on(feedback * 255, 0, 0);
+ * }
+ * ```
+ *
+ * @param      node   The control node of the parameter
+ * @param      value  The value (booleans are 0.0 / 1.0)
+ *
+ * @return     False if the node is not an effect parameter
+ */
+bool fx_pedal::read_param(fx_control_node * node, float * value) {
+
+  FX_PARAM_READBACK rb;
+  if (!get_param_readback_desc(node, &rb)) {
+    return false;
+  }
+
+  uint8_t * member = (uint8_t *) rb.effect + rb.member_offset;
+  if (rb.param_type == T_BOOL) {
+    *value = * (bool *) member ? 1.0 : 0.0;
+  } else if (rb.param_type == T_INT16) {
+    *value = (float) * (int16_t *) member;
+  } else if (rb.param_type == T_INT32) {
+    *value = (float) * (int32_t *) member;
+  } else {
+    *value = * (float *) member;
+  }
+  return true;
+}
+
+
+/******************************************************************************
+ *  Scheduled parameter updates
+ *
+ *  A frame arrives at the DSP whenever the next service() tick flushes the 
+ *  SPI link, so a setter call lands up to a tick late.  Between 
+ *  schedule_params_at_block() / schedule_params_at_beat() and 
+ *  end_scheduled_params(), setters hold their updates with a target DSP 
+ *  block instead.  Each update is sent SCHEDULED_PARAM_LEAD_MS ahead of its 
+ *  block in a frame that carries the block, and the DSP applies it there.
+ *
+ *  The block a host time maps to comes from a model of the DSP clock that 
+ *  follows the block counter in the status frames.  Firmware that does not 
+ *  report a counter never syncs the model; updates are then sent as plain 
+ *  frames when the model, running at the nominal rate, reaches their block.
+ *****************************************************************************/
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+/**
+ * @brief      Updates the DSP clock model with a block count received in a 
+ *             status frame
+ *
+ * @param[in]  block   The block counter reported by the DSP
+ * @param[in]  now_us  When it was received (micros())
+ */
+void fx_pedal::update_dsp_clock(uint32_t block, uint32_t now_us) {
+
+  // Firmware without a block counter reports 0
+  if (block == 0) {
+    return;
+  }
+
+  // The counter is sampled somewhere inside the block it reports
+  float observed = (float) (int32_t) (block - dsp_clock.ref_block) + 0.5;
+  float predicted = dsp_clock.ref_frac + (float) (int32_t) (now_us - dsp_clock.ref_us) * dsp_clock.blocks_per_us;
+  float err = observed - predicted;
+  uint32_t dt_us = now_us - dsp_clock.ref_us;
+
+  // Start over on the first count and when the DSP has been reset or stalled
+  if (!dsp_clock.synced || dt_us == 0 || fabs(err) > DSP_CLOCK_MAX_ERROR_BLOCKS) {
+    if (dsp_clock.synced) {
+      DEBUG_MSG("DSP clock jumped, resynchronizing", MSG_DEBUG);
+    }
+    dsp_clock.synced = true;
+    dsp_clock.anchor_block = block;
+    dsp_clock.anchor_us = now_us;
+    dsp_clock.ref_block = block;
+    dsp_clock.ref_frac = 0.5;
+    dsp_clock.ref_us = now_us;
+    return;
+  }
+
+  // For the first second measure the rate directly from the first count so 
+  // the model locks quickly even if the nominal rate is well off
+  if (now_us - dsp_clock.anchor_us < DSP_CLOCK_ACQUIRE_MS * 1000) {
+    dsp_clock.blocks_per_us = (float) (int32_t) (block - dsp_clock.anchor_block) / (float) (now_us - dsp_clock.anchor_us);
+    dsp_clock.ref_block = block;
+    dsp_clock.ref_frac = 0.5;
+    dsp_clock.ref_us = now_us;
+    return;
+  }
+
+  dsp_clock.blocks_per_us += DSP_CLOCK_FREQ_GAIN * err / (float) dt_us;
+
+  float now = predicted + DSP_CLOCK_PHASE_GAIN * err;
+  float whole = floorf(now);
+  dsp_clock.ref_block += (int32_t) whole;
+  dsp_clock.ref_frac = now - whole;
+  dsp_clock.ref_us = now_us;
+}
+
+/**
+ * @brief      Estimates the DSP block being processed at a given time
+ *
+ * @param[in]  at_us  The time (micros()), may be in the future
+ *
+ * @return     The DSP block
+ */
+uint32_t fx_pedal::get_dsp_block(uint32_t at_us) {
+  float blocks = dsp_clock.ref_frac + (float) (int32_t) (at_us - dsp_clock.ref_us) * dsp_clock.blocks_per_us;
+  return dsp_clock.ref_block + (int32_t) floorf(blocks);
+}
+
+/**
+ * @brief      Estimates the DSP block and the sample within it being 
+ *             processed at a given time
+ *
+ * @param[in]  at_us   The time (micros()), may be in the future
+ * @param      sample  The sample within the block (output)
+ *
+ * @return     The DSP block
+ */
+uint32_t fx_pedal::get_dsp_block(uint32_t at_us, uint16_t * sample) {
+  float blocks = dsp_clock.ref_frac + (float) (int32_t) (at_us - dsp_clock.ref_us) * dsp_clock.blocks_per_us;
+  float whole = floorf(blocks);
+  *sample = (uint16_t) ((blocks - whole) * DSP_BLOCK_SAMPLES);
+  if (*sample >= DSP_BLOCK_SAMPLES) {
+    *sample = DSP_BLOCK_SAMPLES - 1;
+  }
+  return dsp_clock.ref_block + (int32_t) whole;
+}
+
+/**
+ * @brief      Holds a parameter update until its block is near, replacing 
+ *             any update of the same parameter for the same block
+ */
+void fx_pedal::schedule_param_update(EFFECT_TYPE instance_type, uint8_t instance_id, uint8_t param_type, uint8_t param_id, uint32_t raw) {
+
+  FX_SCHEDULED_PARAM * event = NULL;
+  for (int i=0;i<MAX_SCHEDULED_PARAMS;i++) {
+    FX_SCHEDULED_PARAM * e = &scheduled_params[i];
+    if (e->in_use && e->instance_id == instance_id && e->param_id == param_id && e->block == schedule_block) {
+      event = e;
+      break;
+    }
+    if (!e->in_use && event == NULL) {
+      event = e;
+    }
+  }
+
+  if (event == NULL) {
+    DEBUG_MSG("Too many scheduled parameter updates, sending now", MSG_WARN);
+    spi_transmit_param_frame(instance_type, instance_id, param_type, param_id, raw);
+    return;
+  }
+
+  event->in_use = true;
+  event->type = instance_type;
+  event->instance_id = instance_id;
+  event->param_type = param_type;
+  event->param_id = param_id;
+  event->value = raw;
+  event->block = schedule_block;
+}
+
+/**
+ * @brief      Sends the scheduled updates whose block is within the lead time
+ */
+void fx_pedal::service_scheduled_params(void) {
+
+  uint32_t now_block = get_dsp_block(micros());
+  int32_t lead_blocks = 0;
+  if (dsp_clock.synced) {
+    lead_blocks = (int32_t) (SCHEDULED_PARAM_LEAD_MS * 1000.0 * dsp_clock.blocks_per_us);
+  }
+
+  for (int i=0;i<MAX_SCHEDULED_PARAMS;i++) {
+    FX_SCHEDULED_PARAM * event = &scheduled_params[i];
+    if (!event->in_use || (int32_t) (event->block - now_block) > lead_blocks) {
+      continue;
+    }
+    if (dsp_clock.synced) {
+      spi_transmit_scheduled_param_frame(event);
+    } else {
+      spi_transmit_param_frame(event->type, event->instance_id, event->param_type, event->param_id, event->value);
+    }
+    event->in_use = false;
+  }
+}
+
+/**
+ * @brief      Drops all scheduled updates (used once the full parameter 
+ *             blocks have been sent to the DSP)
+ */
+void fx_pedal::clear_scheduled_params(void) {
+  for (int i=0;i<MAX_SCHEDULED_PARAMS;i++) {
+    scheduled_params[i].in_use = false;
+  }
+}
+
+#endif  // DOXYGEN_SHOULD_SKIP_THIS
+
+
+/**
+ * @brief      Returns the audio block the DSP is processing right now
+ *
+ * The DSP processes audio in blocks of 128 samples (375 per second).  Use 
+ * this with `schedule_params_at_block()` to make changes a fixed time ahead.
+ *
+ * @return     The current DSP block
+ */
+uint32_t fx_pedal::get_dsp_block(void) {
+  return get_dsp_block(micros());
+}
+
+/**
+ * @brief      Makes the following setter calls apply on the next tap tempo 
+ *             beat rather than when their frames reach the DSP
+ *
+ * ``` CPP
+ * if (pedal.new_tap_interval()) {
+ *   pedal.schedule_params_at_beat();
+ *   delay.set_length_ms(pedal.get_tap_interval_ms());
+ *   slicer.set_period_ms(pedal.get_tap_interval_ms());
+ *   pedal.end_scheduled_params();
+ * }
+ * ```
+ *
+ * @return     False if there is no tap tempo yet (setters apply right away)
+ */
+bool fx_pedal::schedule_params_at_beat(void) {
+
+  if (!tap_locked) {
+    return false;
+  }
+
+  // Next beat on the grid fitted to the taps
+  uint32_t now_ms = millis();
+  uint32_t next_beat_ms = get_tap_beat_ms(now_ms) + (uint32_t) (tap_interval_ms + 0.5);
+  float until_beat_ms = (float) (next_beat_ms - now_ms);
+
+  schedule_params_at_block(get_dsp_block(micros() + (uint32_t) (until_beat_ms * 1000.0)));
+  return true;
+}
+
+/**
+ * @brief      Makes the following setter calls apply at a specific DSP block
+ *
+ * @param[in]  block  The block (see `get_dsp_block()`)
+ */
+void fx_pedal::schedule_params_at_block(uint32_t block) {
+  schedule_active = true;
+  schedule_block = block;
+}
+
+/**
+ * @brief      Ends `schedule_params_at_beat()` / `schedule_params_at_block()`;
+ *             setter calls apply right away again
+ */
+void fx_pedal::end_scheduled_params(void) {
+  schedule_active = false;
+}
+
+
+/******************************************************************************
+ *  Control streams
+ *
+ *  A pot mapped to a parameter with a setter or the modulation matrix only 
+ *  reaches the DSP once per service tick, one single parameter frame per 
+ *  change, so a sweep lands in audible steps.  A control stream samples the 
+ *  pot every CONTROL_STREAM_SAMPLE_US instead and sends the points in 
+ *  compact frames that carry the DSP block and sample of their first point.
+ *  The DSP ramps between the points, and every point lands a fixed 
+ *  CONTROL_STREAM_DELAY_MS after it was sampled.  The destination is sent 
+ *  once in a bind frame, so each point costs a single word.
+ *
+ *  Firmware that does not report its block counter cannot place the points; 
+ *  the stream then writes the parameter through the update scheduler.
+ *****************************************************************************/
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+/**
+ * @brief      Returns the float parameter member behind an effect control 
+ *             input (NULL if it has none)
+ */
+float * fx_pedal::get_float_param(fx_control_node * node) {
+  fx_effect * effect = node->parent_effect;
+  for (int i=0;i<effect->param_table_len;i++) {
+    if (effect->param_table[i].param_id == node->param_id && effect->param_table[i].type == T_FLOAT) {
+      return (float *) ((uint8_t *) effect + effect->param_table[i].member_offset);
+    }
+  }
+  return NULL;
+}
+
+// Words of a float, high word first
+static void put_float_words(uint16_t * dest, float value) {
+  uint32_t raw;
+  memcpy(&raw, &value, sizeof(raw));
+  dest[0] = (uint16_t) (raw >> 16);
+  dest[1] = (uint16_t) (raw & 0xFFFF);
+}
+
+/**
+ * @brief      Tells the DSP which parameter the stream drives, or that the 
+ *             stream has stopped
+ *
+ * @param[in]  stop  True to stop the stream
+ */
+void fx_pedal::spi_transmit_control_stream_bind(bool stop) {
+
+  uint16_t bind[SPI_CONTROL_STREAM_BIND_WORDS];
+  memset(bind, 0, sizeof(bind));
+
+  bind[0] = HEADER_CONTROL_STREAM_BIND;
+  if (stop) {
+    bind[1] = UNDEFINED;
+  } else {
+    fx_effect * effect = control_stream.dest->parent_effect;
+    bind[1] = (uint16_t) effect->type;
+    bind[2] = (uint16_t) effect->instance_id;
+    bind[3] = control_stream.dest->param_id;
+    put_float_words(&bind[4], control_stream.min);
+    put_float_words(&bind[6], control_stream.min + control_stream.range);
+    bind[8] = (uint16_t) ((uint32_t) CONTROL_STREAM_SAMPLE_US * DSP_SAMPLE_RATE_HZ / 1000000);
+  }
+
+  spi_fifo_insert_block(bind, SPI_CONTROL_STREAM_BIND_WORDS);
+}
+
+/**
+ * @brief      Sends the points collected so far, or writes the parameter 
+ *             when the DSP clock is unknown
+ */
+void fx_pedal::send_control_stream_frame(void) {
+
+  FX_CONTROL_STREAM * cs = &control_stream;
+  int count = cs->total_points;
+  cs->total_points = 0;
+
+  // Nothing to send while the pot rests
+  if (cs->sent) {
+    uint16_t deadband = (uint16_t) (CONTROL_STREAM_DEADBAND * 65535.0);
+    bool moved = false;
+    for (int i=0;i<count;i++) {
+      if (abs((int) cs->points[i] - (int) cs->last_point) > deadband) {
+        moved = true;
+        break;
+      }
+    }
+    if (!moved) {
+      control_stream_stats.idle_frames++;
+      return;
+    }
+  }
+
+  // Effect isn't part of a running canvas yet
+  fx_effect * effect = cs->dest->parent_effect;
+  if (!valid_canvas || effect->instance_id == 0xFF) {
+    return;
+  }
+
+  // Keep the member in step with the DSP (read_param(), save_canvas())
+  cs->last_point = cs->points[count - 1];
+  cs->sent = true;
+  effect->stop_ramp(cs->param);
+  *cs->param = cs->min + cs->range * ((float) cs->last_point * (1.0 / 65535.0));
+
+  if (!dsp_clock.synced) {
+    effect->transmit_param(cs->param);
+    return;
+  }
+
+  if (!cs->bound) {
+    spi_transmit_control_stream_bind(false);
+    cs->bound = true;
+  }
+
+  uint16_t frame[SPI_CONTROL_STREAM_FRAME_WORDS(CONTROL_STREAM_FRAME_POINTS) - SPI_FRAME_OVERHEAD_WORDS];
+  uint16_t sample;
+  uint32_t block = get_dsp_block(cs->first_us + CONTROL_STREAM_DELAY_MS * 1000, &sample);
+
+  frame[0] = HEADER_CONTROL_STREAM;
+  frame[1] = (uint16_t) (block >> 16);
+  frame[2] = (uint16_t) (block & 0xFFFF);
+  frame[3] = sample;
+  frame[4] = (uint16_t) count;
+  for (int i=0;i<count;i++) {
+    frame[5 + i] = cs->points[i];
+  }
+  spi_fifo_insert_block(frame, 5 + count);
+
+  cs->pending = true;
+  cs->pending_us = cs->first_us;
+  control_stream_stats.frames++;
+  control_stream_stats.points += count;
+  control_stream_stats.words += SPI_CONTROL_STREAM_FRAME_WORDS(count);
+}
+
+/**
+ * @brief      Samples the streamed pot onto the point grid and sends each 
+ *             frame as it fills; called from the pot task after the pots 
+ *             are read
+ */
+void fx_pedal::service_control_stream(void) {
+
+  FX_CONTROL_STREAM * cs = &control_stream;
+  if (cs->pot == NULL) {
+    return;
+  }
+
+  uint32_t now = micros();
+  float x = cs->pot->val;
+
+  // Start the grid at the first reading and again after a long gap
+  if (!cs->started || now - cs->last_us > CONTROL_STREAM_MAX_GAP_MS * 1000) {
+    cs->started = true;
+    cs->last_val = x;
+    cs->last_us = now;
+    cs->next_us = now;
+    cs->total_points = 0;
+  }
+
+  // Points fall between readings, so interpolate to the grid
+  while ((int32_t) (now - cs->next_us) >= 0) {
+    float v = x;
+    if (now != cs->last_us) {
+      v = cs->last_val + (x - cs->last_val) * (float) (cs->next_us - cs->last_us) / (float) (now - cs->last_us);
+    }
+    if (v < 0.0) {
+      v = 0.0;
+    } else if (v > 1.0) {
+      v = 1.0;
+    }
+    if (cs->total_points == 0) {
+      cs->first_us = cs->next_us;
+    }
+    cs->points[cs->total_points++] = (uint16_t) (v * 65535.0 + 0.5);
+    cs->next_us += CONTROL_STREAM_SAMPLE_US;
+    if (cs->total_points == CONTROL_STREAM_FRAME_POINTS) {
+      send_control_stream_frame();
+    }
+  }
+  cs->last_val = x;
+  cs->last_us = now;
+
+  // Send the frame now rather than on the next link tick (the SPI driver 
+  // holds off for 10 ms after each flush, so this is retried each run)
+  if (cs->pending) {
+    spi_service();
+    if (spi_fifo_empty()) {
+      cs->pending = false;
+      uint32_t delay_us = micros() - cs->pending_us;
+      if (delay_us > control_stream_stats.max_send_delay_us) {
+        control_stream_stats.max_send_delay_us = delay_us;
+      }
+      if (delay_us > CONTROL_STREAM_DELAY_MS * 1000) {
+        control_stream_stats.late_frames++;
+      }
+    }
+  }
+}
+
+#endif  // DOXYGEN_SHOULD_SKIP_THIS
+
+
+/**
+ * @brief      Streams a pot (typically `exp_pedal`) to a float parameter of 
+ *             an effect at the pot sampling rate
+ *
+ * Setting a parameter from a pot in `loop()` sends at most one value per 
+ * service tick, which makes wah or volume sweeps sound stepped.  A stream 
+ * sends the pot every 2 ms and the DSP ramps between the values, each one 
+ * applied a fixed 25 ms after the pot was read.  Frames are only sent while
+ * the pot moves.  Only one stream runs at a time; calling this again 
+ * replaces it.
+ *
+ * ``` CPP
+ * void setup() {
+ *   pedal.init();
+ *   ...
+ *   pedal.run();
+ *   pedal.stream_control(&pedal.exp_pedal, wah_filter.freq, 300.0, 2500.0);
+ * }
+ * ```
+ *
+ * Don't also set the parameter from the sketch, a ramp or the modulation 
+ * matrix while it is streamed.
+ *
+ * @param      pot   The pot
+ * @param      dest  The float control input of an effect
+ * @param[in]  min   Parameter value with the pot at 0.0
+ * @param[in]  max   Parameter value with the pot at 1.0
+ *
+ * @return     False if the destination is not a float effect parameter or 
+ *             is driven by a control route
+ */
+bool fx_pedal::stream_control(fx_pot * pot, fx_control_node * dest, float min, float max) {
+
+  fx_effect * effect = dest->parent_effect;
+  if (effect == NULL || dest->node_direction != NODE_IN || dest->node_type != NODE_FLOAT) {
+    DEBUG_MSG("Stream destination must be a float control input of an effect", MSG_ERROR);
+    return false;
+  }
+  if (dest->connected) {
+    DEBUG_MSG("Stream destination is driven by a control route", MSG_ERROR);
+    return false;
+  }
+
+  float * param = get_float_param(dest);
+  if (param == NULL) {
+    DEBUG_MSG("Stream destination has no float parameter", MSG_ERROR);
+    return false;
+  }
+
+  control_stream.pot = pot;
+  control_stream.dest = dest;
+  control_stream.param = param;
+  control_stream.min = min;
+  control_stream.range = max - min;
+  control_stream.bound = false;
+  control_stream.started = false;
+  control_stream.sent = false;
+  control_stream.pending = false;
+  return true;
+}
+
+/**
+ * @brief      Stops the control stream; the parameter keeps its last value
+ */
+void fx_pedal::stop_control_stream(void) {
+  if (control_stream.pot == NULL) {
+    return;
+  }
+  if (control_stream.bound) {
+    spi_transmit_control_stream_bind(true);
+  }
+  control_stream.pot = NULL;
+}
+
+/**
+ * @brief      Returns the control stream metrics
+ *
+ * A moving pot costs 2.8 words per point on the SPI link (`words` / 
+ * `points`), where a single parameter update costs 11.
+ *
+ * @param      stats  The metrics (output)
+ */
+void fx_pedal::get_control_stream_stats(FX_CONTROL_STREAM_STATS * stats) {
+  *stats = control_stream_stats;
+}
+
+/**
+ * @brief      Clears the control stream metrics
+ */
+void fx_pedal::reset_control_stream_stats(void) {
+  control_stream_stats.frames = 0;
+  control_stream_stats.points = 0;
+  control_stream_stats.words = 0;
+  control_stream_stats.idle_frames = 0;
+  control_stream_stats.late_frames = 0;
+  control_stream_stats.max_send_delay_us = 0;
+}
+
+
+/******************************************************************************
+ *  MIDI input
+ *
+ *  Bytes from the MIDI port (or passed to midi_receive()) go through the 
+ *  parser in dm_fx_midi.cpp as they arrive.  Control changes and notes set 
+ *  the values of their routes, keeping only the latest value of each, and 
+ *  the MIDI task sends every value that changed in one frame as soon as the 
+ *  SPI link can flush it, so a burst of messages costs one frame.  The 
+ *  effect members are updated too.  MIDI clock drives the tap tempo, so everything 
+ *  that follows the tap tempo follows the clock.
+ *
+ *  Firmware that does not report its block counter predates value frames; 
+ *  effect parameters are then sent through the parameter update scheduler 
+ *  and the canvas note nodes keep following the pitch tracker.
+ *****************************************************************************/
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+static inline bool midi_channel_matches(uint8_t route_channel, uint8_t channel) {
+  return route_channel == MIDI_CHANNEL_ANY || route_channel == channel;
+}
+
+/**
+ * @brief      Adds a route after checking its destination
+ *
+ * @return     False if the destination is not a float effect parameter or a 
+ *             canvas control node, or there are too many routes
+ */
+bool fx_pedal::add_midi_route(uint8_t type, uint8_t channel, uint8_t number, fx_control_node * dest, float min, float max) {
+
+  if (channel > 16) {
+    DEBUG_MSG("MIDI channels are 1 - 16 (or MIDI_CHANNEL_ANY)", MSG_ERROR);
+    return false;
+  }
+
+  float * param = NULL;
+  if (dest->parent_canvas != this) {
+    if (dest->parent_effect == NULL || dest->node_direction != NODE_IN || dest->node_type != NODE_FLOAT) {
+      DEBUG_MSG("MIDI destination must be a float control input of an effect or a canvas control node", MSG_ERROR);
+      display_error_status(ERROR_CODE_ILLEGAL_ROUTING);
+      return false;
+    }
+    if (dest->connected) {
+      DEBUG_MSG("MIDI destination is driven by a control route", MSG_ERROR);
+      display_error_status(ERROR_CODE_ILLEGAL_ROUTING);
+      return false;
+    }
+    param = get_float_param(dest);
+    if (param == NULL) {
+      DEBUG_MSG("MIDI destination has no float parameter", MSG_ERROR);
+      display_error_status(ERROR_CODE_ILLEGAL_ROUTING);
+      return false;
+    }
+  }
+
+  if (total_midi_routes >= MAX_MIDI_ROUTES) {
+    DEBUG_MSG("Too many MIDI routes - define MAX_MIDI_ROUTES to allow more", MSG_ERROR);
+    display_error_status(ERROR_CODE_ILLEGAL_ROUTING);
+    return false;
+  }
+
+  FX_MIDI_ROUTE * route = &midi_routes[total_midi_routes++];
+  route->type = type;
+  route->channel = channel;
+  route->number = number;
+  route->dest = dest;
+  route->param = param;
+  route->min = min;
+  route->range = max - min;
+  route->pending = false;
+  return true;
+}
+
+/**
+ * @brief      Holds a new value of a route for the next frame
+ */
+void fx_pedal::set_midi_route_value(FX_MIDI_ROUTE * route, float value, uint32_t now_us) {
+  if (route->pending) {
+    midi_stats.coalesced++;
+  }
+  route->pending = true;
+  route->value = value;
+  if (!midi_values_pending) {
+    midi_values_pending = true;
+    midi_pending_since_us = now_us;
+  }
+}
+
+/**
+ * @brief      Holds a new value of a canvas note node for the next frame
+ *
+ * @param[in]  param_id  FX_CANVAS_PARAM_ID_NOTE_FREQ, _NOTE_DURATION or 
+ *                       _NOTE_NEW_NOTE
+ */
+void fx_pedal::set_midi_note_value(uint8_t param_id, float value, uint32_t now_us) {
+  uint8_t bit = 1 << (param_id - 1);
+  if (midi_note_pending & bit) {
+    midi_stats.coalesced++;
+  }
+  midi_note_pending |= bit;
+  midi_note_values[param_id - 1] = value;
+  if (!midi_values_pending) {
+    midi_values_pending = true;
+    midi_pending_since_us = now_us;
+  }
+}
+
+/**
+ * @brief      Acts on a decoded MIDI message
+ *
+ * @param      msg     The message
+ * @param[in]  now_us  When it was received (micros())
+ */
+void fx_pedal::handle_midi_message(const FX_MIDI_MSG * msg, uint32_t now_us) {
+
+  if (msg->status == MIDI_CLOCK) {
+    if (midi_clock.enabled) {
+      midi_clock_tick(now_us);
+    }
+    return;
+  }
+  if (msg->status == MIDI_START) {
+    // The next clock is the first beat
+    midi_clock.count = 0;
+    return;
+  }
+  if (msg->status >= 0xF0) {
+    return;
+  }
+
+  uint8_t type = msg->status & 0xF0;
+  uint8_t channel = (msg->status & 0x0F) + 1;
+
+  if (type == MIDI_CONTROL_CHANGE) {
+    for (int i=0;i<total_midi_routes;i++) {
+      FX_MIDI_ROUTE * route = &midi_routes[i];
+      if (route->type == MIDI_CONTROL_CHANGE && route->number == msg->data1 && midi_channel_matches(route->channel, channel)) {
+        set_midi_route_value(route, route->min + route->range * ((float) msg->data2 * (1.0 / 127.0)), now_us);
+      }
+    }
+    return;
+  }
+
+  if (type == MIDI_NOTE_ON) {
+    float hz = midi_note_to_hz(msg->data1);
+    for (int i=0;i<total_midi_routes;i++) {
+      FX_MIDI_ROUTE * route = &midi_routes[i];
+      if (route->type == MIDI_NOTE_ON && midi_channel_matches(route->channel, channel)) {
+        set_midi_route_value(route, hz, now_us);
+      }
+    }
+    if (midi_note_channel != UNDEFINED && midi_channel_matches(midi_note_channel, channel)) {
+      midi_note = msg->data1;
+      midi_note_on_us = now_us;
+      set_midi_note_value(FX_CANVAS_PARAM_ID_NOTE_FREQ, hz, now_us);
+      set_midi_note_value(FX_CANVAS_PARAM_ID_NOTE_DURATION, 0.0, now_us);
+      set_midi_note_value(FX_CANVAS_PARAM_ID_NOTE_NEW_NOTE, 1.0, now_us);
+    }
+    return;
+  }
+
+  // Only the release of the latest note ends it
+  if (type == MIDI_NOTE_OFF && midi_note_channel != UNDEFINED && midi_channel_matches(midi_note_channel, channel) && 
+      msg->data1 == midi_note) {
+    midi_note = UNDEFINED;
+    set_midi_note_value(FX_CANVAS_PARAM_ID_NOTE_DURATION, (float) (now_us - midi_note_on_us) * 0.001, now_us);
+    set_midi_note_value(FX_CANVAS_PARAM_ID_NOTE_NEW_NOTE, 0.0, now_us);
+  }
+}
+
+/**
+ * @brief      Fits the tempo and beat phase to the latest MIDI clocks
+ *
+ * @param[in]  now_us  When the clock was received (micros())
+ */
+void fx_pedal::midi_clock_tick(uint32_t now_us) {
+
+  FX_MIDI_CLOCK * c = &midi_clock;
+  if (c->total_ticks > 0 && now_us - c->last_us > MIDI_CLOCK_TIMEOUT_MS * 1000) {
+    c->total_ticks = 0;
+    c->next_tick = 0;
+    c->count = 0;
+  }
+  c->last_us = now_us;
+  c->ticks_us[c->next_tick] = now_us;
+  if (++c->next_tick >= MIDI_CLOCK_HISTORY) {
+    c->next_tick = 0;
+  }
+  if (c->total_ticks < MIDI_CLOCK_HISTORY) {
+    c->total_ticks++;
+  }
+  uint32_t since_beat = c->count++ % MIDI_CLOCKS_PER_BEAT;
+
+  if (c->total_ticks < MIDI_CLOCKS_PER_BEAT / 2) {
+    return;
+  }
+
+  // Least squares line through the clock times, oldest first; reading the 
+  // port from a task adds up to a task period of jitter to each clock
+  int n = c->total_ticks;
+  int first = (c->next_tick + MIDI_CLOCK_HISTORY - n) % MIDI_CLOCK_HISTORY;
+  uint32_t t0 = c->ticks_us[first];
+  float sx = 0, sy = 0, sxx = 0, sxy = 0;
+  for (int i=0;i<n;i++) {
+    float y = (float) (c->ticks_us[(first + i) % MIDI_CLOCK_HISTORY] - t0);
+    sx += i;
+    sy += y;
+    sxx += (float) i * i;
+    sxy += i * y;
+  }
+  float b = (n * sxy - sx * sy) / (n * sxx - sx * sx);
+  float a = (sy - b * sx) / n;
+  if (b <= 0) {
+    return;
+  }
+
+  // Anchor the beat grid at the fitted time of the latest beat
+  float beat_us = a + b * (float) ((n - 1) - (int) since_beat);
+  float ago_ms = ((float) (now_us - t0) - beat_us) * 0.001;
+  tap_interval_ms = b * MIDI_CLOCKS_PER_BEAT * 0.001;
+  tap_beat_ms = millis() - (int32_t) lroundf(ago_ms);
+  tap_confidence = 1.0;
+  tap_locked = true;
+  midi_stats.clock_bpm = 60000.0 / tap_interval_ms;
+
+  if (c->reported_ms == 0.0 || fabs(tap_interval_ms - c->reported_ms) > MIDI_CLOCK_TEMPO_CHANGE * c->reported_ms) {
+    c->reported_ms = tap_interval_ms;
+    tap_new_val = true;
+  }
+}
+
+/**
+ * @brief      Updates the effect members of the routes with new values and 
+ *             sends all new values to the DSP in one frame
+ */
+void fx_pedal::send_midi_values(void) {
+
+  uint16_t frame[2 + (MAX_MIDI_ROUTES + 3) * SPI_CONTROL_VALUE_WORDS];
+  uint16_t count = 0;
+  bool value_frames = dsp_clock.synced;
+
+  for (int i=0;i<total_midi_routes;i++) {
+    FX_MIDI_ROUTE * route = &midi_routes[i];
+    if (!route->pending) {
+      continue;
+    }
+    route->pending = false;
+
+    uint16_t key = route->dest->param_id;
+    if (route->param != NULL) {
+      fx_effect * effect = route->dest->parent_effect;
+      effect->stop_ramp(route->param);
+      *route->param = route->value;
+      if (!value_frames) {
+        effect->transmit_param(route->param);
+        continue;
+      }
+      if (effect->instance_id == 0xFF) {
+        continue;
+      }
+      key |= (uint16_t) effect->instance_id << 8;
+    } else if (!value_frames) {
+      continue;
+    }
+
+    uint16_t * v = &frame[2 + count++ * SPI_CONTROL_VALUE_WORDS];
+    v[0] = key;
+    put_float_words(&v[1], route->value);
+  }
+
+  for (int id=FX_CANVAS_PARAM_ID_NOTE_FREQ;id<=FX_CANVAS_PARAM_ID_NOTE_NEW_NOTE;id++) {
+    if (value_frames && (midi_note_pending & (1 << (id - 1)))) {
+      uint16_t * v = &frame[2 + count++ * SPI_CONTROL_VALUE_WORDS];
+      v[0] = id;
+      put_float_words(&v[1], midi_note_values[id - 1]);
+    }
+  }
+  midi_note_pending = 0;
+  midi_values_pending = false;
+
+  if (count == 0 || !valid_canvas) {
+    return;
+  }
+
+  frame[0] = HEADER_CONTROL_VALUES;
+  frame[1] = count;
+  spi_fifo_insert_block(frame, 2 + count * SPI_CONTROL_VALUE_WORDS);
+  spi_service();
+
+  midi_stats.frames++;
+  midi_stats.values += count;
+  midi_frame_pending = true;
+  midi_frame_since_us = midi_pending_since_us;
+}
+
+/**
+ * @brief      Reads the MIDI port and sends new values once the last frame 
+ *             has gone out
+ */
+void fx_pedal::service_midi(void) {
+
+  if (midi_port != NULL) {
+    for (int i=0;i<MIDI_MAX_BYTES_PER_RUN && midi_port->available() > 0;i++) {
+      midi_receive((uint8_t) midi_port->read());
+    }
+  }
+
+  if (midi_clock.total_ticks > 0 && micros() - midi_clock.last_us > MIDI_CLOCK_TIMEOUT_MS * 1000) {
+    midi_clock.total_ticks = 0;
+    midi_clock.next_tick = 0;
+    midi_clock.count = 0;
+    midi_stats.clock_bpm = 0.0;
+  }
+
+  // A frame waiting in the FIFO goes with the next flush (possibly the 
+  // link task's)
+  if (midi_frame_pending) {
+    spi_service();
+    if (!spi_fifo_empty()) {
+      return;
+    }
+    midi_frame_pending = false;
+    uint32_t latency_us = micros() - midi_frame_since_us;
+    midi_latency_total_us += latency_us;
+    midi_latency_frames++;
+    if (latency_us > midi_stats.latency_max_us) {
+      midi_stats.latency_max_us = latency_us;
+    }
+  }
+
+  // Values keep coalescing until the link can take the frame right away
+  if (midi_values_pending && spi_transmit_ready()) {
+    send_midi_values();
+  }
+}
+
+#endif  // DOXYGEN_SHOULD_SKIP_THIS
+
+
+/**
+ * @brief      Reads MIDI from a serial port
+ *
+ * The port is read by `service()` every millisecond.  Open it first (MIDI 
+ * DIN ports run at 31250 baud).  For other sources, such as a USB MIDI 
+ * library, pass the bytes to `midi_receive()` instead.
+ *
+ * ``` CPP
+ * void setup() {
+ *   pedal.init();
+ *   ...
+ *   pedal.run();
+ *
+ *   midi_uart.begin(31250);          // A serial port wired to a MIDI input
+ *   pedal.set_midi_input(&midi_uart);
+ *   pedal.route_midi_cc(1, 11, wah_filter.freq, 300.0, 2500.0);  // Expression (CC 11) on channel 1
+ *   pedal.route_midi_notes(MIDI_CHANNEL_ANY);                     // Notes drive pedal.note_frequency, ...
+ *   pedal.use_midi_clock(true);                                   // Tap tempo follows the MIDI clock
+ * }
+ * ```
+ *
+ * @param      port  The port (NULL to stop reading)
+ */
+void fx_pedal::set_midi_input(Stream * port) {
+  midi_port = port;
+  midi_parser_init(&midi_parser);
+}
+
+/**
+ * @brief      Passes a received MIDI byte to the MIDI input
+ *
+ * @param[in]  b     The byte
+ */
+void fx_pedal::midi_receive(uint8_t b) {
+  midi_stats.bytes++;
+  FX_MIDI_MSG msg;
+  if (midi_parse_byte(&midi_parser, b, &msg)) {
+    midi_stats.messages++;
+    handle_midi_message(&msg, micros());
+  }
+}
+
+/**
+ * @brief      Routes a MIDI control change to a float parameter of an effect
+ *             or a canvas control node
+ *
+ * Controller values 0 to 127 are scaled to `min` to `max`.
+ *
+ * @param[in]  channel  The MIDI channel (1 - 16, or MIDI_CHANNEL_ANY)
+ * @param[in]  cc       The controller number (e.g. 1 for the mod wheel, 11 
+ *                      for expression)
+ * @param      dest     The control node
+ * @param[in]  min      Value with the controller at 0
+ * @param[in]  max      Value with the controller at 127
+ *
+ * @return     False if the destination can't be set from MIDI or there are 
+ *             already MAX_MIDI_ROUTES routes
+ */
+bool fx_pedal::route_midi_cc(uint8_t channel, uint8_t cc, fx_control_node * dest, float min, float max) {
+  return add_midi_route(MIDI_CONTROL_CHANGE, channel, cc, dest, min, max);
+}
+
+/**
+ * @brief      Makes MIDI notes drive the canvas note nodes (`note_frequency`,
+ *             `note_duration`, `new_note`) in place of the DSP's pitch tracker
  *
- * @return     True if successful, false if not
+ * A note on sets `note_frequency` to the note's frequency and `new_note` to 
+ * 1.0; releasing the latest note sets `note_duration` to how long it was held
+ * in milliseconds and `new_note` back to 0.0.
+ *
+ * @param[in]  channel  The MIDI channel (1 - 16, or MIDI_CHANNEL_ANY)
+ *
+ * @return     False if the channel is not valid
  */
-bool fx_pedal::run(void) {
+bool fx_pedal::route_midi_notes(uint8_t channel) {
+  if (channel > 16) {
+    DEBUG_MSG("MIDI channels are 1 - 16 (or MIDI_CHANNEL_ANY)", MSG_ERROR);
+    return false;
+  }
+  midi_note_channel = channel;
+  return true;
+}
 
-  
-  bool ready = true;
+/**
+ * @brief      Routes the frequency of MIDI notes (in Hz) to a float parameter 
+ *             of an effect, such as the frequency of an oscillator
+ *
+ * @param[in]  channel  The MIDI channel (1 - 16, or MIDI_CHANNEL_ANY)
+ * @param      dest     The control node
+ *
+ * @return     False if the destination can't be set from MIDI or there are 
+ *             already MAX_MIDI_ROUTES routes
+ */
+bool fx_pedal::route_midi_notes(uint8_t channel, fx_control_node * dest) {
+  return add_midi_route(MIDI_NOTE_ON, channel, 0, dest, 0.0, 0.0);
+}
 
-  // Check to see if our routing is valid
+/**
+ * @brief      Makes the tap tempo follow MIDI clock
+ *
+ * While clock arrives, `get_tap_interval_ms()`, `get_tap_phase()`, the tap 
+ * LED and `schedule_params_at_beat()` follow it, with the first clock after 
+ * a MIDI start on the beat.  `new_tap_interval()` returns true when the 
+ * tempo changes.
+ *
+ * @param[in]  enable  True to follow MIDI clock
+ */
+void fx_pedal::use_midi_clock(bool enable) {
+  midi_clock.enabled = enable;
+  midi_clock.total_ticks = 0;
+  midi_clock.next_tick = 0;
+  midi_clock.count = 0;
+}
+
+/**
+ * @brief      Returns the MIDI input metrics
+ *
+ * @param      stats  The metrics (output)
+ */
+void fx_pedal::get_midi_stats(FX_MIDI_STATS * stats) {
+  *stats = midi_stats;
+  stats->stray_bytes = midi_parser.stray_bytes;
+  stats->latency_mean_us = midi_latency_frames ? midi_latency_total_us / midi_latency_frames : 0.0;
+}
+
+/**
+ * @brief      Clears the MIDI input metrics
+ */
+void fx_pedal::reset_midi_stats(void) {
+  midi_stats.bytes = 0;
+  midi_stats.messages = 0;
+  midi_stats.stray_bytes = 0;
+  midi_stats.frames = 0;
+  midi_stats.values = 0;
+  midi_stats.coalesced = 0;
+  midi_stats.latency_max_us = 0;
+  midi_stats.latency_mean_us = 0.0;
+  midi_stats.clock_bpm = 0.0;
+  midi_parser.stray_bytes = 0;
+  midi_latency_total_us = 0.0;
+  midi_latency_frames = 0;
+}
+
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+/**
+ * @brief      Verifies the audio and control routing of the canvas before it is 
+ *             sent to the DSP
+ */
+void fx_pedal::check_canvas_routing(void) {
   if (total_audio_routes == 0) {
     DEBUG_MSG("No routes defined", MSG_ERROR);
     display_error_status(ERROR_CODE_ILLEGAL_ROUTING);
@@ -1070,49 +3305,131 @@ bool fx_pedal::run(void) {
     DEBUG_MSG("Errors in the control routing.  Fix errors in your route_control() calls.", MSG_ERROR);
     display_error_status(ERROR_CODE_ILLEGAL_ROUTING);
   }  
+}
 
-  if (ready) {
-    display_data_from_sharc();
+/**
+ * @brief      Checks that every route_audio() / route_control() call found room 
+ *             in the instance and routing stacks
+ *
+ * @return     True if the whole canvas is in the stacks, false if not
+ */
+bool fx_pedal::check_canvas_capacity(void) {
+  if (canvas_over_capacity) {
+    DEBUG_MSG("Canvas is larger than this build supports - define DM_FX_LARGE_CANVAS to allow more", MSG_ERROR);
+    return false;
+  }
+  return true;
+}
 
-    // Send routing stack to DSP
-    spi_transmit_audio_routing_stack();
-    display_data_from_sharc();
+/**
+ * @brief      Checks that the DSP firmware has a shadow canvas slot.  Older 
+ *             firmware ignores HEADER_CANVAS_SLOT, so a preload would land in 
+ *             the running canvas.
+ *
+ * @return     True if the firmware supports preloading, false if not
+ */
+bool fx_pedal::check_canvas_slots(void) {
+  if (!dsp_status.cap_canvas_slots) {
+    DEBUG_MSG("DSP firmware does not support preloading canvases - update the firmware or use run()", MSG_ERROR);
+    return false;
+  }
+  return true;
+}
 
-    spi_transmit_control_routing_stack();
-    display_data_from_sharc();
+/**
+ * @brief      Points the DSP back at the active canvas once a shadow canvas has 
+ *             been sent and waits for the DSP to report it is ready to swap
+ *
+ * @return     True if the shadow canvas is ready, false if not
+ */
+bool fx_pedal::finish_preload(void) {
 
-    // Send instance stack to DSP
-    spi_transmit_instance_stack();
-    display_data_from_sharc();
+  spi_transmit_canvas_slot(CANVAS_SLOT_ACTIVE);
+
+  shadow_canvas_loaded = wait_for_shadow_canvas(true);
+  shadow_params_stale = false;
+  if (!shadow_canvas_loaded) {
+    report_canvas_errors();
+  }
+  return shadow_canvas_loaded;
+}
 
-    // Send parameters to DSP
-    spi_transmit_all_params();
+/**
+ * @brief      Sets the initial bypass state of a canvas that has been sent to the 
+ *             DSP and waits for it to start running
+ *
+ * @return     True if the canvas is running, false if not
+ */
+bool fx_pedal::start_canvas(void) {
+
+  // If we've added bypass controls, start effect bypassed
+  if (bypass_control_enabled) {
+    pedal.bypassed = true;
+    bypass_fx();
+  } else {
+    pedal.bypassed = false;
+    enable_fx();
+  }
+
+  // Wait for DSP to send message that canvas is running
+  wait_for_canvas_to_start();
+  uint32_t now = millis();
+  while (millis() < now + 50) {
     display_data_from_sharc();
+  }
 
-    // If we've added bypass controls, start effect bypassed
-    if (bypass_control_enabled) {
-      pedal.bypassed = true;
-      bypass_fx();
-    } else {
-      pedal.bypassed = false;
-      enable_fx();
-    }
+  if (dsp_status.state_canvas_running) {
+    DEBUG_MSG("Canvas is running", MSG_INFO);
+    valid_canvas = true;
+  } else {
+    report_canvas_errors();
+    valid_canvas = false;
+  } 
 
-    // Wait for DSP to send message that canvas is running
-    wait_for_canvas_to_start();
-    int now = millis();
-    while (millis() < now + 50) {
-      display_data_from_sharc();
-    }
+  return valid_canvas;
+}
+
+#endif  // DOXYGEN_SHOULD_SKIP_THIS
+
+
+/**
+ * @brief      Runs the current canvas (i.e. compiles and downloads to the DSP)
+ *
+ * Nothing is sent if a `route_audio()` or `route_control()` call failed 
+ * because the canvas had too many effects or routes for this build.
+ *
+ * @return     True if successful, false if not
+ */
+bool fx_pedal::run(void) {
 
+  
+  bool ready = true;
 
+  // Part of the canvas is missing if a stack filled up, so send none of it
+  if (!check_canvas_capacity()) {
+    return false;
+  }
 
-    if (dsp_status.state_canvas_running) {
-      DEBUG_MSG("Canvas is running", MSG_INFO);
-    } else {
-      report_canvas_errors();
-      ready = false;
-    } 
+  // Check to see if our routing is valid
+  check_canvas_routing();
+
+  if (ready) {
+    display_data_from_sharc();
+
+    // Send routing and instance stacks to DSP, then the parameters (this 
+    // includes any queued updates)
+    if (!spi_transmit_canvas_topology() || !spi_transmit_all_params()) {
+      return false;
+    }
+    commit_instance_ids();
+    control_stream.bound = false;
+    display_data_from_sharc();
+
+    char buf[64];
+    sprintf(buf, "Scratch arena high water: %u of %u words", scratch_high_water(), SCRATCH_ARENA_WORDS);
+    DEBUG_MSG(buf, MSG_DEBUG);
+
+    ready = start_canvas();
   }
 
   // Display error code on LEDs
@@ -1125,6 +3442,133 @@ bool fx_pedal::run(void) {
 }
 
 
+/**
+ * @brief      Clears the canvas so a new one can be built with `route_audio()` and 
+ *             `route_control()` and then preloaded with `preload()`
+ *
+ * The canvas currently running on the DSP is not affected.
+ */
+void fx_pedal::new_canvas(void) {
+  reset_canvas_stacks();
+}
+
+
+/**
+ * @brief      Sends the current canvas to the shadow slot on the DSP while the 
+ *             active canvas keeps running
+ *
+ * This works like `run()` except the audio is never interrupted.  Once the 
+ * preload is complete, call `swap_canvas()` to switch to the new canvas.
+ *
+ * ``` CPP
+ * pedal.new_canvas();
+ * pedal.route_audio(pedal.instr_in, my_delay.input);
+ * pedal.route_audio(my_delay.output, pedal.amp_out);
+ * if (pedal.preload()) {
+ *   pedal.swap_canvas(32);
+ * }
+ * ```
+ *
+ * Effect parameters can be changed at any point: until the swap they apply 
+ * to the running canvas, and `swap_canvas()` brings the preloaded canvas up 
+ * to date with anything changed after the preload.
+ *
+ * Preloading needs DSP firmware with a shadow canvas slot; with older firmware 
+ * this returns false without sending anything.
+ *
+ * @return     True if the shadow canvas is ready to be swapped in, false if not
+ */
+bool fx_pedal::preload(void) {
+
+  if (!check_canvas_slots() || !check_canvas_capacity()) {
+    return false;
+  }
+
+  // Check to see if our routing is valid
+  check_canvas_routing();
+
+  display_data_from_sharc();
+
+  // Send routing, instance stacks and parameters to the shadow slot
+  spi_transmit_canvas_slot(CANVAS_SLOT_SHADOW);
+  if (!spi_transmit_canvas_topology() || !spi_transmit_all_params()) {
+    spi_transmit_canvas_slot(CANVAS_SLOT_ACTIVE);
+    return false;
+  }
+  display_data_from_sharc();
+
+  return finish_preload();
+}
+
+
+/**
+ * @brief      Makes the preloaded shadow canvas active using the default crossfade
+ *
+ * @return     True if the new canvas is running, false if not
+ */
+bool fx_pedal::swap_canvas(void) {
+  return swap_canvas(CANVAS_SWAP_CROSSFADE_BLOCKS);
+}
+
+
+/**
+ * @brief      Makes the preloaded shadow canvas active
+ *
+ * The DSP crossfades from the output of the old canvas to the output of the 
+ * new canvas over `crossfade_blocks` audio blocks.  Zero switches immediately.
+ *
+ * @param[in]  crossfade_blocks  Length of the crossfade in audio blocks
+ *
+ * @return     True if the new canvas is running, false if not
+ */
+bool fx_pedal::swap_canvas(uint16_t crossfade_blocks) {
+
+  if (!check_canvas_slots()) {
+    return false;
+  }
+
+  if (!shadow_canvas_loaded) {
+    DEBUG_MSG("No canvas has been preloaded - call preload() first", MSG_WARN);
+    return false;
+  }
+
+  // Parameters written since the preload went to the old canvas, so bring 
+  // the shadow canvas up to date first (a canvas loaded from an image has no 
+  // effect objects to read them from)
+  if (shadow_params_stale && instance_stack[total_instances - 1].address != NULL) {
+    spi_transmit_canvas_slot(CANVAS_SLOT_SHADOW);
+    bool sent = spi_transmit_all_params();
+    spi_transmit_canvas_slot(CANVAS_SLOT_ACTIVE);
+    if (!sent) {
+      return false;
+    }
+  }
+
+  spi_transmit_swap(crossfade_blocks);
+  shadow_canvas_loaded = false;
+  commit_instance_ids();
+
+  // DSP clears the shadow flag once the old canvas has been released
+  if (!wait_for_shadow_canvas(false) || !dsp_status.state_canvas_running) {
+    report_canvas_errors();
+    valid_canvas = false;
+    return false;
+  }
+
+  // Bypass state carries over, so resend it for the new canvas
+  if (bypassed) {
+    bypass_fx();
+  } else {
+    enable_fx();
+  }
+
+  DEBUG_MSG("Canvas swapped", MSG_INFO);
+  valid_canvas = true;
+  control_stream.bound = false;
+  return true;
+}
+
+
 
 
 /******************************************************************************
@@ -1136,116 +3580,431 @@ bool fx_pedal::run(void) {
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 
-void fx_pedal::register_tap(void) {
+// Median of a short array (sorts it)
+static float tap_median(float * v, int n) {
+  for (int i=1;i<n;i++) {
+    float x = v[i];
+    int j = i - 1;
+    while (j >= 0 && v[j] > x) {
+      v[j + 1] = v[j];
+      j--;
+    }
+    v[j + 1] = x;
+  }
+  return (n & 1) ? v[n / 2] : 0.5 * (v[n / 2 - 1] + v[n / 2]);
+}
+
+/**
+ * @brief      Fits a beat grid to tap times: tap i should fall at 
+ *             taps[0] + a + b * i
+ * 
+ * A robust first guess (repeated median slope and median offset) finds the 
+ * taps that are far off the grid; the others are then fitted by least 
+ * squares.  The repeated median is used rather than the median interval as 
+ * one sloppy tap spoils two intervals but only one of the slopes.  With at 
+ * least TAP_TREND_MIN_TAPS taps a clear, steady change of period is fitted 
+ * as well, and the grid returned then continues from the last tap at the 
+ * period the taps have reached.
+ *
+ * @param[in]  taps   The tap times (ms)
+ * @param[in]  n      The number of taps
+ * @param      a      The offset (output)
+ * @param      b      The period (output)
+ * @param      rms    The RMS distance of the fitted taps from the grid (output)
+ * @param      limit  Distance from the grid beyond which taps were left out (output)
+ *
+ * @return     The number of taps fitted (the grid is only valid for 3 or more)
+ */
+static int tap_fit(const uint32_t * taps, int n, float * a, float * b, float * rms, float * limit) {
+
+  float t[TAP_HISTORY_LEN], tmp[TAP_HISTORY_LEN];
+  for (int i=0;i<n;i++) {
+    t[i] = (float) (taps[i] - taps[0]);
+  }
+
+  // Robust grid: for each tap the median slope to the other taps, the median
+  // of those, then the median offset of the taps from it
+  float slopes[TAP_HISTORY_LEN];
+  for (int i=0;i<n;i++) {
+    int k = 0;
+    for (int j=0;j<n;j++) {
+      if (j != i) {
+        tmp[k++] = (t[j] - t[i]) / (float) (j - i);
+      }
+    }
+    slopes[i] = tap_median(tmp, k);
+  }
+  float rb = tap_median(slopes, n);
+  for (int i=0;i<n;i++) {
+    tmp[i] = t[i] - rb * i;
+  }
+  float ra = tap_median(tmp, n);
+
+  // Taps further from the robust grid than 3 sigma (from the median absolute
+  // deviation) are outliers
+  for (int i=0;i<n;i++) {
+    tmp[i] = fabs(t[i] - (ra + rb * i));
+  }
+  *limit = 3.0 * 1.4826 * tap_median(tmp, n);
+  if (*limit < TAP_OUTLIER_MIN_MS) {
+    *limit = TAP_OUTLIER_MIN_MS;
+  }
+
+  // Too few taps to tell which one is sloppy, so fit them all
+  if (n < TAP_OUTLIER_MIN_TAPS) {
+    *limit = INFINITY;
+  }
+
+  // Least squares over the inliers
+  float sx = 0, sy = 0, sxx = 0, sxy = 0;
+  int used = 0;
+  for (int i=0;i<n;i++) {
+    if (fabs(t[i] - (ra + rb * i)) > *limit) {
+      continue;
+    }
+    sx += i;
+    sy += t[i];
+    sxx += (float) i * i;
+    sxy += i * t[i];
+    used++;
+  }
+  if (used < 3) {
+    return used;
+  }
+  float det = used * sxx - sx * sx;
+  *b = (used * sxy - sx * sy) / det;
+  *a = (sy - *b * sx) / used;
+
+  float sq = 0;
+  for (int i=0;i<n;i++) {
+    if (fabs(t[i] - (ra + rb * i)) <= *limit) {
+      float r = t[i] - (*a + *b * i);
+      sq += r * r;
+    }
+  }
+  *rms = sqrtf(sq / used);
+
+  // A tempo that keeps changing bends the taps away from a straight grid.  
+  // Fit a steady change of period too (a term orthogonal to the line, so the 
+  // line stays as it is), and when it is more than 4 standard errors from 
+  // zero continue the grid from the last tap at the period reached there.
+  if (used < TAP_TREND_MIN_TAPS) {
+    return used;
+  }
+  float mu = sx / used;
+  float su2 = 0, su3 = 0;
+  for (int i=0;i<n;i++) {
+    if (fabs(t[i] - (ra + rb * i)) <= *limit) {
+      float u = i - mu;
+      su2 += u * u;
+      su3 += u * u * u;
+    }
+  }
+  float m2 = su2 / used;
+  float k = su3 / su2;
+  float sqt = 0, sqq = 0;
+  for (int i=0;i<n;i++) {
+    if (fabs(t[i] - (ra + rb * i)) <= *limit) {
+      float u = i - mu;
+      float q = u * u - m2 - k * u;
+      sqt += q * t[i];
+      sqq += q * q;
+    }
+  }
+  float c = sqt / sqq;
+  float sq_trend = sq - c * c * sqq;
+  if (sq_trend <= 0 || c * c * sqq * (used - 3) <= 16.0 * sq_trend) {
+    return used;
+  }
+
+  float u_last = (n - 1) - mu;
+  float q_last = u_last * u_last - m2 - k * u_last;
+  float q_next = (u_last + 1) * (u_last + 1) - m2 - k * (u_last + 1);
+  float last = *a + *b * (n - 1) + c * q_last;
+  *b += c * (q_next - q_last);
+  *a = last - *b * (n - 1);
+  *rms = sqrtf(sq_trend / used);
+  return used;
+}
+
+// True if all the taps fit one grid (with a steady change of period) closely
+static bool tap_trend_fits(const uint32_t * taps, int n, float drift) {
+  float a, b, rms, limit;
+  return tap_fit(taps, n, &a, &b, &rms, &limit) == n && rms < 0.3 * drift;
+}
+
+/**
+ * @brief      Adds a tap and refits the beat grid
+ *
+ * @param[in]  tap_ms  When the footswitch was pressed (millis())
+ */
+void fx_pedal::register_tap(uint32_t tap_ms) {
+
+  uint32_t interval = tap_ms - tap_last_tap;
+  tap_last_tap = tap_ms;
+  tap_count++;
+
+  // A pause starts a new sequence.  So do two intervals in a row that are 
+  // both clearly longer, or both clearly shorter, than the tempo; the taps 
+  // that started the new tempo are kept.  A single odd interval is only a 
+  // sloppy tap, which the fit leaves out.
+  bool restart = (tap_indx == 0 || interval > TAP_TIMEOUT_MS);
+  if (!restart && tap_indx >= 3) {
+    float change = (float) interval - tap_interval_ms;
+    float prev_change = (float) (tap_history[tap_indx - 1] - tap_history[tap_indx - 2]) - tap_interval_ms;
+    if (fabs(change) > TAP_TEMPO_CHANGE * tap_interval_ms &&
+        fabs(prev_change) > TAP_TEMPO_CHANGE * tap_interval_ms &&
+        (change > 0) == (prev_change > 0)) {
+      tap_history[0] = tap_history[tap_indx - 2];
+      tap_history[1] = tap_history[tap_indx - 1];
+      tap_indx = 2;
+      tap_locked = false;
+      tap_new_val = false;
+      tap_restarts++;
+    }
+  }
+  if (restart) {
+    tap_history[0] = tap_ms;
+    tap_indx = 1;
+    tap_locked = false;
+    tap_new_val = false;
+    tap_led_flash_cntr = tap_ms;
+    return;
+  }
+
+  if (tap_indx >= TAP_HISTORY_LEN) {
+    for (int i=1;i<TAP_HISTORY_LEN;i++) {
+      tap_history[i - 1] = tap_history[i];
+    }
+    tap_indx = TAP_HISTORY_LEN - 1;
+  }
+  tap_history[tap_indx++] = tap_ms;
+
+  if (tap_indx == 2) {
+    // One interval: a tempo to fit the next taps against, but not locked
+    tap_interval_ms = (float) interval;
+    tap_beat_ms = tap_ms;
+    tap_led_flash_cntr = tap_ms;
+    return;
+  }
+
+  // A gradual tempo change moves each new tap further off the grid of the 
+  // earlier taps, where a sloppy tap is off on its own: when the grid is 
+  // well determined and the last three taps are off it on the same side, 
+  // each further than the one before and the last two well off, fit only 
+  // the taps of the new tempo.  A tempo that changes steadily is left to the 
+  // trend in the fit, which needs the longer history.
+  if (tap_indx >= TAP_DRIFT_MIN_TAPS + 2) {
+    float a, b, rms, limit;
+    int n = tap_indx - 2;
+    if (tap_fit(tap_history, n, &a, &b, &rms, &limit) >= TAP_DRIFT_MIN_TAPS) {
+      float drift = TAP_TEMPO_DRIFT * b;
+      float rm1 = (float) (tap_history[n - 1] - tap_history[0]) - (a + b * (n - 1));
+      float r0 = (float) (tap_history[n] - tap_history[0]) - (a + b * n);
+      float r1 = (float) (tap_history[n + 1] - tap_history[0]) - (a + b * (n + 1));
+      if (fabs(r0) > drift && fabs(r1 - r0) > 0.5 * drift &&
+          fabs(r1) > fabs(r0) && fabs(r0) > fabs(rm1) &&
+          (r0 > 0) == (r1 > 0) && (rm1 > 0) == (r0 > 0) &&
+          !tap_trend_fits(tap_history, tap_indx, drift)) {
+        for (int i=0;i<3;i++) {
+          tap_history[i] = tap_history[tap_indx - 3 + i];
+        }
+        tap_indx = 3;
+        tap_restarts++;
+      }
+    }
+  }
+
+  if (fit_tap_tempo()) {
+    tap_locked = true;
+    tap_new_val = true;
+  }
+  tap_led_flash_cntr = get_tap_beat_ms(millis());
+}
+
+/**
+ * @brief      Fits the beat grid to the tap history and updates the tempo, 
+ *             the beat anchor and the confidence
+ * 
+ * The confidence combines the share of taps that fit, how tightly they fit 
+ * and how many there are.
+ *
+ * @return     False if too few taps agree to fit a tempo
+ */
+bool fx_pedal::fit_tap_tempo(void) {
+
+  int n = tap_indx;
+  float a, b, rms, limit;
+  int used = tap_fit(tap_history, n, &a, &b, &rms, &limit);
+  if (used < 3) {
+    return false;
+  }
+
+  float fit = 1.0 - rms / (0.1 * b);
+  if (fit < 0) {
+    fit = 0;
+  }
+  float count = (used - 1) / 4.0;
+  if (count > 1.0) {
+    count = 1.0;
+  }
+  tap_confidence = fit * count * ((float) used / (float) n);
+
+  // Anchor the grid at the fitted time of the latest tap
+  tap_interval_ms = b;
+  tap_beat_ms = tap_history[0] + (int32_t) lroundf(a + b * (n - 1));
+  return true;
+}
+
+/**
+ * @brief      Returns the latest beat of the tap tempo grid at or before a time
+ *
+ * @param[in]  now_ms  The time (millis())
+ *
+ * @return     The time of the beat
+ */
+uint32_t fx_pedal::get_tap_beat_ms(uint32_t now_ms) {
+  if (tap_interval_ms <= 0) {
+    return now_ms;
+  }
+  double since = (double) (int32_t) (now_ms - tap_beat_ms);
+  double beats = floor(since / tap_interval_ms);
+  return tap_beat_ms + (int32_t) floor(beats * tap_interval_ms + 0.5);
+}
+
+/**
+ * @brief      Catches footswitch edges the interrupts missed
+ * 
+ * An interrupt can read a bouncing switch in the wrong state, so a switch 
+ * that reads differently from its decoder on two scans in a row gets the 
+ * edge it missed, timed from the first of those scans.
+ */
+void fx_pedal::button_press_check(void) {
+
+  for (int i=0;i<2;i++) {
+    bool down = !digitalRead(i ? PIN_FOOTSW_LEFT : PIN_FOOTSW_RIGHT);
+    if (down == gesture_decoder[i].down) {
+      footswitch_stale[i] = false;
+    } else if (!footswitch_stale[i]) {
+      footswitch_stale[i] = true;
+      footswitch_stale_us[i] = micros();
+    } else {
+      footswitch_stale[i] = false;
+      handle_footswitch_edge(i ? FOOTSWITCH_LEFT : FOOTSWITCH_RIGHT, down, footswitch_stale_us[i]);
+    }
+  }
+}
 
-  uint32_t interval = millis() - tap_last_tap;
-  tap_last_tap = millis();
-  tap_led_flash_cntr = millis();
+/**
+ * @brief      Handles the footswitch edges queued by the interrupt handlers 
+ *             and the gestures that are due
+ */
+void  fx_pedal::service_button_events(void) {
 
-  #if 0
-    Serial.print("Debug: interval:");
-    Serial.println(interval);
-  #endif 
+  FX_INPUT_EVENT ev;
+  while (input_event_pop(&ev)) {
+    bool counted = ev.pressed && !gesture_decoder[ev.footswitch == FOOTSWITCH_LEFT].down;
 
-  if (tap_indx == 0 || interval > 2000) {
-    
-    tap_indx = 1;      
-    tap_locked = false;
-    tap_new_val = false;
+    handle_footswitch_edge((FOOTSWITCH) ev.footswitch, ev.pressed, ev.time_us);
 
-    for (int i=0;i<15;i++) {
-      tap_history[i] = 0;
+    if (counted) {
+      uint32_t latency_us = micros() - ev.time_us;
+      input_events_handled++;
+      input_latency_total_us += latency_us;
+      if (latency_us > input_latency_max_us) {
+        input_latency_max_us = latency_us;
+      }
     }
+  }
 
-    return;
-  } else if (tap_indx < 2) {
-    tap_history[tap_indx++] = interval;
-    tap_locked = false;
-  } else {
-    tap_history[tap_indx++] = interval;
-    if (tap_indx >= 16) {
-      tap_indx = 15;
-    }
-    float sum = 0.0;
-    for (int i=1; i<tap_indx; i++) {
-      sum += (float) tap_history[i];
-    }
-    sum *= 1.0/((float) (tap_indx-1));
-    tap_locked = true;
-    tap_interval_ms = sum;
-    tap_new_val = true;
-    #if 0
-      Serial.print("Debug: tap ms:");
-      Serial.println(tap_interval_ms);
-    #endif 
+  // Long presses, holds and taps that waited for a double tap
+  FX_GESTURE_EVENT events[GESTURE_MAX_EVENTS];
+  uint32_t now = micros();
+  for (int i=0;i<2;i++) {
+    int count = gesture_poll(&gesture_decoder[i], now, events);
+    dispatch_gestures(i ? FOOTSWITCH_LEFT : FOOTSWITCH_RIGHT, events, count);
   }
 }
 
-void fx_pedal::button_press_check(void) {
-  static int time_since_last_press = 0;
-  if (millis() < time_since_last_press + 75) {
+/**
+ * @brief      Acts on a footswitch press or release: bypass, tap tempo, the
+ *             `button_pressed()` / `button_released()` events and gestures
+ *
+ * @param[in]  footswitch  The footswitch (FOOTSWITCH_RIGHT, FOOTSWITCH_LEFT)
+ * @param[in]  pressed     True for a press
+ * @param[in]  time_us     When it happened (micros())
+ */
+void fx_pedal::handle_footswitch_edge(FOOTSWITCH footswitch, bool pressed, uint32_t time_us) {
+
+  int indx = (footswitch == FOOTSWITCH_LEFT) ? 1 : 0;
+  if (pressed == gesture_decoder[indx].down) {
     return;
   }
-  time_since_last_press = millis();
 
-  bool left = !digitalRead(PIN_FOOTSW_LEFT);
-  bool right = !digitalRead(PIN_FOOTSW_RIGHT);
+  // Gestures that were due before this edge go first
+  FX_GESTURE_EVENT events[GESTURE_MAX_EVENTS];
+  int count = gesture_edge(&gesture_decoder[indx], pressed, time_us, events);
+  dispatch_gestures(footswitch, events, count);
 
-  if (left && left != footswitch_left_last_state) {
-    footswitch_left_pressed = true;  
-  } else if (!left && left != footswitch_left_last_state) {
-    footswitch_left_released = true;  
+  if (!pressed) {
+    if (footswitch == FOOTSWITCH_RIGHT) {
+      footswitch_right_released = true;
+    } else {
+      footswitch_left_released = true;
+    }
+    return;
   }
 
-  if (right && right != footswitch_right_last_state) {
-    footswitch_right_pressed = true;  
-  } else if (!right && right != footswitch_right_last_state) {
-    footswitch_right_released = true; 
+  if (footswitch == FOOTSWITCH_RIGHT) {
+    DEBUG_MSG("Right pressed", MSG_DEBUG);
+    footswitch_right_pressed = true;
+  } else {
+    DEBUG_MSG("Left pressed", MSG_DEBUG);
+    footswitch_left_pressed = true;
   }
 
-  footswitch_left_last_state = left;
-  footswitch_right_last_state = right;
-}
-
-void  fx_pedal::service_button_events(void) {
-
-  if (footswitch_right_pressed_event) {
-    footswitch_right_pressed_event = false;
+  // Taps are timed from the interrupt, not from when they are handled
+  if (tap_control_enabled && tap_footswitch == footswitch) {
+    DEBUG_MSG("Tap registered", MSG_DEBUG);
+    register_tap(millis() - (micros() - time_us) / 1000);
+  }
 
-    if (bypass_control_enabled && bypass_footswitch == FOOTSWITCH_RIGHT) {
+  if (bypass_control_enabled && bypass_footswitch == footswitch) {
 
-        DEBUG_MSG("Toggle bypass", MSG_DEBUG);
+    DEBUG_MSG("Toggle bypass", MSG_DEBUG);
 
-        if (bypassed) {
-          led_right.turn_on();
-          enable_fx();
-        } else {
-          led_right.turn_off();
-          bypass_fx();
-        }
-        bypassed = !bypassed;
-      }
+    fx_led * led = (footswitch == FOOTSWITCH_RIGHT) ? &led_right : &led_left;
+    if (bypassed) {
+      led->turn_on();
+      enable_fx();
+    } else {
+      led->turn_off();
+      bypass_fx();
+    }
+    bypassed = !bypassed;
   }
+}
 
-  if (footswitch_left_pressed_event) {
-    footswitch_left_pressed_event = false;
-    if (bypass_control_enabled && bypass_footswitch == FOOTSWITCH_LEFT) {
+/**
+ * @brief      Calls the handlers of decoded gestures
+ */
+void fx_pedal::dispatch_gestures(FOOTSWITCH footswitch, const FX_GESTURE_EVENT * events, int count) {
 
-      DEBUG_MSG("Toggle bypass", MSG_DEBUG);
+  int indx = (footswitch == FOOTSWITCH_LEFT) ? 1 : 0;
+  for (int i=0;i<count;i++) {
+    void (*handler)(void) = gesture_handlers[indx][events[i].gesture];
+    if (handler == NULL) {
+      continue;
+    }
 
-      if (bypassed) {
-        //Serial.println("Turning on left LED");
-        led_left.turn_on();
-        //turn_on_left_footsw_led();
-        enable_fx();
-      } else {
-        //Serial.println("Turning off left LED");
-        led_left.turn_off();
-        //turn_off_left_footsw_led();
-        bypass_fx();
-      }
-      bypassed = !bypassed;
+    uint32_t latency_us = micros() - events[i].time_us;
+    gesture_events++;
+    gesture_latency_total_us += latency_us;
+    if (latency_us > gesture_latency_max_us) {
+      gesture_latency_max_us = latency_us;
     }
+
+    handler();
   }
 }
 
@@ -1295,6 +4054,44 @@ float fx_pedal::get_tap_freq_hz(void) {
 }
 
 
+/**
+ * @brief      Returns where in the current beat of the tap tempo we are
+ * 
+ * The beats are fitted to the taps, so effects changed on phase 0 (see also
+ * `schedule_params_at_beat()`) stay in time with what was tapped.
+ * 
+ * ``` CPP
+ * if (pedal.get_tap_phase() < 0.5) {
+ *   pedal.led_center.turn_on(RED);    // first half of each beat
+ * } else {
+ *   pedal.led_center.turn_off();
+ * }
+ * ```
+ *
+ * @return     The phase (0.0 on the beat up to 1.0 just before the next one),
+ *             or 0.0 if there is no tap tempo yet
+ */
+float fx_pedal::get_tap_phase(void) {
+  if (!tap_locked || tap_interval_ms <= 0) {
+    return 0.0;
+  }
+  uint32_t now_ms = millis();
+  float phase = (float) (now_ms - get_tap_beat_ms(now_ms)) / tap_interval_ms;
+  return (phase < 1.0) ? phase : 0.0;
+}
+
+/**
+ * @brief      Returns how well the taps agree on a tempo
+ * 
+ * Sloppy taps are left out of the tempo, but they (and uneven tapping in 
+ * general) lower the confidence.  A few steady taps give close to 1.0.
+ *
+ * @return     The confidence (0.0 to 1.0), 0.0 if there is no tap tempo yet
+ */
+float fx_pedal::get_tap_confidence(void) {
+  return tap_locked ? tap_confidence : 0.0;
+}
+
 /**
  * @brief      Sets the LED blink rate for tap interval
  * 
@@ -1311,6 +4108,8 @@ void fx_pedal::set_tap_blink_rate_hz(float rate_hz) {
   }
   tap_interval_ms = (1000.0/rate_hz);
   tap_locked = true;
+  tap_confidence = 1.0;
+  tap_beat_ms = millis();
   tap_control_enabled = true;
 }
 
@@ -1331,6 +4130,8 @@ void fx_pedal::set_tap_blink_rate_hz(float rate_hz, FOOTSWITCH led) {
   }
   tap_interval_ms = (1000.0/rate_hz);
   tap_locked = true;
+  tap_confidence = 1.0;
+  tap_beat_ms = millis();
   tap_blink_only_enabled = true;
   tap_footswitch = led;
 
@@ -1353,6 +4154,8 @@ void fx_pedal::set_tap_blink_rate_ms(float ms) {
   }
   tap_interval_ms = ms;
   tap_locked = true;
+  tap_confidence = 1.0;
+  tap_beat_ms = millis();
   tap_control_enabled = true;
 }
 
@@ -1373,6 +4176,8 @@ void fx_pedal::set_tap_blink_rate_ms(float ms, FOOTSWITCH led) {
   }
   tap_interval_ms = ms;
   tap_locked = true;
+  tap_confidence = 1.0;
+  tap_beat_ms = millis();
   tap_blink_only_enabled = true;
   tap_footswitch = led;
 }    
@@ -1450,6 +4255,62 @@ bool fx_pedal::button_released(FOOTSWITCH footswitch, bool enable_led) {
   return result;
 }
 
+/**
+ * @brief      Calls a function when a footswitch is tapped, double tapped or
+ *             held down
+ * 
+ * A tap is passed on as soon as it cannot become another gesture with a 
+ * handler on that footswitch: with only a tap handler, right when the 
+ * footswitch is pressed; with a long press or hold handler, when it is 
+ * released; and with a double tap handler, once the time for a second tap 
+ * has passed.  So only add the handlers a footswitch needs.
+ * 
+ * Handlers are called from `service()`.  Gestures are decoded alongside the 
+ * bypass and tap tempo footswitches, which still act on every press.
+ * 
+ * ``` CPP
+ * void next_preset() { ... }
+ * void previous_preset() { ... }
+ * 
+ * void setup() {
+ *   pedal.init();
+ *   pedal.add_gesture_handler(FOOTSWITCH_LEFT, GESTURE_TAP, next_preset);
+ *   pedal.add_gesture_handler(FOOTSWITCH_LEFT, GESTURE_DOUBLE_TAP, previous_preset);
+ *   ...
+ * ```
+ *
+ * @param[in]  footswitch  The footswitch (FOOTSWITCH_LEFT, FOOTSWITCH_RIGHT)
+ * @param[in]  gesture     The gesture (GESTURE_TAP, GESTURE_DOUBLE_TAP, 
+ *                         GESTURE_LONG_PRESS, GESTURE_HOLD)
+ * @param[in]  handler     The function to call, or NULL to remove the handler
+ *
+ * @return     False if the footswitch or gesture is not valid
+ */
+bool fx_pedal::add_gesture_handler(FOOTSWITCH footswitch, FOOTSWITCH_GESTURE gesture, void (*handler)(void)) {
+
+  if (footswitch != FOOTSWITCH_LEFT && footswitch != FOOTSWITCH_RIGHT) {
+    DEBUG_MSG("Gestures need FOOTSWITCH_LEFT or FOOTSWITCH_RIGHT", MSG_ERROR);
+    return false;
+  }
+  if (gesture >= GESTURE_TOTAL) {
+    DEBUG_MSG("Invalid gesture", MSG_ERROR);
+    return false;
+  }
+
+  int indx = (footswitch == FOOTSWITCH_LEFT) ? 1 : 0;
+  gesture_handlers[indx][gesture] = handler;
+
+  // The decoder only waits to tell apart gestures that have handlers
+  uint8_t enabled = 0;
+  for (int i=0;i<GESTURE_TOTAL;i++) {
+    if (gesture_handlers[indx][i] != NULL) {
+      enabled |= (1 << i);
+    }
+  }
+  gesture_decoder[indx].enabled = enabled;
+  return true;
+}
+
 
 
 
@@ -1468,7 +4329,7 @@ void fx_pedal::print_processor_load(int seconds) {
   if (seconds < 1) {
     seconds = 1;
   }
-  static int now = 0;
+  static uint32_t now = 0;
   if (millis() > now + seconds*1000) {
     Serial.print("Processor load: ");
     Serial.print(dsp_status.loading_percentage);
@@ -1503,7 +4364,7 @@ void fx_pedal::print_instance_stack() {
       Serial.print(instance_stack[i].type);
       Serial.println(")");
       
-      sprintf(buf,"  Address: %#04x", (int) instance_stack[i].address); Serial.println(buf);
+      sprintf(buf,"  Address: %p", instance_stack[i].address); Serial.println(buf);
 
     } else {
       Serial.println("Undefined instance found");
@@ -1517,8 +4378,6 @@ void fx_pedal::print_instance_stack() {
  */
 void fx_pedal::print_routing_table() {
   
-  char buf[64];
-
   Serial.println();
   Serial.println("Audio routing table:");
 
@@ -1738,8 +4597,186 @@ void fx_pedal::print_param_tables() {
   }
 }
 
+
+/**
+ * @brief      Fills in a report of how much memory the pedal and the current 
+ *             canvas use
+ *
+ * The same sketch gives the same object sizes on any build with 32-bit 
+ * pointers.  Heap and stack figures depend on where the sketch is running.
+ *
+ * @param      report  The report (output)
+ */
+void fx_pedal::get_memory_report(FX_MEMORY_REPORT * report) {
+
+  FX_INSTANCE_MEMORY mem;
+
+  report->pedal_bytes = sizeof(fx_pedal);
+  report->canvas_stack_bytes = sizeof(instance_stack) + sizeof(audio_routing_stack) + sizeof(control_routing_stack);
+  report->spi_buffer_bytes = spi_buffer_bytes();
+  report->scratch_bytes = SCRATCH_ARENA_WORDS * sizeof(uint16_t);
+  report->scratch_peak_bytes = scratch_high_water() * sizeof(uint16_t);
+  report->heap_used_bytes = debug_heap_used();
+  report->stack_free_bytes = debug_stack_free();
+
+  report->effect_bytes = 0;
+  report->dsp_buffer_bytes = 0;
+  for (int i=1;i<total_instances;i++) {
+    if (get_instance_memory(i, &mem)) {
+      report->effect_bytes += mem.object_bytes;
+      report->dsp_buffer_bytes += mem.dsp_buffer_bytes;
+    }
+  }
+}
+
+
+/**
+ * @brief      Fills in how much memory one effect instance in the canvas uses
+ *
+ * @param[in]  instance  The position of the effect in the instance stack 
+ *                       (1 is the first effect, 0 is the canvas)
+ * @param      mem       The memory usage (output)
+ *
+ * @return     True if the instance exists, false if not
+ */
+bool fx_pedal::get_instance_memory(uint8_t instance, FX_INSTANCE_MEMORY * mem) {
+
+  if (instance == 0 || instance >= total_instances) {
+    return false;
+  }
+
+  mem->id = instance_stack[instance].id;
+  mem->type = instance_stack[instance].type;
+  mem->object_bytes = get_effect_size(instance_stack[instance].type);
+  mem->node_bytes = 0;
+  mem->param_table_bytes = 0;
+  mem->dsp_buffer_bytes = 0;
+
+  // Canvases loaded from an image have no effect objects
+  fx_effect * effect = (fx_effect *) instance_stack[instance].address;
+  if (effect != NULL) {
+    mem->node_bytes = effect->total_audio_nodes * sizeof(fx_audio_node) + 
+                      effect->total_control_nodes * sizeof(fx_control_node) +
+                      sizeof(effect->audio_node_stack) + sizeof(effect->control_node_stack);
+    mem->param_table_bytes = effect->param_table_len * sizeof(FX_PARAM_DESC);
+    mem->dsp_buffer_bytes = get_dsp_buffer_estimate(effect);
+  }
+  return true;
+}
+
+
+/**
+ * @brief      Utility function to print the memory report to the console
+ */
+void fx_pedal::print_memory_report(void) {
+
+  // Room for the longest effect name and four 10 digit numbers
+  char buf[160];
+  FX_MEMORY_REPORT report;
+  FX_INSTANCE_MEMORY mem;
+
+  get_memory_report(&report);
+
+  Serial.println();
+  Serial.println("Memory report:");
+  snprintf(buf, sizeof(buf), " Canvas profile: %s (%d effects, %d routes, %lu bytes less than large)", DM_FX_CANVAS_PROFILE, 
+          MAX_INSTANCES, MAX_ROUTES, 
+          (unsigned long) (FX_PEDAL_STACK_BYTES(MAX_INSTANCES_LARGE, MAX_ROUTES_LARGE) - report.canvas_stack_bytes)); 
+  Serial.println(buf);
+  snprintf(buf, sizeof(buf), " Pedal object: %lu bytes (stacks %lu)", (unsigned long) report.pedal_bytes, (unsigned long) report.canvas_stack_bytes); Serial.println(buf);
+  snprintf(buf, sizeof(buf), " SPI buffers: %lu bytes", (unsigned long) report.spi_buffer_bytes); Serial.println(buf);
+  snprintf(buf, sizeof(buf), " Scratch arena: %lu bytes (peak %lu)", (unsigned long) report.scratch_bytes, (unsigned long) report.scratch_peak_bytes); Serial.println(buf);
+  snprintf(buf, sizeof(buf), " Heap used: %lu bytes", (unsigned long) report.heap_used_bytes); Serial.println(buf);
+  snprintf(buf, sizeof(buf), " Stack free: %lu bytes", (unsigned long) report.stack_free_bytes); Serial.println(buf);
+
+  for (int i=1;i<total_instances;i++) {
+    if (get_instance_memory(i, &mem)) {
+      snprintf(buf, sizeof(buf), " ID %#04x %s: %lu bytes (nodes %lu), table %lu bytes, DSP %lu bytes", 
+              (int) mem.id, get_effect_type(mem.type), (unsigned long) mem.object_bytes, 
+              (unsigned long) mem.node_bytes, (unsigned long) mem.param_table_bytes, 
+              (unsigned long) mem.dsp_buffer_bytes); 
+      Serial.println(buf);
+    }
+  }
+  snprintf(buf, sizeof(buf), " Effects total: %lu bytes, DSP total: %lu bytes", (unsigned long) report.effect_bytes, (unsigned long) report.dsp_buffer_bytes); Serial.println(buf);
+  Serial.println();
+}
+
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 
+/**
+ * @brief      Gets the size of the effect object of a given type
+ *
+ * @param[in]  t     The effect type
+ *
+ * @return     Size in bytes (0 if the type is unknown)
+ */
+uint32_t fx_pedal::get_effect_size(EFFECT_TYPE t) {
+  if (t == FX_ADSR_ENVELOPE) return sizeof(fx_adsr_envelope);
+  else if (t == FX_ALLPASS_FILTER) return sizeof(fx_allpass_filter);
+  else if (t == FX_AMPLITUDE_MODULATOR) return sizeof(fx_amplitude_mod);
+  else if (t == FX_ARPEGGIATOR) return sizeof(fx_arpeggiator);
+  else if (t == FX_BIQUAD_FILTER) return sizeof(fx_biquad_filter);
+  else if (t == FX_DESTRUCTOR) return sizeof(fx_destructor);
+  else if (t == FX_COMPRESSOR) return sizeof(fx_compressor);
+  else if (t == FX_DELAY) return sizeof(fx_delay);
+  else if (t == FX_DELAY_MULTITAP) return sizeof(fx_multitap_delay);
+  else if (t == FX_ENVELOPE_TRACKER) return sizeof(fx_envelope_tracker);
+  else if (t == FX_GAIN) return sizeof(fx_gain);
+  else if (t == FX_HARMONIZER) return sizeof(fx_harmonizer);
+  else if (t == FX_IMPULSE_RESPONSE) return sizeof(fx_impulse_response);
+  else if (t == FX_INSTRUMENT_SYNTH) return sizeof(fx_instrument_synth);
+  else if (t == FX_LOOPER) return sizeof(fx_looper);
+  else if (t == FX_MIXER_2) return sizeof(fx_mixer_2);
+  else if (t == FX_MIXER_3) return sizeof(fx_mixer_3);
+  else if (t == FX_MIXER_4) return sizeof(fx_mixer_4);
+  else if (t == FX_OSCILLATOR) return sizeof(fx_oscillator);
+  else if (t == FX_PHASE_SHIFTER) return sizeof(fx_phase_shifter);
+  else if (t == FX_PITCH_SHIFT) return sizeof(fx_pitch_shift);
+  else if (t == FX_RING_MOD) return sizeof(fx_ring_mod);
+  else if (t == FX_SLICER) return sizeof(fx_slicer);
+  else if (t == FX_SPECTRALIZER) return sizeof(fx_pitch_shift_fd);
+  else if (t == FX_VARIABLE_DELAY) return sizeof(fx_variable_delay);
+  else return 0;
+}
+
+/**
+ * @brief      Estimates how much memory an effect allocates on the DSP for its
+ *             delay / loop buffers from its parameters
+ *
+ * @param      effect  The effect
+ *
+ * @return     Estimated size in bytes (0 for effects without sample buffers)
+ */
+uint32_t fx_pedal::get_dsp_buffer_estimate(fx_effect * effect) {
+
+  float len_ms = 0.0;
+  float val;
+
+  if (effect->type == FX_DELAY) {
+    effect->get_param_float(FX_DELAY_PARAM_OFFSET_DELAY_LEN_MAX, &len_ms);
+  } else if (effect->type == FX_VARIABLE_DELAY) {
+    effect->get_param_float(FX_VAR_DELAY_OFFSET_DELAY_LEN_MS, &len_ms);
+  } else if (effect->type == FX_LOOPER) {
+    if (effect->get_param_float(FX_LOOPER_PARAM_OFFSET_LOOP_SIZE_S, &val)) {
+      len_ms = val * 1000.0;
+    }
+  } else if (effect->type == FX_DELAY_MULTITAP) {
+    const uint8_t taps[4] = {FX_MULTITAP_DELAY_OFFSET_TAP_1_MS, FX_MULTITAP_DELAY_OFFSET_TAP_2_MS,
+                             FX_MULTITAP_DELAY_OFFSET_TAP_3_MS, FX_MULTITAP_DELAY_OFFSET_TAP_4_MS};
+    for (int i=0;i<4;i++) {
+      if (effect->get_param_float(taps[i], &val) && val > len_ms) {
+        len_ms = val;
+      }
+    }
+  }
+
+  if (len_ms <= 0.0) {
+    return 0;
+  }
+  return (uint32_t) (len_ms * (DSP_SAMPLE_RATE_HZ / 1000.0)) * DSP_BYTES_PER_SAMPLE;
+}
+
 /**
  * @brief      Gets the effect type string
  *
@@ -1747,7 +4784,7 @@ void fx_pedal::print_param_tables() {
  *
  * @return     string value.
  */
-char * fx_pedal::get_effect_type(EFFECT_TYPE t) {
+const char * fx_pedal::get_effect_type(EFFECT_TYPE t) {
   if (t == FX_NONE) return "none";
   else if (t == FX_ADSR_ENVELOPE) return "adsr envelope";
   else if (t == FX_ALLPASS_FILTER) return "allpass filter";
@@ -1846,36 +4883,116 @@ bool fx_effect::get_control_node_index(fx_control_node * node, uint8_t * local_n
 }
 
 
+/**
+ * @brief      Returns the compact id of this node (see NODE_ID())
+ *
+ * @return     The node id or NODE_ID_INVALID if the node is not in the node 
+ *             stack of its parent
+ */
+uint16_t fx_audio_node::get_node_id(void) {
+
+  if (parent_effect != NULL) {
+    for (int i=0;i<parent_effect->total_audio_nodes;i++) {
+      if (parent_effect->audio_node_stack[i] == this) {
+        return NODE_ID(parent_effect->instance_id, false, i);
+      }
+    }
+  } else if (parent_canvas != NULL) {
+    uint8_t indx;
+    if (parent_canvas->get_audio_node_index(this, &indx)) {
+      return NODE_ID(0, false, indx);
+    }
+  }
+  return NODE_ID_INVALID;
+}
+
+/**
+ * @brief      Returns the compact id of this node (see NODE_ID())
+ *
+ * @return     The node id or NODE_ID_INVALID if the node is not in the node 
+ *             stack of its parent
+ */
+uint16_t fx_control_node::get_node_id(void) {
+
+  if (parent_effect != NULL) {
+    for (int i=0;i<parent_effect->total_control_nodes;i++) {
+      if (parent_effect->control_node_stack[i] == this) {
+        return NODE_ID(parent_effect->instance_id, true, i);
+      }
+    }
+  } else if (parent_canvas != NULL) {
+    uint8_t indx;
+    if (parent_canvas->get_control_node_index(this, &indx)) {
+      return NODE_ID(0, true, indx);
+    }
+  }
+  return NODE_ID_INVALID;
+}
+
+
+/**
+ * @brief      Sets the parameter descriptor table of this effect
+ *
+ * @param[in]  table  The table (normally set up with FX_PARAM_TABLE())
+ * @param[in]  len    The number of entries in the table
+ */
+void fx_effect::set_param_table(const FX_PARAM_DESC * table, uint8_t len) {
+  param_table = table;
+  param_table_len = len;
+  param_group_first = len;
+  param_group_count = 0;
+  param_group_stride = 0;
+}
+
+/**
+ * @brief      Marks the entries at the end of the parameter table as a group that 
+ *             repeats (e.g. an array of structures)
+ *
+ * @param[in]  first   The first table entry of the group
+ * @param[in]  count   Number of times the group is serialized
+ * @param[in]  stride  Bytes between the members of consecutive repeats
+ */
+void fx_effect::set_param_group(uint8_t first, uint8_t count, uint16_t stride) {
+  param_group_first = first;
+  param_group_count = count;
+  param_group_stride = stride;
+}
+
 uint16_t * fx_effect::serialize_params(uint16_t * serialized_params, uint16_t * size) {
 
   // serialize instance data
   int indx = 0;
 
   uint32_t part_32;
-  uint16_t part_16;
-  uint8_t part_8;
-  
-  for (int i=0;i<total_params;i++) {
-   
-    if (param_stack_types[i] == T_BOOL) {
-     // Serial.println(" : bool");
-      part_16 = * (uint8_t *) param_stack[i];
-      serialized_params[indx++] = part_16;
-    }
-    else if (param_stack_types[i] == T_INT16) {
-      //Serial.println(" : int16");
-      //Serial.println((int)param_stack[i],HEX);
-      serialized_params[indx++] = (uint16_t) (* (uint16_t *) param_stack[i]);
-    }
-    else if (param_stack_types[i] == T_INT32) {
-      //Serial.println(" : int32");
-      part_32 = * (uint32_t *) param_stack[i];
-      serialized_params[indx++] = (uint16_t)((* (uint32_t *) param_stack[i]) >> 16);
-      serialized_params[indx++] = (uint16_t)((* (uint32_t *) param_stack[i]) & 0xFFFF);
-    }
-    else if (param_stack_types[i] == T_FLOAT) {
-      //Serial.println(" : float");
-      part_32 = * (uint32_t *) param_stack[i];
+  int group_len = param_table_len - param_group_first;
+  int total = param_group_first + group_len * param_group_count;
+
+  for (int n=0;n<total;n++) {
+
+    // Look up descriptor (and which repeat of the group we are in)
+    const FX_PARAM_DESC * desc;
+    uint32_t offset;
+    if (n < param_group_first) {
+      desc = &param_table[n];
+      offset = desc->member_offset;
+    } else {
+      int rep = (n - param_group_first) / group_len;
+      desc = &param_table[param_group_first + (n - param_group_first) % group_len];
+      offset = desc->member_offset + rep * param_group_stride;
+    }
+    if (desc->wire_offset == FX_WIRE_NONE) {
+      continue;
+    }
+    void * param = (void *) ((uint8_t *) this + offset);
+
+    if (desc->type == T_BOOL) {
+      serialized_params[indx++] = (uint16_t) (* (uint8_t *) param);
+    }
+    else if (desc->type == T_INT16) {
+      serialized_params[indx++] = (uint16_t) (* (uint16_t *) param);
+    }
+    else if (desc->type == T_INT32 || desc->type == T_FLOAT) {
+      memcpy(&part_32, param, sizeof(part_32));
       serialized_params[indx++] = (uint16_t) (part_32 >> 16);
       serialized_params[indx++] = (uint16_t) (part_32 & 0xFFFF);
     }   
@@ -1886,66 +5003,183 @@ uint16_t * fx_effect::serialize_params(uint16_t * serialized_params, uint16_t *
       DEBUG_MSG("Maximum parameter limit (MAX_PARMS_PER_FX) exceeded", MSG_ERROR); 
       display_error_status(ERROR_INTERNAL);
     }
-
-    //sprintf(buf,"  %#08x - %d", param_stack[i], (int) param_stack_types[i]); Serial.println(buf);
-
   }
   *size = indx;
   #if 0
     Serial.println("  ------");
-
+    char buf[32];
     for (int i=0;i<indx;i++) {
-      //sprintf(buf,"  %#04x, [%#08x] -> %#04x - %d", serialized_params[i], param_stack[i], * (uint16_t *) param_stack[i], (int) param_stack_types[i]); Serial.println(buf);
       sprintf(buf,"  %#04x", serialized_params[i]); Serial.println(buf);
     }
     Serial.println("Complete");
-    //sprintf(buf, "Bool: %d" , (int) sizeof(bool)); Serial.println(buf);
   #endif 
+  return serialized_params;
 }
 
 /**
- * @brief      Checks to see if a float parameter has been updated
- * 
- * This function also applies hysteresis 
+ * @brief      Reads a float parameter by its offset in the parameter block
  *
- * @param      param       The parameter
- * @param      param_last  The parameter last
+ * @param[in]  wire_offset  The FX_*_OFFSET_* of the parameter
+ * @param      value        The value (output)
  *
- * @return     True if updated, false if not
+ * @return     True if the effect has a float parameter at that offset
  */
-bool  fx_effect::float_param_updated( float * param, float * param_last, float threshold ) {
-  
-  bool different;
-  if (abs(*param - *param_last) > threshold) {
-    different = true;
-  } else {
-    different = false;
+bool fx_effect::get_param_float(uint8_t wire_offset, float * value) {
+
+  for (int i=0;i<param_table_len;i++) {
+    if (param_table[i].wire_offset == wire_offset && param_table[i].type == T_FLOAT) {
+      *value = * (float *) ((uint8_t *) this + param_table[i].member_offset);
+      return true;
+    }
   }
+  return false;
+}
 
-  *param_last = *param;
+/**
+ * @brief      Ramps a float parameter to a new value from the pedal's service loop
+ *
+ * The parameter ID used to send the updates comes from the member's entry 
+ * in the parameter table, as with set_param().
+ *
+ * @param      param        The parameter member
+ * @param      node         The control node for this parameter (NULL if none)
+ * @param[in]  target       The value to ramp to
+ * @param[in]  duration_ms  The duration of the ramp in milliseconds
+ *
+ * @return     False if the parameter is controlled by a control route or 
+ *             has no float setter entry in the parameter table
+ */
+bool fx_effect::ramp_param(float * param, fx_control_node * node, float target, uint32_t duration_ms) {
 
-  return different;
+  // If this node is being controlled by a controller, don't allow a direct write to it
+  if (node != NULL && node->connected) {
+    return false;
+  }
+  const FX_PARAM_DESC * desc = get_param_desc(param);
+  if (desc == NULL || desc->param_id == FX_PARAM_ID_NONE || desc->type != T_FLOAT) {
+    Serial.print("Error with ");
+    Serial.println(effect_name); 
+    DEBUG_MSG("Ramped parameter has no float setter entry in the parameter table", MSG_ERROR);
+    return false;
+  }
+  parent_canvas->start_param_ramp(this, param, desc->param_id, target, duration_ms);
+  return true;
+}
 
+/**
+ * @brief      Stops a ramp on a parameter, used by setters that write the 
+ *             parameter directly
+ */
+void fx_effect::stop_ramp(float * param) {
+  parent_canvas->cancel_param_ramp(param);
 }
 
 /**
- * @brief      Checks to see if a bool parameter has been updated
+ * @brief      Checks to see if a new value for a float parameter is inside 
+ *             the deadband declared in the parameter table
+ *
+ * The new value is compared against the value last accepted rather than the 
+ * last value requested, so a pot hovering at the edge of the band does not 
+ * send alternating updates.  Either end of the range the value is written 
+ * from is never suppressed, so a pot on its end stop always reaches the 
+ * minimum or maximum of the parameter.
  *
- * @param      param       The parameter
- * @param      param_last  The parameter last
+ * @param      param     The parameter member
+ * @param[in]  value     The new value
+ * @param[in]  range_lo  The low end of the range the value comes from
+ * @param[in]  range_hi  The high end of the range the value comes from
  *
- * @return     True if updated, false if not
+ * @return     True if the new value should be ignored
  */
-bool  fx_effect::bool_param_updated( bool * param, bool * param_last ) {
-  bool different = false;
-  if (*param != *param_last) {
-    different = true;
+bool  fx_effect::float_within_deadband(float * param, float value, float range_lo, float range_hi) {
+
+  if (value == *param) {
+    return true;
+  }
+  if (value == range_lo || value == range_hi) {
+    return false;
+  }
+
+  // Members repeated in a parameter group and members not in the table get 
+  // the default deadband
+  constexpr uint8_t default_deadband = fx_param_default_deadband(T_FLOAT);
+  const FX_PARAM_DESC * desc = get_param_desc(param);
+  uint8_t deadband = (desc != NULL) ? desc->deadband : default_deadband;
+
+  float band = (deadband & ~FX_DEADBAND_RELATIVE) * 0.001;
+  if (deadband & FX_DEADBAND_RELATIVE) {
+    float mag = fabs(*param);
+    if (mag > 1.0) {
+      band *= mag;
+    }
+  }
+
+  if (fabs(value - *param) < band) {
+    parent_canvas->param_update_stats.suppressed++;
+    return true;
   }
-  *param_last = *param;
-  return different;
+  return false;
 }    
 
 
+/**
+ * @brief      Checks whether a setter should ignore a new value of a float 
+ *             parameter
+ *
+ * Setters have no range to go by, so 0.0 and whole numbers are treated as the 
+ * ends of the range: a pot sent as pot.val, or mapped to a range with whole 
+ * number ends, reaches both ends exactly.  With the deadbands of the effect 
+ * turned off only an unchanged value is ignored.
+ *
+ * @param      param  The parameter member
+ * @param[in]  value  The new value
+ *
+ * @return     True if the new value should be ignored
+ */
+bool  fx_effect::float_within_deadband(float * param, float value) {
+
+  if (!param_deadbands || value == truncf(value)) {
+    return value == *param;
+  }
+  return float_within_deadband(param, value, 0.0, 0.0);
+}
+
+
+/**
+ * @brief      Finds the parameter table entry of a parameter member
+ *
+ * @param[in]  param  The parameter member
+ *
+ * @return     The table entry or NULL if the member is not in the table
+ */
+const FX_PARAM_DESC * fx_effect::get_param_desc(const void * param) {
+  uint16_t offset = (const uint8_t *) param - (const uint8_t *) this;
+  for (int i=0;i<param_table_len;i++) {
+    if (param_table[i].member_offset == offset) {
+      return &param_table[i];
+    }
+  }
+  return NULL;
+}
+
+/**
+ * @brief      Sends the current value of a parameter member to the DSP 
+ *             using the id and type from its parameter table entry
+ *
+ * @param[in]  param  The parameter member
+ */
+void fx_effect::transmit_param(const void * param) {
+  const FX_PARAM_DESC * desc = get_param_desc(param);
+  if (desc == NULL || desc->param_id == FX_PARAM_ID_NONE) {
+    Serial.print("Error with ");
+    Serial.println(effect_name); 
+    DEBUG_MSG("Parameter has no setter entry in the parameter table", MSG_ERROR);
+    return;
+  }
+  parent_canvas->spi_transmit_param(type, instance_id, (PARAM_TYPES) desc->type, desc->param_id, (void *) param);
+}
+
+
 void  fx_effect::print_params(void) {
   Serial.println(" No print function declared for this effect");
 }
@@ -1971,7 +5205,7 @@ bool  fx_effect::service(void) {
 
 fx_led::fx_led(LED_POS pos) {
   led_pos = pos;
-  last_scan = millis();
+  steps = 0;
 }
 
 
@@ -1979,20 +5213,17 @@ void  fx_led::update_rgb_led(void) {
   rgb_write((int) led_pos, (uint8_t) cur_r, (uint8_t) cur_g, (uint8_t) cur_b);
 }
 
+// Called by the pedal every LED_UPDATE_RATE_MS
 void  fx_led::service() {
-  if (millis() >= last_scan + LED_UPDATE_RATE_MS) {
-    last_scan = millis();
-
-    if (steps) {
+  if (steps) {
 
-      cur_r += inc_r;
-      cur_g += inc_g;
-      cur_b += inc_b;
+    cur_r += inc_r;
+    cur_g += inc_g;
+    cur_b += inc_b;
 
-      update_rgb_led();
+    update_rgb_led();
 
-      steps--;
-    }
+    steps--;
   }
 }   
 #endif // DOXYGEN_SHOULD_SKIP_THIS
@@ -2080,6 +5311,7 @@ void  fx_led::turn_off() {
  */
 void  fx_led::set_rgb(uint8_t red, uint8_t green, uint8_t blue) {
   #if defined (DM_FX)
+    (void) red; (void) green; (void) blue;
     turn_on();
   #elif defined (DM_FX_TWO)
     cur_r = red;
@@ -2106,6 +5338,8 @@ void  fx_led::set_rgb(LED_COLOR rgb) {
     float green = ((uint32_t) rgb >> 8) & 0xFF;
     float blue = (uint32_t) rgb & 0xFF;
     set_rgb(red, green, blue);      
+  #else
+    (void) rgb;
   #endif 
 }
 
@@ -2141,6 +5375,8 @@ void  fx_led::fade_to_rgb(uint8_t red, uint8_t green, uint8_t blue, uint32_t mil
     inc_b = (target_b - cur_b) * inc;
 
     update_rgb_led();
+  #else
+    (void) red; (void) green; (void) blue; (void) milliseconds;
   #endif 
 
 }
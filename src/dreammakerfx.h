@@ -12,11 +12,16 @@
 #include "dm_fx_spi_proto.h"
 #include "dm_fx_codec.h"
 #include "dm_fx_ui.h"
+#include "dm_fx_adc.h"
+#include "dm_fx_sched.h"
+#include "dm_fx_profile.h"
 #include "dm_fx_debug.h"
 #include "dm_fx_platform_constants.h"
+#include "dm_fx_scratch.h"
 #include "dm_fx_semitones.h"
 
 #include "effects/dm_fx_effects_defines.h"
+#include "effects/dm_fx_effect_macros.h"
 
 
 #define API_VERSION         10602
@@ -24,6 +29,13 @@
 
 class fx_effect;
 class fx_pedal;
+class fx_pot;
+class fx_control_node;
+
+#include "dm_fx_canvas_image.h"
+#include "dm_fx_mod_matrix.h"
+#include "dm_fx_gesture.h"
+#include "dm_fx_midi.h"
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 
@@ -71,8 +83,296 @@ typedef struct {
   CTRL_NODE_TYPE type;
 } CTRL_ROUTE;
 
+/**
+ * Describes one parameter of an effect.  Each effect declares a constant table 
+ * of these (see FX_PARAM_TABLE() in dm_fx_effect_macros.h) which lives in flash 
+ * and is walked by fx_effect::serialize_params().
+ */
+typedef struct {
+  uint16_t member_offset;     // Offset of the parameter member in the effect object
+  uint8_t  type;              // PARAM_TYPES
+  uint8_t  param_id;          // FX_*_PARAM_ID_* or FX_PARAM_ID_NONE
+  uint8_t  wire_offset;       // FX_*_OFFSET_* word offset in the serialized parameter block
+  uint8_t  deadband;          // FX_DEADBAND_* applied to writes from setters and the modulation matrix
+} FX_PARAM_DESC;
+
+// Parameter can only be set as part of the parameter block
+#define FX_PARAM_ID_NONE      (0xFF)
+
+// Number of 16-bit words a parameter type takes in the parameter block
+constexpr uint8_t fx_param_words(uint8_t type) {
+  return (type == T_FLOAT || type == T_INT32) ? 2 : 1;
+}
+
+// Number of bytes a parameter type reads from its member
+constexpr uint8_t fx_param_bytes(uint8_t type) {
+  return (type == T_FLOAT || type == T_INT32) ? 4 : ((type == T_INT16) ? 2 : 1);
+}
+
+// Not defined on purpose: referenced from a constant expression when a 
+// parameter type is wider than its member so the build fails
+uint8_t fx_param_type_wider_than_member(void);
+
+constexpr uint8_t fx_param_checked_type(uint8_t type, size_t member_size) {
+  return (member_size >= fx_param_bytes(type)) ? type : fx_param_type_wider_than_member();
+}
+
+// Parameter deadbands.  Setters and the modulation matrix ignore a new value 
+// that is within the deadband of the value last accepted, so noise around a 
+// pot position does not send a stream of frames and a value sitting on the 
+// edge of the band does not flip back and forth (hysteresis).  The ends of 
+// the range always get through: the mapping range for the modulation matrix, 
+// and 0.0 and whole numbers for setters (see fx_effect::set_param_deadbands() 
+// to send every change from the setters of an effect).
+// The magnitude is stored in thousandths (0.001 -> 0.127).  Absolute deadbands suit 0.0 -> 1.0 values like
+// mixes; relative deadbands scale with values above 1.0 (frequencies, times).
+#define FX_DEADBAND_NONE      (0)
+#define FX_DEADBAND_RELATIVE  (0x80)
+#define FX_DEADBAND_ABS(x)    fx_deadband((x), false)
+#define FX_DEADBAND_REL(x)    fx_deadband((x), true)
+
+// Not defined on purpose: referenced from a constant expression when a 
+// deadband does not fit in its encoding so the build fails
+uint8_t fx_deadband_too_large(void);
+
+constexpr uint8_t fx_deadband(float x, bool relative) {
+  return (x * 1000.0f + 0.5f > 127.0f) ? fx_deadband_too_large() :
+         (uint8_t) ((relative ? FX_DEADBAND_RELATIVE : 0) | (uint8_t) (x * 1000.0f + 0.5f));
+}
+
+// Floats get a small relative deadband unless their table entry says otherwise;
+// integers and bools are enumerations, counts and switches so any change counts
+constexpr uint8_t fx_param_default_deadband(uint8_t type) {
+  return (type == T_FLOAT) ? FX_DEADBAND_REL(0.002) : FX_DEADBAND_NONE;
+}
+
+// Wire offset of a parameter the DSP accepts from setters but that is not 
+// part of the serialized parameter block
+#define FX_WIRE_NONE          (0xFF)
+
+// Parameter table has no repeating group of entries
+#define FX_PARAM_GROUP_NONE   (0xFF)
+
+// Verifies each entry of a parameter table starts where the previous one ends
+constexpr bool fx_param_table_valid(const FX_PARAM_DESC * table, int len, int i = 0, int wire_offset = 0) {
+  return (i >= len) ? true : 
+         (table[i].wire_offset == FX_WIRE_NONE) ? fx_param_table_valid(table, len, i + 1, wire_offset) :
+         ((table[i].wire_offset == wire_offset) && 
+          fx_param_table_valid(table, len, i + 1, wire_offset + fx_param_words(table[i].type)));
+}
+
 #endif
 
+/**
+ * Memory used by one effect instance (see `fx_pedal::get_instance_memory()`)
+ */
+typedef struct {
+  uint8_t     id;                 /**< Instance ID of the effect */
+  EFFECT_TYPE type;               /**< Type of the effect */
+  uint32_t    object_bytes;       /**< SRAM used by the effect object (includes its nodes) */
+  uint32_t    node_bytes;         /**< Part of object_bytes used by the audio / control nodes and node stacks */
+  uint32_t    param_table_bytes;  /**< Flash used by the parameter descriptor table */
+  uint32_t    dsp_buffer_bytes;   /**< Estimated DSP memory used by delay / loop buffers */
+} FX_INSTANCE_MEMORY;
+
+/**
+ * Memory used by the pedal and the current canvas (see `fx_pedal::get_memory_report()`)
+ */
+typedef struct {
+  uint32_t    pedal_bytes;        /**< SRAM used by the pedal object */
+  uint32_t    canvas_stack_bytes; /**< Part of pedal_bytes used by the instance and routing stacks */
+  uint32_t    spi_buffer_bytes;   /**< SRAM used by the SPI transmit FIFO and receive buffer */
+  uint32_t    scratch_bytes;      /**< SRAM used by the scratch arena for protocol buffers */
+  uint32_t    scratch_peak_bytes; /**< Most of the scratch arena used at once so far */
+  uint32_t    effect_bytes;       /**< SRAM used by all effect objects in the canvas */
+  uint32_t    heap_used_bytes;    /**< Heap high water mark */
+  uint32_t    stack_free_bytes;   /**< Free space between the heap and the stack (0 on host builds) */
+  uint32_t    dsp_buffer_bytes;   /**< Estimated DSP memory used by delay / loop buffers of all effects */
+} FX_MEMORY_REPORT;
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+// A float parameter being ramped from the host (see fx_pedal::start_param_ramp())
+typedef struct {
+  fx_effect * effect;             // NULL when this slot is free
+  float *     param;              // Parameter member in the effect
+  uint8_t     param_id;
+  float       start;
+  float       target;
+  uint32_t    start_ms;
+  uint32_t    duration_ms;
+  uint32_t    next_ms;            // When the next update is due
+} FX_PARAM_RAMP;
+
+// Latest value of a parameter for the update scheduler (see fx_pedal::queue_param_update())
+typedef struct {
+  EFFECT_TYPE type;
+  uint8_t     instance_id;
+  uint8_t     param_id;
+  uint8_t     param_type;
+  bool        in_use;
+  bool        pending;            // value has not been sent yet
+  bool        sent;               // last_value is valid
+  uint32_t    value;              // Raw bits of the queued value
+  uint32_t    last_value;         // Raw bits of the value last sent
+  uint32_t    since_ms;           // When the update was first queued
+} FX_PARAM_UPDATE;
+
+// A parameter whose value is read back from the DSP
+typedef struct {
+  fx_effect * effect;
+  uint8_t     param_id;
+  uint8_t     param_type;
+  uint16_t    member_offset;
+  uint32_t    updated_ms;         // When the DSP last returned its value (0 if never)
+} FX_PARAM_READBACK;
+
+// A parameter update held until shortly before the DSP block it should land on
+typedef struct {
+  EFFECT_TYPE type;
+  uint8_t     instance_id;
+  uint8_t     param_id;
+  uint8_t     param_type;
+  bool        in_use;
+  uint32_t    value;              // Raw bits of the value
+  uint32_t    block;              // DSP block to apply it at
+} FX_SCHEDULED_PARAM;
+
+// Host model of the DSP block counter, kept in step with the counter in the 
+// status frames by a second order loop (phase and rate correction)
+typedef struct {
+  bool        synced;             // DSP has reported its block counter
+  uint32_t    ref_block;          // Whole blocks at ref_us
+  float       ref_frac;           // Fraction of a block at ref_us
+  uint32_t    ref_us;
+  float       blocks_per_us;
+  uint32_t    last_count_us;      // dsp_status.block_count_us last applied
+  uint32_t    anchor_block;       // First count after (re)syncing
+  uint32_t    anchor_us;
+} FX_DSP_CLOCK;
+
+// A pot streamed to a float parameter (see fx_pedal::stream_control())
+typedef struct {
+  fx_pot *    pot;                // NULL when no stream is running
+  fx_control_node * dest;
+  float *     param;              // Parameter member in the effect
+  float       min;
+  float       range;
+  bool        bound;              // Bind frame sent for the running canvas
+  uint16_t    points[CONTROL_STREAM_FRAME_POINTS];
+  uint8_t     total_points;
+  uint32_t    first_us;           // When points[0] was sampled
+  uint32_t    next_us;            // When the next point is sampled
+  bool        started;            // last_val / last_us are valid
+  float       last_val;           // Last pot reading and when it was taken
+  uint32_t    last_us;
+  bool        sent;               // last_point is valid
+  uint16_t    last_point;         // Last point sent
+  bool        pending;            // A frame is waiting in the SPI FIFO
+  uint32_t    pending_us;         // When its first point was sampled
+} FX_CONTROL_STREAM;
+
+// A MIDI message routed to a float parameter or a canvas control node (see 
+// fx_pedal::route_midi_cc())
+typedef struct {
+  uint8_t     type;               // MIDI_CONTROL_CHANGE or MIDI_NOTE_ON
+  uint8_t     channel;            // 1 - 16, or MIDI_CHANNEL_ANY
+  uint8_t     number;             // Controller number
+  fx_control_node * dest;
+  float *     param;              // Parameter member in the effect (NULL for the canvas)
+  float       min;
+  float       range;
+  bool        pending;            // value has not been sent yet
+  float       value;
+} FX_MIDI_ROUTE;
+
+// MIDI clock tempo follower
+typedef struct {
+  bool        enabled;
+  uint32_t    ticks_us[MIDI_CLOCK_HISTORY];   // Ring of the latest clock times
+  uint8_t     total_ticks;
+  uint8_t     next_tick;
+  uint32_t    count;              // Clocks since start (a beat every MIDI_CLOCKS_PER_BEAT)
+  uint32_t    last_us;
+  float       reported_ms;        // Beat interval last reported by new_tap_interval()
+} FX_MIDI_CLOCK;
+
+#endif  // DOXYGEN_SHOULD_SKIP_THIS
+
+/**
+ * Parameter update scheduler metrics (see `fx_pedal::get_param_update_stats()`)
+ */
+typedef struct {
+  uint16_t    budget_words;       /**< Words the scheduler may send each service tick */
+  float       link_utilization;   /**< Sustained share of the budget in use (0.0 -> 1.0, smoothed) */
+  uint32_t    max_staleness_ms;   /**< Longest an update has waited before being sent */
+  uint16_t    pending;            /**< Updates currently waiting */
+  uint32_t    sent;               /**< Updates sent */
+  uint32_t    coalesced;          /**< Updates replaced by a newer value before being sent */
+  uint32_t    forced;             /**< Updates sent outside the budget because the queue was full */
+  uint32_t    suppressed;         /**< Setter and modulation matrix writes ignored because the new value was inside the parameter's deadband */
+} FX_PARAM_UPDATE_STATS;
+
+/**
+ * Statistics of a task run by `fx_pedal::service()` (see `fx_pedal::get_task_stats()`)
+ */
+typedef struct {
+  const char * name;              /**< Task name */
+  uint32_t    period_us;          /**< How often the task is released */
+  uint32_t    budget_us;          /**< Expected run time */
+  uint32_t    runs;               /**< Times the task has run */
+  uint32_t    deadline_misses;    /**< Runs that finished after their deadline */
+  uint32_t    budget_overruns;    /**< Runs that took longer than the budget */
+  uint32_t    skipped;            /**< Releases dropped because the task fell a whole period behind */
+  uint32_t    max_run_us;         /**< Longest run */
+  uint32_t    max_jitter_us;      /**< Longest delay from release to start */
+  float       mean_jitter_us;     /**< Average delay from release to start */
+} FX_TASK_STATS;
+
+/**
+ * Footswitch press timing (see `fx_pedal::get_input_stats()`)
+ */
+typedef struct {
+  uint32_t    events;             /**< Presses seen by the interrupt handlers */
+  uint32_t    dropped;            /**< Presses lost because too many were waiting */
+  uint32_t    isr_max_us;         /**< Longest interrupt handler run */
+  float       isr_mean_us;        /**< Average interrupt handler run */
+  uint32_t    latency_max_us;     /**< Longest time from a press to its action (bypass, tap) */
+  float       latency_mean_us;    /**< Average time from a press to its action */
+  uint32_t    gestures;           /**< Gestures passed to handlers */
+  uint32_t    gesture_latency_max_us;   /**< Longest time from when a gesture could be told apart to its handler */
+  float       gesture_latency_mean_us;  /**< Average time from when a gesture could be told apart to its handler */
+  uint32_t    taps;               /**< Taps fed to the tap tempo */
+  uint32_t    tap_restarts;       /**< Tap sequences cut short by a change of tempo (a pause is not counted) */
+} FX_INPUT_STATS;
+
+/**
+ * Control stream metrics (see `fx_pedal::get_control_stream_stats()`)
+ */
+typedef struct {
+  uint32_t    frames;             /**< Frames sent */
+  uint32_t    points;             /**< Points sent */
+  uint32_t    words;              /**< Words the frames took on the SPI link */
+  uint32_t    idle_frames;        /**< Frames not sent because the pot did not move */
+  uint32_t    late_frames;        /**< Frames sent after their first point was due on the DSP */
+  uint32_t    max_send_delay_us;  /**< Longest time from sampling a frame's first point to sending the frame */
+} FX_CONTROL_STREAM_STATS;
+
+/**
+ * MIDI input metrics (see `fx_pedal::get_midi_stats()`)
+ */
+typedef struct {
+  uint32_t    bytes;              /**< Bytes received */
+  uint32_t    messages;           /**< Messages decoded */
+  uint32_t    stray_bytes;        /**< Data bytes that belonged to no message (e.g. a status byte was lost) */
+  uint32_t    frames;             /**< Value frames sent to the DSP */
+  uint32_t    values;             /**< Values sent */
+  uint32_t    coalesced;          /**< Values replaced by a newer one before being sent */
+  uint32_t    latency_max_us;     /**< Longest time from receiving a message to sending its frame */
+  float       latency_mean_us;    /**< Average time from receiving a message to sending its frame */
+  float       clock_bpm;          /**< Tempo of the MIDI clock (0.0 if there is none) */
+} FX_MIDI_STATS;
+
 
 
 
@@ -81,6 +381,13 @@ typedef struct {
  ***********************************************************************/
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 
+// Compact node ids used in debug output: the instance id of the parent (0 for
+// the canvas) in the upper byte and the local node index in the lower seven
+// bits, with NODE_ID_CONTROL set for control nodes
+#define NODE_ID_CONTROL               (0x0080)
+#define NODE_ID_INVALID               (0xFFFF)
+#define NODE_ID(INSTANCE, CONTROL, INDEX)  ((uint16_t) (((INSTANCE) << 8) | ((CONTROL) ? NODE_ID_CONTROL : 0) | ((INDEX) & 0x7F)))
+
 /**
  * @brief      Class for effects audio node.
  * 
@@ -100,12 +407,12 @@ class fx_audio_node {
 
     NODE_DIRECTION node_direction;    
     bool           connected;
-    char           node_name[MAX_NODE_NAME];
+    const char *   node_name;       // Points to a string literal, never copied
 
     // Audio nodes that are part of the effect
     fx_audio_node(NODE_DIRECTION dir, const char * name, fx_effect * p) {
       node_direction = dir;
-      strcpy(node_name, name);
+      node_name = name;
       parent_effect = p;
       parent_canvas = NULL;
       connected = false;
@@ -114,12 +421,13 @@ class fx_audio_node {
     // Audio nodes that are part of the canvas (i.e. ADCs, DACs)
     fx_audio_node(NODE_DIRECTION dir, const char * name, fx_pedal * p) {
       node_direction = dir;
-      strcpy(node_name, name);
+      node_name = name;
       parent_canvas = p;
       parent_effect = NULL;
       connected = false;
     }    
-  
+
+    uint16_t get_node_id(void);
 };
 
 /**
@@ -134,6 +442,7 @@ class fx_audio_node {
 class fx_control_node {
 
   friend class fx_pedal;
+  friend class fx_mod_matrix;
 
   protected:
     fx_effect      * parent_effect;
@@ -143,7 +452,7 @@ class fx_control_node {
     uint8_t        param_id;
     NODE_DIRECTION node_direction;
     CTRL_NODE_TYPE node_type;
-    char           node_name[MAX_NODE_NAME];
+    const char *   node_name;       // Points to a string literal, never copied
 
     bool           connected;
 
@@ -152,7 +461,7 @@ class fx_control_node {
       param_id = ctrl_param_id;
       node_direction = dir;
       node_type = type;
-      strcpy(node_name, name);
+      node_name = name;
       parent_effect = p;
       parent_canvas = NULL;
       connected = false;  
@@ -163,11 +472,13 @@ class fx_control_node {
       param_id = ctrl_param_id;
       node_direction = dir;
       node_type = type;
-      strcpy(node_name, name);
+      node_name = name;
       parent_canvas = p;
       parent_effect = NULL;
       connected = false;
     }    
+
+    uint16_t get_node_id(void);
 };
 
 #endif  // DOXYGEN_SHOULD_SKIP_THIS
@@ -234,7 +545,6 @@ class fx_led {
     float  target_r, target_g, target_b;
     float  inc_r, inc_g, inc_b;
     uint32_t steps;
-    uint32_t last_scan;
 
     void  update_rgb_led(void);
 
@@ -389,6 +699,25 @@ class fx_pot {
 
   #define POT_LONG_HIST_LEN  (10)
   #define POT_SHORT_HIST_LEN (3)
+  #define POT_HIST_INTERVAL_MS (50)   // Rate the histories are sampled at
+
+  // One-euro filter (Casiez et al.) applied to every reading: the cutoff 
+  // rises with the speed of the knob, so the value is quiet at rest and 
+  // follows fast turns with little lag
+  #ifndef POT_FILTER_MIN_CUTOFF_HZ
+    #define POT_FILTER_MIN_CUTOFF_HZ  (1.0f)
+  #endif
+  #ifndef POT_FILTER_BETA
+    #define POT_FILTER_BETA           (20.0f)  // Added cutoff (Hz) per unit/second of knob speed
+  #endif
+  #define POT_FILTER_D_CUTOFF_HZ      (10.0f)  // Smoothing of the speed estimate
+  #define POT_FILTER_MAX_DT_S         (0.1f)
+
+  // A turn slower than the history windows can see is still reported once 
+  // the value has moved this far from the last reported change, and once the 
+  // knob stops a final change is reported if it rests this far from it
+  #define POT_CHANGE_MIN              (0.01f)
+  #define POT_CHANGE_SETTLE_MIN       (0.003f)
 
   private:
     bool  first_read;
@@ -401,40 +730,54 @@ class fx_pot {
     float pot_history_long[POT_LONG_HIST_LEN];
     float pot_history_short[POT_SHORT_HIST_LEN];
     int   pot_long_hist_indx, pot_short_hist_indx;
-    int   last_poll;
+    float pot_long_mean, pot_long_m2;       // Running mean / sum of squared differences
+    float pot_short_mean, pot_short_m2;
+    float filt_val, filt_dx;                // One-euro filter state
+    float changed_val;                      // Filtered value at the last change
+    uint32_t last_us;
+    uint32_t last_poll;
 
     #pragma GCC optimize ("-O3")
     #pragma GCC push_options
 
-    float pot_mean(float * a, float pts) {
-      float mean = 0;
-      float r = 1.0 / pts;
-      for (int i=0;i<pts;i++) {
-        mean += a[i];
-      }
-      mean *= r;
-      return mean;
-    }
-
-    float pot_variance(float * a, float pts) {
-      float mean = 0;
-
-      float r = 1.0 / pts;
+    void pot_stats(float * a, int pts, float * mean, float * m2) {
+      float sum = 0;
       for (int i=0;i<pts;i++) {
-        mean += a[i];
+        sum += a[i];
       }
-      mean *= r;
+      *mean = sum / pts;
 
       float v = 0.0;
       for (int i=0;i<pts;i++) {
-        float x = a[i] - mean;
+        float x = a[i] - *mean;
         v += x*x;
       }
-      v *= r;
+      *m2 = v;
+    }
+
+    /**
+     * @brief      Replaces the oldest sample of a history and updates its 
+     *             mean and sum of squared differences in O(1) (Welford).  The 
+     *             statistics are recomputed each time the history wraps so 
+     *             rounding errors cannot build up.
+     */
+    void pot_hist_push(float * a, int pts, int * indx, float * mean, float * m2, float x) {
+      float old = a[*indx];
+      float old_mean = *mean;
+      a[*indx] = x;
+      *mean += (x - old) / pts;
+      *m2 += (x - old) * ((x - *mean) + (old - old_mean));
+      if (++(*indx) >= pts) {
+        *indx = 0;
+        pot_stats(a, pts, mean, m2);
+      }
+    }
+
+    float pot_filter_alpha(float cutoff_hz, float dt) {
+      float tau = 1.0f / ((float) PI2 * cutoff_hz);
+      return dt / (dt + tau);
+    }
 
-      return v;
-    }    
-    
     #pragma GCC pop_options
 
   public:
@@ -464,65 +807,83 @@ class fx_pot {
     #pragma GCC optimize ("-O3")
     #pragma GCC push_options
     void read_pot() {
-      
-      changed = false;
 
-      if (millis() < last_poll + 50) {
-        return;
-      }
-      last_poll = millis();
-
-      int val_int;
-      if (pin_number == 0) val_int = analogRead(A0);
-      else if (pin_number == 1) val_int = analogRead(A1);
-      else if (pin_number == 2) val_int = analogRead(A2);
-      else if (pin_number == 3) val_int = analogRead(A3);
-      else if (pin_number == 4) val_int = analogRead(A4);
-      else if (pin_number == 5) val_int = analogRead(A5);
-      else {
-        val_int = 0;
-      }
-      float valf = (1.0/1023.0) * (float) val_int;
+      // The ADC scan keeps the latest result, so this is called on every 
+      // service() and filters each reading
+      int   adc = pot_adc_read(pin_number);
+      float x = (adc >= POT_ADC_FULL_SCALE) ? 1.0f : (1.0f/POT_ADC_FULL_SCALE) * (float) adc;
+      uint32_t now_us = micros();
 
       if (first_read) {
         for (int i=0;i<POT_LONG_HIST_LEN;i++) {
-          pot_history_long[i] = valf;
+          pot_history_long[i] = x;
         }
         for (int i=0;i<POT_SHORT_HIST_LEN;i++) {
-          pot_history_short[i] = valf;
-        }        
+          pot_history_short[i] = x;
+        }
+        pot_long_mean = pot_short_mean = x;
+        pot_long_m2 = pot_short_m2 = 0.0;
+        filt_val = changed_val = x;
+        filt_dx = 0.0;
+        last_us = now_us;
+        last_poll = millis();
         changed = true;
         first_read = false;
-      } else {
-
-        pot_history_long[pot_long_hist_indx++] = valf;
-        pot_history_short[pot_short_hist_indx++] = valf;
+        set_val(x);
+        return;
+      }
 
-        if (pot_long_hist_indx >= POT_LONG_HIST_LEN) {
-          pot_long_hist_indx = 0;
+      float dt = (float) (now_us - last_us) * 1e-6f;
+      if (dt > 0.0f) {
+        last_us = now_us;
+        if (dt > POT_FILTER_MAX_DT_S) {
+          dt = POT_FILTER_MAX_DT_S;
         }
-        if (pot_short_hist_indx >= POT_SHORT_HIST_LEN) {
-          pot_short_hist_indx = 0;
+        float dx = (x - filt_val) / dt;
+        filt_dx += pot_filter_alpha(POT_FILTER_D_CUTOFF_HZ, dt) * (dx - filt_dx);
+        float cutoff = POT_FILTER_MIN_CUTOFF_HZ + POT_FILTER_BETA * fabsf(filt_dx);
+        filt_val += pot_filter_alpha(cutoff, dt) * (x - filt_val);
+
+        // The filter only creeps towards an end stop, so snap to it once 
+        // close; a setter fed from the pot then reaches the end of its range
+        if ((adc <= 0 || adc >= POT_ADC_FULL_SCALE) && fabsf(x - filt_val) < POT_CHANGE_MIN) {
+          filt_val = x;
         }
+        set_val(filt_val);
+      }
 
-        float v_long = pot_variance(pot_history_long, POT_LONG_HIST_LEN);
-        
-        if (v_long > 0.0001) {
-          changed = true;
-          float v_short= pot_variance(pot_history_short, POT_SHORT_HIST_LEN);
-          if (v_short < 0.00005) {
-            changed = false;
-          }
-        }    
+      if (fabsf(filt_val - changed_val) > POT_CHANGE_MIN || 
+          (filt_val != changed_val && (filt_val == 0.0f || filt_val == 1.0f))) {
+        changed = true;
+        changed_val = filt_val;
+      }
+
+      if (millis() < last_poll + POT_HIST_INTERVAL_MS) {
+        return;
+      }
+      last_poll = millis();
+
+      pot_hist_push(pot_history_long, POT_LONG_HIST_LEN, &pot_long_hist_indx, &pot_long_mean, &pot_long_m2, filt_val);
+      pot_hist_push(pot_history_short, POT_SHORT_HIST_LEN, &pot_short_hist_indx, &pot_short_mean, &pot_short_m2, filt_val);
+
+      // Moving: the long history shows the knob moved recently and the 
+      // short history that it has not stopped yet
+      bool moving = (pot_long_m2 * (1.0f/POT_LONG_HIST_LEN) > 0.0001f && 
+                     pot_short_m2 * (1.0f/POT_SHORT_HIST_LEN) >= 0.00005f);
+      if (moving || fabsf(filt_val - changed_val) > POT_CHANGE_SETTLE_MIN) {
+        changed = true;
+        changed_val = filt_val;
       }
-      val = pot_mean(pot_history_short, POT_SHORT_HIST_LEN);
+    }
 
+    void set_val(float valf) {
+      val = valf;
       #if defined (DM_FX_TWO)
-        val = 1.0 - val;
+        val = 1.0f - val;
       #endif 
-      val_inv = 1.0-val;
-      val_log = log10(1.0 + (val*9.0));
-      val_log_inv = 1.0 - log10(1.0 + ((1.0-val)*9.0));
+      val_inv = 1.0f - val;
+      val_log = pot_log_curve(val);
+      val_log_inv = 1.0f - pot_log_curve(1.0f - val);
     }
     #pragma GCC pop_options
 
@@ -604,26 +965,93 @@ class fx_pedal {
     bool        initialized;
     bool        valid_audio_routes;
     bool        valid_control_routes;
+
+    // A route_audio() / route_control() call failed because a stack was full
+    bool        canvas_over_capacity;
     bool        debug_mode, debug_dsp_telemetry, debug_no_reset;
     
-    uint32_t    last_service_ts;
-
-    uint32_t    tap_history[16];
+    // Parameters being ramped by service()
+    FX_PARAM_RAMP param_ramps[MAX_PARAM_RAMPS];
+
+    // Parameter updates waiting for service() and the scheduler metrics
+    FX_PARAM_UPDATE param_updates[MAX_PARAM_UPDATES];
+    FX_PARAM_UPDATE_STATS param_update_stats;
+
+    // Parameters read back from the DSP
+    FX_PARAM_READBACK param_readbacks[MAX_PARAM_READBACKS];
+    uint8_t     total_param_readbacks;
+    uint8_t     param_readback_next;
+    uint32_t    param_readback_last_ms;
+
+    // Parameter updates held for a DSP block and the model of the DSP clock
+    FX_SCHEDULED_PARAM scheduled_params[MAX_SCHEDULED_PARAMS];
+    FX_DSP_CLOCK dsp_clock;
+    bool        schedule_active;
+    uint32_t    schedule_block;
+
+    // Pot streamed to a control node and its metrics
+    FX_CONTROL_STREAM control_stream;
+    FX_CONTROL_STREAM_STATS control_stream_stats;
+
+    // MIDI input: port, parser, routes, canvas note values and tempo
+    Stream *    midi_port;
+    FX_MIDI_PARSER midi_parser;
+    FX_MIDI_ROUTE midi_routes[MAX_MIDI_ROUTES];
+    uint8_t     total_midi_routes;
+    uint8_t     midi_note_channel;      // UNDEFINED if notes don't drive the canvas
+    uint8_t     midi_note;              // Note playing (UNDEFINED if none)
+    uint32_t    midi_note_on_us;
+    float       midi_note_values[3];    // By canvas parameter ID - 1
+    uint8_t     midi_note_pending;      // 1 << (canvas parameter ID - 1)
+    bool        midi_values_pending;
+    uint32_t    midi_pending_since_us;  // Oldest message waiting to be sent
+    bool        midi_frame_pending;     // A frame is waiting in the SPI FIFO
+    uint32_t    midi_frame_since_us;
+    FX_MIDI_CLOCK midi_clock;
+    FX_MIDI_STATS midi_stats;
+    float       midi_latency_total_us;
+    uint32_t    midi_latency_frames;
+
+    // Modulation matrix evaluated by service() (NULL if none)
+    fx_mod_matrix * mod_matrix;
+
+    // Tap tempo: tap times, and the beat grid fitted to them (beats fall on 
+    // tap_beat_ms + n * tap_interval_ms)
+    uint32_t    tap_history[TAP_HISTORY_LEN];
     uint16_t    tap_indx = 0;
     float       tap_interval_ms;
+    uint32_t    tap_beat_ms;
+    float       tap_confidence;
     bool        tap_locked;
     bool        tap_led_flash;
     uint32_t    tap_led_flash_cntr;
     uint32_t    tap_last_tap;
     bool        tap_new_val;
 
+    // Time from footswitch interrupts to their handling in service()
+    uint32_t    input_events_handled;
+    uint32_t    input_latency_total_us;
+    uint32_t    input_latency_max_us;
+    uint32_t    tap_count;
+    uint32_t    tap_restarts;
+
     bool        footswitch_left_pressed, footswitch_right_pressed;
     bool        footswitch_left_released, footswitch_right_released;
-    bool        footswitch_left_last_state, footswitch_right_last_state;
+
+    // Footswitch gestures ([0] right, [1] left).  The decoders also hold 
+    // whether each footswitch is down; the scan feeds them an edge the 
+    // interrupts missed once it has read the other state twice in a row
+    FX_GESTURE_DECODER  gesture_decoder[2];
+    void        (*gesture_handlers[2][GESTURE_TOTAL])(void);
+    bool        footswitch_stale[2];
+    uint32_t    footswitch_stale_us[2];
+    uint32_t    gesture_events;
+    uint32_t    gesture_latency_total_us;
+    uint32_t    gesture_latency_max_us;
 
     DSP_STATUS * status;
 
-    char * get_effect_type(EFFECT_TYPE t);
+    const char * get_effect_type(EFFECT_TYPE t);
 
     // All effect instances in canvas
     FX_INSTANCE instance_stack[MAX_INSTANCES];
@@ -640,6 +1068,19 @@ class fx_pedal {
     // Does this canvas have a valid topology
     bool        valid_canvas;   
 
+    // Has a canvas been preloaded into the shadow slot on the DSP
+    bool        shadow_canvas_loaded;
+
+    // Parameters were written after the preload, so the shadow canvas has 
+    // older values than the effects
+    bool        shadow_params_stale;
+
+    // Effects of the canvas running on the DSP.  Their instance_id stays the 
+    // one they have in that canvas until a new canvas replaces it, while 
+    // the instance stack may already describe the next canvas.
+    void *      live_instances[MAX_INSTANCES];
+    int         total_live_instances;
+
     // Canvas audio nodes
     fx_audio_node sys_input_instr_l;
     fx_audio_node sys_input_instr_r;
@@ -653,6 +1094,12 @@ class fx_pedal {
     fx_control_node sys_note_duration_ms;
     fx_control_node sys_new_note;
 
+    // Clears the instance and routing stacks back to an empty canvas
+    void    reset_canvas_stacks(void);
+
+    // Gives the effects the instance IDs of the canvas that is now running
+    void    commit_instance_ids(void);
+
     // Adds a new route
     bool    add_audio_route_to_stack(uint8_t src_id, uint8_t src_node_indx, uint8_t dest_id, uint8_t dest_node_indx);
     bool    add_control_route_to_stack(uint8_t src_id, 
@@ -669,11 +1116,84 @@ class fx_pedal {
     void    spi_get_status(void);
     void    spi_service(void);
     void    spi_transmit_bypass(uint16_t bypass_state);
-    void    spi_transmit_all_params(void);
-    void    spi_transmit_params(uint16_t node_index);
-    void    spi_transmit_audio_routing_stack(void);
-    void    spi_transmit_control_routing_stack(void);
-    void    spi_transmit_instance_stack(void);
+    bool    spi_transmit_all_params(void);
+    bool    spi_transmit_params(uint16_t node_index);
+    bool    spi_transmit_audio_routing_stack(void);
+    bool    spi_transmit_control_routing_stack(void);
+    bool    spi_transmit_instance_stack(void);
+    bool    spi_transmit_canvas_topology(void);
+
+    // Enables the canvas once it has been sent and waits for it to start running
+    bool    start_canvas(void);
+
+    // Shadow canvas support
+    void    check_canvas_routing(void);
+    bool    check_canvas_capacity(void);
+    void    spi_transmit_canvas_slot(uint16_t slot);
+    void    spi_transmit_swap(uint16_t crossfade_blocks);
+    bool    finish_preload(void);
+    bool    check_canvas_slots(void);
+
+    // Periodic work run by service() as scheduler tasks
+    void    add_service_tasks(void);
+    void    service_ui(void);
+    void    service_pots(void);
+    void    service_leds(void);
+    void    service_link(void);
+    static void service_task_ui(void * arg);
+    static void service_task_pots(void * arg);
+    static void service_task_leds(void * arg);
+    static void service_task_buttons(void * arg);
+    static void service_task_link(void * arg);
+
+    // Parameter ramps
+    bool    start_param_ramp(fx_effect * effect, float * param, uint8_t param_id, float target, uint32_t duration_ms);
+    void    cancel_param_ramp(float * param);
+    void    service_param_ramps(void);
+    uint32_t get_ramp_interval_ms(void);
+
+    // Parameter update scheduler
+    void    spi_transmit_param_frame(EFFECT_TYPE instance_type, uint8_t instance_id, uint8_t param_type, uint8_t param_id, uint32_t raw);
+    void    queue_param_update(EFFECT_TYPE instance_type, uint8_t instance_id, uint8_t param_type, uint8_t param_id, uint32_t raw);
+    void    send_param_update(FX_PARAM_UPDATE * update, uint32_t now);
+    uint32_t get_param_update_priority(FX_PARAM_UPDATE * update, uint32_t now);
+    void    service_param_updates(void);
+    void    clear_param_updates(void);
+
+    // Parameter readback
+    bool    get_param_readback_desc(fx_control_node * node, FX_PARAM_READBACK * rb);
+    FX_PARAM_READBACK * find_param_readback(fx_control_node * node);
+    void    spi_transmit_readback_request(void);
+    void    apply_param_readbacks(void);
+
+    // Scheduled parameter updates
+    void    update_dsp_clock(uint32_t block, uint32_t now_us);
+    uint32_t get_dsp_block(uint32_t at_us);
+    void    schedule_param_update(EFFECT_TYPE instance_type, uint8_t instance_id, uint8_t param_type, uint8_t param_id, uint32_t raw);
+    void    spi_transmit_scheduled_param_frame(FX_SCHEDULED_PARAM * event);
+    void    service_scheduled_params(void);
+    void    clear_scheduled_params(void);
+    uint32_t get_dsp_block(uint32_t at_us, uint16_t * sample);
+
+    // Control streams
+    float * get_float_param(fx_control_node * node);
+    void    spi_transmit_control_stream_bind(bool stop);
+    void    send_control_stream_frame(void);
+    void    service_control_stream(void);
+
+    // MIDI input
+    bool    add_midi_route(uint8_t type, uint8_t channel, uint8_t number, fx_control_node * dest, float min, float max);
+    void    handle_midi_message(const FX_MIDI_MSG * msg, uint32_t now_us);
+    void    set_midi_route_value(FX_MIDI_ROUTE * route, float value, uint32_t now_us);
+    void    set_midi_note_value(uint8_t param_id, float value, uint32_t now_us);
+    void    midi_clock_tick(uint32_t now_us);
+    void    send_midi_values(void);
+    void    service_midi(void);
+    static void service_task_midi(void * arg);
+
+    // Memory report support
+    uint32_t get_effect_size(EFFECT_TYPE t);
+    uint32_t get_dsp_buffer_estimate(fx_effect * effect);
 
     // Returns the index in the node index for this effect 
     bool    get_audio_node_index(fx_audio_node * node, uint8_t * node_index);
@@ -698,6 +1218,9 @@ class fx_pedal {
 
     #ifndef DOXYGEN_SHOULD_SKIP_THIS
     friend class fx_effect;
+    friend class fx_canvas_reader;
+    friend class fx_audio_node;
+    friend class fx_control_node;
 
     bool        bypass_control_enabled;
     bool        bypassed;
@@ -755,37 +1278,37 @@ class fx_pedal {
     #ifndef DOXYGEN_SHOULD_SKIP_THIS
     fx_pedal():
 
+      sys_input_instr_l(NODE_OUT, "instr_in_l", this), 
+      sys_input_instr_r(NODE_OUT, "instr_in_r", this), 
+      sys_output_amp_l(NODE_IN, "amp_out_l", this),
+      sys_output_amp_r(NODE_IN, "amp_out_r", this),
+      sys_input_mic_l(NODE_IN, "mic_in_l", this),
+      sys_input_mic_r(NODE_IN, "mic_in_r", this),
+      sys_current_frequency(NODE_OUT, NODE_FLOAT, "current note frequency", this, FX_CANVAS_PARAM_ID_NOTE_FREQ),
+      sys_note_duration_ms(NODE_OUT, NODE_FLOAT, "current note duration (ms)", this, FX_CANVAS_PARAM_ID_NOTE_DURATION),
+      sys_new_note(NODE_OUT, NODE_FLOAT, "New note playing event", this, FX_CANVAS_PARAM_ID_NOTE_NEW_NOTE),
+
       #if defined (DM_FX)
         pot_right(0),
         pot_center(1),
         pot_left(2),
         led_left(LED_LEFT),
-        led_right(LED_RIGHT),
+        led_right(LED_RIGHT) {
 
       #elif defined (DM_FX_TWO)
+        pot_top_left(0),
+        pot_top_right(1),
         pot_bot_left(2),
         pot_bot_center(3),
         pot_bot_right(4),
-        pot_top_left(0),
-        pot_top_right(1),
         exp_pedal(5),
         toggle_left(8, 9),
         toggle_right(10, 11),
         led_left(LED_LEFT),
         led_center(LED_CENTER),
-        led_right(LED_RIGHT),
+        led_right(LED_RIGHT) {
       #endif 
 
-      sys_input_instr_l(NODE_OUT, "instr_in_l", this), 
-      sys_input_instr_r(NODE_OUT, "instr_in_r", this), 
-      sys_output_amp_l(NODE_IN, "amp_out_l", this),
-      sys_output_amp_r(NODE_IN, "amp_out_r", this),
-      sys_input_mic_l(NODE_IN, "mic_in_l", this),
-      sys_input_mic_r(NODE_IN, "mic_in_r", this),
-      sys_current_frequency(NODE_OUT, NODE_FLOAT, "current note frequency", this, FX_CANVAS_PARAM_ID_NOTE_FREQ),
-      sys_note_duration_ms(NODE_OUT, NODE_FLOAT, "current note duration (ms)", this, FX_CANVAS_PARAM_ID_NOTE_DURATION),
-      sys_new_note(NODE_OUT, NODE_FLOAT, "New note playing event", this, FX_CANVAS_PARAM_ID_NOTE_NEW_NOTE) {
-
         // Audio routing nodes
         instr_in = &sys_input_instr_l;    // Alias
         instr_in_l = &sys_input_instr_l;
@@ -817,32 +1340,8 @@ class fx_pedal {
         audio_node_stack[5] = mic_in_r;
         */
 
-        // Add canvas as instance 0
-        total_instances = 1;
-        instance_stack[0].id = 0;
-        instance_stack[0].type = FX_CANVAS;
-
-        // Init the remaining slots in the instance stack
-        for (int i=1;i<MAX_INSTANCES;i++) {
-          instance_stack[i].id = UNDEFINED;
-          instance_stack[i].address = NULL;       
-          instance_stack[i].type = FX_UNDEFINED; 
-        }
-
-        // Init the slots in the audio and control routing stacks
-        total_audio_routes = 0;
-        total_control_routes = 0;
-        for (int i=0;i<MAX_ROUTES;i++) {
-          audio_routing_stack[i].src_id = UNDEFINED;
-          audio_routing_stack[i].src_node_indx = UNDEFINED;       
-          audio_routing_stack[i].dest_id = UNDEFINED; 
-          audio_routing_stack[i].src_node_indx = UNDEFINED;       
-
-          control_routing_stack[i].src_id = UNDEFINED;
-          control_routing_stack[i].src_node_indx = UNDEFINED;       
-          control_routing_stack[i].dest_id = UNDEFINED; 
-          control_routing_stack[i].src_node_indx = UNDEFINED;            
-        }          
+        // Start with an empty canvas (just the canvas itself as instance 0)
+        reset_canvas_stacks();
 
         // Reset DSP by default
         debug_no_reset = false;
@@ -862,22 +1361,86 @@ class fx_pedal {
         tap_blink_only_enabled = false;
 
         // Button press detection
-        footswitch_left_last_state = true;
-        footswitch_right_last_state = true;
-
         footswitch_left_pressed = false;
         footswitch_right_pressed = false;
         footswitch_left_released = false;
         footswitch_right_released = false;
 
+        // No gesture handlers
+        for (int i=0;i<2;i++) {
+          gesture_init(&gesture_decoder[i], 0);
+          footswitch_stale[i] = false;
+          for (int j=0;j<GESTURE_TOTAL;j++) {
+            gesture_handlers[i][j] = NULL;
+          }
+        }
+
         // Set routes valid to false 
         valid_audio_routes = false;
         valid_control_routes = false;
+        canvas_over_capacity = false;
+
+        // No shadow canvas loaded
+        shadow_canvas_loaded = false;
+        shadow_params_stale = false;
+        total_live_instances = 0;
 
         status = &dsp_status;
 
-        // Set last service timetamp
-        last_service_ts = millis();
+        // No parameter ramps running
+        for (int i=0;i<MAX_PARAM_RAMPS;i++) {
+          param_ramps[i].effect = NULL;
+        }
+
+        // No parameter updates waiting
+        clear_param_updates();
+        param_update_stats.budget_words = PARAM_UPDATE_BUDGET_WORDS;
+        reset_param_update_stats();
+
+        // No scheduled updates; the DSP clock runs at its nominal rate until
+        // the DSP reports its block counter
+        clear_scheduled_params();
+        schedule_active = false;
+        dsp_clock.synced = false;
+        dsp_clock.ref_block = 0;
+        dsp_clock.ref_frac = 0.0;
+        dsp_clock.ref_us = micros();
+        dsp_clock.blocks_per_us = (float) DSP_SAMPLE_RATE_HZ / (DSP_BLOCK_SAMPLES * 1000000.0);
+        dsp_clock.last_count_us = 0;
+
+        // No control stream
+        control_stream.pot = NULL;
+        reset_control_stream_stats();
+
+        // No MIDI input
+        midi_port = NULL;
+        midi_parser_init(&midi_parser);
+        total_midi_routes = 0;
+        midi_note_channel = UNDEFINED;
+        midi_note = UNDEFINED;
+        midi_note_pending = 0;
+        midi_values_pending = false;
+        midi_frame_pending = false;
+        midi_clock.enabled = false;
+        midi_clock.total_ticks = 0;
+        midi_clock.next_tick = 0;
+        midi_clock.count = 0;
+        midi_clock.reported_ms = 0.0;
+        reset_midi_stats();
+
+        // No modulation matrix
+        mod_matrix = NULL;
+
+        // Periodic work done by service()
+        add_service_tasks();
+        input_events_handled = 0;
+        input_latency_total_us = 0;
+        input_latency_max_us = 0;
+        tap_count = 0;
+        tap_restarts = 0;
+        gesture_events = 0;
+        gesture_latency_total_us = 0;
+        gesture_latency_max_us = 0;
 
     }
     #endif    // DOXYGEN_SHOULD_SKIP_THIS
@@ -895,6 +1458,17 @@ class fx_pedal {
     bool    run(void);
     void    service(void);
 
+    // Save / restore the canvas as a binary image
+    uint32_t save_canvas(uint8_t * image, uint32_t max_len);
+    bool     load_canvas(const uint8_t * image, uint32_t len);
+
+    // Preload the next canvas while the current one is running, then swap to it
+    void    new_canvas(void);
+    bool    preload(void);
+    bool    preload_canvas(const uint8_t * image, uint32_t len);
+    bool    swap_canvas(void);
+    bool    swap_canvas(uint16_t crossfade_blocks);
+
     // Canvas configuration
 
     // Route audio and control links
@@ -906,6 +1480,9 @@ class fx_pedal {
     void    add_bypass_button(FOOTSWITCH footswitch);
     void    add_tap_interval_button(FOOTSWITCH footswitch, bool enable_led_flash);
 
+    // Attach a modulation matrix that maps pots, tap tempo, etc. to parameters
+    void    add_mod_matrix(fx_mod_matrix * matrix);
+
     // Canvas control
     void    bypass_fx(void);
     void    enable_fx(void);
@@ -917,6 +1494,8 @@ class fx_pedal {
     bool    new_tap_interval(void);
     float   get_tap_interval_ms(void);
     float   get_tap_freq_hz(void);
+    float   get_tap_phase(void);
+    float   get_tap_confidence(void);
     void    set_tap_blink_rate_hz(float rate_hz);
     void    set_tap_blink_rate_hz(float rate_hz, FOOTSWITCH led);
     void    set_tap_blink_rate_ms(float ms);
@@ -925,12 +1504,19 @@ class fx_pedal {
     // Events for when a button is pressed and released
     bool    button_pressed(FOOTSWITCH footswitch, bool enable_led);
     bool    button_released(FOOTSWITCH footswitch, bool enable_led);
+
+    // Handlers for taps, double taps and long presses of a footswitch
+    bool    add_gesture_handler(FOOTSWITCH footswitch, FOOTSWITCH_GESTURE gesture, void (*handler)(void));
   
     // Register a tap for tap reading
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
-      void    register_tap(void);
+      void    register_tap(uint32_t tap_ms);
+      bool    fit_tap_tempo(void);
+      uint32_t get_tap_beat_ms(uint32_t now_ms);
       void    button_press_check(void);
       void    service_button_events(void);
+      void    handle_footswitch_edge(FOOTSWITCH footswitch, bool pressed, uint32_t time_us);
+      void    dispatch_gestures(FOOTSWITCH footswitch, const FX_GESTURE_EVENT * events, int count);
 #endif  // DOXYGEN_SHOULD_SKIP_THIS
 
     // Utility functions to print the instance and routing stack
@@ -939,6 +1525,55 @@ class fx_pedal {
     void    print_param_tables(void);
     void    print_processor_load(int seconds);
 
+    // Periodic tasks run by service() alongside the pedal's own
+    int     add_task(void (*task)(void), uint32_t period_ms);
+    int     add_task(void (*task)(void), uint32_t period_ms, uint32_t budget_us);
+    bool    get_task_stats(int task_id, FX_TASK_STATS * stats);
+    void    reset_task_stats(void);
+    void    print_task_stats(void);
+    void    get_input_stats(FX_INPUT_STATS * stats);
+    void    reset_input_stats(void);
+
+    // Where loop() time goes (build with DM_FX_PROFILE)
+    void    print_profile(void);
+    void    reset_profile(void);
+
+    // Parameter update scheduler
+    void    set_param_update_budget(uint16_t words_per_tick);
+    void    get_param_update_stats(FX_PARAM_UPDATE_STATS * stats);
+    void    reset_param_update_stats(void);
+
+    // Live values of parameters, including ones driven by control routes
+    bool    add_param_readback(fx_control_node * node);
+    bool    read_param(fx_control_node * node, float * value);
+
+    // Apply the parameter changes made by setters at a DSP block or tap tempo beat
+    uint32_t get_dsp_block(void);
+    bool    schedule_params_at_beat(void);
+    void    schedule_params_at_block(uint32_t block);
+    void    end_scheduled_params(void);
+
+    // Stream a pot to a control node at the pot rate, smoothed on the DSP
+    bool    stream_control(fx_pot * pot, fx_control_node * dest, float min, float max);
+    void    stop_control_stream(void);
+    void    get_control_stream_stats(FX_CONTROL_STREAM_STATS * stats);
+    void    reset_control_stream_stats(void);
+
+    // MIDI input routed to effect parameters, the canvas note nodes and the tempo
+    void    set_midi_input(Stream * port);
+    void    midi_receive(uint8_t b);
+    bool    route_midi_cc(uint8_t channel, uint8_t cc, fx_control_node * dest, float min, float max);
+    bool    route_midi_notes(uint8_t channel);
+    bool    route_midi_notes(uint8_t channel, fx_control_node * dest);
+    void    use_midi_clock(bool enable);
+    void    get_midi_stats(FX_MIDI_STATS * stats);
+    void    reset_midi_stats(void);
+
+    // Memory footprint of the pedal and the canvas
+    void    get_memory_report(FX_MEMORY_REPORT * report);
+    bool    get_instance_memory(uint8_t instance, FX_INSTANCE_MEMORY * mem);
+    void    print_memory_report(void);
+
         // Supporting functions control
     #ifndef DOXYGEN_SHOULD_SKIP_THIS
       void    spi_transmit_param(EFFECT_TYPE instance_type, uint32_t instance_id, PARAM_TYPES param_type, uint8_t param_id, void * value);
@@ -963,6 +1598,9 @@ class fx_effect {
   protected:
 
     friend fx_pedal;
+    friend fx_audio_node;
+    friend fx_control_node;
+    friend fx_mod_matrix;
 
 
     EFFECT_TYPE     type;
@@ -973,16 +1611,22 @@ class fx_effect {
     fx_control_node * control_node_stack[MAX_NODES_PER_FX];
     int             total_control_nodes;
 
-    // Parameter stack
-    void            * param_stack[MAX_PARMS_PER_FX];
-    PARAM_TYPES     param_stack_types[MAX_PARMS_PER_FX];
+    // Parameter descriptor table (in flash)
+    const FX_PARAM_DESC * param_table;
+    uint8_t         param_table_len;
 
-    // total number of parameters that this effect has
-    int             total_params;
+    // Entries from param_group_first to the end of the table are serialized 
+    // param_group_count times, param_group_stride bytes apart (e.g. arrays of steps)
+    uint8_t         param_group_first;
+    uint8_t         param_group_count;
+    uint16_t        param_group_stride;
 
     // Universal effect parameters
     bool            param_enabled;
 
+    // Setters filter small changes through the parameter deadbands
+    bool            param_deadbands;
+
     fx_audio_node   node_input;
     fx_audio_node   node_output;
     fx_control_node node_enabled;
@@ -998,9 +1642,39 @@ class fx_effect {
     bool get_audio_node_index(fx_audio_node * node, uint8_t * local_node_index);
     bool get_control_node_index(fx_control_node * node, uint8_t * local_node_index);
 
+    void  set_param_table(const FX_PARAM_DESC * table, uint8_t len);
+    void  set_param_group(uint8_t first, uint8_t count, uint16_t stride);
     uint16_t * serialize_params(uint16_t * serialized_params, uint16_t * size);
-    bool  float_param_updated( float * param, float * param_last, float threshold );
-    bool  bool_param_updated( bool * param, bool * param_last );
+    bool  get_param_float(uint8_t wire_offset, float * value);
+    const FX_PARAM_DESC * get_param_desc(const void * param);
+    bool  float_within_deadband(float * param, float value);
+    bool  float_within_deadband(float * param, float value, float range_lo, float range_hi);
+    void  transmit_param(const void * param);
+
+    // Used by CHECK_LAST() and set_param(); floats are compared after the 
+    // conversion the setter makes and go through the parameter's deadband, 
+    // everything else must match exactly
+    template<typename P, typename V> bool param_unchanged(P * param, V value) { return *param == value; }
+    template<typename V> bool param_unchanged(float * param, V value) { return float_within_deadband(param, (float) value); }
+    bool  ramp_param(float * param, fx_control_node * node, float target, uint32_t duration_ms);
+    void  stop_ramp(float * param);
+    template<typename P> void stop_ramp(P *) { }
+
+    // Effect setters write parameters through set_param(), which takes the 
+    // parameter id and wire type from the member's entry in the parameter 
+    // table.  The write is skipped while the parameter's control node is 
+    // driven by a control route.
+    template<typename P, typename V> void set_param(P * param, V value, fx_control_node * node) {
+      stop_ramp(param);
+      if ((node != NULL && node->connected) || param_unchanged(param, value)) {
+        return;
+      }
+      *param = (P) value;
+      transmit_param(param);
+    }
+    template<typename P, typename V> void set_param(P * param, V value) {
+      set_param(param, value, (fx_control_node *) NULL);
+    }
 
 
   public:
@@ -1010,6 +1684,16 @@ class fx_effect {
      #ifndef DOXYGEN_SHOULD_SKIP_THIS
       // String name of current effect    
       char  effect_name[32];
+
+      // Parameters in wire order (effects without their own table, like the 
+      // mixers, only have the enable flag)
+      FX_PARAM_TABLE(fx_effect,
+        FX_PARAM(param_enabled, T_BOOL, FX_PARAM_ID_ENABLED, FX_PARAM_OFFSET_ENABLED)
+      );
+
+      // First entry of the parameter table that repeats (see set_param_group()), 
+      // FX_PARAM_GROUP_NONE if the parameter block has a fixed size
+      static uint8_t get_class_param_group_first(void) { return FX_PARAM_GROUP_NONE; }
       
       // Constructor
       fx_effect() : 
@@ -1026,11 +1710,12 @@ class fx_effect {
           total_control_nodes = 0;
           control_node_stack[total_control_nodes++] = &node_enabled;
           
-          // Set up initial parameter stack
+          // Set up initial parameter table (effects replace this in their init())
           param_enabled = true;
-          param_stack[0] = &param_enabled;
-          param_stack_types[0] = T_BOOL;
-          total_params = 1;
+          FX_PARAM_TABLE_INIT();
+
+          // Setters ignore changes within the parameter deadbands
+          param_deadbands = true;
 
           // Node index has not been assigned
           node_index = 0;
@@ -1041,6 +1726,9 @@ class fx_effect {
           // Set instance ID to 0xFF (meaning it hasn't been routed/placed yet)
           instance_id = 0xFF;
 
+          // There is only one canvas
+          parent_canvas = &pedal;
+
       }
 
       bool  service(void);
@@ -1065,11 +1753,23 @@ class fx_effect {
      */
     void  bypass(void) { param_enabled = false; }
 
+    /**
+     * @brief      Turns the parameter deadbands of this effect's setters on or 
+     *             off.  They are on by default so a setter fed from a pot 
+     *             ignores the noise around the pot position; turn them off 
+     *             when a sketch needs every change sent, however small.
+     *
+     * @param[in]  enabled  True to ignore small changes, false to send every 
+     *                      change
+     */
+    void  set_param_deadbands(bool enabled) { param_deadbands = enabled; }
+
     #ifndef DOXYGEN_SHOULD_SKIP_THIS
     void print_ctrl_node_status(fx_control_node * t) {
       char buf[64];
+      uint16_t id = t->get_node_id();
 
-      sprintf(buf," + [%s] %s: ", (t->node_direction==NODE_IN?"ctrl-in":"ctrl-out"), t->node_name);  Serial.print(buf);
+      sprintf(buf," + [%s %02x.c%u] %s: ", (t->node_direction==NODE_IN?"ctrl-in":"ctrl-out"), id >> 8, id & 0x7F, t->node_name);  Serial.print(buf);
       if (t->connected) {
         Serial.println("routed");
       } else {
@@ -1079,7 +1779,9 @@ class fx_effect {
 
     void print_audio_node_status(fx_audio_node * t) {
       char buf[64];
-      sprintf(buf," * [%s] %s: ", (t->node_direction==NODE_IN?"audio-in":"audio-out"), t->node_name);  Serial.print(buf);
+      uint16_t id = t->get_node_id();
+
+      sprintf(buf," * [%s %02x.a%u] %s: ", (t->node_direction==NODE_IN?"audio-in":"audio-out"), id >> 8, id & 0x7F, t->node_name);  Serial.print(buf);
       if (t->connected) {
         Serial.println("routed");
       } else {
@@ -1087,7 +1789,7 @@ class fx_effect {
       }
     }
 
-    void print_parameter( void * val, char * name, PARAM_TYPES type) {
+    void print_parameter( void * val, const char * name, PARAM_TYPES type) {
       char buf[64];
       if (type == T_FLOAT) {
         sprintf(buf," %s: %.2f", name, *(float*) val);  Serial.println(buf);
@@ -1100,8 +1802,6 @@ class fx_effect {
     #endif 
 };
 
-#include "effects/dm_fx_effect_macros.h"
-
 #include "effects/dm_fx_adsr_envelope.h"
 #include "effects/dm_fx_allpass_filter.h"
 #include "effects/dm_fx_amplitude_modulator.h"
@@ -68,7 +68,7 @@ private:
     float param_peak_ratio;
     float param_sustain_ratio;
     float param_out_vol;
-    bool  param_look_ahead;
+    int16_t param_look_ahead;
 
     // Control nodes
     fx_control_node node_ctrl_attack_ms;
@@ -92,30 +92,8 @@ private:
       input = &node_input;
       output = &node_output;
 
-      // Initialize parameter stack
-      int indx = 1;
-      param_stack[indx] = &param_attack_ms;
-      param_stack_types[indx++] = T_FLOAT;
-      param_stack[indx] = &param_decay_ms;
-      param_stack_types[indx++] = T_FLOAT;
-      param_stack[indx] = &param_sustain_ms;
-      param_stack_types[indx++] = T_FLOAT;
-      param_stack[indx] = &param_release_ms;
-      param_stack_types[indx++] = T_FLOAT;
-
-      param_stack[indx] = &param_peak_ratio;
-      param_stack_types[indx++] = T_FLOAT;
-      param_stack[indx] = &param_sustain_ratio;
-      param_stack_types[indx++] = T_FLOAT;
-
-      param_stack[indx] = &param_out_vol;
-      param_stack_types[indx++] = T_FLOAT;
-
-      param_stack[indx] = &param_look_ahead;
-      param_stack_types[indx++] = T_INT16;
-
-
-      total_params = indx;
+      // Initialize parameter table
+      FX_PARAM_TABLE_INIT();
 
       // Add addiitonal notes to the control stack
       control_node_stack[total_control_nodes++] = &node_ctrl_attack_ms;
@@ -142,6 +120,21 @@ private:
 
  public:
 
+    #ifndef DOXYGEN_SHOULD_SKIP_THIS
+    // Parameters in wire order (see FX_PARAM_TABLE() in dm_fx_effect_macros.h)
+    FX_PARAM_TABLE(fx_adsr_envelope,
+      FX_PARAM(param_enabled,       T_BOOL,  FX_ADSR_PARAM_ID_ENABLED,       FX_ADSR_OFFSET_ENABLED),
+      FX_PARAM(param_attack_ms,     T_FLOAT, FX_ADSR_PARAM_ID_ATK_MS,        FX_ADSR_OFFSET_ATK_MS),
+      FX_PARAM(param_decay_ms,      T_FLOAT, FX_ADSR_PARAM_ID_DEC_MS,        FX_ADSR_OFFSET_DEC_MS),
+      FX_PARAM(param_sustain_ms,    T_FLOAT, FX_ADSR_PARAM_ID_SUS_MS,        FX_ADSR_OFFSET_SUS_MS),
+      FX_PARAM(param_release_ms,    T_FLOAT, FX_ADSR_PARAM_ID_RLS_MS,        FX_ADSR_OFFSET_RLS_MS),
+      FX_PARAM(param_peak_ratio,    T_FLOAT, FX_ADSR_PARAM_ID_PEAK_RATIO,    FX_ADSR_OFFSET_RATIO_PEAK),
+      FX_PARAM(param_sustain_ratio, T_FLOAT, FX_ADSR_PARAM_ID_SUSTAIN_RATIO, FX_ADSR_OFFSET_RATIO_SUSTAIN),
+      FX_PARAM(param_out_vol,       T_FLOAT, FX_ADSR_PARAM_ID_OUT_VOL,       FX_ADSR_OFFSET_VOL_OUT),
+      FX_PARAM(param_look_ahead,    T_INT16, FX_PARAM_ID_NONE,               FX_ADSR_OFFSET_LOOKAHEAD)
+    );
+    #endif
+
    /**
      * Audio routing node: primary audio input
      */
@@ -253,18 +246,14 @@ private:
      * @brief      Enable the __this_effect__ (it is enabled by default)
      */
     void enable() {
-      CHECK_LAST_ENABLED();
-      param_enabled = true; 
-      parent_canvas->spi_transmit_param(FX_ADSR_ENVELOPE, instance_id, T_BOOL, FX_ADSR_PARAM_ID_ENABLED, (void *) &param_enabled);
+      set_param(&param_enabled, true);
     }
 
     /**
      * @brief      Bypass the __this_effect__ (will just pass clean audio through)
      */
     void bypass() {
-      CHECK_LAST_DISABLED();
-      param_enabled = false; 
-      parent_canvas->spi_transmit_param(FX_ADSR_ENVELOPE, instance_id, T_BOOL, FX_ADSR_PARAM_ID_ENABLED, (void *) &param_enabled);
+      set_param(&param_enabled, false);
     }      
 
 
@@ -276,16 +265,7 @@ private:
      * @param[in]  attack  The attack time in milliseconds
      */
     void set_attack_ms(float attack) {
-      CHECK_LAST(attack, param_attack_ms);
-
-      // If this node is being controlled by a controller, don't allow a direct write to it
-      if (node_ctrl_attack_ms.connected) {
-        return;
-      }
-
-      param_attack_ms = attack; 
-      parent_canvas->spi_transmit_param(FX_ADSR_ENVELOPE, instance_id, T_FLOAT, FX_ADSR_PARAM_ID_ATK_MS, &param_attack_ms);
-
+      set_param(&param_attack_ms, attack, &node_ctrl_attack_ms);
     }
 
     /**
@@ -294,16 +274,7 @@ private:
      * @param[in]  decay  The decay time in milliseconds
      */
     void set_decay_ms(float decay) {
-      CHECK_LAST(decay, param_decay_ms);
-
-      // If this node is being controlled by a controller, don't allow a direct write to it
-      if (node_ctrl_decay_ms.connected) {
-        return;
-      }
-
-      param_decay_ms = decay; 
-      parent_canvas->spi_transmit_param(FX_ADSR_ENVELOPE, instance_id, T_FLOAT, FX_ADSR_PARAM_ID_DEC_MS, &param_decay_ms);
-
+      set_param(&param_decay_ms, decay, &node_ctrl_decay_ms);
     }
 
     /**
@@ -312,27 +283,11 @@ private:
      * @param[in]  sustain  The sustain time in milliseconds
      */
     void set_sustain_ms(float sustain) {
-      CHECK_LAST(sustain, param_sustain_ms);
-
-      // If this node is being controlled by a controller, don't allow a direct write to it
-      if (node_ctrl_sustain_ms.connected) {
-        return;
-      }
-
-      param_sustain_ms = sustain; 
-      parent_canvas->spi_transmit_param(FX_ADSR_ENVELOPE, instance_id, T_FLOAT, FX_ADSR_PARAM_ID_SUS_MS, &param_sustain_ms);
+      set_param(&param_sustain_ms, sustain, &node_ctrl_sustain_ms);
     }
 
     void set_release_ms(float release) {
-      CHECK_LAST(release, param_release_ms);
-
-      // If this node is being controlled by a controller, don't allow a direct write to it
-      if (node_ctrl_release_ms.connected) {
-        return;
-      }
-
-      param_release_ms = release; 
-      parent_canvas->spi_transmit_param(FX_ADSR_ENVELOPE, instance_id, T_FLOAT, FX_ADSR_PARAM_ID_RLS_MS, &param_release_ms);
+      set_param(&param_release_ms, release, &node_ctrl_release_ms);
     }
 
 
@@ -342,16 +297,7 @@ private:
      * @param[in]  gain  The gain value (linear)
      */
     void set_output_gain(float gain) {
-
-      CHECK_LAST(gain, param_out_vol);
-
-      // If this node is being controlled by a controller, don't allow a direct write to it
-      if (node_ctrl_out_vol.connected) {
-        return;
-      }
-
-      param_out_vol = gain; 
-      parent_canvas->spi_transmit_param(FX_ADSR_ENVELOPE, instance_id, T_FLOAT, FX_ADSR_PARAM_ID_OUT_VOL, &param_out_vol);      
+      set_param(&param_out_vol, gain, &node_ctrl_out_vol);
     }
 
 
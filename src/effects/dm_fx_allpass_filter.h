@@ -35,14 +35,8 @@ private:
     input = &node_input;
     output = &node_output;
 
-      // Initialize parameter stack
-    int indx = 1;
-    param_stack[indx] = &param_gain;
-    param_stack_types[indx++] = T_FLOAT;
-    param_stack[indx] = &param_length_ms;
-    param_stack_types[indx++] = T_FLOAT;
-
-    total_params = indx;         
+    // Initialize parameter table
+    FX_PARAM_TABLE_INIT();
 
     // Assign controls
     gain = &node_ctrl_gain;
@@ -50,6 +44,15 @@ private:
 
  public:
 
+    #ifndef DOXYGEN_SHOULD_SKIP_THIS
+    // Parameters in wire order (see FX_PARAM_TABLE() in dm_fx_effect_macros.h)
+    FX_PARAM_TABLE(fx_allpass_filter,
+      FX_PARAM(param_enabled,   T_BOOL,  FX_ALLPASS_PARAM_ID_ENABLED, FX_ALLPASS_OFFSET_ENABLED),
+      FX_PARAM(param_gain,      T_FLOAT, FX_ALLPASS_PARAM_ID_GAIN,    FX_ALLPASS_OFFSET_GAIN),
+      FX_PARAM(param_length_ms, T_FLOAT, FX_PARAM_ID_NONE,            FX_ALLPASS_OFFSET_LENGTH_MS)
+    );
+    #endif
+
  /**
    * Audio routing node: primary audio input
    */
@@ -85,19 +88,15 @@ private:
   /**
    * @brief      Enanle the allpass filter
    */
-  void enable() {    
-    CHECK_LAST_ENABLED();
-    param_enabled = true; 
-    parent_canvas->spi_transmit_param(FX_ALLPASS_FILTER, instance_id, T_BOOL, FX_ALLPASS_PARAM_ID_ENABLED, (void *) &param_enabled);
+  void enable() {
+    set_param(&param_enabled, true);
   }
 
   /**
    * @brief      Bypass the allpass filter  (will just pass clean audio through)
    */
   void bypass() {
-    CHECK_LAST_DISABLED();
-    param_enabled = false; 
-    parent_canvas->spi_transmit_param(FX_ALLPASS_FILTER, instance_id, T_BOOL, FX_ALLPASS_PARAM_ID_ENABLED, (void *) &param_enabled);
+    set_param(&param_enabled, false);
   }  
 
   /**
@@ -105,15 +104,8 @@ private:
    *
    * @param[in]  gain  Gain of the offpass filter
    */
-  void set_gain(float gain) { 
-    CHECK_LAST(gain, param_gain);
-    
-    if (node_ctrl_gain.connected) {
-      return; 
-    }
-
-    param_gain = gain; 
-    parent_canvas->spi_transmit_param(FX_ALLPASS_FILTER, instance_id, T_FLOAT, FX_ALLPASS_PARAM_ID_GAIN, &param_gain);
+  void set_gain(float gain) {
+    set_param(&param_gain, gain, &node_ctrl_gain);
   }
 
   /**
@@ -64,7 +64,6 @@ class fx_amplitude_mod: public fx_effect {
     float     param_phase_deg;
     bool      param_ext_modulator;
 
-    OSC_TYPES last_type;
 
     void init() {
 	    // Set class
@@ -78,23 +77,8 @@ class fx_amplitude_mod: public fx_effect {
 	    output = &node_output;
 	    ext_mod_in = &node_loop_ext_mod;      
 
-		  	// Initialize parameter stack
-	    int indx = 1;
-	    param_stack[indx] = &param_rate_hz;
-	    param_stack_types[indx++] = T_FLOAT;
-
-      param_stack[indx] = &param_phase_deg;
-      param_stack_types[indx++] = T_FLOAT;
-
-	    param_stack[indx] = &param_depth;
-	    param_stack_types[indx++] = T_FLOAT;
-
-	    param_stack[indx] = &param_type;
-	    param_stack_types[indx++] = T_INT16;
-
-	    param_stack[indx] = &param_ext_modulator;
-	    param_stack_types[indx++] = T_BOOL;
-	    total_params = indx;         
+	    // Initialize parameter table
+	    FX_PARAM_TABLE_INIT();
 
 	   	// Add additional nodes to the audio stack
 	    audio_node_stack[total_audio_nodes++] = &node_loop_ext_mod;
@@ -114,6 +98,18 @@ class fx_amplitude_mod: public fx_effect {
 
  public:
 
+    #ifndef DOXYGEN_SHOULD_SKIP_THIS
+    // Parameters in wire order (see FX_PARAM_TABLE() in dm_fx_effect_macros.h)
+    FX_PARAM_TABLE(fx_amplitude_mod,
+      FX_PARAM(param_enabled,       T_BOOL,  FX_AMP_MOD_PARAM_ID_ENABLED,   FX_AMP_MOD_OFFSET_ENABLED),
+      FX_PARAM(param_rate_hz,       T_FLOAT, FX_AMP_MOD_PARAM_ID_MOD_FREQ,  FX_AMP_MOD_OFFSET_MOD_FREQ),
+      FX_PARAM(param_phase_deg,     T_FLOAT, FX_AMP_MOD_PARAM_ID_MOD_PHASE, FX_AMP_MOD_OFFSET_MOD_PHASE),
+      FX_PARAM(param_depth,         T_FLOAT, FX_AMP_MOD_PARAM_ID_MOD_DEPTH, FX_AMP_MOD_OFFSET_MOD_DEPTH),
+      FX_PARAM(param_type,          T_INT16, FX_AMP_MOD_PARAM_ID_MOD_TYPE,  FX_AMP_MOD_OFFSET_MOD_TYPE),
+      FX_PARAM(param_ext_modulator, T_BOOL,  FX_AMP_MOD_PARAM_ID_EXT_MOD,   FX_AMP_MOD_OFFSET_EXT_MOD)
+    );
+    #endif
+
 
 
 	/**
@@ -157,7 +153,7 @@ class fx_amplitude_mod: public fx_effect {
 			// Set parameters
 	    param_depth = depth;
 	    param_rate_hz = rate_hz;
-	    last_type = param_type = OSC_SINE;
+	    param_type = OSC_SINE;
 	    param_ext_modulator = false;
       param_phase_deg = 0;
 
@@ -190,7 +186,7 @@ class fx_amplitude_mod: public fx_effect {
 	    param_depth = depth;
 	    param_rate_hz = rate_hz;
       param_phase_deg = initial_phase_deg;      
-	    last_type = param_type = modulation_type;
+	    param_type = modulation_type;
 	    param_ext_modulator = use_ext_modulator;
 
 	    init();
@@ -199,19 +195,15 @@ class fx_amplitude_mod: public fx_effect {
   /**
    * @brief      Enable the amplitude modululator (it is enabled by default)
    */
-  void enable() {    
-    CHECK_LAST_ENABLED();
-    param_enabled = true; 
-    parent_canvas->spi_transmit_param(FX_AMPLITUDE_MODULATOR, instance_id, T_BOOL, FX_AMP_MOD_PARAM_ID_ENABLED, (void *) &param_enabled);
+  void enable() {
+    set_param(&param_enabled, true);
   }
 
   /**
    * @brief      Bypass the amplitude modululator  (will just pass clean audio through)
    */
   void bypass() {
-    CHECK_LAST_DISABLED();
-    param_enabled = false; 
-    parent_canvas->spi_transmit_param(FX_AMPLITUDE_MODULATOR, instance_id, T_BOOL, FX_AMP_MOD_PARAM_ID_ENABLED, (void *) &param_enabled);
+    set_param(&param_enabled, false);
   }  
 
 
@@ -226,15 +218,18 @@ class fx_amplitude_mod: public fx_effect {
    * @param[in]  depth  The depth fom 0.0 -> 1.0.  0.0 is no modulation at all,
    *                    1.0 is full modulation.
    */
-  void set_depth(float depth) { 
-    CHECK_LAST(depth, param_depth);
-    
-    if (node_ctrl_depth.connected) {
-      return; 
-    }
+  void set_depth(float depth) {
+    set_param(&param_depth, depth, &node_ctrl_depth);
+  }
 
-    param_depth = depth; 
-    parent_canvas->spi_transmit_param(FX_AMPLITUDE_MODULATOR, instance_id, T_FLOAT, FX_AMP_MOD_PARAM_ID_MOD_DEPTH, &param_depth);
+  /**
+   * @brief      Ramps the depth of the modulator to a new value over a period of time.
+   *
+   * @param[in]  depth  The new value (0.0 -> 1.0)
+   * @param[in]  ramp_ms  The duration of the ramp in milliseconds
+   */
+  void set_depth_ramped(float depth, uint32_t ramp_ms) {
+    ramp_param(&param_depth, &node_ctrl_depth, depth, ramp_ms);
   }
 
 
@@ -243,15 +238,8 @@ class fx_amplitude_mod: public fx_effect {
    *
    * @param[in]  rate_hz  The rate hz
    */
-  void set_rate_hz(float rate_hz) { 
-    CHECK_LAST(rate_hz, param_rate_hz);
-
-    if (node_ctrl_rate_hz.connected) {
-      return; 
-    }
-
-    param_rate_hz = rate_hz; 
-    parent_canvas->spi_transmit_param(FX_AMPLITUDE_MODULATOR, instance_id, T_FLOAT, FX_AMP_MOD_PARAM_ID_MOD_FREQ, &param_rate_hz);
+  void set_rate_hz(float rate_hz) {
+    set_param(&param_rate_hz, rate_hz, &node_ctrl_rate_hz);
   }    
 
 
@@ -261,15 +249,7 @@ class fx_amplitude_mod: public fx_effect {
    * @param[in]  new_type  The new type of LFO (OSC_TYPES)
    */
   void set_lfo_type(OSC_TYPES new_type) {
-    CHECK_LAST(new_type, param_type);
-
-    param_type = new_type; 
-    
-    if (new_type != last_type) {
-      parent_canvas->spi_transmit_param(FX_AMPLITUDE_MODULATOR, instance_id, T_INT16, FX_AMP_MOD_PARAM_ID_MOD_TYPE, &param_type);
-    }
-    last_type = new_type;
-
+    set_param(&param_type, new_type);
   }
 
   /**
@@ -26,6 +26,11 @@
  * ```
  */
 
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+// Index of param_arp_steps[0].freq in the parameter table
+#define ARP_PARAM_TABLE_FIRST_STEP  (4)
+#endif
+
 class fx_arpeggiator: public fx_effect {
 
   private:
@@ -52,25 +57,11 @@ class fx_arpeggiator: public fx_effect {
       // Set name
       strcpy(effect_name, "arpeggiator");
 
-        // Initialize parameter stack
-      int indx = 1;
-      param_stack[indx] = &param_total_steps;
-      param_stack_types[indx++] = T_INT16;
-
-      for (int i=0;i<param_total_steps;i++) {
-        param_stack[indx] = &param_arp_steps[i].freq;
-        param_stack_types[indx++] = T_FLOAT;
-        param_stack[indx] = &param_arp_steps[i].vol;
-        param_stack_types[indx++] = T_FLOAT;
-        param_stack[indx] = &param_arp_steps[i].dur;
-        param_stack_types[indx++] = T_FLOAT;
-        param_stack[indx] = &param_arp_steps[i].param_1;
-        param_stack_types[indx++] = T_FLOAT;
-        param_stack[indx] = &param_arp_steps[i].param_2;
-        param_stack_types[indx++] = T_FLOAT;
-      }
+      // Initialize parameter table
+      FX_PARAM_TABLE_INIT();
 
-      total_params = indx;            
+      // The step entries repeat for each step in the sequence
+      set_param_group(get_class_param_group_first(), param_total_steps, sizeof(ARP_STEP));
 
       // Assign controls
       time_scale = &node_ctrl_time_scale;
@@ -98,6 +89,24 @@ class fx_arpeggiator: public fx_effect {
 
   public:
 
+    #ifndef DOXYGEN_SHOULD_SKIP_THIS
+    // Parameters in wire order (see FX_PARAM_TABLE() in dm_fx_effect_macros.h)
+    FX_PARAM_TABLE(fx_arpeggiator,
+      FX_PARAM(param_enabled,              T_BOOL,  FX_ARPEGGIATOR_PARAM_ID_ENABLE, FX_ARPEGGIATOR_OFFSET_EN),
+      FX_PARAM_LIVE(param_time_scale,      T_FLOAT, FX_ARPEGGIATOR_PARAM_ID_TIME_SCALE),
+      FX_PARAM_LIVE(param_period_ms,       T_FLOAT, FX_ARPEGGIATOR_PARAM_ID_PERIOD),
+      FX_PARAM(param_total_steps,          T_INT16, FX_PARAM_ID_NONE,               FX_ARPEGGIATOR_OFFSET_TOTAL_STEPS),
+      FX_PARAM_DB(param_arp_steps[0].freq,    T_FLOAT, FX_PARAM_ID_NONE,               FX_ARPEGGIATOR_OFFSET_STEPS, FX_DEADBAND_REL(0.001)),
+      FX_PARAM(param_arp_steps[0].vol,     T_FLOAT, FX_PARAM_ID_NONE,               FX_ARPEGGIATOR_OFFSET_STEPS + 2),
+      FX_PARAM(param_arp_steps[0].dur,     T_FLOAT, FX_PARAM_ID_NONE,               FX_ARPEGGIATOR_OFFSET_STEPS + 4),
+      FX_PARAM(param_arp_steps[0].param_1, T_FLOAT, FX_PARAM_ID_NONE,               FX_ARPEGGIATOR_OFFSET_STEPS + 6),
+      FX_PARAM(param_arp_steps[0].param_2, T_FLOAT, FX_PARAM_ID_NONE,               FX_ARPEGGIATOR_OFFSET_STEPS + 8)
+    );
+
+    // The entries from the first step on repeat for each step in the sequence
+    static uint8_t get_class_param_group_first(void) { return ARP_PARAM_TABLE_FIRST_STEP; }
+    #endif
+
     /**
      * Control routing node: Time scale of arpeggiator (aka playback rate).  A value of 1.0 runs arpeggiator at default speed.  Lower is slower, higher is faster.
      */
@@ -191,18 +200,8 @@ class fx_arpeggiator: public fx_effect {
      *
      * @param[in]  new_time_scale  The new time scale ratio (1.0 is current time scale, > 1.0 is faster, < 1.0 is slower)
      */
-    void set_time_scale(float new_time_scale) { 
-
-      CHECK_LAST(new_time_scale, param_time_scale);
-
-      // If this node is being controlled by a controller, don't allow a direct write to it
-      if (node_ctrl_time_scale.connected) {
-        return;
-      }
-
-
-      param_time_scale = new_time_scale;
-      parent_canvas->spi_transmit_param(FX_ARPEGGIATOR, instance_id, T_FLOAT, FX_ARPEGGIATOR_PARAM_ID_TIME_SCALE, (void *) &param_time_scale);
+    void set_time_scale(float new_time_scale) {
+      set_param(&param_time_scale, new_time_scale, &node_ctrl_time_scale);
     }
 
     /**
@@ -210,17 +209,8 @@ class fx_arpeggiator: public fx_effect {
      *
      * @param[in]  new_duration  The new duration in milliseconds
      */
-    void set_duration_ms(float new_duration) { 
-
-      CHECK_LAST(new_duration, param_period_ms);
-
-      // If this node is being controlled by a controller, don't allow a direct write to it
-      if (node_ctrl_period_ms.connected) {
-        return;
-      }
-
-      param_period_ms = new_duration;
-      parent_canvas->spi_transmit_param(FX_ARPEGGIATOR, instance_id, T_FLOAT, FX_ARPEGGIATOR_PARAM_ID_PERIOD, (void *) &param_period_ms);
+    void set_duration_ms(float new_duration) {
+      set_param(&param_period_ms, new_duration, &node_ctrl_period_ms);
     }
 
 
@@ -254,7 +244,7 @@ class fx_arpeggiator: public fx_effect {
 
 
         Serial.println(instance_id);
-        Serial.println(total_params);
+        Serial.println(param_table_len);
 
         Serial.println();
       }
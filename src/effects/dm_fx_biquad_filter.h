@@ -89,21 +89,8 @@ class fx_biquad_filter: public fx_effect {
 	    input = &node_input;
 	    output = &node_output;
 	    
-			// Initialize parameter stack
-	    int indx = 1;
-	    param_stack[indx] = &param_type;
-	    param_stack_types[indx++] = T_INT16;
-	    param_stack[indx] = &param_speed;
-	    param_stack_types[indx++] = T_INT16;
-	    param_stack[indx] = &param_freq;
-	    param_stack_types[indx++] = T_FLOAT;
-	    param_stack[indx] = &param_q;
-	    param_stack_types[indx++] = T_FLOAT;
-	    param_stack[indx] = &param_gain;
-	    param_stack_types[indx++] = T_FLOAT;
-      param_stack[indx] = &param_order;
-      param_stack_types[indx++] = T_INT16;
-	    total_params = indx;    
+	    // Initialize parameter table
+	    FX_PARAM_TABLE_INIT();
 
 	    // Add addititonal nodes to the control stack
 	    control_node_stack[total_control_nodes++] = &node_ctrl_freq;
@@ -120,6 +107,19 @@ class fx_biquad_filter: public fx_effect {
 
  public:
 
+    #ifndef DOXYGEN_SHOULD_SKIP_THIS
+    // Parameters in wire order (see FX_PARAM_TABLE() in dm_fx_effect_macros.h)
+    FX_PARAM_TABLE(fx_biquad_filter,
+      FX_PARAM(param_enabled, T_BOOL,  FX_BIQUAD_PARAM_ID_ENABLED, FX_BIQUAD_PARAM_OFFSET_EN),
+      FX_PARAM(param_type,    T_INT16, FX_BIQUAD_PARAM_ID_TYPE,    FX_BIQUAD_PARAM_OFFSET_TYPE),
+      FX_PARAM(param_speed,   T_INT16, FX_BIQUAD_PARAM_ID_SPEED,   FX_BIQUAD_PARAM_OFFSET_SPEED),
+      FX_PARAM(param_freq,    T_FLOAT, FX_BIQUAD_PARAM_ID_FREQ,    FX_BIQUAD_PARAM_OFFSET_FREQ),
+      FX_PARAM(param_q,       T_FLOAT, FX_BIQUAD_PARAM_ID_Q,       FX_BIQUAD_PARAM_OFFSET_Q),
+      FX_PARAM(param_gain,    T_FLOAT, FX_BIQUAD_PARAM_ID_GAIN,    FX_BIQUAD_PARAM_OFFSET_GAIN),
+      FX_PARAM(param_order,   T_INT16, FX_BIQUAD_PARAM_ID_ORDER,   FX_BIQUAD_PARAM_OFFSET_ORDER)
+    );
+    #endif
+
 	/**
 	 * Audio routing node: primary audio input
 	 */
@@ -290,18 +290,14 @@ class fx_biquad_filter: public fx_effect {
    * @brief      Enable the biquad filter (it is enabled by default)
    */
   void enable() {
-    CHECK_LAST_ENABLED();
-    param_enabled = true; 
-    parent_canvas->spi_transmit_param(FX_BIQUAD_FILTER, instance_id, T_BOOL, FX_BIQUAD_PARAM_ID_ENABLED, (void *) &param_enabled);
+    set_param(&param_enabled, true);
   }
 
   /**
    * @brief      Bypass the biquad filter (will just pass clean audio through)
    */
   void bypass() {
-    CHECK_LAST_DISABLED();
-    param_enabled = false; 
-    parent_canvas->spi_transmit_param(FX_BIQUAD_FILTER, instance_id, T_BOOL, FX_BIQUAD_PARAM_ID_ENABLED, (void *) &param_enabled);
+    set_param(&param_enabled, false);
   }  
 
 
@@ -310,17 +306,8 @@ class fx_biquad_filter: public fx_effect {
    *
    * @param[in]  freq  The new center frequency for the filter in Hz (must be lower than 24000.0)
    */
-  void set_freq(float freq) { 
-
-    CHECK_LAST(freq, param_freq);
-
-    // If this node is being controlled by a controller, don't allow a direct write to it
-    if (node_ctrl_freq.connected) {
-      return; 
-    }
-
-    param_freq = freq; 
-    parent_canvas->spi_transmit_param(FX_BIQUAD_FILTER, instance_id, T_FLOAT, FX_BIQUAD_PARAM_ID_FREQ, &param_freq);
+  void set_freq(float freq) {
+    set_param(&param_freq, freq, &node_ctrl_freq);
   }
 
   /**
@@ -329,16 +316,8 @@ class fx_biquad_filter: public fx_effect {
    *
    * @param[in]  q     The Q factor (must be between 0.01 and 100.0)
    */
-  void set_q(float q) { 
-
-    CHECK_LAST(q, param_q)
-
-    if (node_ctrl_q.connected) {
-      return; 
-    }
-
-    param_q = q; 
-    parent_canvas->spi_transmit_param(FX_BIQUAD_FILTER, instance_id, T_FLOAT, FX_BIQUAD_PARAM_ID_Q, &param_q);
+  void set_q(float q) {
+    set_param(&param_q, q, &node_ctrl_q);
   }    
 
   /**
@@ -360,11 +339,7 @@ class fx_biquad_filter: public fx_effect {
 
     filt_resonance = filt_resonance * 0.7071;
 
-    CHECK_LAST(filt_resonance, param_q);
-
-    param_q = filt_resonance * 0.7071;
-
-    parent_canvas->spi_transmit_param(FX_BIQUAD_FILTER, instance_id, T_FLOAT, FX_BIQUAD_PARAM_ID_Q, &param_q);
+    set_param(&param_q, filt_resonance * 0.7071);
   }   
 
   /**
@@ -372,15 +347,8 @@ class fx_biquad_filter: public fx_effect {
    *
    * @param[in]  gain  The gain in dB
    */
-  void set_gain(float gain) { 
-
-    CHECK_LAST(gain, param_gain);
-    if (node_ctrl_gain.connected) {
-      return; 
-    }
-
-    param_gain = gain; 
-    parent_canvas->spi_transmit_param(FX_BIQUAD_FILTER, instance_id, T_FLOAT, FX_BIQUAD_PARAM_ID_GAIN, &param_gain);
+  void set_gain(float gain) {
+    set_param(&param_gain, gain, &node_ctrl_gain);
   }   
 
   /**
@@ -83,19 +83,8 @@ class fx_compressor: public fx_effect {
 	    input = &node_input;
 	    output = &node_output;
 	    
-			// Initialize parameter stack
-	    int indx = 1;
-	    param_stack[indx] = &param_threshold;
-	    param_stack_types[indx++] = T_FLOAT;
-	    param_stack[indx] = &param_ratio;
-	    param_stack_types[indx++] = T_FLOAT;
-	    param_stack[indx] = &param_attack;
-	    param_stack_types[indx++] = T_FLOAT;
-	    param_stack[indx] = &param_release;
-	    param_stack_types[indx++] = T_FLOAT;
-	    param_stack[indx] = &param_gain_out;
-	    param_stack_types[indx++] = T_FLOAT;    
-	    total_params = indx;    
+	    // Initialize parameter table
+	    FX_PARAM_TABLE_INIT();
 
 	    // Add addititonal nodes to the control stack
 	    control_node_stack[total_control_nodes++] = &node_ctrl_threshold;
@@ -115,6 +104,18 @@ class fx_compressor: public fx_effect {
 
 	public:
 
+    #ifndef DOXYGEN_SHOULD_SKIP_THIS
+    // Parameters in wire order (see FX_PARAM_TABLE() in dm_fx_effect_macros.h)
+    FX_PARAM_TABLE(fx_compressor,
+      FX_PARAM(param_enabled,   T_BOOL,  FX_COMPRESSOR_PARAM_ID_ENABLED,  FX_COMPRESSOR_PARAM_OFFSET_EN),
+      FX_PARAM(param_threshold, T_FLOAT, FX_COMPRESSOR_PARAM_ID_THRESH,   FX_COMPRESSOR_PARAM_OFFSET_THRESH),
+      FX_PARAM(param_ratio,     T_FLOAT, FX_COMPRESSOR_PARAM_ID_RATIO,    FX_COMPRESSOR_PARAM_OFFSET_RATIO),
+      FX_PARAM(param_attack,    T_FLOAT, FX_COMPRESSOR_PARAM_ID_ATTACK,   FX_COMPRESSOR_PARAM_OFFSET_ATTACK),
+      FX_PARAM(param_release,   T_FLOAT, FX_COMPRESSOR_PARAM_ID_RELEASE,  FX_COMPRESSOR_PARAM_OFFSET_RELEASE),
+      FX_PARAM(param_gain_out,  T_FLOAT, FX_COMPRESSOR_PARAM_ID_OUT_GAIN, FX_COMPRESSOR_PARAM_OFFSET_OUT_GAIN)
+    );
+    #endif
+
     /**
      * Audio routing node: primary audio input
      */
@@ -184,18 +185,14 @@ class fx_compressor: public fx_effect {
      * @brief      Enable the __this_effect__ (it is enabled by default)
      */
     void enable() {
-      CHECK_LAST_ENABLED();
-      param_enabled = true; 
-      parent_canvas->spi_transmit_param(FX_COMPRESSOR, instance_id, T_BOOL, FX_COMPRESSOR_PARAM_ID_ENABLED, (void *) &param_enabled);
+      set_param(&param_enabled, true);
     }
 
     /**
      * @brief      Bypass the __this_effect__ (will just pass clean audio through)
      */
     void bypass() {
-      CHECK_LAST_DISABLED();
-      param_enabled = false; 
-      parent_canvas->spi_transmit_param(FX_COMPRESSOR, instance_id, T_BOOL, FX_COMPRESSOR_PARAM_ID_ENABLED, (void *) &param_enabled);
+      set_param(&param_enabled, false);
     }  
 
     /**
@@ -203,15 +200,8 @@ class fx_compressor: public fx_effect {
      *
      * @param[in]  threshold  The threshold is where the robot starts turning down the volume.  This value is in decibels so a good place to start is between -60.0 and -30.0  
      */
-    void set_threshold(float threshold) { 
-      CHECK_LAST(threshold, param_threshold);
-
-      if (node_ctrl_threshold.connected) {
-        return; 
-      }
-
-      param_threshold = threshold; 
-      parent_canvas->spi_transmit_param(FX_COMPRESSOR, instance_id, T_FLOAT, FX_COMPRESSOR_PARAM_ID_THRESH, &param_threshold);
+    void set_threshold(float threshold) {
+      set_param(&param_threshold, threshold, &node_ctrl_threshold);
     }  
 
     /**
@@ -219,14 +209,8 @@ class fx_compressor: public fx_effect {
      *
      * @param[in]  ratio  The ratio is how aggressively the robot will turn down the volume when the input exceeds the threshold.  Values from 2-16 create a softer effect.  A very high value of 100.0 creates a hard ceiling.
      */
-    void set_ratio(float ratio) { 
-      CHECK_LAST(ratio, param_ratio);
-
-      if (node_ctrl_ratio.connected) {
-        return; 
-      }
-      param_ratio = ratio; 
-      parent_canvas->spi_transmit_param(FX_COMPRESSOR, instance_id, T_FLOAT, FX_COMPRESSOR_PARAM_ID_RATIO, &param_ratio);
+    void set_ratio(float ratio) {
+      set_param(&param_ratio, ratio, &node_ctrl_ratio);
     }  
 
     /**
@@ -234,14 +218,8 @@ class fx_compressor: public fx_effect {
      *
      * @param[in]  attack  The attack is the time in milliseconds for robot to respond when a note exceeds the threshold.  Setting this to 20-30 will allow a bit of a peak to sneak through.
      */
-    void set_attack(float attack) { 
-      CHECK_LAST(attack, param_attack);
-
-      if (node_ctrl_attack.connected) {
-        return; 
-      }
-      param_attack = attack; 
-      parent_canvas->spi_transmit_param(FX_COMPRESSOR, instance_id, T_FLOAT, FX_COMPRESSOR_PARAM_ID_ATTACK, &param_attack);
+    void set_attack(float attack) {
+      set_param(&param_attack, attack, &node_ctrl_attack);
     }    
 
     /**
@@ -249,14 +227,8 @@ class fx_compressor: public fx_effect {
      *
      * @param[in]  release  The release is the time in milliseconds for robot to respond when a note falls below the threshold.
      */
-    void set_release(float release) { 
-      CHECK_LAST(release, param_release);
-
-      if (node_ctrl_release.connected) {
-        return; 
-      }
-      param_release = release; 
-      parent_canvas->spi_transmit_param(FX_COMPRESSOR, instance_id, T_FLOAT, FX_COMPRESSOR_PARAM_ID_RELEASE, &param_release);
+    void set_release(float release) {
+      set_param(&param_release, release, &node_ctrl_release);
     }  
 
     /**
@@ -264,14 +236,8 @@ class fx_compressor: public fx_effect {
      *
      * @param[in]  gain_out  The gain out (typically 1.0 for no gain adjustment and higher to increase gain)
      */
-    void set_output_gain(float gain_out) { 
-      CHECK_LAST(gain_out, param_gain_out);
-      
-      if (node_ctrl_out_gain.connected) {
-        return; 
-      }
-      param_gain_out = gain_out; 
-      parent_canvas->spi_transmit_param(FX_COMPRESSOR, instance_id, T_FLOAT, FX_COMPRESSOR_PARAM_ID_OUT_GAIN, &param_gain_out);
+    void set_output_gain(float gain_out) {
+      set_param(&param_gain_out, gain_out, &node_ctrl_out_gain);
     }  
 
 
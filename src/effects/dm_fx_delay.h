@@ -88,26 +88,8 @@ class fx_delay: public fx_effect {
       fx_send = &node_delay_tx;
       fx_receive = &node_delay_rx;
 
-      // Initialize parameter stack
-      int indx = 1;
-      param_stack[indx] = &param_len_ms;
-      param_stack_types[indx++] = T_FLOAT;
-
-      param_stack[indx] = &param_len_max_ms;
-      param_stack_types[indx++] = T_FLOAT;
-
-      param_stack[indx] = &param_feedback;
-      param_stack_types[indx++] = T_FLOAT;
-
-      param_stack[indx] = &param_dry_mix;
-      param_stack_types[indx++] = T_FLOAT;
-
-      param_stack[indx] = &param_wet_mix;
-      param_stack_types[indx++] = T_FLOAT;
-
-      param_stack[indx] = &param_ext_fb_processing;
-      param_stack_types[indx++] = T_BOOL;
-      total_params = indx;
+      // Initialize parameter table
+      FX_PARAM_TABLE_INIT();
 
       // Add additional nodes to the audio stack
       audio_node_stack[total_audio_nodes++] = &node_delay_rx;
@@ -129,6 +111,19 @@ class fx_delay: public fx_effect {
 
   public:
 
+    #ifndef DOXYGEN_SHOULD_SKIP_THIS
+    // Parameters in wire order (see FX_PARAM_TABLE() in dm_fx_effect_macros.h)
+    FX_PARAM_TABLE(fx_delay,
+      FX_PARAM(param_enabled,           T_BOOL,  FX_DELAY_PARAM_ID_ENABLED,    FX_DELAY_PARAM_OFFSET_EN),
+      FX_PARAM(param_len_ms,            T_FLOAT, FX_DELAY_PARAM_ID_LEN_MS,     FX_DELAY_PARAM_OFFSET_DELAY_LEN),
+      FX_PARAM(param_len_max_ms,        T_FLOAT, FX_DELAY_PARAM_ID_LEN_MAX_MS, FX_DELAY_PARAM_OFFSET_DELAY_LEN_MAX),
+      FX_PARAM(param_feedback,          T_FLOAT, FX_DELAY_PARAM_ID_FEEDBACK,   FX_DELAY_PARAM_OFFSET_DELAY_FB),
+      FX_PARAM(param_dry_mix,           T_FLOAT, FX_DELAY_PARAM_ID_DRY_MIX,    FX_DELAY_PARAM_OFFSET_DELAY_DRY),
+      FX_PARAM(param_wet_mix,           T_FLOAT, FX_DELAY_PARAM_ID_WET_MIX,    FX_DELAY_PARAM_OFFSET_DELAY_WET),
+      FX_PARAM(param_ext_fb_processing, T_BOOL,  FX_DELAY_PARAM_ID_EXT_FB,     FX_DELAY_PARAM_OFFSET_EXT_LOOP)
+    );
+    #endif
+
 
     /**
      * Audio routing node [input]: primary audio input
@@ -281,18 +276,14 @@ class fx_delay: public fx_effect {
      * @brief      Enables the delay effect
      */
     void enable() {
-      CHECK_LAST_ENABLED();
-      param_enabled = true; 
-      parent_canvas->spi_transmit_param(FX_DELAY, instance_id, T_BOOL, FX_DELAY_PARAM_ID_ENABLED, (void *) &param_enabled);
+      set_param(&param_enabled, true);
     }
 
     /**
      * @brief      Bypass the delay effect (will just pass clean audio through)
      */
     void bypass() {
-      CHECK_LAST_DISABLED();
-      param_enabled = false; 
-      parent_canvas->spi_transmit_param(FX_DELAY, instance_id, T_BOOL, FX_DELAY_PARAM_ID_ENABLED, (void *) &param_enabled);
+      set_param(&param_enabled, false);
     }
 
     /**
@@ -301,17 +292,8 @@ class fx_delay: public fx_effect {
      * If you want the ability to set a longer delay than the initial value, use the advanced constructor as this will allow you
      * to also specify the total amount of delay space to allocate which is then the maximum length of a delay.
      */
-    void set_length_ms(float len_ms) { 
-
-      CHECK_LAST(len_ms, param_len_ms);
-
-      // If this node is being controlled by a controller, don't allow a direct write to it
-      if (node_ctrl_len_ms.connected) {
-        return;
-      }
-
-      param_len_ms = len_ms; 
-      parent_canvas->spi_transmit_param(FX_DELAY, instance_id, T_FLOAT, FX_DELAY_PARAM_ID_LEN_MS, (void *) &param_len_ms);
+    void set_length_ms(float len_ms) {
+      set_param(&param_len_ms, len_ms, &node_ctrl_len_ms);
     }
 
     /**
@@ -319,17 +301,18 @@ class fx_delay: public fx_effect {
      *
      * @param[in]  feedback  How much of the output is feedback to the input.  A value of 0.0 will product a single delay.  A value of 1.0 will produce endless echoes.  0.5-0.7 is a nice decaying echo.
      */
-    void set_feedback(float feedback) { 
-
-      CHECK_LAST(feedback, param_feedback);
-
-      // If this node is being controlled by a controller, don't allow a direct write to it
-      if (node_ctrl_feedback.connected) {
-        return; 
-      }
+    void set_feedback(float feedback) {
+      set_param(&param_feedback, feedback, &node_ctrl_feedback);
+    }
 
-      param_feedback = feedback; 
-      parent_canvas->spi_transmit_param(FX_DELAY, instance_id, T_FLOAT, FX_DELAY_PARAM_ID_FEEDBACK, &param_feedback);
+    /**
+     * @brief      Ramps the feedback of the delay to a new value over a period of time.
+     *
+     * @param[in]  feedback  The new value (0.0 to 1.0)
+     * @param[in]  ramp_ms  The duration of the ramp in milliseconds
+     */
+    void set_feedback_ramped(float feedback, uint32_t ramp_ms) {
+      ramp_param(&param_feedback, &node_ctrl_feedback, feedback, ramp_ms);
     }
 
     /**
@@ -337,17 +320,18 @@ class fx_delay: public fx_effect {
      *
      * @param[in]  dry_mix  The mix of the clean signal (0.0 to 1.0)
      */
-    void set_dry_mix(float dry_mix) { 
-      
-      CHECK_LAST(dry_mix, param_dry_mix);
-
-      // If this node is being controlled by a controller, don't allow a direct write to it
-      if (node_ctrl_dry_mix.connected) {
-        return; 
-      }
+    void set_dry_mix(float dry_mix) {
+      set_param(&param_dry_mix, dry_mix, &node_ctrl_dry_mix);
+    }
 
-      param_dry_mix = dry_mix; 
-      parent_canvas->spi_transmit_param(FX_DELAY, instance_id, T_FLOAT, FX_DELAY_PARAM_ID_DRY_MIX, &param_dry_mix);
+    /**
+     * @brief      Ramps the dry mix to a new value over a period of time.
+     *
+     * @param[in]  dry_mix  The new value (0.0 to 1.0)
+     * @param[in]  ramp_ms  The duration of the ramp in milliseconds
+     */
+    void set_dry_mix_ramped(float dry_mix, uint32_t ramp_ms) {
+      ramp_param(&param_dry_mix, &node_ctrl_dry_mix, dry_mix, ramp_ms);
     }
 
 
@@ -360,17 +344,18 @@ class fx_delay: public fx_effect {
      *
      * @param[in]  wet_mix  The mix of the delayed/echo signal (0.0 to 1.0)
      */
-    void set_wet_mix(float wet_mix) { 
-      
-      CHECK_LAST(wet_mix, param_wet_mix);
-
-      // If this node is being controlled by a controller, don't allow a direct write to it
-      if (node_ctrl_wet_mix.connected) {
-        return; 
-      }
+    void set_wet_mix(float wet_mix) {
+      set_param(&param_wet_mix, wet_mix, &node_ctrl_wet_mix);
+    }
 
-      param_wet_mix = wet_mix; 
-      parent_canvas->spi_transmit_param(FX_DELAY, instance_id, T_FLOAT, FX_DELAY_PARAM_ID_WET_MIX, &param_wet_mix);
+    /**
+     * @brief      Ramps the wet / delay mix to a new value over a period of time.
+     *
+     * @param[in]  wet_mix  The new value (0.0 to 1.0)
+     * @param[in]  ramp_ms  The duration of the ramp in milliseconds
+     */
+    void set_wet_mix_ramped(float wet_mix, uint32_t ramp_ms) {
+      ramp_param(&param_wet_mix, &node_ctrl_wet_mix, wet_mix, ramp_ms);
     }
 
   
@@ -381,14 +366,11 @@ class fx_delay: public fx_effect {
      */
     void  print_params(void) {
       char buf[64];
-      const char * num;
-      String val;
 
       // sprintf(buf," [%#08x] -> %#08x : %d", param_stack[1], * (uint32_t *) param_stack[1], (int) param_stack_types[1]); Serial.println(buf);
 
       sprintf(buf," Enabled: %s", param_enabled ? "true" : "false");  Serial.println(buf);
-      val = String(param_len_ms); num = val.c_str();
-      sprintf(buf," Length (ms): %s", num);  Serial.println(buf);
+      sprintf(buf," Length (ms): %.2f", param_len_ms);  Serial.println(buf);
       sprintf(buf," Max length (ms): %.2f", param_len_max_ms);  Serial.println(buf);
       sprintf(buf," Feedback: %.2f", param_feedback);  Serial.println(buf);
       sprintf(buf," Dry mix: %.2f", param_dry_mix);  Serial.println(buf);
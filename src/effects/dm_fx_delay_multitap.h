@@ -45,28 +45,8 @@ class fx_multitap_delay: public fx_effect {
       // Set name
       strcpy(effect_name, "multitap delay");
 
-      int indx = 1;
-      param_stack[indx] = &param_tap_1_ms;
-      param_stack_types[indx++] = T_FLOAT;
-      param_stack[indx] = &param_gain_1;
-      param_stack_types[indx++] = T_FLOAT;
-      param_stack[indx] = &param_tap_2_ms;
-      param_stack_types[indx++] = T_FLOAT;
-      param_stack[indx] = &param_gain_2;
-      param_stack_types[indx++] = T_FLOAT;
-      param_stack[indx] = &param_tap_3_ms;
-      param_stack_types[indx++] = T_FLOAT;
-      param_stack[indx] = &param_gain_3;
-      param_stack_types[indx++] = T_FLOAT;
-      param_stack[indx] = &param_tap_4_ms;
-      param_stack_types[indx++] = T_FLOAT;
-      param_stack[indx] = &param_gain_4;
-      param_stack_types[indx++] = T_FLOAT;
-      param_stack[indx] = &param_dry_mix;
-      param_stack_types[indx++] = T_FLOAT;
-      param_stack[indx] = &param_wet_mix;
-      param_stack_types[indx++] = T_FLOAT;
-      total_params = indx;
+      // Initialize parameter table
+      FX_PARAM_TABLE_INIT();
 
 		    // Assign programmable node names
 		    input = &node_input;
@@ -76,6 +56,23 @@ class fx_multitap_delay: public fx_effect {
 
   public:
 
+    #ifndef DOXYGEN_SHOULD_SKIP_THIS
+    // Parameters in wire order (see FX_PARAM_TABLE() in dm_fx_effect_macros.h)
+    FX_PARAM_TABLE(fx_multitap_delay,
+      FX_PARAM(param_enabled,  T_BOOL,  FX_MULTITAP_DELAY_PARAM_ID_ENABLED, FX_MULTITAP_DELAY_OFFSET_ENABLED),
+      FX_PARAM(param_tap_1_ms, T_FLOAT, FX_PARAM_ID_NONE,                   FX_MULTITAP_DELAY_OFFSET_TAP_1_MS),
+      FX_PARAM(param_gain_1,   T_FLOAT, FX_PARAM_ID_NONE,                   FX_MULTITAP_DELAY_OFFSET_TAP_1_GAIN),
+      FX_PARAM(param_tap_2_ms, T_FLOAT, FX_PARAM_ID_NONE,                   FX_MULTITAP_DELAY_OFFSET_TAP_2_MS),
+      FX_PARAM(param_gain_2,   T_FLOAT, FX_PARAM_ID_NONE,                   FX_MULTITAP_DELAY_OFFSET_TAP_2_GAIN),
+      FX_PARAM(param_tap_3_ms, T_FLOAT, FX_PARAM_ID_NONE,                   FX_MULTITAP_DELAY_OFFSET_TAP_3_MS),
+      FX_PARAM(param_gain_3,   T_FLOAT, FX_PARAM_ID_NONE,                   FX_MULTITAP_DELAY_OFFSET_TAP_3_GAIN),
+      FX_PARAM(param_tap_4_ms, T_FLOAT, FX_PARAM_ID_NONE,                   FX_MULTITAP_DELAY_OFFSET_TAP_4_MS),
+      FX_PARAM(param_gain_4,   T_FLOAT, FX_PARAM_ID_NONE,                   FX_MULTITAP_DELAY_OFFSET_TAP_4_GAIN),
+      FX_PARAM(param_dry_mix,  T_FLOAT, FX_MULTITAP_DELAY_PARAM_ID_DRY_MIX, FX_MULTITAP_DELAY_OFFSET_CLEAN_MIX),
+      FX_PARAM(param_wet_mix,  T_FLOAT, FX_MULTITAP_DELAY_PARAM_ID_WET_MIX, FX_MULTITAP_DELAY_OFFSET_WET_MIX)
+    );
+    #endif
+
     /**
      * Audio routing node [input]: primary audio input
      */
@@ -130,18 +127,14 @@ class fx_multitap_delay: public fx_effect {
      * @brief      Enable the multitap delay (it is enabled by default)
      */
     void enable() {
-      CHECK_LAST_ENABLED();
-      param_enabled = true; 
-      parent_canvas->spi_transmit_param(FX_DELAY_MULTITAP, instance_id, T_BOOL, FX_MULTITAP_DELAY_PARAM_ID_ENABLED, (void *) &param_enabled);
+      set_param(&param_enabled, true);
     }
 
     /**
      * @brief      Bypass the multitap delay (will just pass clean audio through)
      */
     void bypass() {
-      CHECK_LAST_DISABLED();
-      param_enabled = false; 
-      parent_canvas->spi_transmit_param(FX_DELAY_MULTITAP, instance_id, T_BOOL, FX_MULTITAP_DELAY_PARAM_ID_ENABLED, (void *) &param_enabled);
+      set_param(&param_enabled, false);
     }    
 
     /**
@@ -149,13 +142,8 @@ class fx_multitap_delay: public fx_effect {
      *
      * @param[in]  dry_mix  The new dry mix
      */
-    void set_dry_mix(float dry_mix) { 
-      
-      CHECK_LAST(dry_mix, param_dry_mix);
-
-
-      param_dry_mix = dry_mix; 
-      parent_canvas->spi_transmit_param(FX_DELAY_MULTITAP, instance_id, T_FLOAT, FX_MULTITAP_DELAY_PARAM_ID_DRY_MIX, &param_dry_mix);
+    void set_dry_mix(float dry_mix) {
+      set_param(&param_dry_mix, dry_mix);
     }
 
     /**
@@ -163,12 +151,8 @@ class fx_multitap_delay: public fx_effect {
      *
      * @param[in]  wet_mix  The new wet mix
      */
-    void set_wet_mix(float wet_mix) { 
-      
-      CHECK_LAST(wet_mix, param_wet_mix);
-
-      param_wet_mix = wet_mix; 
-      parent_canvas->spi_transmit_param(FX_DELAY_MULTITAP, instance_id, T_FLOAT, FX_MULTITAP_DELAY_PARAM_ID_WET_MIX, &param_wet_mix);
+    void set_wet_mix(float wet_mix) {
+      set_param(&param_wet_mix, wet_mix);
     }
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
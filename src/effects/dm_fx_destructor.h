@@ -39,17 +39,8 @@ class fx_destructor: public fx_effect {
 		    input = &node_input;
 		    output = &node_output;
 		    
-				// Initialize parameter stack
-		    int indx = 1;
-		    param_stack[indx] = &param_type;
-		    param_stack_types[indx++] = T_INT16;
-        param_stack[indx] = &param_param_1;
-        param_stack_types[indx++] = T_FLOAT;
-		    param_stack[indx] = &param_param_2;
-		    param_stack_types[indx++] = T_FLOAT;
-		    param_stack[indx] = &param_output_gain;
-		    param_stack_types[indx++] = T_FLOAT;
-		    total_params = indx;    
+		    // Initialize parameter table
+		    FX_PARAM_TABLE_INIT();
 
 		    // Add addititonal nodes to the control stack
 		    control_node_stack[total_control_nodes++] = &node_ctrl_param_1;
@@ -64,6 +55,17 @@ class fx_destructor: public fx_effect {
 
  public:
 
+    #ifndef DOXYGEN_SHOULD_SKIP_THIS
+    // Parameters in wire order (see FX_PARAM_TABLE() in dm_fx_effect_macros.h)
+    FX_PARAM_TABLE(fx_destructor,
+      FX_PARAM(param_enabled,     T_BOOL,  FX_DESTRUCTOR_PARAM_ID_ENABLED,  FX_DESTRUCTOR_OFFSET_ENABLED),
+      FX_PARAM(param_type,        T_INT16, FX_DESTRUCTOR_PARAM_ID_TYPE,     FX_DESTRUCTOR_OFFSET_POLY_TYPE),
+      FX_PARAM(param_param_1,     T_FLOAT, FX_DESTRUCTOR_PARAM_ID_PARAM_1,  FX_DESTRUCTOR_OFFSET_PARAM_1),
+      FX_PARAM(param_param_2,     T_FLOAT, FX_DESTRUCTOR_PARAM_ID_PARAM_2,  FX_DESTRUCTOR_OFFSET_PARAM_2),
+      FX_PARAM(param_output_gain, T_FLOAT, FX_DESTRUCTOR_PARAM_ID_OUT_GAIN, FX_DESTRUCTOR_OFFSET_OUT_GAIN)
+    );
+    #endif
+
   /**
    * Audio routing node [input]: primary audio input
    */
@@ -163,18 +165,14 @@ class fx_destructor: public fx_effect {
    * @brief      Enable the destructor (it is enabled by default)
    */
   void enable() {
-    CHECK_LAST_ENABLED();
-    param_enabled = true; 
-    parent_canvas->spi_transmit_param(FX_DESTRUCTOR, instance_id, T_BOOL, FX_DESTRUCTOR_PARAM_ID_ENABLED, (void *) &param_enabled);
+    set_param(&param_enabled, true);
   }
 
   /**
    * @brief      Bypass the destructor (will just pass clean audio through)
    */
   void bypass() {
-    CHECK_LAST_DISABLED();
-    param_enabled = false; 
-    parent_canvas->spi_transmit_param(FX_DESTRUCTOR, instance_id, T_BOOL, FX_DESTRUCTOR_PARAM_ID_ENABLED, (void *) &param_enabled);
+    set_param(&param_enabled, false);
   }  
 
   /**
@@ -184,16 +182,8 @@ class fx_destructor: public fx_effect {
    *                        1.0.  A value of 0.1 will provide aggressive clipping where
    *                        as a value of 0.8 will provide more gentle clipping.
    */
-  void set_param_1(float new_param_1) { 
-
-    CHECK_LAST(new_param_1, param_param_1);
-    
-    if (node_ctrl_param_1.connected) {
-      return; 
-    }
-
-    param_param_1 = new_param_1; 
-    parent_canvas->spi_transmit_param(FX_DESTRUCTOR, instance_id, T_FLOAT, FX_DESTRUCTOR_PARAM_ID_PARAM_1, &param_param_1);
+  void set_param_1(float new_param_1) {
+    set_param(&param_param_1, new_param_1, &node_ctrl_param_1);
   }
 
 
@@ -221,16 +211,8 @@ class fx_destructor: public fx_effect {
    * @param[in]  drive  The drive a value that the incoming signal will get
    *                    multiplied by before entering the destructor.
    */
-  void set_param_2(float new_param_2) { 
-
-    CHECK_LAST(new_param_2, param_param_2);
-
-    if (node_ctrl_param_2.connected) {
-      return; 
-    }
-
-    param_param_2 = new_param_2; 
-    parent_canvas->spi_transmit_param(FX_DESTRUCTOR, instance_id, T_FLOAT, FX_DESTRUCTOR_PARAM_ID_PARAM_2, &param_param_2);
+  void set_param_2(float new_param_2) {
+    set_param(&param_param_2, new_param_2, &node_ctrl_param_2);
   }  
 
   /**
@@ -255,17 +237,8 @@ class fx_destructor: public fx_effect {
    *
    * @param[in]  gain  The gain is the value that will be multiplied at the output stage of the destructor. 
    */
-  void set_output_gain(float new_gain) { 
-
-    CHECK_LAST(new_gain, param_output_gain);
-
-
-    if (node_ctrl_output_gain.connected) {
-      return; 
-    }
-
-    param_output_gain = new_gain; 
-    parent_canvas->spi_transmit_param(FX_DESTRUCTOR, instance_id, T_FLOAT, FX_DESTRUCTOR_PARAM_ID_OUT_GAIN, &param_output_gain);
+  void set_output_gain(float new_gain) {
+    set_param(&param_output_gain, new_gain, &node_ctrl_output_gain);
   }    
 
   /**
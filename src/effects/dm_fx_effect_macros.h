@@ -1,9 +1,84 @@
 #ifndef DM_FX_EFFECT_MACROS
 #define DM_FX_EFFECT_MACROS
 
+#include <stddef.h>
+
 #define CHECK_LAST_RUN(FUNC, NAME) static uint32_t FUNC ## NAME ## _last = 0;  if (millis() < FUNC ## NAME ## _last + 30) { return; } FUNC ## NAME ## _last = millis();
 #define CHECK_LAST_ENABLED() if (param_enabled) { return; } 
 #define CHECK_LAST_DISABLED() if (!param_enabled) { return; } 
-#define CHECK_LAST(VALUE, PARAM_NAME) if (VALUE == PARAM_NAME) { return; }
+#define CHECK_LAST(VALUE, PARAM_NAME) if (param_unchanged(&PARAM_NAME, VALUE)) { return; }
+
+/**
+ * Parameter descriptor tables
+ *
+ * Each effect lists its parameters in wire order in the public section of 
+ * its class and installs the table from its init() function:
+ *
+ *   FX_PARAM_TABLE(fx_gain,
+ *     FX_PARAM(param_enabled, T_BOOL,  FX_GAIN_PARAM_ID_ENABLED, FX_GAIN_PARAM_OFFSET_EN),
+ *     FX_PARAM(param_gain,    T_FLOAT, FX_GAIN_PARAM_ID_GAIN,    FX_GAIN_PARAM_OFFSET_GAIN),
+ *     FX_PARAM(param_speed,   T_INT16, FX_GAIN_PARAM_ID_SPEED,   FX_GAIN_PARAM_OFFSET_SPEED)
+ *   );
+ *
+ *   void init(void) {
+ *     ...
+ *     FX_PARAM_TABLE_INIT();
+ *   }
+ *
+ * The table is a constant in flash.  The build fails if an FX_*_OFFSET_* 
+ * define does not match the layout implied by the parameter types, if a 
+ * type is wider than its member, or if param_enabled is not the first entry.
+ * Effects are only ever derived directly from fx_effect, so member offsets 
+ * of the derived class are also valid from the fx_effect base pointer.
+ * The table is also reachable without an instance through the static 
+ * get_class_param_table(), which the canvas image reader uses to check 
+ * parameter blocks before they are sent to the DSP.
+ *
+ * FX_PARAM() gives float parameters the default deadband, which setters 
+ * (through set_param() and CHECK_LAST()) and the modulation matrix apply to 
+ * new values; FX_PARAM_DB() sets it explicitly, e.g. a tighter band for 
+ * pitch-related parameters where a small step is audible:
+ *
+ *     FX_PARAM_DB(param_freq, T_FLOAT, FX_OSCILLATOR_PARAM_ID_FREQ, 
+ *                 FX_OSCILLATOR_PARAM_OFFSET_FREQ, FX_DEADBAND_REL(0.001))
+ *
+ * FX_PARAM_LIVE() lists a parameter that has a setter but no place in the 
+ * serialized parameter block.  Setters look up the id and type of every 
+ * parameter in the table, so each parameter with a setter needs an entry.
+ */
+#define FX_PARAM_DB(MEMBER, TYPE, ID, WIRE_OFFSET, DEADBAND) \
+  { (uint16_t) offsetof(fx_self, MEMBER), \
+    fx_param_checked_type(TYPE, sizeof(((fx_self *) 0)->MEMBER)), \
+    (uint8_t) (ID), \
+    (uint8_t) (WIRE_OFFSET), \
+    (uint8_t) (DEADBAND) }
+
+#define FX_PARAM(MEMBER, TYPE, ID, WIRE_OFFSET) \
+  FX_PARAM_DB(MEMBER, TYPE, ID, WIRE_OFFSET, fx_param_default_deadband(TYPE))
+
+#define FX_PARAM_LIVE(MEMBER, TYPE, ID) \
+  FX_PARAM(MEMBER, TYPE, ID, FX_WIRE_NONE)
+
+#define FX_PARAM_TABLE(CLASS, ...) \
+  static const FX_PARAM_DESC * get_class_param_table(uint8_t * len) { \
+    typedef CLASS fx_self; \
+    _Pragma("GCC diagnostic push") \
+    _Pragma("GCC diagnostic ignored \"-Winvalid-offsetof\"") \
+    static constexpr FX_PARAM_DESC fx_param_table[] = { __VA_ARGS__ }; \
+    static_assert(fx_param_table[0].member_offset == offsetof(fx_self, param_enabled), \
+                  #CLASS ": param_enabled must be the first parameter"); \
+    _Pragma("GCC diagnostic pop") \
+    static_assert(fx_param_table_valid(fx_param_table, sizeof(fx_param_table) / sizeof(FX_PARAM_DESC)), \
+                  #CLASS ": parameter table does not match its FX_*_OFFSET_* defines"); \
+    *len = sizeof(fx_param_table) / sizeof(FX_PARAM_DESC); \
+    return fx_param_table; \
+  }
+
+#define FX_PARAM_TABLE_INIT() \
+  do { \
+    uint8_t fx_param_table_len; \
+    const FX_PARAM_DESC * fx_param_table = get_class_param_table(&fx_param_table_len); \
+    set_param_table(fx_param_table, fx_param_table_len); \
+  } while (0)
 
-#endif 	// DM_FX_EFFECT_MACROS
\ No newline at end of file
+#endif 	// DM_FX_EFFECT_MACROS
@@ -234,6 +234,8 @@ typedef enum {
 #define     SYS_ERR_PARAM   (0x0200)
 #define     SYS_ERR_CRPT    (0x0400)
 #define     SYS_ERR_OTHER   (0x0800)
+#define     SYS_SHADOW_OK   (0x2000)
+#define     SYS_CAP_CANVAS_SLOTS (0x0004)   // Firmware has a shadow canvas slot (HEADER_CANVAS_SLOT / HEADER_SWAP_CANVAS)
 
 typedef enum {
     SPI_DSP_STAT_FIRMWARE_MAJ,
@@ -254,6 +256,11 @@ typedef enum {
     SPI_DSP_STAT_NOTE_4_FREQ,
     SPI_DSP_STAT_NOTE_4_AMP,
     SPI_DSP_STAT_NOTE_4_DUR,
+    SPI_DSP_STAT_BLOCK_COUNT_HI,    // Audio blocks processed, sampled as the frame is clocked out
+    SPI_DSP_STAT_BLOCK_COUNT_LO,
+    SPI_DSP_STAT_READBACK_COUNT,    // Parameter values requested with HEADER_PARAM_READBACK
+    SPI_DSP_STAT_READBACK_START,    // key, value high, value low for each
+    SPI_DSP_STAT_READBACK_END = SPI_DSP_STAT_READBACK_START + SPI_READBACK_SLOTS * 3 - 1,
     SPI_DSP_STAT_FRAME_SIZE
 } SPI_STATUS_FRAME_OFFSETs;
 
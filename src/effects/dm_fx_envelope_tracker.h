@@ -43,21 +43,8 @@ class fx_envelope_tracker:public fx_effect {
       strcpy(effect_name, "envelope tracker");
 
 
-      // Initialize parameter stack
-      int indx = 1;
-      param_stack[indx] = &param_attack_ms;
-      param_stack_types[indx++] = T_FLOAT;
-      param_stack[indx] = &param_decay_ms;
-      param_stack_types[indx++] = T_FLOAT;
-      param_stack[indx] = &param_scale;
-      param_stack_types[indx++] = T_FLOAT;
-      param_stack[indx] = &param_offset;
-      param_stack_types[indx++] = T_FLOAT;      
-      param_stack[indx] = &param_type;
-      param_stack_types[indx++] = T_INT16;
-      param_stack[indx] = &param_triggered;
-      param_stack_types[indx++] = T_BOOL;
-      total_params = indx;
+      // Initialize parameter table
+      FX_PARAM_TABLE_INIT();
 
       // Initialize node stacks
       control_node_stack[total_control_nodes++] = &node_ctrl_attack_ms;
@@ -78,6 +65,19 @@ class fx_envelope_tracker:public fx_effect {
 
   public:
 
+    #ifndef DOXYGEN_SHOULD_SKIP_THIS
+    // Parameters in wire order (see FX_PARAM_TABLE() in dm_fx_effect_macros.h)
+    FX_PARAM_TABLE(fx_envelope_tracker,
+      FX_PARAM(param_enabled,   T_BOOL,  FX_ENV_TRACKER_PARAM_ID_ENABLED,   FX_ENV_TRACKER_OFFSET_EN),
+      FX_PARAM(param_attack_ms, T_FLOAT, FX_ENV_TRACKER_PARAM_ID_ATTACK_MS, FX_ENV_TRACKER_OFFSET_ATTACK_MS),
+      FX_PARAM(param_decay_ms,  T_FLOAT, FX_ENV_TRACKER_PARAM_ID_DECAY_MS,  FX_ENV_TRACKER_OFFSET_DECAY_MS),
+      FX_PARAM(param_scale,     T_FLOAT, FX_ENV_TRACKER_PARAM_ID_SCALE,     FX_ENV_TRACKER_OFFSET_SCALE),
+      FX_PARAM(param_offset,    T_FLOAT, FX_ENV_TRACKER_PARAM_ID_OFFSET,    FX_ENV_TRACKER_OFFSET_OFFSET),
+      FX_PARAM(param_type,      T_INT16, FX_ENV_TRACKER_PARAM_ID_TYPE,      FX_ENV_TRACKER_OFFSET_TYPE),
+      FX_PARAM(param_triggered, T_BOOL,  FX_ENV_TRACKER_PARAM_ID_TRIGGERED, FX_ENV_TRACKER_OFFSET_TRIGGERED)
+    );
+    #endif
+
     // Audio node names that users will be using
     fx_audio_node * input;
 
@@ -118,9 +118,9 @@ class fx_envelope_tracker:public fx_effect {
     fx_envelope_tracker(float attack_speed_ms, float decay_speed_ms, bool triggered) : 
       node_ctrl_attack_ms(NODE_IN, NODE_FLOAT, "node_ctrl_attack_speed", this, FX_ENV_TRACKER_PARAM_ID_ATTACK_MS),
       node_ctrl_decay_ms(NODE_IN, NODE_FLOAT, "node_ctrl_decay_speed", this, FX_ENV_TRACKER_PARAM_ID_DECAY_MS),
+      node_ctrl_envelope(NODE_OUT, NODE_FLOAT, "node_ctrl_envelope", this, FX_ENV_TRACKER_PARAM_ID_VALUE),
       node_ctrl_scale(NODE_IN, NODE_FLOAT, "node_ctrl_scale", this, FX_ENV_TRACKER_PARAM_ID_SCALE),
-      node_ctrl_offset(NODE_IN, NODE_FLOAT, "node_ctrl_offset", this, FX_ENV_TRACKER_PARAM_ID_OFFSET),
-      node_ctrl_envelope(NODE_OUT, NODE_FLOAT, "node_ctrl_envelope", this, FX_ENV_TRACKER_PARAM_ID_VALUE) {
+      node_ctrl_offset(NODE_IN, NODE_FLOAT, "node_ctrl_offset", this, FX_ENV_TRACKER_PARAM_ID_OFFSET) {
     
       param_attack_ms = attack_speed_ms;
       param_decay_ms = decay_speed_ms;
@@ -135,9 +135,9 @@ class fx_envelope_tracker:public fx_effect {
     fx_envelope_tracker(float attack_speed_ms, float decay_speed_ms, bool triggered, float ctrl_scale, float ctrl_offset) : 
       node_ctrl_attack_ms(NODE_IN, NODE_FLOAT, "node_ctrl_attack_speed", this, FX_ENV_TRACKER_PARAM_ID_ATTACK_MS),
       node_ctrl_decay_ms(NODE_IN, NODE_FLOAT, "node_ctrl_decay_speed", this, FX_ENV_TRACKER_PARAM_ID_DECAY_MS),
+      node_ctrl_envelope(NODE_OUT, NODE_FLOAT, "node_ctrl_envelope", this, FX_ENV_TRACKER_PARAM_ID_VALUE),
       node_ctrl_scale(NODE_IN, NODE_FLOAT, "node_ctrl_scale", this, FX_ENV_TRACKER_PARAM_ID_SCALE),
-      node_ctrl_offset(NODE_IN, NODE_FLOAT, "node_ctrl_offset", this, FX_ENV_TRACKER_PARAM_ID_OFFSET),
-      node_ctrl_envelope(NODE_OUT, NODE_FLOAT, "node_ctrl_envelope", this, FX_ENV_TRACKER_PARAM_ID_VALUE) {
+      node_ctrl_offset(NODE_IN, NODE_FLOAT, "node_ctrl_offset", this, FX_ENV_TRACKER_PARAM_ID_OFFSET) {
     
       param_attack_ms = attack_speed_ms;
       param_decay_ms = decay_speed_ms;
@@ -150,30 +150,12 @@ class fx_envelope_tracker:public fx_effect {
     }
 
 
-    void set_attack_speed_ms(float attack_speed_ms) { 
-
-      CHECK_LAST(attack_speed_ms, param_attack_ms);
-
-      // If this node is being controlled by a controller, don't allow a direct write to it
-      if (node_ctrl_attack_ms.connected) {
-        return; 
-      }
-
-      param_attack_ms = attack_speed_ms; 
-      parent_canvas->spi_transmit_param(FX_ENVELOPE_TRACKER, instance_id, T_FLOAT, FX_ENV_TRACKER_PARAM_ID_ATTACK_MS, &param_attack_ms);
+    void set_attack_speed_ms(float attack_speed_ms) {
+      set_param(&param_attack_ms, attack_speed_ms, &node_ctrl_attack_ms);
     }
 
-    void set_decay_speed_ms(float decay_speed_ms) { 
-
-      CHECK_LAST(decay_speed_ms, param_decay_ms);
-
-      // If this node is being controlled by a controller, don't allow a direct write to it
-      if (node_ctrl_decay_ms.connected) {
-        return; 
-      }
-
-      param_decay_ms = decay_speed_ms; 
-      parent_canvas->spi_transmit_param(FX_ENVELOPE_TRACKER, instance_id, T_FLOAT, FX_ENV_TRACKER_PARAM_ID_DECAY_MS, &param_decay_ms);
+    void set_decay_speed_ms(float decay_speed_ms) {
+      set_param(&param_decay_ms, decay_speed_ms, &node_ctrl_decay_ms);
     }
 
     /**
@@ -181,30 +163,12 @@ class fx_envelope_tracker:public fx_effect {
      *
      * @param[in]  scale  The scale value / multiplier
      */
-    void set_env_scale(float scale) { 
-
-      CHECK_LAST(scale, param_scale);
-
-      // If this node is being controlled by a controller, don't allow a direct write to it
-      if (node_ctrl_scale.connected) {
-        return; 
-      }
-
-      param_scale = scale; 
-      parent_canvas->spi_transmit_param(FX_ENVELOPE_TRACKER, instance_id, T_FLOAT, FX_ENV_TRACKER_PARAM_ID_SCALE, &param_scale);
+    void set_env_scale(float scale) {
+      set_param(&param_scale, scale, &node_ctrl_scale);
     }
 
-    void set_env_offset(float offset) { 
-
-      CHECK_LAST(offset, param_offset);
-
-      // If this node is being controlled by a controller, don't allow a direct write to it
-      if (node_ctrl_offset.connected) {
-        return; 
-      }
-
-      param_offset = offset; 
-      parent_canvas->spi_transmit_param(FX_ENVELOPE_TRACKER, instance_id, T_FLOAT, FX_ENV_TRACKER_PARAM_ID_OFFSET, &param_offset);
+    void set_env_offset(float offset) {
+      set_param(&param_offset, offset, &node_ctrl_offset);
     }
 
 
@@ -34,13 +34,8 @@ class fx_gain: public fx_effect {
       output = &node_output;
 
 
-      // Initialize parameter stack
-      int indx = 1;
-      param_stack[indx] = &param_gain;
-      param_stack_types[indx++] = T_FLOAT;
-      param_stack[indx] = &param_speed;
-      param_stack_types[indx++] = T_INT16;
-      total_params = indx;
+      // Initialize parameter table
+      FX_PARAM_TABLE_INIT();
 
       // Add addiitonal notes to the control stack
       control_node_stack[total_control_nodes++] = &node_ctrl_gain;
@@ -49,6 +44,15 @@ class fx_gain: public fx_effect {
     }    
  public:
 
+    #ifndef DOXYGEN_SHOULD_SKIP_THIS
+    // Parameters in wire order (see FX_PARAM_TABLE() in dm_fx_effect_macros.h)
+    FX_PARAM_TABLE(fx_gain,
+      FX_PARAM(param_enabled, T_BOOL,  FX_GAIN_PARAM_ID_ENABLED, FX_GAIN_PARAM_OFFSET_EN),
+      FX_PARAM(param_gain,    T_FLOAT, FX_GAIN_PARAM_ID_GAIN,    FX_GAIN_PARAM_OFFSET_GAIN),
+      FX_PARAM(param_speed,   T_INT16, FX_GAIN_PARAM_ID_SPEED,   FX_GAIN_PARAM_OFFSET_SPEED)
+    );
+    #endif
+
    /**
      * Audio routing node: primary audio input
      */
@@ -102,18 +106,14 @@ class fx_gain: public fx_effect {
      * @brief      Enable the __this_effect__ (it is enabled by default)
      */
     void enable() {
-      CHECK_LAST_ENABLED();
-      param_enabled = true; 
-      parent_canvas->spi_transmit_param(FX_GAIN, instance_id, T_BOOL, FX_GAIN_PARAM_ID_ENABLED, (void *) &param_enabled);
+      set_param(&param_enabled, true);
     }
 
     /**
      * @brief      Bypass the __this_effect__ (will just pass clean audio through)
      */
     void bypass() {
-      CHECK_LAST_DISABLED();
-      param_enabled = false; 
-      parent_canvas->spi_transmit_param(FX_GAIN, instance_id, T_BOOL, FX_GAIN_PARAM_ID_ENABLED, (void *) &param_enabled);
+      set_param(&param_enabled, false);
     }    
 
     /**
@@ -123,17 +123,18 @@ class fx_gain: public fx_effect {
      *
      * @param[in]  new_gain  The new gain value (0.0 -> 4.0)
      */
-    void set_gain(float new_gain) { 
-
-      CHECK_LAST(new_gain, param_gain);
-
-      // If this node is being controlled by a controller, don't allow a direct write to it
-      if (node_ctrl_gain.connected) {
-        return; 
-      }
+    void set_gain(float new_gain) {
+      set_param(&param_gain, new_gain, &node_ctrl_gain);
+    }
 
-      param_gain = new_gain; 
-      parent_canvas->spi_transmit_param(FX_GAIN, instance_id, T_FLOAT, FX_GAIN_PARAM_ID_GAIN, &param_gain);
+    /**
+     * @brief      Ramps the gain multiplier to a new value over a period of time.
+     *
+     * @param[in]  new_gain  The new value (0.0 -> 4.0)
+     * @param[in]  ramp_ms  The duration of the ramp in milliseconds
+     */
+    void set_gain_ramped(float new_gain, uint32_t ramp_ms) {
+      ramp_param(&param_gain, &node_ctrl_gain, new_gain, ramp_ms);
     }
 
     /**
@@ -145,18 +146,7 @@ class fx_gain: public fx_effect {
      * @param[in]  new_gain_db  The new gain value (dB)
      */
     void set_gain_db(float new_gain_db) { 
-
-
-      // If this node is being controlled by a controller, don't allow a direct write to it
-      if (node_ctrl_gain.connected) {
-        return; 
-      }
-
-      new_gain_db = powf(10.0, new_gain_db*(1.0/20.0)); 
-      CHECK_LAST(new_gain_db, param_gain);
-
-      param_gain = new_gain_db; 
-      parent_canvas->spi_transmit_param(FX_GAIN, instance_id, T_FLOAT, FX_GAIN_PARAM_ID_GAIN, &param_gain);
+      set_param(&param_gain, powf(10.0, new_gain_db*(1.0/20.0)), &node_ctrl_gain);
     }    
 
     /**
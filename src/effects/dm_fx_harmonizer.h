@@ -6,7 +6,6 @@
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 
-#define PARAM_STACK(PARAM, TYPE)  param_stack[total_params] = &PARAM ; param_stack_types[total_params++] = TYPE; 
 #define CTRL_STACK(NODE, ALIAS)  control_node_stack[total_control_nodes++] = &NODE; ALIAS = &NODE ;
 #define CHECK_NODE_CONNECTED(NODE)  if (  NODE.connected) { return; }
 
@@ -43,10 +42,8 @@ class fx_harmonizer: public fx_effect {
       // Set name
       strcpy(effect_name, "harmonizer");
 
-      PARAM_STACK(param_key,    T_INT16);
-      PARAM_STACK(param_mode,   T_INT16);
-      PARAM_STACK(param_offset, T_INT16);
-      PARAM_STACK(param_vol,    T_FLOAT);
+      // Initialize parameter table
+      FX_PARAM_TABLE_INIT();
 
       CTRL_STACK(node_ctrl_key,       key);
       CTRL_STACK(node_ctrl_mode,      mode);
@@ -58,6 +55,17 @@ class fx_harmonizer: public fx_effect {
     }
 
   public:
+
+    #ifndef DOXYGEN_SHOULD_SKIP_THIS
+    // Parameters in wire order (see FX_PARAM_TABLE() in dm_fx_effect_macros.h)
+    FX_PARAM_TABLE(fx_harmonizer,
+      FX_PARAM(param_enabled, T_BOOL,  FX_HARMONIZER_PARAM_ID_ENABLED, FX_HARMONIZER_OFFSET_ENABLED),
+      FX_PARAM(param_key,     T_INT16, FX_HARMONIZER_PARAM_ID_KEY,     FX_HARMONIZER_OFFSET_KEY),
+      FX_PARAM(param_mode,    T_INT16, FX_HARMONIZER_PARAM_ID_MODE,    FX_HARMONIZER_OFFSET_MODE),
+      FX_PARAM(param_offset,  T_INT16, FX_HARMONIZER_PARAM_ID_OFFSET,  FX_HARMONIZER_OFFSET_NOTE_OFFSET),
+      FX_PARAM(param_vol,     T_FLOAT, FX_HARMONIZER_PARAM_ID_VOL,     FX_HARMONIZER_OFFSET_VOL)
+    );
+    #endif
     /**
      * Control routing node: The key being played in (of type MUSIC_KEY).
      */
@@ -104,8 +112,8 @@ class fx_harmonizer: public fx_effect {
       node_ctrl_mode(NODE_IN, NODE_INT32, "node_ctrl_mode", this, FX_HARMONIZER_PARAM_ID_MODE),
       node_ctrl_offset(NODE_IN, NODE_INT32, "node_ctrl_offset", this, FX_HARMONIZER_PARAM_ID_OFFSET),
       node_ctrl_vol_in(NODE_IN, NODE_FLOAT, "node_ctrl_vol_in", this, FX_HARMONIZER_PARAM_ID_VOL),
-      node_ctrl_freq_out(NODE_OUT, NODE_FLOAT, "node_ctrl_freq_out", this, FX_HARMONIZER_PARAM_ID_FREQ_OUT),
-      node_ctrl_vol_out(NODE_OUT, NODE_FLOAT, "node_ctrl_vol_out", this, FX_HARMONIZER_PARAM_ID_VOL_OUT) 
+      node_ctrl_vol_out(NODE_OUT, NODE_FLOAT, "node_ctrl_vol_out", this, FX_HARMONIZER_PARAM_ID_VOL_OUT),
+      node_ctrl_freq_out(NODE_OUT, NODE_FLOAT, "node_ctrl_freq_out", this, FX_HARMONIZER_PARAM_ID_FREQ_OUT) 
       {
 
       	param_key = harm_key;
@@ -122,13 +130,8 @@ class fx_harmonizer: public fx_effect {
      *
      * @param[in]  new_key  The new key of type MUSIC_KEY
      */
-    void set_key(MUSIC_KEY new_key) { 
-
-      CHECK_LAST(new_key, param_key);
-      CHECK_NODE_CONNECTED(node_ctrl_key);
-
-      param_key = new_key;  
-      parent_canvas->spi_transmit_param(FX_HARMONIZER, instance_id, T_INT16, FX_HARMONIZER_PARAM_ID_KEY, &param_key);
+    void set_key(MUSIC_KEY new_key) {
+      set_param(&param_key, new_key, &node_ctrl_key);
     }      
 
   /**
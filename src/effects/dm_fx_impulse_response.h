@@ -31,13 +31,21 @@ class fx_impulse_response: public fx_effect {
       input = &node_input;
       output = &node_output;
 
-      // Initialize parameter stack
-      PARAM_STACK(param_impulse,    T_INT16);
+      // Initialize parameter table
+      FX_PARAM_TABLE_INIT();
 
     }    
 
   public:
 
+    #ifndef DOXYGEN_SHOULD_SKIP_THIS
+    // Parameters in wire order (see FX_PARAM_TABLE() in dm_fx_effect_macros.h)
+    FX_PARAM_TABLE(fx_impulse_response,
+      FX_PARAM(param_enabled, T_BOOL,  FX_IMPULSE_RESPONSE_PARAM_ID_ENABLED,      FX_IMPULSE_RESPONSE_OFFSET_ENABLED),
+      FX_PARAM(param_impulse, T_INT16, FX_IMPULSE_RESPONSE_PARAM_ID_IMPULSE_RESP, FX_IMPULSE_RESPONSE_OFFSET_IMPULSE_RESP)
+    );
+    #endif
+
    /**
      * Audio routing node: primary audio input
      */
@@ -48,26 +48,8 @@ class fx_instrument_synth: public fx_effect {
           // Assign programmable node names
           output = &node_output;
 
-          // Initialize parameter stack
-          int indx = 1;
-          param_stack[indx] = &param_osc_type;
-          param_stack_types[indx++] = T_INT16;
-          param_stack[indx] = &param_fm_osc_type;
-          param_stack_types[indx++] = T_INT16;    
-          param_stack[indx] = &param_freq_ratio;
-          param_stack_types[indx++] = T_FLOAT;
-          param_stack[indx] = &param_fm_mod_freq_ratio;
-          param_stack_types[indx++] = T_FLOAT;
-          param_stack[indx] = &param_fm_mod_depth;
-          param_stack_types[indx++] = T_FLOAT;
-          param_stack[indx] = &param_attack_ms;
-          param_stack_types[indx++] = T_FLOAT;
-          param_stack[indx] = &param_filt_resonance;
-          param_stack_types[indx++] = T_FLOAT;
-          param_stack[indx] = &param_filt_response;
-          param_stack_types[indx++] = T_FLOAT;
-
-          total_params = indx;
+          // Initialize parameter table
+          FX_PARAM_TABLE_INIT();
 
           // Add addiitonal notes to the control stack
           control_node_stack[total_control_nodes++] = &node_ctrl_freq_ratio;
@@ -88,6 +70,21 @@ class fx_instrument_synth: public fx_effect {
 
     public:
 
+    #ifndef DOXYGEN_SHOULD_SKIP_THIS
+    // Parameters in wire order (see FX_PARAM_TABLE() in dm_fx_effect_macros.h)
+    FX_PARAM_TABLE(fx_instrument_synth,
+      FX_PARAM(param_enabled,           T_BOOL,  FX_INSTRUMENT_SYNTH_PARAM_ID_ENABLED,        FX_INSTRUMENT_SYNTH_PARAM_OFFSET_EN),
+      FX_PARAM(param_osc_type,          T_INT16, FX_INSTRUMENT_SYNTH_PARAM_ID_OSC_TYPE,       FX_INSTRUMENT_SYNTH_PARAM_OFFSET_OSC_TYPE),
+      FX_PARAM(param_fm_osc_type,       T_INT16, FX_INSTRUMENT_SYNTH_PARAM_ID_OSC_FM_TYPE,    FX_INSTRUMENT_SYNTH_PARAM_OFFSET_OSC_FM_TYPE),
+      FX_PARAM_DB(param_freq_ratio,        T_FLOAT, FX_INSTRUMENT_SYNTH_PARAM_ID_FREQ_RATIO,     FX_INSTRUMENT_SYNTH_PARAM_OFFSET_FREQ_RATIO, FX_DEADBAND_REL(0.001)),
+      FX_PARAM_DB(param_fm_mod_freq_ratio, T_FLOAT, FX_INSTRUMENT_SYNTH_PARAM_ID_FM_MOD_RATIO,   FX_INSTRUMENT_SYNTH_PARAM_OFFSET_FM_MOD_RATIO, FX_DEADBAND_REL(0.001)),
+      FX_PARAM(param_fm_mod_depth,      T_FLOAT, FX_INSTRUMENT_SYNTH_PARAM_ID_FM_MOD_DEPTH,   FX_INSTRUMENT_SYNTH_PARAM_OFFSET_FM_MOD_DEPTH),
+      FX_PARAM(param_attack_ms,         T_FLOAT, FX_INSTRUMENT_SYNTH_PARAM_ID_ATTACK_MS,      FX_INSTRUMENT_SYNTH_PARAM_OFFSET_ATTACK_MS),
+      FX_PARAM(param_filt_resonance,    T_FLOAT, FX_INSTRUMENT_SYNTH_PARAM_ID_FILT_RESONANCE, FX_INSTRUMENT_SYNTH_PARAM_OFFSET_FILT_RESONANCE),
+      FX_PARAM(param_filt_response,     T_FLOAT, FX_INSTRUMENT_SYNTH_PARAM_ID_FILT_RESPONSE,  FX_INSTRUMENT_SYNTH_PARAM_OFFSET_FILT_RESPONSE)
+    );
+    #endif
+
         /**
      * Audio routing node: primary audio output
      */
@@ -132,10 +129,10 @@ class fx_instrument_synth: public fx_effect {
      * @param[in]  filter_response   How much the filter sweeps (0.0 to 1.0)
      */
     fx_instrument_synth( OSC_TYPES osc_type, float attack_ms, float filter_resonance, float filter_response) :
-        node_ctrl_freq_ratio(NODE_IN, NODE_FLOAT, "node_ctrl_freq_ratio", this, FX_INSTRUMENT_SYNTH_PARAM_ID_FREQ_RATIO),
+        node_ctrl_attack_ms(NODE_IN, NODE_FLOAT, "node_ctrl_attack_ms", this, FX_INSTRUMENT_SYNTH_PARAM_ID_ATTACK_MS),
+            node_ctrl_freq_ratio(NODE_IN, NODE_FLOAT, "node_ctrl_freq_ratio", this, FX_INSTRUMENT_SYNTH_PARAM_ID_FREQ_RATIO),
             node_ctrl_dm_mod_freq_ratio(NODE_IN, NODE_FLOAT, "node_ctrl_dm_mod_freq_ratio", this, FX_INSTRUMENT_SYNTH_PARAM_ID_FM_MOD_RATIO),
             node_ctrl_dm_mod_depth(NODE_IN, NODE_FLOAT, "node_ctrl_dm_mod_depth", this, FX_INSTRUMENT_SYNTH_PARAM_ID_FM_MOD_DEPTH),
-            node_ctrl_attack_ms(NODE_IN, NODE_FLOAT, "node_ctrl_attack_ms", this, FX_INSTRUMENT_SYNTH_PARAM_ID_ATTACK_MS),
             node_ctrl_filt_resonance(NODE_IN, NODE_FLOAT, "node_ctrl_filt_resonance", this, FX_INSTRUMENT_SYNTH_PARAM_ID_FILT_RESONANCE),
             node_ctrl_filt_response(NODE_IN, NODE_FLOAT, "param_filt_response", this, FX_INSTRUMENT_SYNTH_PARAM_ID_FILT_RESPONSE) {
 
@@ -167,10 +164,10 @@ class fx_instrument_synth: public fx_effect {
      * @param[in]  filter_response    How much the filter sweeps
      */
     fx_instrument_synth( OSC_TYPES osc_type, OSC_TYPES fm_mod_osc_type, float fm_mod_depth, float freq_ratio, float freq_ratio_fm_mod, float attack_ms, float filter_resonance, float filter_response) :
-        node_ctrl_freq_ratio(NODE_IN, NODE_FLOAT, "node_ctrl_freq_ratio", this, FX_INSTRUMENT_SYNTH_PARAM_ID_FREQ_RATIO),
+        node_ctrl_attack_ms(NODE_IN, NODE_FLOAT, "node_ctrl_attack_ms", this, FX_INSTRUMENT_SYNTH_PARAM_ID_ATTACK_MS),
+            node_ctrl_freq_ratio(NODE_IN, NODE_FLOAT, "node_ctrl_freq_ratio", this, FX_INSTRUMENT_SYNTH_PARAM_ID_FREQ_RATIO),
             node_ctrl_dm_mod_freq_ratio(NODE_IN, NODE_FLOAT, "node_ctrl_dm_mod_freq_ratio", this, FX_INSTRUMENT_SYNTH_PARAM_ID_FM_MOD_RATIO),
             node_ctrl_dm_mod_depth(NODE_IN, NODE_FLOAT, "node_ctrl_dm_mod_depth", this, FX_INSTRUMENT_SYNTH_PARAM_ID_FM_MOD_DEPTH),
-            node_ctrl_attack_ms(NODE_IN, NODE_FLOAT, "node_ctrl_attack_ms", this, FX_INSTRUMENT_SYNTH_PARAM_ID_ATTACK_MS),
             node_ctrl_filt_resonance(NODE_IN, NODE_FLOAT, "node_ctrl_filt_resonance", this, FX_INSTRUMENT_SYNTH_PARAM_ID_FILT_RESONANCE),
             node_ctrl_filt_response(NODE_IN, NODE_FLOAT, "node_ctrl_filt_response", this, FX_INSTRUMENT_SYNTH_PARAM_ID_FILT_RESPONSE) {
 
@@ -192,18 +189,14 @@ class fx_instrument_synth: public fx_effect {
      * @brief      Enable the instrument synth (it is enabled by default)
      */
     void enable() {
-      CHECK_LAST_ENABLED();
-      param_enabled = true; 
-      parent_canvas->spi_transmit_param(FX_INSTRUMENT_SYNTH, instance_id, T_BOOL, FX_INSTRUMENT_SYNTH_PARAM_ID_ENABLED, (void *) &param_enabled);
+      set_param(&param_enabled, true);
     }
 
     /**
      * @brief      Bypass the instrument synth (will just pass zero audio through)
      */
     void bypass() {
-      CHECK_LAST_DISABLED();
-      param_enabled = false; 
-      parent_canvas->spi_transmit_param(FX_INSTRUMENT_SYNTH, instance_id, T_BOOL, FX_INSTRUMENT_SYNTH_PARAM_ID_ENABLED, (void *) &param_enabled);
+      set_param(&param_enabled, false);
     }           
 
   
@@ -213,16 +206,8 @@ class fx_instrument_synth: public fx_effect {
     *
     * @param[in]  ratio  Ratio of synthesized frequency to note playing.  For example, a value of 1.0 would play the same note.  A value of 0.5 would play a note an octave below.  A value of 2.0 would play a note an octave above.
     */
-    void set_freq_ratio(float ratio) { 
-
-        CHECK_LAST(ratio, param_freq_ratio);
-
-        if (node_ctrl_freq_ratio.connected) {
-          return; 
-        }
-
-        param_freq_ratio = ratio;
-        parent_canvas->spi_transmit_param(FX_INSTRUMENT_SYNTH, instance_id, T_FLOAT, FX_INSTRUMENT_SYNTH_PARAM_ID_FREQ_RATIO, &param_freq_ratio);
+    void set_freq_ratio(float ratio) {
+      set_param(&param_freq_ratio, ratio, &node_ctrl_freq_ratio);
     }  
 
       /**
@@ -231,16 +216,7 @@ class fx_instrument_synth: public fx_effect {
        * @param[in]  fm_mod_ratio  The fm modifier ratio relative to the frequency of the tone being played
        */
       void set_fm_mod_ratio(float fm_mod_ratio) {
-
-        CHECK_LAST(fm_mod_ratio, param_fm_mod_freq_ratio);
-
-        if (node_ctrl_dm_mod_freq_ratio.connected) {
-          return; 
-        }
-
-        param_fm_mod_freq_ratio = fm_mod_ratio;
-        parent_canvas->spi_transmit_param(FX_INSTRUMENT_SYNTH, instance_id, T_FLOAT, FX_INSTRUMENT_SYNTH_PARAM_ID_FM_MOD_RATIO, &param_fm_mod_freq_ratio);
-
+        set_param(&param_fm_mod_freq_ratio, fm_mod_ratio, &node_ctrl_dm_mod_freq_ratio);
       }
 
       /**
@@ -249,16 +225,7 @@ class fx_instrument_synth: public fx_effect {
        * @param[in]  depth  The FM mod depth (0.0 -> 1.0)
        */
     void set_fm_mod_depth(float depth) {
-
-        CHECK_LAST(depth, param_fm_mod_depth);
-
-
-        if (node_ctrl_dm_mod_depth.connected) {
-            return; 
-        }
-
-          param_fm_mod_depth = depth;
-          parent_canvas->spi_transmit_param(FX_INSTRUMENT_SYNTH, instance_id, T_FLOAT, FX_INSTRUMENT_SYNTH_PARAM_ID_FM_MOD_DEPTH, &param_fm_mod_depth);     
+        set_param(&param_fm_mod_depth, depth, &node_ctrl_dm_mod_depth);
       }
 
       /**
@@ -266,16 +233,8 @@ class fx_instrument_synth: public fx_effect {
        *
        * @param[in]  attack_ms  The attack milliseconds
        */
-    void set_attack_ms(float attack_ms) { 
-
-        CHECK_LAST(attack_ms, param_attack_ms);
-
-        if (node_ctrl_attack_ms.connected) {
-          return; 
-        }
-
-        param_attack_ms = attack_ms;
-        parent_canvas->spi_transmit_param(FX_INSTRUMENT_SYNTH, instance_id, T_FLOAT, FX_INSTRUMENT_SYNTH_PARAM_ID_ATTACK_MS, &param_attack_ms);
+    void set_attack_ms(float attack_ms) {
+        set_param(&param_attack_ms, attack_ms, &node_ctrl_attack_ms);
       }
 
     /**
@@ -284,16 +243,7 @@ class fx_instrument_synth: public fx_effect {
     * @param[in]  resonance  The resonance of the filter
     */
     void set_filter_resonance(float resonance) {
-
-        CHECK_LAST(resonance, param_filt_resonance);
-
-        if (node_ctrl_filt_resonance.connected) {
-          return; 
-        }
-
-        param_filt_resonance = resonance;
-        parent_canvas->spi_transmit_param(FX_INSTRUMENT_SYNTH, instance_id, T_FLOAT, FX_INSTRUMENT_SYNTH_PARAM_ID_FILT_RESONANCE, &param_filt_resonance);
-
+      set_param(&param_filt_resonance, resonance, &node_ctrl_filt_resonance);
     }
 
     /**
@@ -302,16 +252,7 @@ class fx_instrument_synth: public fx_effect {
     * @param[in]  response  The response (0.0 is not responsive / static filter, 1.0 is very dynamic filter)
     */
     void set_filter_response(float response) {
-
-        CHECK_LAST(response, param_filt_response);
-
-        if (node_ctrl_filt_response.connected) {
-          return; 
-        }
-
-        param_filt_response = response;
-        parent_canvas->spi_transmit_param(FX_INSTRUMENT_SYNTH, instance_id, T_FLOAT, FX_INSTRUMENT_SYNTH_PARAM_ID_FILT_RESPONSE, &param_filt_response);
-        
+      set_param(&param_filt_response, response, &node_ctrl_filt_response);
     }
 
     /**
@@ -320,12 +261,7 @@ class fx_instrument_synth: public fx_effect {
     * @param[in]  new_type  The new type of LFO (OSC_TYPES)
     */
     void set_oscillator_type(OSC_TYPES new_type) {
-
-        CHECK_LAST(new_type, param_osc_type);
-
-        param_osc_type = new_type; 
-        parent_canvas->spi_transmit_param(FX_INSTRUMENT_SYNTH, instance_id, T_INT16, FX_INSTRUMENT_SYNTH_PARAM_ID_OSC_TYPE, &param_osc_type);
-        
+      set_param(&param_osc_type, new_type);
     }
 
     /**
@@ -334,12 +270,7 @@ class fx_instrument_synth: public fx_effect {
     * @param[in]  new_type  The new type of LFO (OSC_TYPES)
     */
     void set_oscillator_type_fm_mod(OSC_TYPES new_type) {
-
-        CHECK_LAST(new_type, param_fm_osc_type);
-
-        param_fm_osc_type = new_type; 
-        parent_canvas->spi_transmit_param(FX_INSTRUMENT_SYNTH, instance_id, T_INT16, FX_INSTRUMENT_SYNTH_PARAM_ID_OSC_FM_TYPE, &param_fm_osc_type);
-    
+      set_param(&param_fm_osc_type, new_type);
     }
 
 
@@ -41,6 +41,20 @@ class fx_looper: public fx_effect {
 
   public:
 
+    #ifndef DOXYGEN_SHOULD_SKIP_THIS
+    // Parameters in wire order (see FX_PARAM_TABLE() in dm_fx_effect_macros.h)
+    FX_PARAM_TABLE(fx_looper,
+      FX_PARAM(param_enabled,               T_BOOL,  FX_LOOPER_PARAM_ID_ENABLED,     FX_LOOPER_PARAM_OFFSET_EN),
+      FX_PARAM(param_max_length_seconds,    T_FLOAT, FX_LOOPER_PARAM_ID_LOOP_SIZE_S, FX_LOOPER_PARAM_OFFSET_LOOP_SIZE_S),
+      FX_PARAM(param_dry_mix,               T_FLOAT, FX_LOOPER_PARAM_ID_DRY_MIX,     FX_LOOPER_PARAM_OFFSET_DRY_MIX),
+      FX_PARAM(param_loop_mix,              T_FLOAT, FX_LOOPER_PARAM_ID_LOOP_MIX,    FX_LOOPER_PARAM_OFFSET_LOOP_MIX),
+      FX_PARAM(param_playback_rate,         T_FLOAT, FX_LOOPER_PARAM_ID_RATE,        FX_LOOPER_PARAM_OFFSET_RATE),
+      FX_PARAM(param_ext_pre_processing_en, T_BOOL,  FX_LOOPER_PARAM_ID_EXT_FB,      FX_LOOPER_PARAM_OFFSET_EXT_PP),
+      FX_PARAM(param_start,                 T_BOOL,  FX_LOOPER_PARAM_ID_START,       FX_LOOPER_PARAM_OFFSET_START),
+      FX_PARAM(param_stop,                  T_BOOL,  FX_LOOPER_PARAM_ID_STOP,        FX_LOOPER_PARAM_OFFSET_STOP)
+    );
+    #endif
+
 
    /**
      * Audio routing node: primary audio input
@@ -153,29 +167,8 @@ class fx_looper: public fx_effect {
       preproc_receive = &node_loop_pp_receive;
 
 
- 			// Initialize parameter stack
-      int indx = 1;
-      param_stack[indx] = &param_max_length_seconds;
-      param_stack_types[indx++] = T_FLOAT;
-
-      param_stack[indx] = &param_dry_mix;
-      param_stack_types[indx++] = T_FLOAT;
-
-      param_stack[indx] = &param_loop_mix;
-      param_stack_types[indx++] = T_FLOAT;
-
-      param_stack[indx] = &param_playback_rate;
-      param_stack_types[indx++] = T_FLOAT;
-
-      param_stack[indx] = &param_ext_pre_processing_en;
-      param_stack_types[indx++] = T_BOOL;
-
-      param_stack[indx] = &param_start;
-      param_stack_types[indx++] = T_FLOAT;
-
-      param_stack[indx] = &param_stop;
-      param_stack_types[indx++] = T_BOOL;
-      total_params = indx;
+      // Initialize parameter table
+      FX_PARAM_TABLE_INIT();
 
       // Add additional nodes to the audio stack
       audio_node_stack[total_audio_nodes++] = &node_loop_pp_receive;
@@ -204,49 +197,36 @@ class fx_looper: public fx_effect {
      * @brief      Enable the __this_effect__ (it is enabled by default)
      */
     void enable() {
-      CHECK_LAST_ENABLED();
-      param_enabled = true; 
-      parent_canvas->spi_transmit_param(FX_LOOPER, instance_id, T_BOOL, FX_LOOPER_PARAM_ID_ENABLED, (void *) &param_enabled);
+      set_param(&param_enabled, true);
     }
 
     /**
      * @brief      Bypass the __this_effect__ (will just pass clean audio through)
      */
     void bypass() {
-      CHECK_LAST_DISABLED();
-      param_enabled = false; 
-      parent_canvas->spi_transmit_param(FX_LOOPER, instance_id, T_BOOL, FX_LOOPER_PARAM_ID_ENABLED, (void *) &param_enabled);
+      set_param(&param_enabled, false);
     }    
 
     void start_loop_recording() {
     	param_start = true;
     	param_stop = false;
-    	parent_canvas->spi_transmit_param(FX_LOOPER, instance_id, T_BOOL, FX_LOOPER_PARAM_ID_START, (void *) &param_start);
+    	transmit_param(&param_start);
     }
 
     void stop_loop_recording() {
     	param_start = false;
     	param_stop= true;
-    	parent_canvas->spi_transmit_param(FX_LOOPER, instance_id, T_BOOL, FX_LOOPER_PARAM_ID_STOP, (void *) &param_stop);
+    	transmit_param(&param_stop);
     }
 
     void stop_loop_playback() {
       param_start = false;
       param_stop= true;
-      parent_canvas->spi_transmit_param(FX_LOOPER, instance_id, T_BOOL, FX_LOOPER_PARAM_ID_STOP, (void *) &param_stop);
+      transmit_param(&param_stop);
     }
 
-    void set_playback_rate(float playback_rate) { 
-
-      CHECK_LAST(playback_rate, param_playback_rate);
-
-      // If this node is being controlled by a controller, don't allow a direct write to it
-      if (node_ctrl_playback_rate.connected) {
-        return; 
-      }
-
-      param_playback_rate = playback_rate; 
-      parent_canvas->spi_transmit_param(FX_LOOPER, instance_id, T_FLOAT, FX_LOOPER_PARAM_ID_RATE, &param_playback_rate);
+    void set_playback_rate(float playback_rate) {
+      set_param(&param_playback_rate, playback_rate, &node_ctrl_playback_rate);
     }
 
     /**
@@ -254,17 +234,18 @@ class fx_looper: public fx_effect {
      *
      * @param[in]  new_loop_mix  The new loop mix value (0.0 -> 1.0)
      */
-    void set_loop_mix(float new_loop_mix) { 
-
-      CHECK_LAST(new_loop_mix, param_loop_mix);
-
-      // If this node is being controlled by a controller, don't allow a direct write to it
-      if (node_ctrl_loop_mix.connected) {
-        return; 
-      }
+    void set_loop_mix(float new_loop_mix) {
+      set_param(&param_loop_mix, new_loop_mix, &node_ctrl_loop_mix);
+    }
 
-      param_loop_mix = new_loop_mix; 
-      parent_canvas->spi_transmit_param(FX_LOOPER, instance_id, T_FLOAT, FX_LOOPER_PARAM_ID_LOOP_MIX, &param_loop_mix);
+    /**
+     * @brief      Ramps the loop mix to a new value over a period of time.
+     *
+     * @param[in]  new_loop_mix  The new value (0.0 -> 1.0)
+     * @param[in]  ramp_ms  The duration of the ramp in milliseconds
+     */
+    void set_loop_mix_ramped(float new_loop_mix, uint32_t ramp_ms) {
+      ramp_param(&param_loop_mix, &node_ctrl_loop_mix, new_loop_mix, ramp_ms);
     }
 
     /**
@@ -272,19 +253,20 @@ class fx_looper: public fx_effect {
      *
      * @param[in]  new_dry_mix  The new dry mix value (0.0 -> 1.0)
      */
-    void set_dry_mix(float new_dry_mix) { 
-
-      CHECK_LAST(new_dry_mix, param_dry_mix);
-
-      // If this node is being controlled by a controller, don't allow a direct write to it
-      if (node_ctrl_dry_mix.connected) {
-        return; 
-      }
-
-      param_dry_mix = new_dry_mix; 
-      parent_canvas->spi_transmit_param(FX_LOOPER, instance_id, T_FLOAT, FX_LOOPER_PARAM_ID_DRY_MIX, &param_dry_mix);
+    void set_dry_mix(float new_dry_mix) {
+      set_param(&param_dry_mix, new_dry_mix, &node_ctrl_dry_mix);
     }    
 
+    /**
+     * @brief      Ramps the dry mix to a new value over a period of time.
+     *
+     * @param[in]  new_dry_mix  The new value (0.0 -> 1.0)
+     * @param[in]  ramp_ms  The duration of the ramp in milliseconds
+     */
+    void set_dry_mix_ramped(float new_dry_mix, uint32_t ramp_ms) {
+      ramp_param(&param_dry_mix, &node_ctrl_dry_mix, new_dry_mix, ramp_ms);
+    }
+
 /**
      * @brief  Prints the parameters for the delay effect
      */
@@ -34,30 +34,8 @@ class fx_oscillator: public fx_effect {
       // Assign programmable node names
       output = &node_output;      
 
-      // Initialize parameter stack
-      int indx = 1;
-      param_stack[indx] = &param_freq;
-      param_stack_types[indx++] = T_FLOAT;
-
-      param_stack[indx] = &param_amp;
-      param_stack_types[indx++] = T_FLOAT;
-
-      param_stack[indx] = &param_offset;
-      param_stack_types[indx++] = T_FLOAT;
-
-      param_stack[indx] = &param_type;
-      param_stack_types[indx++] = T_INT16;
-
-      param_stack[indx] = &param_osc_param1;
-      param_stack_types[indx++] = T_FLOAT;
-
-      param_stack[indx] = &param_osc_param2;
-      param_stack_types[indx++] = T_FLOAT;
-
-      param_stack[indx] = &param_osc_initial_phase;
-      param_stack_types[indx++] = T_FLOAT;
-
-      total_params = indx;      
+      // Initialize parameter table
+      FX_PARAM_TABLE_INIT();
 
 
       // Add addiitonal notes to the control stack
@@ -75,6 +53,20 @@ class fx_oscillator: public fx_effect {
 
  public:
 
+    #ifndef DOXYGEN_SHOULD_SKIP_THIS
+    // Parameters in wire order (see FX_PARAM_TABLE() in dm_fx_effect_macros.h)
+    FX_PARAM_TABLE(fx_oscillator,
+      FX_PARAM(param_enabled,           T_BOOL,  FX_OSCILLATOR_PARAM_ID_ENABLED,           FX_OSCILLATOR_PARAM_OFFSET_OFFSET_EN),
+      FX_PARAM_DB(param_freq,              T_FLOAT, FX_OSCILLATOR_PARAM_ID_FREQ,              FX_OSCILLATOR_PARAM_OFFSET_FREQ, FX_DEADBAND_REL(0.001)),
+      FX_PARAM(param_amp,               T_FLOAT, FX_OSCILLATOR_PARAM_ID_AMP,               FX_OSCILLATOR_PARAM_OFFSET_AMP),
+      FX_PARAM(param_offset,            T_FLOAT, FX_OSCILLATOR_PARAM_ID_OFFSET,            FX_OSCILLATOR_PARAM_OFFSET_OFFSET),
+      FX_PARAM(param_type,              T_INT16, FX_OSCILLATOR_PARAM_ID_TYPE,              FX_OSCILLATOR_PARAM_OFFSET_TYPE),
+      FX_PARAM(param_osc_param1,        T_FLOAT, FX_OSCILLATOR_PARAM_ID_OSC_PARAM1,        FX_OSCILLATOR_PARAM_OFFSET_OSC_PARAM1),
+      FX_PARAM(param_osc_param2,        T_FLOAT, FX_OSCILLATOR_PARAM_ID_OSC_PARAM2,        FX_OSCILLATOR_PARAM_OFFSET_OSC_PARAM2),
+      FX_PARAM(param_osc_initial_phase, T_FLOAT, FX_OSCILLATOR_PARAM_ID_OSC_INITIAL_PHASE, FX_OSCILLATOR_PARAM_OFFSET_OSC_INITIAL_PHASE)
+    );
+    #endif
+
 /**
  * Audio routing node: primary audio oscillator output
  */
@@ -159,18 +151,14 @@ class fx_oscillator: public fx_effect {
      * @brief      Enable the oscillator (it is enabled by default)
      */
     void enable() {
-      CHECK_LAST_ENABLED();      
-      param_enabled = true; 
-      parent_canvas->spi_transmit_param(FX_OSCILLATOR, instance_id, T_BOOL, FX_OSCILLATOR_PARAM_ID_ENABLED, (void *) &param_enabled);
+      set_param(&param_enabled, true);
     }
 
     /**
      * @brief      Bypass the oscillator (it will provide just a constant value)
      */
     void bypass() {
-      CHECK_LAST_DISABLED();
-      param_enabled = false; 
-      parent_canvas->spi_transmit_param(FX_OSCILLATOR, instance_id, T_BOOL, FX_OSCILLATOR_PARAM_ID_ENABLED, (void *) &param_enabled);
+      set_param(&param_enabled, false);
     }      
     
 
@@ -179,17 +167,8 @@ class fx_oscillator: public fx_effect {
      *
      * @param[in]  freq  The frequency in Hz
      */
-    void set_frequency(float freq) { 
-
-      CHECK_LAST(freq, param_freq)
-
-      // If this node is being controlled by a controller, don't allow a direct write to it
-      if (node_ctrl_freq.connected) {
-        return; 
-      }
-
-      param_freq = freq; 
-      parent_canvas->spi_transmit_param(FX_OSCILLATOR, instance_id, T_FLOAT, FX_OSCILLATOR_PARAM_ID_FREQ, &param_freq);
+    void set_frequency(float freq) {
+      set_param(&param_freq, freq, &node_ctrl_freq);
     }   
 
 
@@ -198,17 +177,8 @@ class fx_oscillator: public fx_effect {
      *
      * @param[in]  amplitude  The amplitude (linear)
      */
-    void set_amplitude(float amplitude) { 
-
-      CHECK_LAST(amplitude, param_amp)
-
-      // If this node is being controlled by a controller, don't allow a direct write to it
-      if (node_ctrl_amp.connected) {
-        return; 
-      }
-
-      param_amp = amplitude; 
-      parent_canvas->spi_transmit_param(FX_OSCILLATOR, instance_id, T_FLOAT, FX_OSCILLATOR_PARAM_ID_AMP, &param_amp);
+    void set_amplitude(float amplitude) {
+      set_param(&param_amp, amplitude, &node_ctrl_amp);
     }   
 
     /**
@@ -217,12 +187,7 @@ class fx_oscillator: public fx_effect {
      * @param[in]  new_type  The new type of oscillator (OSC_TYPES)
      */
     void set_oscillator_type(OSC_TYPES new_type) {
-
-      CHECK_LAST(new_type, param_type)
-
-      param_type = new_type; 
-      parent_canvas->spi_transmit_param(FX_OSCILLATOR, instance_id, T_INT16, FX_OSCILLATOR_PARAM_ID_TYPE, &param_type);
-
+      set_param(&param_type, new_type);
     }
 
 
@@ -33,24 +33,8 @@ class fx_phase_shifter: public fx_effect {
 	    input = &node_input;
 	    output = &node_output;
 
-		  // Initialize parameter stack
-	    int indx = 1;
-	    param_stack[indx] = &param_rate_hz;
-	    param_stack_types[indx++] = T_FLOAT;
-
-      param_stack[indx] = &param_depth;
-      param_stack_types[indx++] = T_FLOAT;
-
-	    param_stack[indx] = &param_feedback;
-	    param_stack_types[indx++] = T_FLOAT;
-
-      param_stack[indx] = &param_initial_phase_deg;
-      param_stack_types[indx++] = T_FLOAT;
-
-      param_stack[indx] = &param_type;
-      param_stack_types[indx++] = T_INT16;      
-
-	    total_params = indx;         
+	    // Initialize parameter table
+	    FX_PARAM_TABLE_INIT();
 
       // Add addiitonal notes to the control stack
       control_node_stack[total_control_nodes++] = &node_ctrl_depth;
@@ -71,6 +55,18 @@ class fx_phase_shifter: public fx_effect {
 
   public:
 
+    #ifndef DOXYGEN_SHOULD_SKIP_THIS
+    // Parameters in wire order (see FX_PARAM_TABLE() in dm_fx_effect_macros.h)
+    FX_PARAM_TABLE(fx_phase_shifter,
+      FX_PARAM(param_enabled,           T_BOOL,  FX_PHASE_SHIFTER_PARAM_ID_ENABLED,       FX_PHASE_SHIFTER_PARAM_OFFSET_EN),
+      FX_PARAM(param_rate_hz,           T_FLOAT, FX_PHASE_SHIFTER_PARAM_ID_RATE_HZ,       FX_PHASE_SHIFTER_PARAM_OFFSET_RATE_HZ),
+      FX_PARAM(param_depth,             T_FLOAT, FX_PHASE_SHIFTER_PARAM_ID_DEPTH,         FX_PHASE_SHIFTER_PARAM_OFFSET_DEPTH),
+      FX_PARAM(param_feedback,          T_FLOAT, FX_PHASE_SHIFTER_PARAM_ID_FEEDBACK,      FX_PHASE_SHIFTER_PARAM_OFFSET_FEEDBACK),
+      FX_PARAM(param_initial_phase_deg, T_FLOAT, FX_PHASE_SHIFTER_PARAM_ID_INITIAL_PHASE, FX_PHASE_SHIFTER_PARAM_OFFSET_INITIAL_PHASE),
+      FX_PARAM(param_type,              T_INT16, FX_PHASE_SHIFTER_PARAM_ID_MOD_TYPE,      FX_PHASE_SHIFTER_PARAM_OFFSET_MOD_TYPE)
+    );
+    #endif
+
     /**
      * Audio routing node: primary audio input
      */
@@ -146,18 +142,14 @@ class fx_phase_shifter: public fx_effect {
      * @brief      Enable the phase shifter (it is enabled by default)
      */
     void enable() {
-      CHECK_LAST_ENABLED();
-      param_enabled = true; 
-      parent_canvas->spi_transmit_param(FX_PHASE_SHIFTER, instance_id, T_BOOL, FX_PHASE_SHIFTER_PARAM_ID_ENABLED, (void *) &param_enabled);
+      set_param(&param_enabled, true);
     }
 
     /**
      * @brief      Bypass the phase shifter (will just pass clean audio through)
      */
     void bypass() {
-      CHECK_LAST_DISABLED();
-      param_enabled = false; 
-      parent_canvas->spi_transmit_param(FX_PHASE_SHIFTER, instance_id, T_BOOL, FX_PHASE_SHIFTER_PARAM_ID_ENABLED, (void *) &param_enabled);
+      set_param(&param_enabled, false);
     }  
 
     /**
@@ -166,16 +158,8 @@ class fx_phase_shifter: public fx_effect {
      * @param[in]  depth  The depth fom 0.0 -> 1.0.  0.0 is no modulation at all,
      *                    1.0 is full modulation.
      */
-    void set_depth(float depth) { 
-
-      CHECK_LAST(depth, param_depth);
-
-      if (node_ctrl_depth.connected) {
-        return; 
-      }
-
-      param_depth = depth; 
-      parent_canvas->spi_transmit_param(FX_PHASE_SHIFTER, instance_id, T_FLOAT, FX_PHASE_SHIFTER_PARAM_ID_DEPTH, &param_depth);
+    void set_depth(float depth) {
+      set_param(&param_depth, depth, &node_ctrl_depth);
     }
 
     /**
@@ -183,16 +167,8 @@ class fx_phase_shifter: public fx_effect {
      *
      * @param[in]  rate_hz  The rate hz
      */
-    void set_rate_hz(float rate_hz) { 
-
-      CHECK_LAST(rate_hz, param_rate_hz);
-
-      if (node_ctrl_rate_hz.connected) {
-        return; 
-      }
-
-      param_rate_hz = rate_hz; 
-      parent_canvas->spi_transmit_param(FX_PHASE_SHIFTER, instance_id, T_FLOAT, FX_PHASE_SHIFTER_PARAM_ID_RATE_HZ, &param_rate_hz);
+    void set_rate_hz(float rate_hz) {
+      set_param(&param_rate_hz, rate_hz, &node_ctrl_rate_hz);
     }    
 
     /**
@@ -200,16 +176,8 @@ class fx_phase_shifter: public fx_effect {
      *
      * @param[in]  feedback  Feedback value (between -1.0 and 1.0)
      */
-    void set_feedback(float feedback) { 
-
-      CHECK_LAST(feedback, param_feedback);
-
-      if (node_ctrl_rate_hz.connected) {
-        return; 
-      }
-
-      param_feedback = feedback; 
-      parent_canvas->spi_transmit_param(FX_PHASE_SHIFTER, instance_id, T_FLOAT, FX_PHASE_SHIFTER_PARAM_ID_FEEDBACK, &param_feedback);
+    void set_feedback(float feedback) {
+      set_param(&param_feedback, feedback, &node_ctrl_rate_hz);
     }    
 
     /**
@@ -218,12 +186,7 @@ class fx_phase_shifter: public fx_effect {
      * @param[in]  new_type  The new type of LFO (OSC_TYPES)
      */
     void set_lfo_type(OSC_TYPES new_type) {
-
-      CHECK_LAST(new_type, param_type);
-
-      param_type = new_type; 
-      parent_canvas->spi_transmit_param(FX_PHASE_SHIFTER, instance_id, T_INT16, FX_PHASE_SHIFTER_PARAM_ID_MOD_TYPE, &param_type);
-
+      set_param(&param_type, new_type);
     }
 
 
@@ -25,6 +25,14 @@ class fx_pitch_shift: public fx_effect {
 
  public:
 
+    #ifndef DOXYGEN_SHOULD_SKIP_THIS
+    // Parameters in wire order (see FX_PARAM_TABLE() in dm_fx_effect_macros.h)
+    FX_PARAM_TABLE(fx_pitch_shift,
+      FX_PARAM(param_enabled,    T_BOOL,  FX_PITCH_SHIFT_PARAM_ID_ENABLED,    FX_PITCH_SHIFT_PARAM_OFFSET_OFFSET_EN),
+      FX_PARAM_DB(param_freq_shift, T_FLOAT, FX_PITCH_SHIFT_PARAM_ID_FREQ_SHIFT, FX_PITCH_SHIFT_PARAM_OFFSET_FREQ_SHIFT, FX_DEADBAND_REL(0.001))
+    );
+    #endif
+
     /**
      * Audio routing node: primary audio input
      */
@@ -59,11 +67,8 @@ class fx_pitch_shift: public fx_effect {
       // Defaults
       param_enabled = true;
 
-      // Initialize parameter stack
-      int indx = 1;
-      param_stack[indx] = &param_freq_shift;
-      param_stack_types[indx++] = T_FLOAT;
-      total_params = indx;
+      // Initialize parameter table
+      FX_PARAM_TABLE_INIT();
 
       // Add addiitonal notes to the control stack
       control_node_stack[total_control_nodes++] = &node_ctrl_freq_shift;
@@ -76,18 +81,14 @@ class fx_pitch_shift: public fx_effect {
      * @brief      Enable the pitch shifter (it is enabled by default)
      */
     void enable() {
-      CHECK_LAST_ENABLED();
-      param_enabled = true; 
-      parent_canvas->spi_transmit_param(FX_PITCH_SHIFT, instance_id, T_BOOL, FX_PITCH_SHIFT_PARAM_ID_ENABLED, (void *) &param_enabled);
+      set_param(&param_enabled, true);
     }
 
     /**
      * @brief      Bypass the pitch shifter (will just pass clean audio through)
      */
     void bypass() {
-      CHECK_LAST_DISABLED();
-      param_enabled = false; 
-      parent_canvas->spi_transmit_param(FX_PITCH_SHIFT, instance_id, T_BOOL, FX_PITCH_SHIFT_PARAM_ID_ENABLED, (void *) &param_enabled);
+      set_param(&param_enabled, false);
     }
 
     /**
@@ -96,17 +97,8 @@ class fx_pitch_shift: public fx_effect {
      *
      * @param[in]  freq_shift  The frequency shift
      */
-    void set_freq_shift(float freq_shift) { 
-
-      CHECK_LAST(freq_shift, param_freq_shift);
-
-      // If this node is being controlled by a controller, don't allow a direct write to it
-      if (node_ctrl_freq_shift.connected) {
-        return;
-      }
-
-      param_freq_shift = freq_shift;
-      parent_canvas->spi_transmit_param(FX_PITCH_SHIFT, instance_id, T_FLOAT, FX_PITCH_SHIFT_PARAM_ID_FREQ_SHIFT, (void *) &param_freq_shift);
+    void set_freq_shift(float freq_shift) {
+      set_param(&param_freq_shift, freq_shift, &node_ctrl_freq_shift);
     }
 
 
@@ -115,8 +107,6 @@ class fx_pitch_shift: public fx_effect {
      */
     void  print_params(void) {
       char buf[64];
-      const char * num;
-      String val;
 
       sprintf(buf," Enabled: %s", param_enabled ? "true" : "false");  Serial.println(buf);
       sprintf(buf," Freq shift ratio: %.2f", param_freq_shift);  Serial.println(buf);
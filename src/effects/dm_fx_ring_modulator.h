@@ -42,15 +42,8 @@ class fx_ring_mod: public fx_effect {
       // Defaults
       param_enabled = true;
 
-      // Initialize parameter stack
-      int indx = 1;
-      param_stack[indx] = &param_freq;
-      param_stack_types[indx++] = T_FLOAT;
-      param_stack[indx] = &param_depth;
-      param_stack_types[indx++] = T_FLOAT;
-      param_stack[indx] = &param_enable_filter;
-      param_stack_types[indx++] = T_BOOL;      
-      total_params = indx;
+      // Initialize parameter table
+      FX_PARAM_TABLE_INIT();
 
       // Add addiitonal notes to the control stack
       control_node_stack[total_control_nodes++] = &node_ctrl_freq;
@@ -64,6 +57,16 @@ class fx_ring_mod: public fx_effect {
 
   public:
 
+    #ifndef DOXYGEN_SHOULD_SKIP_THIS
+    // Parameters in wire order (see FX_PARAM_TABLE() in dm_fx_effect_macros.h)
+    FX_PARAM_TABLE(fx_ring_mod,
+      FX_PARAM(param_enabled,       T_BOOL,  FX_RING_MOD_PARAM_ID_ENABLED,   FX_RING_MOD_PARAM_OFFSET_OFFSET_EN),
+      FX_PARAM_DB(param_freq,          T_FLOAT, FX_RING_MOD_PARAM_ID_FREQ,      FX_RING_MOD_PARAM_OFFSET_FREQ, FX_DEADBAND_REL(0.001)),
+      FX_PARAM(param_depth,         T_FLOAT, FX_RING_MOD_PARAM_ID_DEPTH,     FX_RING_MOD_PARAM_OFFSET_DEPTH),
+      FX_PARAM(param_enable_filter, T_BOOL,  FX_RING_MOD_PARAM_ID_EN_FILTER, FX_RING_MOD_PARAM_OFFSET_EN_FILTER)
+    );
+    #endif
+
     /**
      * Audio routing node [input]: primary audio input
      */
@@ -128,18 +131,14 @@ class fx_ring_mod: public fx_effect {
      * @brief      Enable the ring modulator (it is enabled by default)
      */
     void enable() {
-      CHECK_LAST_ENABLED();
-      param_enabled = true; 
-      parent_canvas->spi_transmit_param(FX_RING_MOD, instance_id, T_BOOL, FX_RING_MOD_PARAM_ID_ENABLED, (void *) &param_enabled);
+      set_param(&param_enabled, true);
     }
 
     /**
      * @brief      Bypass the ring modulator (will just pass clean audio through)
      */
     void bypass() {
-      CHECK_LAST_DISABLED();
-      param_enabled = false; 
-      parent_canvas->spi_transmit_param(FX_RING_MOD, instance_id, T_BOOL, FX_RING_MOD_PARAM_ID_ENABLED, (void *) &param_enabled);
+      set_param(&param_enabled, false);
     }
 
     /**
@@ -147,14 +146,8 @@ class fx_ring_mod: public fx_effect {
      *
      * @param[in]  new_freq  The new frequency
      */
-    void set_freq(float new_freq) { 
-      CHECK_LAST(new_freq, param_freq);
-      if (node_ctrl_freq.connected) {
-        return;
-      }
-
-      param_freq = new_freq;
-      parent_canvas->spi_transmit_param(FX_RING_MOD, instance_id, T_FLOAT, FX_RING_MOD_PARAM_ID_FREQ, (void *) &param_freq);
+    void set_freq(float new_freq) {
+      set_param(&param_freq, new_freq, &node_ctrl_freq);
     }
 
     /**
@@ -162,16 +155,8 @@ class fx_ring_mod: public fx_effect {
      *
      * @param[in]  new_depth  The new depth
      */
-    void set_depth(float new_depth) { 
-      
-      CHECK_LAST(new_depth, param_depth);
-
-      if (node_ctrl_depth.connected) {
-        return; 
-      }
-
-      param_depth = new_depth; 
-      parent_canvas->spi_transmit_param(FX_RING_MOD, instance_id, T_FLOAT, FX_RING_MOD_PARAM_ID_DEPTH, (void *) &param_depth);
+    void set_depth(float new_depth) {
+      set_param(&param_depth, new_depth, &node_ctrl_depth);
     }
 
    
@@ -182,8 +167,6 @@ class fx_ring_mod: public fx_effect {
      */
     void  print_params(void) {
       char buf[64];
-      const char * num;
-      String val;
 
       sprintf(buf," Enabled: %s", param_enabled ? "true" : "false");  Serial.println(buf);
       sprintf(buf," Freq (Hz): %.2f", param_freq);  Serial.println(buf);
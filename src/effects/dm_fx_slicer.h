@@ -63,15 +63,8 @@ private:
       audio_node_stack[total_audio_nodes++] = &node_dummy_input;   // dummy output node since inputs and outputs go in pairs
       audio_node_stack[total_audio_nodes++] = &node_output7;
 
-      // Initialize parameter stack
-      int indx = 1;
-
-      param_stack[indx] = &param_period;
-      param_stack_types[indx++] = T_INT32;
-
-      param_stack[indx] = &param_channels;
-      param_stack_types[indx++] = T_INT32;
-      total_params = indx;         
+      // Initialize parameter table
+      FX_PARAM_TABLE_INIT();
 
       control_node_stack[total_control_nodes++] = &node_ctrl_period;
       control_node_stack[total_control_nodes++] = &node_ctrl_start;
@@ -85,6 +78,15 @@ private:
 
  public:
 
+    #ifndef DOXYGEN_SHOULD_SKIP_THIS
+    // Parameters in wire order (see FX_PARAM_TABLE() in dm_fx_effect_macros.h)
+    FX_PARAM_TABLE(fx_slicer,
+      FX_PARAM(param_enabled,  T_BOOL,  FX_SLICER_PARAM_ID_ENABLED,  FX_SLICER_PARAM_OFFSET_EN),
+      FX_PARAM(param_period,   T_FLOAT, FX_SLICER_PARAM_ID_PERIOD,   FX_SLICER_PARAM_OFFSET_PERIOD),
+      FX_PARAM(param_channels, T_INT32, FX_SLICER_PARAM_ID_CHANNELS, FX_SLICER_PARAM_OFFSET_CHANNELS)
+    );
+    #endif
+
   /**
    * Audio routing node: primary audio input
    */
@@ -152,16 +154,16 @@ private:
    * @param[in]  channels   The number of channels to slice between during the period
    */
   fx_slicer(float period_ms, int32_t channels) : 
-    node_output2(NODE_OUT, "output_2", this), 
-    node_output3(NODE_OUT, "output_3", this), 
-    node_output4(NODE_OUT, "output_4", this), 
-    node_output5(NODE_OUT, "output_5", this), 
-    node_output6(NODE_OUT, "output_6", this), 
-    node_output7(NODE_OUT, "output_7", this), 
-    node_output8(NODE_OUT, "output_8", this), 
+    node_output2(NODE_OUT, "output_2", this),
+    node_output3(NODE_OUT, "output_3", this),
+    node_output4(NODE_OUT, "output_4", this),
+    node_output5(NODE_OUT, "output_5", this),
+    node_output6(NODE_OUT, "output_6", this),
+    node_output7(NODE_OUT, "output_7", this),
+    node_output8(NODE_OUT, "output_8", this),
     node_dummy_input(NODE_IN, "dummy", this),
-    node_ctrl_start(NODE_IN, NODE_FLOAT, "node_ctrl_start", this, FX_SLICER_PARAM_ID_START),
-    node_ctrl_period(NODE_IN, NODE_FLOAT, "node_ctrl_period", this, FX_SLICER_PARAM_ID_PERIOD)
+    node_ctrl_period(NODE_IN, NODE_FLOAT, "node_ctrl_period", this, FX_SLICER_PARAM_ID_PERIOD),
+    node_ctrl_start(NODE_IN, NODE_FLOAT, "node_ctrl_start", this, FX_SLICER_PARAM_ID_START)
     {
       
       // Set parameters
@@ -176,18 +178,14 @@ private:
    * @brief      Enable the slicer (it is enabled by default)
    */
   void enable() {
-    CHECK_LAST_ENABLED();
-    param_enabled = true; 
-    parent_canvas->spi_transmit_param(FX_SLICER, instance_id, T_BOOL, FX_SLICER_PARAM_ID_ENABLED, (void *) &param_enabled);
+    set_param(&param_enabled, true);
   }
 
   /**
    * @brief      Bypass the slicer  (will just pass clean audio through)
    */
   void bypass() {
-    CHECK_LAST_DISABLED();
-    param_enabled = false; 
-    parent_canvas->spi_transmit_param(FX_SLICER, instance_id, T_BOOL, FX_SLICER_PARAM_ID_ENABLED, (void *) &param_enabled);
+    set_param(&param_enabled, false);
   }  
 
 
@@ -196,16 +194,8 @@ private:
    *
    * @param[in]  period  The period in milliseconds (thousands of a second)
    */
-  void set_period_ms(float period) { 
-
-    CHECK_LAST(period, param_period);
-          
-    if (node_ctrl_period.connected) {
-      return; 
-    }
-
-    param_period = period; 
-    parent_canvas->spi_transmit_param(FX_AMPLITUDE_MODULATOR, instance_id, T_FLOAT, FX_SLICER_PARAM_ID_PERIOD, &param_period);
+  void set_period_ms(float period) {
+    set_param(&param_period, period, &node_ctrl_period);
   }
 
   /**
@@ -33,6 +33,18 @@ class fx_pitch_shift_fd: public fx_effect {
 
  public:
 
+    #ifndef DOXYGEN_SHOULD_SKIP_THIS
+    // Parameters in wire order (see FX_PARAM_TABLE() in dm_fx_effect_macros.h)
+    FX_PARAM_TABLE(fx_pitch_shift_fd,
+      FX_PARAM(param_enabled,      T_BOOL,  FX_SPECTRALIZER_PARAM_ID_ENABLED,      FX_SPECTRALIZER_PARAM_OFFSET_OFFSET_EN),
+      FX_PARAM_DB(param_freq_shift_1, T_FLOAT, FX_SPECTRALIZER_PARAM_ID_FREQ_SHIFT_1, FX_SPECTRALIZER_PARAM_OFFSET_FREQ_SHIFT_1, FX_DEADBAND_REL(0.001)),
+      FX_PARAM_DB(param_freq_shift_2, T_FLOAT, FX_SPECTRALIZER_PARAM_ID_FREQ_SHIFT_2, FX_SPECTRALIZER_PARAM_OFFSET_FREQ_SHIFT_2, FX_DEADBAND_REL(0.001)),
+      FX_PARAM(param_vol_1,        T_FLOAT, FX_SPECTRALIZER_PARAM_ID_VOL_1,        FX_SPECTRALIZER_PARAM_OFFSET_VOL_1),
+      FX_PARAM(param_vol_2,        T_FLOAT, FX_SPECTRALIZER_PARAM_ID_VOL_2,        FX_SPECTRALIZER_PARAM_OFFSET_VOL_2),
+      FX_PARAM(param_vol_clean,    T_FLOAT, FX_SPECTRALIZER_PARAM_ID_VOL_CLEAN,    FX_SPECTRALIZER_PARAM_OFFSET_VOL_CLEAN)
+    );
+    #endif
+
     /**
      * Audio routing node: primary audio input
      */
@@ -117,17 +129,8 @@ class fx_pitch_shift_fd: public fx_effect {
       // Defaults
       param_enabled = true;
 
-      // Initialize parameter stack
-      param_stack[total_params] = &param_freq_shift_1;
-      param_stack_types[total_params++] = T_FLOAT;
-      param_stack[total_params] = &param_freq_shift_2;
-      param_stack_types[total_params++] = T_FLOAT;
-      param_stack[total_params] = &param_vol_1;
-      param_stack_types[total_params++] = T_FLOAT;
-      param_stack[total_params] = &param_vol_2;
-      param_stack_types[total_params++] = T_FLOAT;
-      param_stack[total_params] = &param_vol_clean;
-      param_stack_types[total_params++] = T_FLOAT;
+      // Initialize parameter table
+      FX_PARAM_TABLE_INIT();
 
       // Add addiitonal notes to the control stack
       control_node_stack[total_control_nodes++] = &node_ctrl_freq_shift_1;
@@ -196,17 +199,8 @@ class fx_pitch_shift_fd: public fx_effect {
       // Defaults
       param_enabled = true;
 
-      // Initialize parameter stack
-      param_stack[total_params] = &param_freq_shift_1;
-      param_stack_types[total_params++] = T_FLOAT;
-      param_stack[total_params] = &param_freq_shift_2;
-      param_stack_types[total_params++] = T_FLOAT;
-      param_stack[total_params] = &param_vol_1;
-      param_stack_types[total_params++] = T_FLOAT;
-      param_stack[total_params] = &param_vol_2;
-      param_stack_types[total_params++] = T_FLOAT;
-      param_stack[total_params] = &param_vol_clean;
-      param_stack_types[total_params++] = T_FLOAT;
+      // Initialize parameter table
+      FX_PARAM_TABLE_INIT();
 
       // Add addiitonal notes to the control stack
       control_node_stack[total_control_nodes++] = &node_ctrl_freq_shift_1;
@@ -227,18 +221,14 @@ class fx_pitch_shift_fd: public fx_effect {
      * @brief      Enable the pitch shifter (it is enabled by default)
      */
     void enable() {
-      CHECK_LAST_ENABLED();
-      param_enabled = true; 
-      parent_canvas->spi_transmit_param(FX_SPECTRALIZER, instance_id, T_BOOL, FX_PITCH_SHIFT_PARAM_ID_ENABLED, (void *) &param_enabled);
+      set_param(&param_enabled, true);
     }
 
     /**
      * @brief      Bypass the pitch shifter (will just pass clean audio through)
      */
     void bypass() {
-      CHECK_LAST_DISABLED();
-      param_enabled = false; 
-      parent_canvas->spi_transmit_param(FX_SPECTRALIZER, instance_id, T_BOOL, FX_PITCH_SHIFT_PARAM_ID_ENABLED, (void *) &param_enabled);
+      set_param(&param_enabled, false);
     }
 
     /**
@@ -252,17 +242,8 @@ class fx_pitch_shift_fd: public fx_effect {
      *
      * @param[in]  new_freq_shift  The frequency shift
      */
-    void set_freq_shift_1(float new_freq_shift) { 
-
-      CHECK_LAST(new_freq_shift, param_freq_shift_1);
-
-      // If this node is being controlled by a controller, don't allow a direct write to it
-      if (node_ctrl_freq_shift_1.connected) {
-        return;
-      }
-
-      param_freq_shift_1 = new_freq_shift;
-      parent_canvas->spi_transmit_param(FX_SPECTRALIZER, instance_id, T_FLOAT, FX_SPECTRALIZER_PARAM_ID_FREQ_SHIFT_1, (void *) &param_freq_shift_1);
+    void set_freq_shift_1(float new_freq_shift) {
+      set_param(&param_freq_shift_1, new_freq_shift, &node_ctrl_freq_shift_1);
     }
 
     /**
@@ -276,17 +257,8 @@ class fx_pitch_shift_fd: public fx_effect {
      *
      * @param[in]  new_freq_shift  The frequency shift
      */
-    void set_freq_shift_2(float new_freq_shift) { 
-
-      CHECK_LAST(new_freq_shift, param_freq_shift_2);
-
-      // If this node is being controlled by a controller, don't allow a direct write to it
-      if (node_ctrl_freq_shift_2.connected) {
-        return;
-      }
-
-      param_freq_shift_2 = new_freq_shift;
-      parent_canvas->spi_transmit_param(FX_SPECTRALIZER, instance_id, T_FLOAT, FX_SPECTRALIZER_PARAM_ID_FREQ_SHIFT_2, (void *) &param_freq_shift_2);
+    void set_freq_shift_2(float new_freq_shift) {
+      set_param(&param_freq_shift_2, new_freq_shift, &node_ctrl_freq_shift_2);
     }
 
     /**
@@ -294,17 +266,8 @@ class fx_pitch_shift_fd: public fx_effect {
      *
      * @param[in]  vol_1  The volume level (0.0 to 1.0)
      */
-    void set_vol_1(float new_vol_1) { 
-
-      CHECK_LAST(new_vol_1, param_vol_1);
-
-      // If this node is being controlled by a controller, don't allow a direct write to it
-      if (node_ctrl_vol_1.connected) {
-        return;
-      }
-
-      param_vol_1 = new_vol_1;
-      parent_canvas->spi_transmit_param(FX_SPECTRALIZER, instance_id, T_FLOAT, FX_SPECTRALIZER_PARAM_ID_VOL_1, (void *) &param_vol_1);
+    void set_vol_1(float new_vol_1) {
+      set_param(&param_vol_1, new_vol_1, &node_ctrl_vol_1);
     }
 
     /**
@@ -312,17 +275,8 @@ class fx_pitch_shift_fd: public fx_effect {
      *
      * @param[in]  vol_2  The volume level (0.0 to 1.0)
      */
-    void set_vol_2(float new_vol_2) { 
-
-      CHECK_LAST(new_vol_2, param_vol_2);
-
-      // If this node is being controlled by a controller, don't allow a direct write to it
-      if (node_ctrl_vol_2.connected) {
-        return;
-      }
-
-      param_vol_2 = new_vol_2;
-      parent_canvas->spi_transmit_param(FX_SPECTRALIZER, instance_id, T_FLOAT, FX_SPECTRALIZER_PARAM_ID_VOL_2, (void *) &param_vol_2);
+    void set_vol_2(float new_vol_2) {
+      set_param(&param_vol_2, new_vol_2, &node_ctrl_vol_2);
     }
 
     /**
@@ -330,17 +284,8 @@ class fx_pitch_shift_fd: public fx_effect {
      *
      * @param[in]  vol_2  The volume level (0.0 to 1.0)
      */
-    void set_vol_clean(float new_vol_clean) { 
-
-      CHECK_LAST(new_vol_clean, param_vol_clean);
-
-      // If this node is being controlled by a controller, don't allow a direct write to it
-      if (node_ctrl_vol_clean.connected) {
-        return;
-      }
-
-      param_vol_clean = new_vol_clean;
-      parent_canvas->spi_transmit_param(FX_SPECTRALIZER, instance_id, T_FLOAT, FX_SPECTRALIZER_PARAM_ID_VOL_CLEAN, (void *) &param_vol_clean);
+    void set_vol_clean(float new_vol_clean) {
+      set_param(&param_vol_clean, new_vol_clean, &node_ctrl_vol_clean);
     }    
 
     /**
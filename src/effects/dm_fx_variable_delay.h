@@ -61,36 +61,8 @@ class fx_variable_delay: public fx_effect {
       ext_mod_in = &node_loop_ext_mod;      
       modulated_out = &node_modulated_out;
 
- 			// Initialize parameter stack
-      int indx = 1;
-      param_stack[indx] = &param_rate_hz;
-      param_stack_types[indx++] = T_FLOAT;
-
-      param_stack[indx] = &param_depth;
-      param_stack_types[indx++] = T_FLOAT;
-
-      param_stack[indx] = &param_initial_phase_deg;
-      param_stack_types[indx++] = T_FLOAT;
-
-      param_stack[indx] = &param_feedback;
-      param_stack_types[indx++] = T_FLOAT;
-
-      param_stack[indx] = &param_type;
-      param_stack_types[indx++] = T_INT16;
-
-      param_stack[indx] = &param_ext_modulator;
-      param_stack_types[indx++] = T_BOOL;
-
-      param_stack[indx] = &param_delay_buf_size_ms;
-      param_stack_types[indx++] = T_FLOAT;
-
-      param_stack[indx] = &param_mix_clean;
-      param_stack_types[indx++] = T_FLOAT;
-
-      param_stack[indx] = &param_mix_delayed;
-      param_stack_types[indx++] = T_FLOAT;
-
-      total_params = indx;      
+      // Initialize parameter table
+      FX_PARAM_TABLE_INIT();
 
       // Add additional nodes to the audio stack
       audio_node_stack[total_audio_nodes++] = &node_loop_ext_mod;
@@ -112,6 +84,22 @@ class fx_variable_delay: public fx_effect {
 
   public:
 
+    #ifndef DOXYGEN_SHOULD_SKIP_THIS
+    // Parameters in wire order (see FX_PARAM_TABLE() in dm_fx_effect_macros.h)
+    FX_PARAM_TABLE(fx_variable_delay,
+      FX_PARAM(param_enabled,           T_BOOL,  FX_VAR_DELAY_PARAM_ID_ENABLED,      FX_VAR_DELAY_OFFSET_ENABLED),
+      FX_PARAM(param_rate_hz,           T_FLOAT, FX_VAR_DELAY_PARAM_ID_MOD_FREQ,     FX_VAR_DELAY_OFFSET_MOD_FREQ),
+      FX_PARAM(param_depth,             T_FLOAT, FX_VAR_DELAY_PARAM_ID_MOD_DEPTH,    FX_VAR_DELAY_OFFSET_MOD_DEPTH),
+      FX_PARAM(param_initial_phase_deg, T_FLOAT, FX_VAR_DELAY_PARAM_ID_MOD_PHASE,    FX_VAR_DELAY_OFFSET_MOD_PHASE),
+      FX_PARAM(param_feedback,          T_FLOAT, FX_VAR_DELAY_PARAM_ID_FEEDBACK,     FX_VAR_DELAY_OFFSET_FEEDBACK),
+      FX_PARAM(param_type,              T_INT16, FX_VAR_DELAY_PARAM_ID_MOD_TYPE,     FX_VAR_DELAY_OFFSET_MOD_TYPE),
+      FX_PARAM(param_ext_modulator,     T_BOOL,  FX_VAR_DELAY_PARAM_ID_EXT_MOD,      FX_VAR_DELAY_OFFSET_EXT_MOD),
+      FX_PARAM(param_delay_buf_size_ms, T_FLOAT, FX_VAR_DELAY_PARAM_ID_DELAY_LEN_MS, FX_VAR_DELAY_OFFSET_DELAY_LEN_MS),
+      FX_PARAM(param_mix_clean,         T_FLOAT, FX_VAR_DELAY_PARAM_ID_MIX_CLEAN,    FX_VAR_DELAY_OFFSET_MIX_CLEAN),
+      FX_PARAM(param_mix_delayed,       T_FLOAT, FX_VAR_DELAY_PARAM_ID_MIX_DELAYED,  FX_VAR_DELAY_OFFSET_MIX_DELAYED)
+    );
+    #endif
+
     /**
      * Audio routing node [input]: primary audio input
      */
@@ -175,13 +163,13 @@ class fx_variable_delay: public fx_effect {
      *                       (e.g. OSC_SINE, OSC_TRI, etc.)
      */
     fx_variable_delay(float rate_hz, float depth, float feedback, OSC_TYPES mod_type) :
-      node_loop_ext_mod(NODE_IN, "external modulator", this),
-      node_modulated_out(NODE_OUT, "modulated output", this),
       node_ctrl_depth(NODE_IN, NODE_FLOAT, "node_ctrl_depth", this, FX_VAR_DELAY_PARAM_ID_MOD_DEPTH),
       node_ctrl_rate_hz(NODE_IN, NODE_FLOAT, "node_ctrl_rate_hz", this, FX_VAR_DELAY_PARAM_ID_MOD_FREQ),
+      node_ctrl_feedback(NODE_IN, NODE_FLOAT, "node_ctrl_feedback", this, FX_VAR_DELAY_PARAM_ID_FEEDBACK),
       node_ctrl_mix_clean(NODE_IN, NODE_FLOAT, "node_ctrl_mix_clean", this, FX_VAR_DELAY_PARAM_ID_MIX_CLEAN),
       node_ctrl_mix_delayed(NODE_IN, NODE_FLOAT, "node_ctrl_mix_delayed", this, FX_VAR_DELAY_PARAM_ID_MIX_DELAYED),
-      node_ctrl_feedback(NODE_IN, NODE_FLOAT, "node_ctrl_feedback", this, FX_VAR_DELAY_PARAM_ID_FEEDBACK) { 
+      node_loop_ext_mod(NODE_IN, "external modulator", this),
+      node_modulated_out(NODE_OUT, "modulated output", this) { 
 
       // Set parameters
       param_initial_phase_deg = 0;
@@ -216,13 +204,13 @@ class fx_variable_delay: public fx_effect {
      * @param[in]  ext_mod      whether to use an external modulation source (set to true or false)
      */
     fx_variable_delay(float rate_hz, float depth, float feedback, float buf_size_ms, float mix_clean, float mix_delayed, OSC_TYPES mod_type, bool ext_mod ) :
-      node_loop_ext_mod(NODE_IN, "external modulator", this),
-      node_modulated_out(NODE_OUT, "modulated output", this),
       node_ctrl_depth(NODE_IN, NODE_FLOAT, "node_ctrl_depth", this, FX_VAR_DELAY_PARAM_ID_MOD_DEPTH),
       node_ctrl_rate_hz(NODE_IN, NODE_FLOAT, "node_ctrl_rate_hz", this, FX_VAR_DELAY_PARAM_ID_MOD_FREQ),
+      node_ctrl_feedback(NODE_IN, NODE_FLOAT, "node_ctrl_feedback", this, FX_VAR_DELAY_PARAM_ID_FEEDBACK),
       node_ctrl_mix_clean(NODE_IN, NODE_FLOAT, "node_ctrl_mix_clean", this, FX_VAR_DELAY_PARAM_ID_MIX_CLEAN),
-      node_ctrl_mix_delayed(NODE_IN, NODE_FLOAT, "node_ctrl_mix_delayed", this, FX_VAR_DELAY_PARAM_ID_MIX_DELAYED),      
-      node_ctrl_feedback(NODE_IN, NODE_FLOAT, "node_ctrl_feedback", this, FX_VAR_DELAY_PARAM_ID_FEEDBACK) { 
+      node_ctrl_mix_delayed(NODE_IN, NODE_FLOAT, "node_ctrl_mix_delayed", this, FX_VAR_DELAY_PARAM_ID_MIX_DELAYED),
+      node_loop_ext_mod(NODE_IN, "external modulator", this),
+      node_modulated_out(NODE_OUT, "modulated output", this) { 
 
       // Set parameters
       param_initial_phase_deg = 0;
@@ -258,13 +246,13 @@ class fx_variable_delay: public fx_effect {
      * @param[in]  initial_phase Initial phase in degrees
      */
     fx_variable_delay(float rate_hz, float depth, float feedback, float buf_size_ms, float mix_clean, float mix_delayed, OSC_TYPES mod_type, bool ext_mod, float initial_phase ) :
-      node_loop_ext_mod(NODE_IN, "external modulator", this),
-      node_modulated_out(NODE_OUT, "modulated output", this),
       node_ctrl_depth(NODE_IN, NODE_FLOAT, "node_ctrl_depth", this, FX_VAR_DELAY_PARAM_ID_MOD_DEPTH),
       node_ctrl_rate_hz(NODE_IN, NODE_FLOAT, "node_ctrl_rate_hz", this, FX_VAR_DELAY_PARAM_ID_MOD_FREQ),
+      node_ctrl_feedback(NODE_IN, NODE_FLOAT, "node_ctrl_feedback", this, FX_VAR_DELAY_PARAM_ID_FEEDBACK),
       node_ctrl_mix_clean(NODE_IN, NODE_FLOAT, "node_ctrl_mix_clean", this, FX_VAR_DELAY_PARAM_ID_MIX_CLEAN),
-      node_ctrl_mix_delayed(NODE_IN, NODE_FLOAT, "node_ctrl_mix_delayed", this, FX_VAR_DELAY_PARAM_ID_MIX_DELAYED),      
-      node_ctrl_feedback(NODE_IN, NODE_FLOAT, "node_ctrl_feedback", this, FX_VAR_DELAY_PARAM_ID_FEEDBACK) { 
+      node_ctrl_mix_delayed(NODE_IN, NODE_FLOAT, "node_ctrl_mix_delayed", this, FX_VAR_DELAY_PARAM_ID_MIX_DELAYED),
+      node_loop_ext_mod(NODE_IN, "external modulator", this),
+      node_modulated_out(NODE_OUT, "modulated output", this) { 
 
       // Set parameters
       param_initial_phase_deg = initial_phase;
@@ -285,18 +273,14 @@ class fx_variable_delay: public fx_effect {
      * @brief      Enable the __this_effect__ (it is enabled by default)
      */
     void enable() {
-      CHECK_LAST_ENABLED();
-      param_enabled = true; 
-      parent_canvas->spi_transmit_param(FX_VARIABLE_DELAY, instance_id, T_BOOL, FX_VAR_DELAY_PARAM_ID_ENABLED, (void *) &param_enabled);
+      set_param(&param_enabled, true);
     }
 
     /**
      * @brief      Bypass the __this_effect__ (will just pass clean audio through)
      */
     void bypass() {
-      CHECK_LAST_DISABLED();
-      param_enabled = false; 
-      parent_canvas->spi_transmit_param(FX_VARIABLE_DELAY, instance_id, T_BOOL, FX_VAR_DELAY_PARAM_ID_ENABLED, (void *) &param_enabled);
+      set_param(&param_enabled, false);
     }  
 
     /**
@@ -304,17 +288,18 @@ class fx_variable_delay: public fx_effect {
      *
      * @param[in]  depth  The new depth value
      */
-    void set_depth(float depth) { 
-
-      CHECK_LAST(depth, param_depth);
-
-      // If this node is being controlled by a controller, don't allow a direct write to it
-      if (node_ctrl_depth.connected) {
-        return; 
-      }
+    void set_depth(float depth) {
+      set_param(&param_depth, depth, &node_ctrl_depth);
+    }
 
-      param_depth = depth; 
-      parent_canvas->spi_transmit_param(FX_VARIABLE_DELAY, instance_id, T_FLOAT, FX_VAR_DELAY_PARAM_ID_MOD_DEPTH, &param_depth);
+    /**
+     * @brief      Ramps the depth of the variable delay to a new value over a period of time.
+     *
+     * @param[in]  depth  The new value
+     * @param[in]  ramp_ms  The duration of the ramp in milliseconds
+     */
+    void set_depth_ramped(float depth, uint32_t ramp_ms) {
+      ramp_param(&param_depth, &node_ctrl_depth, depth, ramp_ms);
     }
 
     /**
@@ -322,17 +307,8 @@ class fx_variable_delay: public fx_effect {
      *
      * @param[in]  rate_hz  The new rate hz
      */
-    void set_rate_hz(float rate_hz) { 
-
-      CHECK_LAST(rate_hz, param_rate_hz);
-
-      // If this node is being controlled by a controller, don't allow a direct write to it
-      if (node_ctrl_rate_hz.connected) {
-        return; 
-      }
-
-      param_rate_hz = rate_hz; 
-      parent_canvas->spi_transmit_param(FX_VARIABLE_DELAY, instance_id, T_FLOAT, FX_VAR_DELAY_PARAM_ID_MOD_FREQ, &param_rate_hz);
+    void set_rate_hz(float rate_hz) {
+      set_param(&param_rate_hz, rate_hz, &node_ctrl_rate_hz);
     }    
 
     /**
@@ -340,67 +316,65 @@ class fx_variable_delay: public fx_effect {
      *
      * @param[in]  feedback  The new feedback value (-1.0->1.0)
      */
-    void set_feedback(float feedback) { 
-
-      CHECK_LAST(feedback, param_feedback);
-
-      // If this node is being controlled by a controller, don't allow a direct write to it
-      if (node_ctrl_rate_hz.connected) {
-        return; 
-      }
-
-      param_feedback = feedback; 
-      parent_canvas->spi_transmit_param(FX_VARIABLE_DELAY, instance_id, T_FLOAT, FX_VAR_DELAY_PARAM_ID_FEEDBACK, &param_feedback);
+    void set_feedback(float feedback) {
+      set_param(&param_feedback, feedback, &node_ctrl_feedback);
     }   
 
+    /**
+     * @brief      Ramps the feedback of the variable delay to a new value over a period of time.
+     *
+     * @param[in]  feedback  The new value (-1.0->1.0)
+     * @param[in]  ramp_ms  The duration of the ramp in milliseconds
+     */
+    void set_feedback_ramped(float feedback, uint32_t ramp_ms) {
+      ramp_param(&param_feedback, &node_ctrl_feedback, feedback, ramp_ms);
+    }
+
     /**
      * @brief      Updates the clean mix of the variable delay
      *
      * @param[in]  mix_clean  The new clean mix value
      */
-    void set_mix_clean(float mix_clean) { 
-
-      CHECK_LAST(mix_clean, param_mix_clean);
-
-      // If this node is being controlled by a controller, don't allow a direct write to it
-      if (node_ctrl_mix_clean.connected) {
-        return; 
-      }
-
-      param_mix_clean = mix_clean; 
-      parent_canvas->spi_transmit_param(FX_VARIABLE_DELAY, instance_id, T_FLOAT, FX_VAR_DELAY_PARAM_ID_MIX_CLEAN, &param_mix_clean);
+    void set_mix_clean(float mix_clean) {
+      set_param(&param_mix_clean, mix_clean, &node_ctrl_mix_clean);
     }     
 
+    /**
+     * @brief      Ramps the clean mix of the variable delay to a new value over a period of time.
+     *
+     * @param[in]  mix_clean  The new value
+     * @param[in]  ramp_ms  The duration of the ramp in milliseconds
+     */
+    void set_mix_clean_ramped(float mix_clean, uint32_t ramp_ms) {
+      ramp_param(&param_mix_clean, &node_ctrl_mix_clean, mix_clean, ramp_ms);
+    }
+
     /**
      * @brief      Updates the delayed signal mix of the variable delay
      *
      * @param[in]  mix_delayed  The new delayed mix value
      */
-    void set_mix_delayed(float mix_delayed) { 
-
-      CHECK_LAST(mix_delayed, param_mix_delayed);
-
-      // If this node is being controlled by a controller, don't allow a direct write to it
-      if (node_ctrl_mix_delayed.connected) {
-        return; 
-      }
-
-      param_mix_delayed= mix_delayed; 
-      parent_canvas->spi_transmit_param(FX_VARIABLE_DELAY, instance_id, T_FLOAT, FX_VAR_DELAY_PARAM_ID_MIX_DELAYED, &param_mix_delayed);
+    void set_mix_delayed(float mix_delayed) {
+      set_param(&param_mix_delayed, mix_delayed, &node_ctrl_mix_delayed);
     }     
 
+    /**
+     * @brief      Ramps the delayed signal mix of the variable delay to a new value over a period of time.
+     *
+     * @param[in]  mix_delayed  The new value
+     * @param[in]  ramp_ms  The duration of the ramp in milliseconds
+     */
+    void set_mix_delayed_ramped(float mix_delayed, uint32_t ramp_ms) {
+      ramp_param(&param_mix_delayed, &node_ctrl_mix_delayed, mix_delayed, ramp_ms);
+    }
+
     /**
      * @brief      Sets the the type of oscillator used as the LFO
      *
      * @param[in]  new_type  The new type of LFO (OSC_TYPES)
      */
     void set_lfo_type(OSC_TYPES new_type) {
-
-      CHECK_LAST(new_type, param_type);
-
-      param_type = new_type; 
-      parent_canvas->spi_transmit_param(FX_VARIABLE_DELAY, instance_id, T_INT16, FX_VAR_DELAY_PARAM_ID_MOD_TYPE, &param_type);
-
+      set_param(&param_type, new_type);
     }
 
    /**
@@ -0,0 +1,143 @@
+// Host build of the library: the parts of the Arduino core the library uses.
+// Time, pins and the SPI / serial ports are simulated in host_arduino.cpp and 
+// can be driven from a test through host_arduino.h.
+#ifndef HOST_ARDUINO_H_CORE
+#define HOST_ARDUINO_H_CORE
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+#include "binary.h"
+
+using std::min;
+using std::max;
+
+typedef bool    boolean;
+typedef uint8_t byte;
+
+#define PROGMEM
+#define F_CPU         (120000000UL)
+#define HSRAM_ADDR    (0x20000000)
+#define HSRAM_SIZE    (0x40000)
+
+#define HIGH          (1)
+#define LOW           (0)
+#define INPUT         (0)
+#define OUTPUT        (1)
+#define INPUT_PULLUP  (2)
+#define INPUT_PULLDOWN (3)
+#define CHANGE        (2)
+#define FALLING       (3)
+#define RISING        (4)
+
+#define A0            (14)
+#define A1            (15)
+#define A2            (16)
+#define A3            (17)
+#define A4            (18)
+#define A5            (19)
+
+#define DEC           (10)
+#define HEX           (16)
+#define BIN           (2)
+
+class String {
+  char buf[64];
+ public:
+  String(const char * s = "")                 { snprintf(buf, sizeof(buf), "%s", s); }
+  String(float f, int digits = 2)             { snprintf(buf, sizeof(buf), "%.*f", digits, f); }
+  String(double f, int digits = 2)            { snprintf(buf, sizeof(buf), "%.*f", digits, f); }
+  String(int i, int base = DEC)               { snprintf(buf, sizeof(buf), base == HEX ? "%x" : "%d", i); }
+  String(unsigned i, int base = DEC)          { snprintf(buf, sizeof(buf), base == HEX ? "%x" : "%u", i); }
+  String(long i, int base = DEC)              { snprintf(buf, sizeof(buf), base == HEX ? "%lx" : "%ld", i); }
+  String(unsigned long i, int base = DEC)     { snprintf(buf, sizeof(buf), base == HEX ? "%lx" : "%lu", i); }
+  const char * c_str() const                  { return buf; }
+  unsigned length() const                     { return strlen(buf); }
+  void toCharArray(char * out, unsigned n) const {
+    if (n) {
+      size_t len = strlen(buf) < n ? strlen(buf) : n - 1;
+      memcpy(out, buf, len);
+      out[len] = 0;
+    }
+  }
+  void replace(const char * from, const char * to) {
+    char out[sizeof(buf)] = "";
+    size_t from_len = strlen(from);
+    for (const char * p = buf; *p && from_len; ) {
+      if (!strncmp(p, from, from_len)) {
+        strncat(out, to, sizeof(out) - 1 - strlen(out));
+        p += from_len;
+      } else {
+        size_t len = strlen(out);
+        if (len < sizeof(out) - 1) {
+          out[len] = *p;
+          out[len + 1] = 0;
+        }
+        p++;
+      }
+    }
+    if (from_len) {
+      memcpy(buf, out, sizeof(buf));
+    }
+  }
+  String operator+(const String & o) const    { String r(buf); strncat(r.buf, o.buf, sizeof(r.buf) - 1 - strlen(r.buf)); return r; }
+  String operator+(const char * o) const      { return *this + String(o); }
+  friend String operator+(const char * a, const String & b) { return String(a) + b; }
+};
+
+// Serial output goes to stdout while host_serial_echo is set
+class Print {
+ public:
+  virtual size_t write(uint8_t c);
+  size_t print(const char * s);
+  size_t print(const String & s)              { return print(s.c_str()); }
+  size_t print(char c)                        { return write((uint8_t) c); }
+  size_t print(int v, int base = DEC)         { return print(String(v, base)); }
+  size_t print(unsigned v, int base = DEC)    { return print(String(v, base)); }
+  size_t print(long v, int base = DEC)        { return print(String(v, base)); }
+  size_t print(unsigned long v, int base = DEC) { return print(String(v, base)); }
+  size_t print(double v, int digits = 2)      { return print(String(v, digits)); }
+  size_t println(void)                        { return print("\n"); }
+  template<typename T> size_t println(T v)    { return print(v) + println(); }
+  template<typename T> size_t println(T v, int fmt) { return print(v, fmt) + println(); }
+};
+
+class Stream : public Print {
+ public:
+  virtual int available(void) { return 0; }
+  virtual int read(void)      { return -1; }
+  virtual int peek(void)      { return -1; }
+};
+
+class HardwareSerial : public Stream {
+ public:
+  void begin(unsigned long) { }
+  operator bool()           { return true; }
+};
+
+extern HardwareSerial Serial, Serial1;
+
+unsigned long millis(void);
+unsigned long micros(void);
+void  delay(unsigned long ms);
+void  delayMicroseconds(unsigned int us);
+
+void  pinMode(uint32_t pin, uint32_t mode);
+void  digitalWrite(uint32_t pin, uint32_t val);
+int   digitalRead(uint32_t pin);
+int   analogRead(uint32_t pin);
+
+#define digitalPinToInterrupt(p)  (p)
+void  attachInterrupt(uint32_t pin, void (*isr)(void), uint32_t mode);
+void  noInterrupts(void);
+void  interrupts(void);
+
+long  random(long max_val);
+void  NVIC_SystemReset(void);
+
+#endif  // HOST_ARDUINO_H_CORE
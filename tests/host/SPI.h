@@ -0,0 +1,30 @@
+// Host build of the library: SPI port routed to the hooks in host_arduino.h
+#ifndef HOST_SPI_H
+#define HOST_SPI_H
+
+#include "Arduino.h"
+
+#define MSBFIRST    (1)
+#define SPI_MODE0   (0)
+#define SPI_MODE1   (1)
+#define SPI_MODE2   (2)
+#define SPI_MODE3   (3)
+
+struct SPISettings {
+  SPISettings() { }
+  SPISettings(uint32_t, uint8_t, uint8_t) { }
+};
+
+class SPIClass {
+ public:
+  void     begin(void) { }
+  void     end(void) { }
+  void     beginTransaction(SPISettings) { }
+  void     endTransaction(void) { }
+  uint8_t  transfer(uint8_t val);
+  uint16_t transfer16(uint16_t val);
+};
+
+extern SPIClass SPI;
+
+#endif  // HOST_SPI_H
@@ -0,0 +1,20 @@
+// Host build of the library: I2C port with nothing attached
+#ifndef HOST_WIRE_H
+#define HOST_WIRE_H
+
+#include "Arduino.h"
+
+class TwoWire : public Stream {
+ public:
+  void    begin(void) { }
+  void    setClock(uint32_t) { }
+  void    beginTransmission(uint8_t) { }
+  uint8_t endTransmission(bool stop = true) { (void) stop; return 0; }
+  size_t  write(uint8_t) { return 1; }
+  size_t  write(const uint8_t *, size_t n) { return n; }
+  uint8_t requestFrom(uint8_t, uint8_t) { return 0; }
+};
+
+extern TwoWire Wire, Wire2;
+
+#endif  // HOST_WIRE_H
@@ -0,0 +1,109 @@
+// Host build of the library: simulated time, pins and ports
+#include "Arduino.h"
+#include "SPI.h"
+#include "Wire.h"
+#include "host_arduino.h"
+
+HardwareSerial  Serial, Serial1;
+SPIClass        SPI;
+TwoWire         Wire, Wire2;
+
+uint64_t  host_us = 0;
+uint32_t  host_call_step_us = 10;
+uint64_t  host_us_limit = 3600ULL * 1000000ULL;
+
+uint16_t  (*host_spi16_hook)(uint16_t tx) = NULL;
+uint8_t   (*host_spi8_hook)(uint8_t tx) = NULL;
+void      (*host_pin_write_hook)(uint32_t pin, uint32_t val) = NULL;
+int       (*host_pin_read_hook)(uint32_t pin) = NULL;
+int       (*host_analog_read_hook)(uint32_t pin) = NULL;
+
+bool      host_serial_echo = false;
+void      (*host_serial_hook)(char c) = NULL;
+int       host_failures = 0;
+
+void host_advance_us(uint64_t us) {
+  host_us += us;
+  if (host_us > host_us_limit) {
+    fprintf(stderr, "simulated time limit reached (library hung?)\n");
+    exit(2);
+  }
+}
+
+int host_test_result(const char * name) {
+  printf("%s: %s\n", name, host_failures ? "FAILED" : "passed");
+  return host_failures ? 1 : 0;
+}
+
+unsigned long millis(void) {
+  host_advance_us(host_call_step_us);
+  return (unsigned long) (host_us / 1000);
+}
+
+unsigned long micros(void) {
+  host_advance_us(host_call_step_us);
+  return (unsigned long) host_us;
+}
+
+void delay(unsigned long ms) {
+  host_advance_us((uint64_t) ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us) {
+  host_advance_us(us);
+}
+
+void pinMode(uint32_t, uint32_t) { }
+
+void digitalWrite(uint32_t pin, uint32_t val) {
+  if (host_pin_write_hook) {
+    host_pin_write_hook(pin, val);
+  }
+}
+
+int digitalRead(uint32_t pin) {
+  return host_pin_read_hook ? host_pin_read_hook(pin) : HIGH;
+}
+
+int analogRead(uint32_t pin) {
+  return host_analog_read_hook ? host_analog_read_hook(pin) : 512;
+}
+
+void attachInterrupt(uint32_t, void (*)(void), uint32_t) { }
+void noInterrupts(void) { }
+void interrupts(void) { }
+
+long random(long max_val) {
+  return max_val > 0 ? rand() % max_val : 0;
+}
+
+void NVIC_SystemReset(void) {
+  fprintf(stderr, "NVIC_SystemReset()\n");
+  exit(3);
+}
+
+uint8_t SPIClass::transfer(uint8_t val) {
+  return host_spi8_hook ? host_spi8_hook(val) : 0;
+}
+
+uint16_t SPIClass::transfer16(uint16_t val) {
+  return host_spi16_hook ? host_spi16_hook(val) : 0;
+}
+
+size_t Print::write(uint8_t c) {
+  if (host_serial_echo) {
+    putchar(c);
+  }
+  if (host_serial_hook) {
+    host_serial_hook((char) c);
+  }
+  return 1;
+}
+
+size_t Print::print(const char * s) {
+  size_t n = 0;
+  while (*s) {
+    n += write((uint8_t) *s++);
+  }
+  return n;
+}
@@ -0,0 +1,44 @@
+// Host build of the library: controls for the simulated board
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+
+// Simulated time in microseconds.  Every call to millis() / micros() also 
+// advances it by host_call_step_us so the library's busy-wait loops finish; 
+// tests that need exact timing set this to 0 and call host_advance_us().
+extern uint64_t host_us;
+extern uint32_t host_call_step_us;
+void  host_advance_us(uint64_t us);
+
+// Simulated time at which a test is considered hung (it exits with an error)
+extern uint64_t host_us_limit;
+
+// Peripherals: NULL hooks read back 0 / HIGH / mid-scale
+extern uint16_t (*host_spi16_hook)(uint16_t tx);
+extern uint8_t  (*host_spi8_hook)(uint8_t tx);
+extern void     (*host_pin_write_hook)(uint32_t pin, uint32_t val);
+extern int      (*host_pin_read_hook)(uint32_t pin);
+extern int      (*host_analog_read_hook)(uint32_t pin);
+
+// Print Serial output to stdout, and / or pass each character to a hook
+extern bool     host_serial_echo;
+extern void     (*host_serial_hook)(char c);
+
+// Test results
+extern int      host_failures;
+
+#define CHECK(cond) \
+  do { \
+    if (!(cond)) { \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+      host_failures++; \
+    } \
+  } while (0)
+
+#define CHECK_NEAR(a, b, tol)  CHECK(fabs((double) (a) - (double) (b)) <= (tol))
+
+// Prints the result and returns the exit code for main()
+int   host_test_result(const char * name);
+
+#endif  // HOST_ARDUINO_H
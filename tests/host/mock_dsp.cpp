@@ -0,0 +1,190 @@
+// Host build of the library: a model of the DSP end of the SPI link
+#include "dreammakerfx.h"
+#include "host_arduino.h"
+#include "mock_dsp.h"
+
+#define MOCK_DSP_BLOCK_SAMPLES  (128)
+
+static mock_dsp * attached_dsp = NULL;
+
+static uint16_t mock_dsp_spi(uint16_t w) {
+  return attached_dsp->transfer(w);
+}
+
+mock_dsp::mock_dsp() {
+  active = 0;
+  selected = CANVAS_SLOT_ACTIVE;
+  shadow_ready = false;
+  dropouts = 0;
+  firmware_ver = 70000;
+  canvas_slots = true;
+  extra_state = 0;
+  status_words = SPI_DSP_STAT_FRAME_SIZE;
+  rx_state = 0;
+  rx_size = 0;
+  tx_pos = 0;
+  for (int i=0;i<2;i++) {
+    canvas[i].loaded = false;
+    canvas[i].running = false;
+  }
+}
+
+void mock_dsp::attach(void) {
+  attached_dsp = this;
+  host_spi16_hook = mock_dsp_spi;
+}
+
+int mock_dsp::count_frames(uint16_t header) const {
+  int n = 0;
+  for (size_t i=0;i<frames.size();i++) {
+    if (!frames[i].words.empty() && frames[i].words[0] == header) {
+      n++;
+    }
+  }
+  return n;
+}
+
+uint16_t mock_dsp::transfer(uint16_t mcu_word) {
+  if (tx_pos >= tx_queue.size()) {
+    queue_status();
+  }
+  // The block counter is read as it goes out rather than when the status 
+  // frame was queued, which may be a service tick earlier
+  if (tx_pos == 2 + SPI_DSP_STAT_BLOCK_COUNT_HI && status_words > SPI_DSP_STAT_BLOCK_COUNT_LO) {
+    uint32_t blocks = current_block();
+    tx_queue[tx_pos] = blocks >> 16;
+    tx_queue[tx_pos + 1] = blocks & 0xFFFF;
+  }
+  uint16_t out = tx_queue[tx_pos++];
+  receive(mcu_word);
+  return out;
+}
+
+uint32_t mock_dsp::current_block(void) const {
+  return (uint32_t) (host_us * DSP_SAMPLE_RATE_HZ / MOCK_DSP_BLOCK_SAMPLES / 1000000);
+}
+
+void mock_dsp::queue_status(void) {
+  std::vector<uint16_t> payload(status_words > SPI_DSP_STAT_FRAME_SIZE ? status_words : (uint16_t) SPI_DSP_STAT_FRAME_SIZE, 0);
+
+  uint16_t state = SYS_VALID | SYS_INITIALIZED | SYS_HF_AUDIO | SYS_LF_AUDIO | extra_state;
+  if (canvas[active].running) {
+    state |= SYS_CANVAS_OK;
+  }
+  if (shadow_ready) {
+    state |= SYS_SHADOW_OK;
+  }
+  if (canvas_slots) {
+    state |= SYS_CAP_CANVAS_SLOTS;
+  }
+  uint32_t blocks = current_block();
+
+  payload[SPI_DSP_STAT_FIRMWARE_MAJ] = firmware_ver >> 16;
+  payload[SPI_DSP_STAT_FIRMWARE_MIN] = firmware_ver & 0xFFFF;
+  payload[SPI_DSP_STAT_SYS_STATE] = state;
+  payload[SPI_DSP_STAT_BLOCK_COUNT_HI] = blocks >> 16;
+  payload[SPI_DSP_STAT_BLOCK_COUNT_LO] = blocks & 0xFFFF;
+  payload[SPI_DSP_STAT_READBACK_COUNT] = readbacks.size() / 3;
+  for (size_t i=0;i<readbacks.size() && i < SPI_READBACK_SLOTS * 3;i++) {
+    payload[SPI_DSP_STAT_READBACK_START + i] = readbacks[i];
+  }
+
+  tx_queue.clear();
+  tx_pos = 0;
+  tx_queue.push_back(0x80FD);
+  tx_queue.push_back(0x80FE);
+  tx_queue.insert(tx_queue.end(), payload.begin(), payload.begin() + status_words);
+  tx_queue.push_back(0x80FF);
+}
+
+void mock_dsp::receive(uint16_t w) {
+  switch (rx_state) {
+    case 0:
+      rx_state = (w == 0x80FD) ? 1 : 0;
+      break;
+    case 1:
+      rx_state = (w == 0x80FE) ? 2 : 0;
+      break;
+    case 2:
+      rx_size = w;
+      rx_frame.us = host_us;
+      rx_frame.words.clear();
+      rx_state = rx_size ? 3 : 4;
+      break;
+    case 3:
+      rx_frame.words.push_back(w);
+      if (rx_frame.words.size() >= rx_size) {
+        rx_state = 4;
+      }
+      break;
+    case 4:
+      if (w == 0x80FF) {
+        frames.push_back(rx_frame);
+        process(rx_frame);
+      }
+      rx_state = 0;
+      break;
+  }
+}
+
+void mock_dsp::process(const MOCK_DSP_FRAME & f) {
+  if (f.words.empty()) {
+    return;
+  }
+  int target = (selected == CANVAS_SLOT_SHADOW) ? 1 - active : active;
+  MOCK_DSP_CANVAS * c = &canvas[target];
+
+  switch (f.words[0]) {
+    case HEADER_AUDIO_ROUTING_BLOCK:
+      // A new canvas replaces whatever the slot held
+      if (c->running) {
+        dropouts++;
+      }
+      c->loaded = false;
+      c->running = false;
+      c->params.clear();
+      if (target != active) {
+        shadow_ready = false;
+      }
+      break;
+
+    case HEADER_INSTANCE_BLOCK:
+      c->instances.assign(f.words.begin() + 1, f.words.end());
+      c->loaded = true;
+      break;
+
+    case HEADER_PARAMETER_BLOCK:
+      if (f.words.size() >= 3) {
+        c->params[f.words[2] & 0xFF].assign(f.words.begin() + 3, f.words.end());
+      }
+      break;
+
+    case HEADER_SET_BYPASS:
+      if (canvas[active].loaded) {
+        canvas[active].running = true;
+      }
+      break;
+
+    case HEADER_CANVAS_SLOT:
+      if (canvas_slots && f.words.size() >= 2) {
+        selected = f.words[1];
+        if (selected == CANVAS_SLOT_ACTIVE && canvas[1 - active].loaded) {
+          shadow_ready = true;
+        }
+      }
+      break;
+
+    case HEADER_SWAP_CANVAS:
+      if (canvas_slots && shadow_ready) {
+        canvas[active].running = false;
+        canvas[active].loaded = false;
+        active = 1 - active;
+        canvas[active].running = true;
+        shadow_ready = false;
+      }
+      break;
+
+    default:
+      break;
+  }
+}
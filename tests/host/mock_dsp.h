@@ -0,0 +1,71 @@
+// Host build of the library: a model of the DSP end of the SPI link
+#ifndef HOST_MOCK_DSP_H
+#define HOST_MOCK_DSP_H
+
+#include <stdint.h>
+#include <map>
+#include <vector>
+
+// A frame received from the MCU (payload only, header word first)
+struct MOCK_DSP_FRAME {
+  uint64_t              us;
+  std::vector<uint16_t> words;
+};
+
+// Canvas held in one slot of the DSP
+struct MOCK_DSP_CANVAS {
+  bool                  loaded;         // instance stack received
+  bool                  running;
+  std::vector<uint16_t> instances;      // type << 8 | id
+  std::map<uint8_t, std::vector<uint16_t> > params;   // by instance id
+};
+
+/**
+ * Decodes the frames the library sends and answers with status frames.  The
+ * active canvas starts running when the bypass state is set after its 
+ * instance stack has been sent; the shadow slot follows HEADER_CANVAS_SLOT 
+ * and HEADER_SWAP_CANVAS.  With canvas_slots cleared it behaves like older 
+ * firmware: it does not report SYS_CAP_CANVAS_SLOTS and ignores both headers, 
+ * so every canvas frame goes to the running canvas.
+ */
+class mock_dsp {
+ public:
+  mock_dsp();
+
+  // Routes the SPI port of the simulated board to this DSP
+  void        attach(void);
+
+  uint16_t    transfer(uint16_t mcu_word);
+
+  // Frames received, in order
+  std::vector<MOCK_DSP_FRAME> frames;
+  int         count_frames(uint16_t header) const;
+
+  MOCK_DSP_CANVAS canvas[2];
+  int         active;             // index of the active canvas
+  int         selected;           // slot the next canvas frames go to (CANVAS_SLOT_*)
+  bool        shadow_ready;
+
+  // Times the running canvas was torn down by a new one (an audio dropout)
+  int         dropouts;
+
+  uint32_t    firmware_ver;
+  bool        canvas_slots;       // firmware has a shadow canvas slot
+  uint16_t    extra_state;        // ORed into the reported system state
+  uint16_t    status_words;       // payload words of a status frame; older firmware sends fewer
+  std::vector<uint16_t> readbacks;  // key, value high, value low of each value returned
+
+ private:
+  void        receive(uint16_t w);
+  void        process(const MOCK_DSP_FRAME & f);
+  void        queue_status(void);
+  uint32_t    current_block(void) const;
+
+  int         rx_state;
+  uint16_t    rx_size;
+  MOCK_DSP_FRAME rx_frame;
+  std::vector<uint16_t> tx_queue;
+  size_t      tx_pos;
+};
+
+#endif  // HOST_MOCK_DSP_H
@@ -0,0 +1,187 @@
+// Host build of the library: a model of the DSP boot flash
+#include "dreammakerfx.h"
+#include "host_arduino.h"
+#include "mock_flash.h"
+
+#define FLASH_CMD_WRITE_STATUS_EN (0x50)
+#define FLASH_CMD_PROG_PAGE       (0x02)
+#define FLASH_CMD_READ            (0x03)
+#define FLASH_CMD_READ_STATUS     (0x05)
+#define FLASH_CMD_WRITE_EN        (0x06)
+#define FLASH_CMD_SECTOR_ERASE    (0x20)
+#define FLASH_CMD_CHIP_ERASE      (0xC7)
+
+#define FLASH_BYTE_US             (2)
+#define FLASH_PAGE_PROGRAM_US     (400)
+#define FLASH_SECTOR_ERASE_US     (45000)
+#define FLASH_CHIP_ERASE_US       (5000000)
+
+static mock_flash * attached_flash = NULL;
+
+static uint8_t mock_flash_spi(uint8_t b) {
+  return attached_flash->transfer(b);
+}
+
+static void mock_flash_pin_write(uint32_t pin, uint32_t val) {
+  attached_flash->pin_write(pin, val);
+}
+
+static uint8_t flip_bits(uint8_t b) {
+  uint8_t r = 0;
+  for (int i=0;i<8;i++) {
+    if (b & (1 << i)) {
+      r |= 1 << (7 - i);
+    }
+  }
+  return r;
+}
+
+mock_flash::mock_flash() : mem(MOCK_FLASH_SIZE, 0xFF) {
+  weak_sector = -1;
+  weak_programs = 0;
+  selected = false;
+  write_enabled = false;
+  busy_until_us = 0;
+  reset_counts();
+}
+
+void mock_flash::attach(void) {
+  attached_flash = this;
+  host_spi8_hook = mock_flash_spi;
+  host_pin_write_hook = mock_flash_pin_write;
+}
+
+void mock_flash::reset_counts(void) {
+  page_programs = 0;
+  sector_erases = 0;
+  chip_erases = 0;
+  bytes_read = 0;
+  bytes_programmed = 0;
+  illegal = 0;
+  sector_programs.assign(MOCK_FLASH_SIZE / MOCK_FLASH_SECTOR_SIZE, 0);
+}
+
+bool mock_flash::busy(void) const {
+  return host_us < busy_until_us;
+}
+
+bool mock_flash::holds(const uint8_t * image, uint32_t len) const {
+  for (uint32_t i=0;i<len;i++) {
+    if (mem[i] != flip_bits(image[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void mock_flash::pin_write(uint32_t pin, uint32_t val) {
+  if (pin != SPI_SHARC_SELECT) {
+    return;
+  }
+  if (val == LOW) {
+    selected = true;
+    command.clear();
+  } else if (selected) {
+    selected = false;
+    end_command();
+  }
+}
+
+uint8_t mock_flash::transfer(uint8_t mcu_byte) {
+  host_advance_us(FLASH_BYTE_US);
+  if (!selected) {
+    return 0;
+  }
+  command.push_back(mcu_byte);
+
+  if (command[0] == FLASH_CMD_READ_STATUS && command.size() == 2) {
+    return (busy() ? 0x01 : 0x00) | (write_enabled ? 0x02 : 0x00);
+  }
+  if (command[0] == FLASH_CMD_READ && command.size() > 4) {
+    if (busy()) {
+      illegal++;
+      return 0xFF;
+    }
+    uint32_t address = (command[1] << 16) | (command[2] << 8) | command[3];
+    bytes_read++;
+    return mem[(address + command.size() - 5) % MOCK_FLASH_SIZE];
+  }
+  return 0;
+}
+
+// Commands take effect when the select line goes high
+void mock_flash::end_command(void) {
+  if (command.empty()) {
+    return;
+  }
+  uint8_t cmd = command[0];
+  if (busy() && cmd != FLASH_CMD_READ_STATUS) {
+    illegal++;
+    command.clear();
+    return;
+  }
+  uint32_t address = 0;
+  if (command.size() >= 4) {
+    address = ((command[1] << 16) | (command[2] << 8) | command[3]) % MOCK_FLASH_SIZE;
+  }
+
+  switch (cmd) {
+    case FLASH_CMD_WRITE_EN:
+      write_enabled = true;
+      break;
+
+    case FLASH_CMD_PROG_PAGE: {
+      if (!write_enabled || command.size() < 4) {
+        illegal++;
+        break;
+      }
+      uint32_t sector = address / MOCK_FLASH_SECTOR_SIZE;
+      bool weak = ((int32_t) sector == weak_sector && weak_programs > 0);
+      for (size_t i=4;i<command.size();i++) {
+        // Addresses wrap within the page
+        uint32_t a = (address & ~(MOCK_FLASH_PAGE_SIZE - 1)) | ((address + i - 4) & (MOCK_FLASH_PAGE_SIZE - 1));
+        uint8_t b = weak ? 0xFF : command[i];
+        if ((mem[a] & b) != b) {
+          illegal++;
+        }
+        mem[a] &= b;
+      }
+      if (weak) {
+        weak_programs--;
+      }
+      bytes_programmed += command.size() - 4;
+      page_programs++;
+      sector_programs[sector]++;
+      busy_until_us = host_us + FLASH_PAGE_PROGRAM_US;
+      write_enabled = false;
+      break;
+    }
+
+    case FLASH_CMD_SECTOR_ERASE:
+      if (!write_enabled || command.size() < 4) {
+        illegal++;
+        break;
+      }
+      memset(&mem[address & ~(MOCK_FLASH_SECTOR_SIZE - 1)], 0xFF, MOCK_FLASH_SECTOR_SIZE);
+      sector_erases++;
+      busy_until_us = host_us + FLASH_SECTOR_ERASE_US;
+      write_enabled = false;
+      break;
+
+    case FLASH_CMD_CHIP_ERASE:
+      if (!write_enabled) {
+        illegal++;
+        break;
+      }
+      memset(&mem[0], 0xFF, MOCK_FLASH_SIZE);
+      chip_erases++;
+      busy_until_us = host_us + FLASH_CHIP_ERASE_US;
+      write_enabled = false;
+      break;
+
+    default:
+      // Status reads, reads and the status register write enable
+      break;
+  }
+  command.clear();
+}
@@ -0,0 +1,64 @@
+// Host build of the library: a model of the DSP boot flash
+#ifndef HOST_MOCK_FLASH_H
+#define HOST_MOCK_FLASH_H
+
+#include <stdint.h>
+#include <vector>
+
+#define MOCK_FLASH_SIZE           (2 * 1024 * 1024)
+#define MOCK_FLASH_PAGE_SIZE      (256)
+#define MOCK_FLASH_SECTOR_SIZE    (4096)
+
+/**
+ * W25Q16-style serial flash on the SPI port, selected by SPI_SHARC_SELECT:
+ * 2 MB, 256 byte pages, 4 KB sectors, with typical timings (page program
+ * 0.4 ms, sector erase 45 ms, chip erase 5 s, 2 us a byte at 4 MHz).  It
+ * counts the operations it sees and anything a real part would not accept:
+ * a command other than a status read while busy, a program or erase without
+ * write enable, or programming a bit from 0 back to 1.
+ *
+ * A weak sector can be set to leave its next weak_programs page programs
+ * unprogrammed, so the read back after them does not match.
+ */
+class mock_flash {
+ public:
+  mock_flash();
+
+  // Routes the SPI port and the select pin of the simulated board to this
+  // flash (a test that watches other pins calls pin_write() from its hook)
+  void        attach(void);
+
+  uint8_t     transfer(uint8_t mcu_byte);
+  void        pin_write(uint32_t pin, uint32_t val);
+  bool        busy(void) const;
+
+  // True if the flash holds an image as the library writes it (the bit
+  // order of every byte flipped)
+  bool        holds(const uint8_t * image, uint32_t len) const;
+
+  std::vector<uint8_t> mem;
+
+  int32_t     weak_sector;        // -1 for none
+  uint32_t    weak_programs;
+
+  // Operations seen
+  uint32_t    page_programs;
+  uint32_t    sector_erases;
+  uint32_t    chip_erases;
+  uint32_t    bytes_read;
+  uint32_t    bytes_programmed;
+  uint32_t    illegal;
+  std::vector<uint32_t> sector_programs;  // page programs of each sector
+
+  void        reset_counts(void);
+
+ private:
+  void        end_command(void);
+
+  bool        selected;
+  bool        write_enabled;
+  uint64_t    busy_until_us;
+  std::vector<uint8_t> command;
+};
+
+#endif  // HOST_MOCK_FLASH_H
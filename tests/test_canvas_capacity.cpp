@@ -0,0 +1,98 @@
+// Canvas capacity: a canvas with more effects or routes than the profile
+// allows fails route_audio() and run() instead of halting the pedal, and so
+// does running out of scratch arena while the canvas is serialized
+#include "dreammakerfx.h"
+#include "host_arduino.h"
+#include "mock_dsp.h"
+
+static mock_dsp dsp;
+
+fx_delay          delay_1(500.0, 0.5);
+
+static fx_gain *      gains[MAX_INSTANCES];
+static fx_mixer_4 *   mixers[MAX_ROUTES / 4 + 1];
+
+static void run_small_canvas(void) {
+  pedal.new_canvas();
+  CHECK(pedal.route_audio(pedal.instr_in, delay_1.input));
+  CHECK(pedal.route_audio(delay_1.output, pedal.amp_out));
+  CHECK(pedal.run());
+}
+
+// A chain of gains one longer than the instance stack
+static void test_too_many_effects(void) {
+  pedal.new_canvas();
+  CHECK(pedal.route_audio(pedal.instr_in, gains[0]->input));
+  bool routed = true;
+  int i;
+  for (i=1;i<MAX_INSTANCES && routed;i++) {
+    routed = pedal.route_audio(gains[i - 1]->output, gains[i]->input);
+  }
+  CHECK(!routed);
+  CHECK(i == MAX_INSTANCES);    // the canvas itself takes instance 0
+
+  size_t frames = dsp.frames.size();
+  CHECK(!pedal.run());
+  uint8_t image[1024];
+  CHECK(pedal.save_canvas(image, sizeof(image)) == 0);
+  CHECK(dsp.frames.size() == frames);
+
+  run_small_canvas();
+}
+
+// Mixers with every input fed from the instrument: four routes per mixer
+static void test_too_many_routes(void) {
+  pedal.new_canvas();
+  bool routed = true;
+  int routes = 0;
+  for (int i=0;i<MAX_ROUTES / 4 + 1 && routed;i++) {
+    routed = pedal.route_audio(pedal.instr_in, mixers[i]->input_1) &&
+             pedal.route_audio(pedal.instr_in, mixers[i]->input_2) &&
+             pedal.route_audio(pedal.instr_in, mixers[i]->input_3) &&
+             pedal.route_audio(pedal.instr_in, mixers[i]->input_4);
+    routes += routed ? 4 : 0;
+  }
+  CHECK(!routed);
+  CHECK(routes <= MAX_ROUTES);
+
+  size_t frames = dsp.frames.size();
+  CHECK(!pedal.run());
+  CHECK(dsp.frames.size() == frames);
+
+  run_small_canvas();
+}
+
+// Serialization buffers come from the scratch arena; with no room run()
+// fails rather than halting
+static void test_scratch_exhausted(void) {
+  pedal.new_canvas();
+  pedal.route_audio(pedal.instr_in, delay_1.input);
+  pedal.route_audio(delay_1.output, pedal.amp_out);
+
+  uint16_t mark = scratch_mark();
+  CHECK(scratch_alloc(SCRATCH_ARENA_WORDS) != NULL);
+  CHECK(scratch_alloc(1) == NULL);
+  CHECK(!pedal.run());
+  scratch_release(mark);
+
+  CHECK(pedal.run());
+}
+
+int main(void) {
+  dsp.attach();
+  host_serial_echo = getenv("ECHO") != NULL;
+
+  for (int i=0;i<MAX_INSTANCES;i++) {
+    gains[i] = new fx_gain(1.0);
+  }
+  for (int i=0;i<MAX_ROUTES / 4 + 1;i++) {
+    mixers[i] = new fx_mixer_4();
+  }
+
+  run_small_canvas();
+  test_too_many_effects();
+  test_too_many_routes();
+  test_scratch_exhausted();
+
+  return host_test_result("canvas capacity");
+}
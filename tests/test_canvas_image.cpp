@@ -0,0 +1,235 @@
+// Canvas images: save / load round trip, and images that are corrupt, 
+// truncated or do not match the parameter tables never reach the DSP
+#include "dreammakerfx.h"
+#include "host_arduino.h"
+#include "mock_dsp.h"
+
+static mock_dsp dsp;
+
+ARP_STEP steps[] = {
+  { .freq = SEMI_TONE_0, .vol = 0.5, .dur = 100.0 },
+  { .freq = SEMI_TONE_7, .vol = 0.8, .dur = 200.0 },
+  { .freq = SEMI_TONE_12, .vol = 0.3, .dur = 100.0 },
+};
+
+fx_delay          delay_1(500.0, 0.5);
+fx_gain           gain_1(0.7);
+fx_arpeggiator    arp(3, steps);
+fx_oscillator     osc(OSC_SINE, 440.0, 0.5);
+fx_mixer_2        mix;
+
+static uint8_t  image[1024];
+static uint32_t image_len;
+
+// Offset of the first parameter record
+static uint32_t param_records_offset(const uint8_t * img) {
+  return CANVAS_IMAGE_HEADER_SIZE + img[8] * CANVAS_IMAGE_INSTANCE_SIZE + 
+         img[9] * CANVAS_IMAGE_AUDIO_SIZE + img[10] * CANVAS_IMAGE_CONTROL_SIZE;
+}
+
+// Offset of the parameter record of the (first) effect of a type
+static uint32_t param_record_offset(const uint8_t * img, uint8_t type) {
+  uint32_t offset = param_records_offset(img);
+  while (img[offset + 1] != type) {
+    offset += CANVAS_IMAGE_PARAM_HDR_SIZE + 2 * (img[offset + 2] | (img[offset + 3] << 8));
+  }
+  return offset;
+}
+
+// Rewrites the trailer after an image has been edited
+static void fix_crc(uint8_t * img, uint32_t len) {
+  uint16_t crc = 0xFFFF;
+  for (uint32_t i=0;i<len-2;i++) {
+    crc = canvas_image_crc16(crc, img[i]);
+  }
+  img[len - 2] = crc & 0xFF;
+  img[len - 1] = crc >> 8;
+}
+
+static void test_round_trip(void) {
+  CHECK(image_len > 0);
+
+  // Running canvas on the DSP, as sent by run()
+  std::map<uint8_t, std::vector<uint16_t> > sent = dsp.canvas[dsp.active].params;
+  CHECK(sent.size() == 5);
+
+  pedal.new_canvas();
+  dsp.canvas[dsp.active].params.clear();
+  CHECK(pedal.load_canvas(image, image_len));
+  CHECK(dsp.canvas[dsp.active].running);
+  CHECK(dsp.canvas[dsp.active].params == sent);
+  CHECK(dsp.canvas[dsp.active].instances.size() == 6);
+
+  // The loaded canvas has no effect objects to save the parameters from
+  uint8_t again[sizeof(image)];
+  CHECK(pedal.save_canvas(again, sizeof(again)) == 0);
+}
+
+static void test_corrupt_image_not_sent(void) {
+  uint8_t bad[sizeof(image)];
+
+  // A flipped bit in the last parameter record: nothing may reach the DSP
+  memcpy(bad, image, image_len);
+  bad[image_len - 6] ^= 0x10;
+  size_t frames = dsp.frames.size();
+  CHECK(!pedal.load_canvas(bad, image_len));
+  CHECK(dsp.frames.size() == frames);
+  CHECK(dsp.canvas[dsp.active].running);
+
+  // Same, streamed in small chunks
+  fx_canvas_reader reader(&pedal);
+  reader.begin();
+  for (uint32_t i=0;i<image_len;i+=7) {
+    reader.feed(&bad[i], image_len - i < 7 ? image_len - i : 7);
+  }
+  CHECK(reader.get_status() == CANVAS_IMAGE_ERR_CRC);
+  CHECK(dsp.frames.size() == frames);
+
+  // Truncated
+  CHECK(!pedal.load_canvas(image, image_len - 1));
+  reader.begin();
+  CHECK(reader.feed(image, image_len - 1) == CANVAS_IMAGE_OK);
+  CHECK(dsp.frames.size() == frames);
+}
+
+static void test_streamed_image_committed_at_trailer(void) {
+  fx_canvas_reader reader(&pedal);
+  size_t frames = dsp.frames.size();
+
+  reader.begin();
+  for (uint32_t i=0;i+7<image_len;i+=7) {
+    CHECK(reader.feed(&image[i], 7) == CANVAS_IMAGE_OK);
+  }
+  CHECK(dsp.frames.size() == frames);
+  uint32_t tail = image_len % 7 ? image_len % 7 : 7;
+  CHECK(reader.feed(&image[image_len - tail], tail) == CANVAS_IMAGE_COMPLETE);
+  CHECK(dsp.frames.size() > frames);
+  CHECK(dsp.canvas[dsp.active].running);
+
+  // Data after the end of the image
+  CHECK(reader.feed(image, 1) == CANVAS_IMAGE_ERR_STATE);
+}
+
+static void test_param_records_checked(void) {
+  uint8_t bad[sizeof(image)];
+  uint32_t offset = param_record_offset(image, FX_GAIN);
+  size_t frames = dsp.frames.size();
+
+  // Parameter record for a different effect type than the instance
+  memcpy(bad, image, image_len);
+  bad[offset + 1] = FX_DELAY;
+  fix_crc(bad, image_len);
+  fx_canvas_reader reader(&pedal);
+  reader.begin();
+  CHECK(reader.feed(bad, image_len) == CANVAS_IMAGE_ERR_PARAMS);
+  CHECK(!pedal.load_canvas(bad, image_len));
+
+  // Gain block one word short
+  uint32_t words = bad[offset + 2];
+  memcpy(bad, image, image_len);
+  bad[offset + 2] = words - 1;
+  memmove(&bad[offset + 4 + 2 * (words - 1)], &bad[offset + 4 + 2 * words], image_len - (offset + 4 + 2 * words));
+  fix_crc(bad, image_len - 2);
+  reader.begin();
+  CHECK(reader.feed(bad, image_len - 2) == CANVAS_IMAGE_ERR_PARAMS);
+
+  // Arpeggiator with a partial step
+  offset = param_record_offset(image, FX_ARPEGGIATOR);
+  words = bad[offset + 2] = image[offset + 2];
+  memcpy(bad, image, image_len);
+  bad[offset + 2] = words - 2;
+  memmove(&bad[offset + 4 + 2 * (words - 2)], &bad[offset + 4 + 2 * words], image_len - (offset + 4 + 2 * words));
+  fix_crc(bad, image_len - 4);
+  reader.begin();
+  CHECK(reader.feed(bad, image_len - 4) == CANVAS_IMAGE_ERR_PARAMS);
+
+  // Instance of an unknown effect type
+  memcpy(bad, image, image_len);
+  bad[CANVAS_IMAGE_HEADER_SIZE + 2 * 2 + 1] = 200;
+  fix_crc(bad, image_len);
+  reader.begin();
+  CHECK(reader.feed(bad, image_len) == CANVAS_IMAGE_ERR_CORRUPT);
+
+  CHECK(dsp.frames.size() == frames);
+}
+
+// Routes to nodes or of node types that do not exist
+static void test_route_records_checked(void) {
+  uint8_t bad[sizeof(image)];
+  uint32_t audio = CANVAS_IMAGE_HEADER_SIZE + image[8] * CANVAS_IMAGE_INSTANCE_SIZE;
+  uint32_t control = audio + image[9] * CANVAS_IMAGE_AUDIO_SIZE;
+  const uint32_t edits[] = { audio + 1, audio + 3, control + 1, control + 4, control + 14 };
+  size_t frames = dsp.frames.size();
+  fx_canvas_reader reader(&pedal);
+
+  CHECK(image[10] == 1);
+  for (uint32_t i=0;i<sizeof(edits)/sizeof(edits[0]);i++) {
+    memcpy(bad, image, image_len);
+    bad[edits[i]] = 200;
+    fix_crc(bad, image_len);
+    reader.begin();
+    CHECK(reader.feed(bad, image_len) == CANVAS_IMAGE_ERR_CORRUPT);
+  }
+  CHECK(dsp.frames.size() == frames);
+}
+
+static char   inspect_line[128];
+static size_t inspect_len;
+
+static void capture_route(char c) {
+  if (c == '\n') {
+    inspect_len = strstr(inspect_line, "Control route") ? sizeof(inspect_line) : 0;
+  } else if (inspect_len < sizeof(inspect_line) - 1) {
+    inspect_line[inspect_len++] = c;
+    inspect_line[inspect_len] = 0;
+  }
+}
+
+static void test_inspect(void) {
+  fx_canvas_reader reader(NULL);
+  reader.begin();
+  CHECK(reader.feed(image, image_len) == CANVAS_IMAGE_COMPLETE);
+
+  // Scale and offset are printed with enough digits to read back exactly
+  uint8_t img[sizeof(image)];
+  uint32_t control = CANVAS_IMAGE_HEADER_SIZE + image[8] * CANVAS_IMAGE_INSTANCE_SIZE + image[9] * CANVAS_IMAGE_AUDIO_SIZE;
+  const float scale = 1.0 / 3.0, offset = -440.1234;
+  memcpy(img, image, image_len);
+  memcpy(&img[control + 6], &scale, 4);
+  memcpy(&img[control + 10], &offset, 4);
+  fix_crc(img, image_len);
+
+  inspect_len = 0;
+  host_serial_hook = capture_route;
+  reader.begin();
+  CHECK(reader.feed(img, image_len) == CANVAS_IMAGE_COMPLETE);
+  host_serial_hook = NULL;
+
+  float s = 0, o = 0;
+  const char * x = strstr(inspect_line, "(x ");
+  CHECK(x != NULL && sscanf(x, "(x %g + %g)", &s, &o) == 2);
+  CHECK(s == scale && o == offset);
+}
+
+int main(void) {
+  dsp.attach();
+  host_serial_echo = getenv("ECHO") != NULL;
+
+  pedal.route_audio(pedal.instr_in, delay_1.input);
+  pedal.route_audio(delay_1.output, gain_1.input);
+  pedal.route_audio(gain_1.output, mix.input_1);
+  pedal.route_audio(osc.output, mix.input_2);
+  pedal.route_audio(mix.output, pedal.amp_out);
+  pedal.route_control(arp.freq, osc.freq);
+  CHECK(pedal.run());
+  image_len = pedal.save_canvas(image, sizeof(image));
+
+  test_round_trip();
+  test_corrupt_image_not_sent();
+  test_streamed_image_committed_at_trailer();
+  test_param_records_checked();
+  test_route_records_checked();
+  test_inspect();
+
+  return host_test_result("canvas image");
+}
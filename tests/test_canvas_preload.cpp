@@ -0,0 +1,198 @@
+// Shadow canvas: preload() refuses to run against firmware without a shadow
+// slot, and with one a new canvas is uploaded while the old one keeps playing
+#include "dreammakerfx.h"
+#include "host_arduino.h"
+#include "mock_dsp.h"
+
+static mock_dsp dsp;
+
+fx_delay          delay_1(500.0, 0.5);
+fx_gain           gain_1(0.7);
+fx_pitch_shift    pitch(2.0);
+
+static uint8_t  image[1024];
+static uint32_t image_len;
+
+// Single parameter frames for an effect type sent since frame first
+static std::vector<const std::vector<uint16_t> *> single_params(size_t first, uint16_t type) {
+  std::vector<const std::vector<uint16_t> *> out;
+  for (size_t i=first;i<dsp.frames.size();i++) {
+    const std::vector<uint16_t> & w = dsp.frames[i].words;
+    if (w.size() >= 7 && w[0] == HEADER_SINGLE_PARAMETER && w[1] == type) {
+      out.push_back(&w);
+    }
+  }
+  return out;
+}
+
+// True if a canvas has an instance of a type with an ID
+static bool in_canvas(const MOCK_DSP_CANVAS & c, uint16_t type, uint16_t id) {
+  for (size_t i=0;i<c.instances.size();i++) {
+    if (c.instances[i] == ((type << 8) | id)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// True if the parameter block of an instance holds a float value
+static bool params_hold(const MOCK_DSP_CANVAS & c, uint16_t type, float value) {
+  uint32_t raw;
+  memcpy(&raw, &value, sizeof(raw));
+  for (size_t i=0;i<c.instances.size();i++) {
+    if ((c.instances[i] >> 8) != type) {
+      continue;
+    }
+    std::map<uint8_t, std::vector<uint16_t> >::const_iterator p = c.params.find(c.instances[i] & 0xFF);
+    if (p == c.params.end()) {
+      return false;
+    }
+    for (size_t k=0;k + 1<p->second.size();k++) {
+      if (p->second[k] == (raw >> 16) && p->second[k + 1] == (raw & 0xFFFF)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+static void run_for_ms(uint32_t ms) {
+  uint64_t end = host_us + (uint64_t) ms * 1000;
+  while (host_us < end) {
+    host_advance_us(1000);
+    pedal.service();
+  }
+}
+
+static void route_canvas_a(void) {
+  pedal.new_canvas();
+  pedal.route_audio(pedal.instr_in, delay_1.input);
+  pedal.route_audio(delay_1.output, pedal.amp_out);
+}
+
+static void route_canvas_b(void) {
+  pedal.new_canvas();
+  pedal.route_audio(pedal.instr_in, pitch.input);
+  pedal.route_audio(pitch.output, gain_1.input);
+  pedal.route_audio(gain_1.output, pedal.amp_out);
+}
+
+// Older firmware ignores HEADER_CANVAS_SLOT, so nothing may be sent at all
+static void test_no_slots_refused(void) {
+  dsp.canvas_slots = false;
+  route_canvas_a();
+  CHECK(pedal.run());
+  CHECK(!dsp_status.cap_canvas_slots);
+  image_len = pedal.save_canvas(image, sizeof(image));
+
+  std::vector<uint16_t> playing = dsp.canvas[dsp.active].instances;
+  size_t frames = dsp.frames.size();
+  dsp.dropouts = 0;
+
+  route_canvas_b();
+  CHECK(!pedal.preload());
+  CHECK(!pedal.swap_canvas());
+  CHECK(!pedal.preload_canvas(image, image_len));
+
+  fx_canvas_reader reader(&pedal);
+  reader.begin(true);
+  CHECK(reader.get_status() == CANVAS_IMAGE_ERR_NO_SLOTS);
+  CHECK(reader.feed(image, image_len) > CANVAS_IMAGE_COMPLETE);
+
+  CHECK(dsp.frames.size() == frames);
+  CHECK(dsp.dropouts == 0);
+  CHECK(dsp.canvas[dsp.active].running);
+  CHECK(dsp.canvas[dsp.active].instances == playing);
+}
+
+// Upload while playing: the old canvas runs until the swap, compared with
+// stopping it and sending the new one with run()
+static void test_upload_while_playing(void) {
+  dsp.canvas_slots = true;
+  route_canvas_a();
+  CHECK(pedal.run());
+  CHECK(dsp_status.cap_canvas_slots);
+  std::vector<uint16_t> playing = dsp.canvas[dsp.active].instances;
+  dsp.dropouts = 0;
+
+  route_canvas_b();
+  uint64_t start = host_us;
+  CHECK(pedal.preload());
+  uint64_t preload_us = host_us - start;
+  CHECK(dsp.dropouts == 0);
+  CHECK(dsp.canvas[dsp.active].running);
+  CHECK(dsp.canvas[dsp.active].instances == playing);
+
+  start = host_us;
+  CHECK(pedal.swap_canvas(32));
+  uint64_t swap_us = host_us - start;
+  CHECK(dsp.dropouts == 0);
+  CHECK(dsp.canvas[dsp.active].running);
+  CHECK(dsp.canvas[dsp.active].instances != playing);
+
+  // The same change made with run() tears down the playing canvas
+  route_canvas_a();
+  start = host_us;
+  CHECK(pedal.run());
+  uint64_t run_us = host_us - start;
+  CHECK(dsp.dropouts == 1);
+
+  printf("preload %.1f ms while playing, swap %.1f ms; run() %.1f ms with %d dropout\n",
+         preload_us / 1000.0, swap_us / 1000.0, run_us / 1000.0, dsp.dropouts);
+}
+
+// Parameters set between preload() and swap_canvas(): the running canvas 
+// keeps its instance IDs until the swap, and the preloaded canvas gets the 
+// values changed after it was sent
+static void test_params_before_swap(void) {
+  dsp.canvas_slots = true;
+  delay_1.set_feedback(0.5);
+  gain_1.set_gain(0.7);
+  route_canvas_a();
+  CHECK(pedal.run());
+  std::vector<uint16_t> playing = dsp.canvas[dsp.active].instances;
+
+  route_canvas_b();
+  CHECK(pedal.preload());
+
+  size_t first = dsp.frames.size();
+  delay_1.set_feedback(0.25);
+  gain_1.set_gain(0.125);
+  run_for_ms(50);
+
+  // Only the delay is in the running canvas, under the ID it has there
+  std::vector<const std::vector<uint16_t> *> delay_sent = single_params(first, FX_DELAY);
+  CHECK(delay_sent.size() == 1);
+  CHECK(!delay_sent.empty() && in_canvas(dsp.canvas[dsp.active], FX_DELAY, (*delay_sent[0])[2]));
+  CHECK(single_params(first, FX_GAIN).empty());
+  CHECK(params_hold(dsp.canvas[dsp.active], FX_DELAY, 0.5));
+  CHECK(!params_hold(dsp.canvas[1 - dsp.active], FX_GAIN, 0.125));
+
+  CHECK(pedal.swap_canvas());
+  CHECK(dsp.canvas[dsp.active].instances != playing);
+  CHECK(params_hold(dsp.canvas[dsp.active], FX_GAIN, 0.125));
+
+  // Now the gain is in the running canvas and the delay in none
+  first = dsp.frames.size();
+  gain_1.set_gain(0.0625);
+  delay_1.set_feedback(0.125);
+  run_for_ms(50);
+  std::vector<const std::vector<uint16_t> *> gain_sent = single_params(first, FX_GAIN);
+  CHECK(gain_sent.size() == 1);
+  CHECK(single_params(first, FX_DELAY).empty());
+  CHECK(!gain_sent.empty() && in_canvas(dsp.canvas[dsp.active], FX_GAIN, (*gain_sent[0])[2]));
+
+  printf("set between preload and swap: %u delay update to the running canvas, gain %s at the swap\n",
+         (unsigned) delay_sent.size(), params_hold(dsp.canvas[dsp.active], FX_GAIN, 0.125) ? "sent" : "lost");
+}
+
+int main(void) {
+  dsp.attach();
+  host_serial_echo = getenv("ECHO") != NULL;
+
+  test_no_slots_refused();
+  test_upload_while_playing();
+  test_params_before_swap();
+
+  return host_test_result("canvas preload");
+}
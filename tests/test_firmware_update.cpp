@@ -0,0 +1,196 @@
+// DSP firmware update: programs a model of the W25Q16 boot flash and checks
+// only the sectors that differ from the image are rewritten, the flash never
+// sees a command it would reject, and init() retries sectors that do not
+// verify and stops with an error when they never do
+#include "dreammakerfx.h"
+#include "host_arduino.h"
+#include "mock_dsp.h"
+#include "mock_flash.h"
+
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static mock_dsp   dsp;
+static mock_flash flash;
+
+static const uint8_t image[] = {
+  #include "dm_fx_dsp_firmware_image.dat"
+};
+
+static const uint32_t image_sectors = (sizeof(image) + MOCK_FLASH_SECTOR_SIZE - 1) / MOCK_FLASH_SECTOR_SIZE;
+
+static uint8_t flip_bits(uint8_t b) {
+  uint8_t r = 0;
+  for (int i=0;i<8;i++) {
+    if (b & (1 << i)) {
+      r |= 1 << (7 - i);
+    }
+  }
+  return r;
+}
+
+// The DSP boots the new firmware when reset is released on a flash that
+// holds the image
+static void pin_write(uint32_t pin, uint32_t val) {
+  flash.pin_write(pin, val);
+  if (pin == PIN_DSP_RESET && val == HIGH && flash.holds(image, sizeof(image))) {
+    dsp.firmware_ver = API_VERSION;
+  }
+}
+
+// A previous release: the image with a few small patches
+static void write_old_release(int patches) {
+  for (uint32_t i=0;i<sizeof(image);i++) {
+    flash.mem[i] = flip_bits(image[i]);
+  }
+  for (int k=0;k<patches;k++) {
+    uint32_t a = (rand() % image_sectors) * MOCK_FLASH_SECTOR_SIZE + rand() % 3000;
+    for (uint32_t i=0;i<64 && a + i<sizeof(image);i++) {
+      flash.mem[a + i] = flip_bits(image[a + i] ^ 0x5A);
+    }
+  }
+}
+
+static bool update(const char * name) {
+  flash.reset_counts();
+  uint64_t start = host_us;
+  bool ok = dsp_update_firmware_image();
+  host_advance_us(100000);
+  CHECK(flash.illegal == 0);
+  CHECK(flash.chip_erases == 0);
+  CHECK(dsp_firmware_update_stats.sectors == image_sectors);
+  CHECK(flash.sector_erases == dsp_firmware_update_stats.sectors_written);
+  printf("%-22s %s %6.2f s, %3u of %u sectors rewritten, %3u pages programmed, %7u bytes read\n", name,
+         ok ? "ok  " : "FAIL", (host_us - start) / 1e6, (unsigned) dsp_firmware_update_stats.sectors_written,
+         (unsigned) image_sectors, (unsigned) flash.page_programs, (unsigned) flash.bytes_read);
+  return ok;
+}
+
+// Only the sectors that differ are erased and programmed
+static void test_changed_sectors(void) {
+  CHECK(update("blank flash"));
+  CHECK(flash.holds(image, sizeof(image)));
+  CHECK(dsp_firmware_update_stats.sectors_written == image_sectors);
+
+  CHECK(update("same image"));
+  CHECK(dsp_firmware_update_stats.sectors_written == 0);
+  CHECK(flash.page_programs == 0);
+
+  write_old_release(6);
+  CHECK(update("6 patched regions"));
+  CHECK(flash.holds(image, sizeof(image)));
+  CHECK(dsp_firmware_update_stats.sectors_written >= 1 && dsp_firmware_update_stats.sectors_written <= 6);
+
+  // Power lost part way through an update: one sector erased, not programmed
+  memset(&flash.mem[40 * MOCK_FLASH_SECTOR_SIZE], 0xFF, MOCK_FLASH_SECTOR_SIZE);
+  CHECK(update("interrupted update"));
+  CHECK(flash.holds(image, sizeof(image)));
+  CHECK(dsp_firmware_update_stats.sectors_written == 1);
+  CHECK(flash.sector_programs[40] == MOCK_FLASH_SECTOR_SIZE / MOCK_FLASH_PAGE_SIZE);
+}
+
+// A sector that does not verify fails the update, and the next update only
+// rewrites that sector
+static void test_failed_sector(void) {
+  write_old_release(0);
+  memset(&flash.mem[7 * MOCK_FLASH_SECTOR_SIZE], 0x00, MOCK_FLASH_SECTOR_SIZE);
+  flash.weak_sector = 7;
+  flash.weak_programs = 1;
+  CHECK(!update("weak sector"));
+  CHECK(dsp_firmware_update_stats.sectors_failed == 1);
+  CHECK(!flash.holds(image, sizeof(image)));
+
+  CHECK(update("weak sector retried"));
+  CHECK(dsp_firmware_update_stats.sectors_written == 1);
+  CHECK(dsp_firmware_update_stats.sectors_failed == 0);
+  CHECK(flash.sector_programs[7] > 0);
+  CHECK(flash.holds(image, sizeof(image)));
+}
+
+// init() with a sector that never verifies: runs in a child process as the
+// pedal then stops for good in display_error_status()
+static void report_weak_programs(void) {
+  printf("weak sector programmed %u times\n", (unsigned) flash.sector_programs[flash.weak_sector]);
+  fflush(stdout);
+}
+
+static void test_init_gives_up(void) {
+  int out[2];
+  CHECK(pipe(out) == 0);
+  pid_t pid = fork();
+  if (pid == 0) {
+    dup2(out[1], 1);
+    dup2(out[1], 2);
+    close(out[0]);
+    host_serial_echo = true;
+    write_old_release(3);
+    memset(&flash.mem[12 * MOCK_FLASH_SECTOR_SIZE], 0x00, MOCK_FLASH_SECTOR_SIZE);
+    flash.weak_sector = 12;
+    flash.weak_programs = 1000000;
+    dsp.firmware_ver = API_VERSION - 1;
+    flash.reset_counts();
+    atexit(report_weak_programs);
+    host_us_limit = host_us + 600ULL * 1000000ULL;
+    pedal.init();
+    printf("init returned\n");
+    exit(0);
+  }
+  close(out[1]);
+  std::string text;
+  char buf[256];
+  ssize_t n;
+  while ((n = read(out[0], buf, sizeof(buf))) > 0) {
+    text.append(buf, n);
+  }
+  close(out[0]);
+  int status = 0;
+  waitpid(pid, &status, 0);
+
+  // Stuck blinking the error code until the simulated time ran out
+  CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 2);
+  CHECK(text.find("simulated time limit") != std::string::npos);
+  CHECK(text.find("DSP firmware update failed") != std::string::npos);
+  CHECK(text.find("init returned") == std::string::npos);
+  char expected[64];
+  sprintf(expected, "weak sector programmed %u times",
+          (unsigned) (DSP_FIRMWARE_UPDATE_ATTEMPTS * MOCK_FLASH_SECTOR_SIZE / MOCK_FLASH_PAGE_SIZE));
+  CHECK(text.find(expected) != std::string::npos);
+  printf("init with a bad sector: %s\n", text.find(expected) != std::string::npos ? expected : "not retried as expected");
+}
+
+// init() with a sector that fails once: the retry fixes it and the DSP boots
+// the new firmware
+static void test_init_retries(void) {
+  write_old_release(3);
+  memset(&flash.mem[9 * MOCK_FLASH_SECTOR_SIZE], 0x00, MOCK_FLASH_SECTOR_SIZE);
+  flash.weak_sector = 9;
+  flash.weak_programs = 1;
+  dsp.firmware_ver = API_VERSION - 1;
+  flash.reset_counts();
+
+  pedal.init();
+  CHECK(flash.illegal == 0);
+  CHECK(flash.holds(image, sizeof(image)));
+  CHECK(flash.sector_programs[9] == 2 * MOCK_FLASH_SECTOR_SIZE / MOCK_FLASH_PAGE_SIZE);
+  CHECK(dsp_status.firmware_ver == API_VERSION);
+  printf("init with a sector that failed once: %u sectors rewritten in the retry\n",
+         (unsigned) dsp_firmware_update_stats.sectors_written);
+}
+
+int main(void) {
+  dsp.attach();
+  flash.attach();
+  host_pin_write_hook = pin_write;
+  host_serial_echo = getenv("ECHO") != NULL;
+  host_us_limit = 24ULL * 3600ULL * 1000000ULL;
+  srand(11);
+
+  test_changed_sectors();
+  test_failed_sector();
+  fflush(stdout);
+  test_init_gives_up();
+  test_init_retries();
+
+  return host_test_result("firmware update");
+}
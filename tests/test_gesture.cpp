@@ -0,0 +1,237 @@
+// Footswitch gestures: feeds synthetic press / release edges to a decoder,
+// polling it every millisecond the way the service loop does, and checks
+// each gesture is reported once, as early as it can be told apart and with
+// the time it could be told apart
+#include "dreammakerfx.h"
+#include "host_arduino.h"
+
+#include <vector>
+
+#define BIT(g)          (1 << (g))
+#define ALL_GESTURES    (BIT(GESTURE_TAP) | BIT(GESTURE_DOUBLE_TAP) | BIT(GESTURE_LONG_PRESS) | BIT(GESTURE_HOLD))
+
+// A press: when it starts and how long it is held (ms)
+struct PRESS {
+  uint32_t  at_ms;
+  uint32_t  held_ms;
+};
+
+struct GESTURE_LOG {
+  FX_GESTURE_EVENT  events[64];
+  uint32_t          reported_us[64];    // when the decoder returned each one
+  int               count;
+};
+
+static void log_events(GESTURE_LOG * log, const FX_GESTURE_EVENT * events, int n, uint32_t now_us) {
+  CHECK(n <= GESTURE_MAX_EVENTS);
+  for (int i=0;i<n && log->count < 64;i++) {
+    log->events[log->count] = events[i];
+    log->reported_us[log->count] = now_us;
+    log->count++;
+  }
+}
+
+// Replays presses from start_us, polling every millisecond until end_ms
+static void replay(uint8_t enabled, const PRESS * presses, int len, uint32_t start_us, uint32_t end_ms,
+                   GESTURE_LOG * log) {
+  FX_GESTURE_DECODER g;
+  FX_GESTURE_EVENT events[GESTURE_MAX_EVENTS];
+  gesture_init(&g, enabled);
+  memset(log, 0, sizeof(GESTURE_LOG));
+
+  int p = 0;
+  bool down = false;
+  for (uint32_t ms=0;ms<=end_ms;ms++) {
+    uint32_t now = start_us + ms * 1000;
+    if (p < len) {
+      uint32_t edge_ms = down ? presses[p].at_ms + presses[p].held_ms : presses[p].at_ms;
+      if (edge_ms == ms) {
+        // The edge lands part way through the millisecond
+        uint32_t t = now - 300;
+        down = !down;
+        log_events(log, events, gesture_edge(&g, down, t, events), t);
+        if (!down) {
+          p++;
+        }
+      }
+    }
+    log_events(log, events, gesture_poll(&g, now, events), now);
+  }
+}
+
+static bool event_is(const GESTURE_LOG * log, int i, uint8_t gesture, uint32_t time_us) {
+  return i < log->count && log->events[i].gesture == gesture && log->events[i].time_us == time_us;
+}
+
+// With only a tap handler the press itself is the tap
+static void test_tap_only(void) {
+  const PRESS presses[] = { { 10, 80 }, { 200, 900 } };
+  GESTURE_LOG log;
+  replay(BIT(GESTURE_TAP), presses, 2, 0, 1500, &log);
+  CHECK(log.count == 2);
+  CHECK(event_is(&log, 0, GESTURE_TAP, 10000 - 300));
+  CHECK(event_is(&log, 1, GESTURE_TAP, 200000 - 300));
+  CHECK(log.reported_us[0] == log.events[0].time_us);
+}
+
+// A tap is told apart from a long press on the release
+static void test_tap_or_long_press(void) {
+  const PRESS presses[] = { { 10, 80 }, { 200, GESTURE_LONG_PRESS_MS - 1 }, { 1000, 900 } };
+  GESTURE_LOG log;
+  replay(BIT(GESTURE_TAP) | BIT(GESTURE_LONG_PRESS), presses, 3, 0, 2500, &log);
+  CHECK(log.count == 3);
+  CHECK(event_is(&log, 0, GESTURE_TAP, 90000 - 300));
+  CHECK(event_is(&log, 1, GESTURE_TAP, (200 + GESTURE_LONG_PRESS_MS - 1) * 1000 - 300));
+  // The long press comes while the footswitch is still down, and the
+  // release after it is not a tap
+  CHECK(event_is(&log, 2, GESTURE_LONG_PRESS, (1000 + GESTURE_LONG_PRESS_MS) * 1000 - 300));
+  CHECK(log.reported_us[2] - log.events[2].time_us < 1000);
+}
+
+// With a double tap handler a tap waits GESTURE_DOUBLE_TAP_MS for a second
+// press; the press and release that finish a double tap add nothing more
+static void test_double_tap(void) {
+  const PRESS presses[] = {
+    { 10, 80 },                                 // tap
+    { 1000, 80 }, { 1080 + GESTURE_DOUBLE_TAP_MS - 1, 80 },       // double tap
+    { 2000, 80 }, { 2080 + GESTURE_DOUBLE_TAP_MS + 1, 80 },       // two taps
+    { 3000, 80 }, { 3200, 1000 },               // double tap, long second press
+  };
+  GESTURE_LOG log;
+  replay(ALL_GESTURES, presses, 7, 0, 5000, &log);
+  CHECK(log.count == 5);
+  CHECK(event_is(&log, 0, GESTURE_TAP, (90 + GESTURE_DOUBLE_TAP_MS) * 1000 - 300));
+  CHECK(event_is(&log, 1, GESTURE_DOUBLE_TAP, (1080 + GESTURE_DOUBLE_TAP_MS - 1) * 1000 - 300));
+  CHECK(event_is(&log, 2, GESTURE_TAP, (2080 + GESTURE_DOUBLE_TAP_MS) * 1000 - 300));
+  CHECK(event_is(&log, 3, GESTURE_TAP, (2080 + 2 * GESTURE_DOUBLE_TAP_MS + 81) * 1000 - 300));
+  CHECK(event_is(&log, 4, GESTURE_DOUBLE_TAP, 3200000 - 300));
+  for (int i=0;i<log.count;i++) {
+    CHECK(log.reported_us[i] - log.events[i].time_us < 1000);
+  }
+}
+
+// A long press is followed by a hold every GESTURE_HOLD_REPEAT_MS
+static void test_hold(void) {
+  const PRESS presses[] = { { 100, GESTURE_LONG_PRESS_MS + 3 * GESTURE_HOLD_REPEAT_MS + 50 } };
+  GESTURE_LOG log;
+  replay(ALL_GESTURES, presses, 1, 0, 2000, &log);
+  uint32_t long_us = (100 + GESTURE_LONG_PRESS_MS) * 1000 - 300;
+  CHECK(log.count == 4);
+  CHECK(event_is(&log, 0, GESTURE_LONG_PRESS, long_us));
+  for (int i=1;i<4;i++) {
+    CHECK(event_is(&log, i, GESTURE_HOLD, long_us + i * GESTURE_HOLD_REPEAT_MS * 1000));
+  }
+}
+
+// A late poll reports what was due with the times it was due, and drops
+// hold repeats it missed rather than sending them together
+static void test_late_poll(void) {
+  FX_GESTURE_DECODER g;
+  FX_GESTURE_EVENT events[GESTURE_MAX_EVENTS];
+  gesture_init(&g, ALL_GESTURES);
+
+  CHECK(gesture_edge(&g, true, 1000, events) == 0);
+  uint32_t late = 1000 + (GESTURE_LONG_PRESS_MS + 2 * GESTURE_HOLD_REPEAT_MS + 10) * 1000;
+  int n = gesture_poll(&g, late, events);
+  CHECK(n == 2);
+  CHECK(events[0].gesture == GESTURE_LONG_PRESS && events[0].time_us == 1000 + GESTURE_LONG_PRESS_MS * 1000);
+  CHECK(events[1].gesture == GESTURE_HOLD &&
+        events[1].time_us == 1000 + (GESTURE_LONG_PRESS_MS + GESTURE_HOLD_REPEAT_MS) * 1000);
+  CHECK(gesture_poll(&g, late, events) == 0);
+  n = gesture_poll(&g, late + GESTURE_HOLD_REPEAT_MS * 1000, events);
+  CHECK(n == 1 && events[0].gesture == GESTURE_HOLD);
+
+  // A release edge seen late still reports the tap waiting on it first
+  gesture_init(&g, ALL_GESTURES);
+  gesture_edge(&g, true, 0, events);
+  gesture_edge(&g, false, 50000, events);
+  n = gesture_edge(&g, true, 50000 + (GESTURE_DOUBLE_TAP_MS + 100) * 1000, events);
+  CHECK(n == 1 && events[0].gesture == GESTURE_TAP && events[0].time_us == 50000 + GESTURE_DOUBLE_TAP_MS * 1000);
+}
+
+// Edges that do not change the state of the footswitch (a bounce the
+// interrupt read the same way twice) are ignored
+static void test_repeated_edges(void) {
+  FX_GESTURE_DECODER g;
+  FX_GESTURE_EVENT events[GESTURE_MAX_EVENTS];
+  gesture_init(&g, BIT(GESTURE_TAP) | BIT(GESTURE_LONG_PRESS));
+
+  CHECK(gesture_edge(&g, false, 1000, events) == 0);
+  CHECK(gesture_edge(&g, true, 2000, events) == 0);
+  CHECK(gesture_edge(&g, true, 40000, events) == 0);
+  int n = gesture_edge(&g, false, 80000, events);
+  CHECK(n == 1 && events[0].gesture == GESTURE_TAP && events[0].time_us == 80000);
+  CHECK(gesture_edge(&g, false, 90000, events) == 0);
+}
+
+// Decoding carries on across micros() wrapping
+static void test_wrap(void) {
+  const PRESS presses[] = { { 10, 80 }, { 1000, 80 }, { 1100, 80 }, { 2000, GESTURE_LONG_PRESS_MS + GESTURE_HOLD_REPEAT_MS } };
+  GESTURE_LOG ref, wrapped;
+  replay(ALL_GESTURES, presses, 4, 0, 4000, &ref);
+  replay(ALL_GESTURES, presses, 4, 0xFFFFFFFF - 1500000, 4000, &wrapped);
+  CHECK(ref.count == 4);
+  CHECK(wrapped.count == ref.count);
+  for (int i=0;i<ref.count && i<wrapped.count;i++) {
+    CHECK(wrapped.events[i].gesture == ref.events[i].gesture);
+    CHECK((uint32_t) (wrapped.events[i].time_us - (0xFFFFFFFF - 1500000)) == ref.events[i].time_us);
+  }
+}
+
+// Random presses against a model of the gestures
+static void test_random(void) {
+  int mismatches = 0, gestures = 0;
+  for (int trial=0;trial<200;trial++) {
+    PRESS presses[12];
+    uint32_t t = 10;
+    for (int i=0;i<12;i++) {
+      presses[i].at_ms = t;
+      presses[i].held_ms = 20 + rand() % 900;
+      t += presses[i].held_ms + 20 + rand() % 600;
+    }
+    GESTURE_LOG log;
+    replay(ALL_GESTURES, presses, 12, 0, t + 1000, &log);
+
+    std::vector<uint8_t> expected;
+    for (int i=0;i<12;i++) {
+      uint32_t release = presses[i].at_ms + presses[i].held_ms;
+      if (presses[i].held_ms >= GESTURE_LONG_PRESS_MS) {
+        expected.push_back(GESTURE_LONG_PRESS);
+        for (uint32_t h=GESTURE_LONG_PRESS_MS + GESTURE_HOLD_REPEAT_MS;h<=presses[i].held_ms;h+=GESTURE_HOLD_REPEAT_MS) {
+          expected.push_back(GESTURE_HOLD);
+        }
+      } else if (i < 11 && presses[i + 1].at_ms < release + GESTURE_DOUBLE_TAP_MS) {
+        expected.push_back(GESTURE_DOUBLE_TAP);
+        i++;      // the second press only finishes the double tap
+      } else {
+        expected.push_back(GESTURE_TAP);
+      }
+    }
+
+    bool match = (int) expected.size() == log.count;
+    for (int i=0;match && i<log.count;i++) {
+      match = log.events[i].gesture == expected[i] && log.reported_us[i] - log.events[i].time_us < 1000;
+    }
+    mismatches += match ? 0 : 1;
+    gestures += log.count;
+  }
+  CHECK(mismatches == 0);
+  printf("random presses: %d gestures, %d of 200 sequences decoded differently from the model\n",
+         gestures, mismatches);
+}
+
+int main(void) {
+  host_serial_echo = getenv("ECHO") != NULL;
+  srand(1);
+
+  test_tap_only();
+  test_tap_or_long_press();
+  test_double_tap();
+  test_hold();
+  test_late_poll();
+  test_repeated_edges();
+  test_wrap();
+  test_random();
+
+  return host_test_result("footswitch gestures");
+}
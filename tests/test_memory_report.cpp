@@ -0,0 +1,86 @@
+// Memory report: prints the report for a canvas of the effects with the
+// longest names and checks every line comes out whole
+#include "dreammakerfx.h"
+#include "host_arduino.h"
+#include "mock_dsp.h"
+
+#include <string>
+#include <vector>
+
+static mock_dsp dsp;
+
+fx_amplitude_mod    trem(1.0, 0.5);
+fx_instrument_synth synth(OSC_SINE, 10.0, 0.5, 0.5);
+fx_impulse_response cab(IR_SPRING_LONG);
+fx_envelope_tracker env(10.0, 100.0, false);
+fx_variable_delay   chorus(1.0, 0.5, 0.0, OSC_SINE);
+fx_looper           looper(1.0, 1.0, 30.0, false);
+fx_mixer_2          mix;
+
+static std::vector<std::string> lines(1);
+
+static void capture(char c) {
+  if (c == '\n') {
+    lines.push_back("");
+  } else {
+    lines.back() += c;
+  }
+}
+
+static const std::string * find_line(const char * text) {
+  for (size_t i=0;i<lines.size();i++) {
+    if (lines[i].find(text) != std::string::npos) {
+      return &lines[i];
+    }
+  }
+  return NULL;
+}
+
+// An effect line ends with its DSP buffer size
+static bool effect_line_whole(const char * name) {
+  const std::string * l = find_line(name);
+  return l != NULL && l->find("DSP ") != std::string::npos && l->size() > 6 &&
+         l->compare(l->size() - 6, 6, " bytes") == 0;
+}
+
+int main(void) {
+  dsp.attach();
+  dsp.firmware_ver = API_VERSION;
+  host_serial_echo = getenv("ECHO") != NULL;
+
+  pedal.init();
+  pedal.new_canvas();
+  CHECK(pedal.route_audio(pedal.instr_in, trem.input));
+  CHECK(pedal.route_audio(trem.output, cab.input));
+  CHECK(pedal.route_audio(cab.output, chorus.input));
+  CHECK(pedal.route_audio(chorus.output, looper.input));
+  CHECK(pedal.route_audio(looper.output, mix.input_1));
+  CHECK(pedal.route_audio(synth.output, mix.input_2));
+  CHECK(pedal.route_audio(mix.output, pedal.amp_out));
+  CHECK(pedal.route_audio(pedal.instr_in, env.input));
+  CHECK(pedal.run());
+
+  host_serial_hook = capture;
+  pedal.print_memory_report();
+  host_serial_hook = NULL;
+
+  CHECK(effect_line_whole("amplitude modulator"));
+  CHECK(effect_line_whole("instrument synth"));
+  CHECK(effect_line_whole("impulse response"));
+  CHECK(effect_line_whole("envelope tracker"));
+  CHECK(effect_line_whole("variable delay"));
+  CHECK(effect_line_whole("looper"));
+  CHECK(find_line("Effects total") != NULL);
+
+  size_t longest = 0;
+  for (size_t i=0;i<lines.size();i++) {
+    longest = lines[i].size() > longest ? lines[i].size() : longest;
+  }
+  printf("memory report: %u lines, longest %u characters\n", (unsigned) lines.size(), (unsigned) longest);
+  if (getenv("ECHO") == NULL) {
+    const std::string * l = find_line("amplitude modulator");
+    printf("%s\n", l ? l->c_str() : "(no amplitude modulator line)");
+  }
+
+  return host_test_result("memory report");
+}
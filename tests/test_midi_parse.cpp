@@ -0,0 +1,201 @@
+// MIDI parser: feeds byte streams to midi_parse_byte() and checks the
+// messages it assembles.  The recorded track in data/midi_track.mid is
+// turned into the bytes an instrument would send (with clock bytes dropped
+// in anywhere, even inside messages) and compared with the messages listed
+// in data/midi_track.txt (status, data1 and data2, one message a line).
+#include "dreammakerfx.h"
+#include "host_arduino.h"
+
+#include <vector>
+
+static std::vector<uint8_t> parse(FX_MIDI_PARSER * p, const uint8_t * bytes, int len) {
+  std::vector<uint8_t> out;
+  FX_MIDI_MSG msg;
+  for (int i=0;i<len;i++) {
+    if (midi_parse_byte(p, bytes[i], &msg)) {
+      out.push_back(msg.status);
+      out.push_back(msg.data1);
+      out.push_back(msg.data2);
+    }
+  }
+  return out;
+}
+
+static bool parses_to(const uint8_t * bytes, int len, const uint8_t * expected, int msgs, uint32_t stray) {
+  FX_MIDI_PARSER p;
+  midi_parser_init(&p);
+  std::vector<uint8_t> out = parse(&p, bytes, len);
+  return (int) out.size() == 3 * msgs && (msgs == 0 || memcmp(out.data(), expected, 3 * msgs) == 0) &&
+         p.stray_bytes == stray;
+}
+
+// Running status, and a note on with velocity 0 reported as a note off
+static void test_running_status(void) {
+  const uint8_t bytes[] = { 0x91, 60, 100, 64, 90, 60, 0, 0xC2, 5, 6 };
+  const uint8_t expected[] = {
+    0x91, 60, 100,  0x91, 64, 90,  0x81, 60, 0,  0xC2, 5, 0,  0xC2, 6, 0
+  };
+  CHECK(parses_to(bytes, sizeof(bytes), expected, 5, 0));
+}
+
+// Real-time bytes come out at once and leave the message being assembled
+// alone; 0xFD (undefined) is dropped
+static void test_realtime(void) {
+  const uint8_t bytes[] = { 0xB0, MIDI_CLOCK, 7, 0xFD, MIDI_START, 100, 11, MIDI_STOP, 20 };
+  const uint8_t expected[] = {
+    MIDI_CLOCK, 0, 0,  MIDI_START, 0, 0,  0xB0, 7, 100,  MIDI_STOP, 0, 0,  0xB0, 11, 20
+  };
+  CHECK(parses_to(bytes, sizeof(bytes), expected, 5, 0));
+}
+
+// System exclusive data is skipped, and system messages cancel running
+// status so data bytes after them belong to nothing
+static void test_system(void) {
+  const uint8_t sysex[] = { 0x90, 60, 100, 0xF0, 0x7E, 0x7F, 0x06, 0x01, MIDI_SYSEX_END, 60, 0 };
+  const uint8_t sysex_expected[] = { 0x90, 60, 100 };
+  CHECK(parses_to(sysex, sizeof(sysex), sysex_expected, 1, 2));
+
+  const uint8_t common[] = { 0xF2, 0x10, 0x20, 0x30, 0xF3, 5, 0xF6, 1 };
+  const uint8_t common_expected[] = { 0xF2, 0x10, 0x20,  0xF3, 5, 0,  0xF6, 0, 0 };
+  CHECK(parses_to(common, sizeof(common), common_expected, 3, 2));
+
+  // A new status byte drops a message that was cut short
+  const uint8_t cut[] = { 0xB0, 7, 0x90, 60, 100 };
+  const uint8_t cut_expected[] = { 0x90, 60, 100 };
+  CHECK(parses_to(cut, sizeof(cut), cut_expected, 1, 0));
+
+  // Data bytes before the first status byte
+  const uint8_t stray[] = { 10, 20, 0x80, 60, 64 };
+  const uint8_t stray_expected[] = { 0x80, 60, 64 };
+  CHECK(parses_to(stray, sizeof(stray), stray_expected, 1, 2));
+}
+
+static std::vector<uint8_t> smf;
+static size_t smf_pos;
+
+static uint32_t smf_vlq(void) {
+  uint32_t v = 0;
+  uint8_t b;
+  do {
+    b = smf[smf_pos++];
+    v = (v << 7) | (b & 0x7F);
+  } while ((b & 0x80) && smf_pos < smf.size());
+  return v;
+}
+
+// The bytes the first track of a standard MIDI file puts on the wire (meta
+// events are not sent)
+static std::vector<uint8_t> smf_track_bytes(void) {
+  std::vector<uint8_t> wire;
+  uint8_t running = 0;
+  smf_pos = 14 + 8;         // header chunk, track chunk header
+  while (smf_pos < smf.size()) {
+    smf_vlq();
+    uint8_t b = smf[smf_pos];
+    if (b == 0xFF) {
+      uint8_t type = smf[smf_pos + 1];
+      smf_pos += 2;
+      smf_pos += smf_vlq();
+      if (type == 0x2F) {   // end of track
+        break;
+      }
+      continue;
+    }
+    if (b == MIDI_SYSEX_START) {
+      smf_pos++;
+      uint32_t len = smf_vlq();
+      wire.push_back(MIDI_SYSEX_START);
+      for (uint32_t i=0;i<len;i++) {
+        wire.push_back(smf[smf_pos++]);
+      }
+      running = 0;
+      continue;
+    }
+    if (b & 0x80) {
+      running = b;
+      wire.push_back(b);
+      smf_pos++;
+    }
+    int len = ((running & 0xF0) == MIDI_PROGRAM_CHANGE || (running & 0xF0) == MIDI_CHANNEL_PRESSURE) ? 1 : 2;
+    for (int i=0;i<len;i++) {
+      wire.push_back(smf[smf_pos++]);
+    }
+  }
+  return wire;
+}
+
+static void test_recorded_track(void) {
+  FILE * fp = fopen("data/midi_track.mid", "rb");
+  CHECK(fp != NULL);
+  if (fp == NULL) {
+    return;
+  }
+  int c;
+  while ((c = fgetc(fp)) != EOF) {
+    smf.push_back((uint8_t) c);
+  }
+  fclose(fp);
+
+  std::vector<uint8_t> expected;
+  fp = fopen("data/midi_track.txt", "r");
+  CHECK(fp != NULL);
+  if (fp == NULL) {
+    return;
+  }
+  int s, d1, d2;
+  while (fscanf(fp, "%d %d %d", &s, &d1, &d2) == 3) {
+    expected.push_back(s);
+    expected.push_back(d1);
+    expected.push_back(d2);
+  }
+  fclose(fp);
+
+  // A clock byte before about one byte in three
+  std::vector<uint8_t> track = smf_track_bytes();
+  std::vector<uint8_t> wire;
+  int clocks = 0;
+  for (size_t i=0;i<track.size();i++) {
+    if (rand() % 3 == 0) {
+      wire.push_back(MIDI_CLOCK);
+      clocks++;
+    }
+    wire.push_back(track[i]);
+  }
+
+  FX_MIDI_PARSER p;
+  midi_parser_init(&p);
+  std::vector<uint8_t> out = parse(&p, wire.data(), wire.size());
+  std::vector<uint8_t> msgs;
+  int clocks_out = 0;
+  for (size_t i=0;i<out.size();i+=3) {
+    if (out[i] == MIDI_CLOCK) {
+      clocks_out++;
+    } else {
+      msgs.insert(msgs.end(), out.begin() + i, out.begin() + i + 3);
+    }
+  }
+
+  int mismatches = 0;
+  for (size_t i=0;i<msgs.size() && i<expected.size();i++) {
+    mismatches += (msgs[i] != expected[i]) ? 1 : 0;
+  }
+  CHECK(!expected.empty());
+  CHECK(msgs.size() == expected.size());
+  CHECK(mismatches == 0);
+  CHECK(clocks_out == clocks);
+  CHECK(p.stray_bytes == 0);
+  printf("recorded track: %u bytes (+%d clocks), %u of %u messages, %d bytes differ\n",
+         (unsigned) track.size(), clocks, (unsigned) (msgs.size() / 3), (unsigned) (expected.size() / 3), mismatches);
+}
+
+int main(void) {
+  host_serial_echo = getenv("ECHO") != NULL;
+  srand(9);
+
+  test_running_status();
+  test_realtime();
+  test_system();
+  test_recorded_track();
+
+  return host_test_result("MIDI parser");
+}
@@ -0,0 +1,225 @@
+// Parameter deadbands: setters and the modulation matrix ignore pot noise
+// but always reach both ends of their range, and an effect with its
+// deadbands turned off sends every change from its setters
+#include "dreammakerfx.h"
+#include "host_arduino.h"
+#include "mock_dsp.h"
+
+static mock_dsp dsp;
+
+fx_gain       gain_1(0.5);
+fx_mod_matrix mods;
+
+// analogRead() values (10 bits)
+static int pot_adc = 512;
+static int pot_noise = 0;
+
+static int read_pots(uint32_t) {
+  int noise = pot_noise ? (rand() % (2 * pot_noise + 1)) - pot_noise : 0;
+  int adc = pot_adc + noise;
+  return adc < 0 ? 0 : (adc > 1023 ? 1023 : adc);
+}
+
+// Values of the gain parameter sent since frame first
+static std::vector<float> gain_updates(size_t first) {
+  std::vector<float> values;
+  for (size_t i=first;i<dsp.frames.size();i++) {
+    const std::vector<uint16_t> & w = dsp.frames[i].words;
+    if (w.size() >= 7 && w[0] == HEADER_SINGLE_PARAMETER && w[1] == FX_GAIN && w[4] == FX_GAIN_PARAM_ID_GAIN) {
+      uint32_t raw = ((uint32_t) w[5] << 16) | w[6];
+      float value;
+      memcpy(&value, &raw, sizeof(float));
+      values.push_back(value);
+    }
+  }
+  return values;
+}
+
+static void run_for_ms(uint32_t ms) {
+  uint64_t end = host_us + (uint64_t) ms * 1000;
+  while (host_us < end) {
+    host_advance_us(1000);
+    pedal.service();
+  }
+}
+
+// A change smaller than the deadband is ignored by the setter unless the
+// deadbands of the effect are turned off
+static void test_setter_small_change(void) {
+  gain_1.set_gain(0.5);
+  run_for_ms(100);
+  size_t first = dsp.frames.size();
+  gain_1.set_gain(0.5001);
+  run_for_ms(100);
+  CHECK(gain_updates(first).empty());
+
+  gain_1.set_param_deadbands(false);
+  gain_1.set_gain(0.5001);
+  run_for_ms(100);
+  std::vector<float> u = gain_updates(first);
+  CHECK(u.size() == 1);
+  CHECK(!u.empty() && u.back() == (float) 0.5001);
+
+  // The same value again is not resent
+  first = dsp.frames.size();
+  gain_1.set_gain(0.5001);
+  run_for_ms(100);
+  CHECK(gain_updates(first).empty());
+  gain_1.set_param_deadbands(true);
+}
+
+typedef struct {
+  uint32_t  calls;          // setter calls
+  uint32_t  suppressed;     // setter calls inside the deadband
+  uint32_t  queued;         // updates queued for the DSP
+  uint32_t  sweep_updates;  // updates sent during the sweep
+  uint32_t  rest_updates;   // updates sent while the pot rests
+  float     end_1;          // value sent at the first end stop
+  float     end_2;          // value sent at the other end stop
+} KNOB_SWEEP;
+
+// A sketch driving a setter from a pot, polled every ms: either on every
+// pass of loop() or only when the pot reports a change
+static void knob_loop(uint32_t ms, int adc_from, int adc_to, bool gated, KNOB_SWEEP * k) {
+  for (uint32_t t=0;t<ms;t++) {
+    pot_adc = adc_from + (int) ((adc_to - adc_from) * (int32_t) t / (int32_t) ms);
+    host_advance_us(1000);
+    pedal.service();
+    if (!gated || pedal.pot_left.has_changed()) {
+      gain_1.set_gain(pedal.pot_left.val * 2.0);
+      k->calls++;
+    }
+  }
+}
+
+// Sweeps the pot from one end stop to the other in 2 s with ADC noise, 
+// rests it in the middle for 2 s, then returns it to the first end stop
+static KNOB_SWEEP sweep_knob(bool gated, bool deadbands) {
+  KNOB_SWEEP k;
+  memset(&k, 0, sizeof(k));
+  gain_1.set_param_deadbands(deadbands);
+  srand(7);
+  pot_noise = 0;
+  knob_loop(500, 0, 0, gated, &k);
+
+  FX_PARAM_UPDATE_STATS stats;
+  pedal.get_param_update_stats(&stats);
+  uint32_t suppressed = stats.suppressed;
+  uint32_t queued = stats.sent + stats.coalesced + stats.pending;
+
+  size_t first = dsp.frames.size();
+  pot_noise = 2;
+  knob_loop(2000, 0, 1023, gated, &k);
+  pot_noise = 0;
+  knob_loop(500, 1023, 1023, gated, &k);
+  std::vector<float> u = gain_updates(first);
+  k.sweep_updates = u.size();
+  k.end_2 = u.empty() ? -1.0 : u.back();
+
+  pot_noise = 2;
+  knob_loop(500, 512, 512, gated, &k);
+  first = dsp.frames.size();
+  knob_loop(2000, 512, 512, gated, &k);
+  k.rest_updates = gain_updates(first).size();
+
+  pot_noise = 0;
+  knob_loop(500, 0, 0, gated, &k);
+  u = gain_updates(first);
+  k.end_1 = u.empty() ? -1.0 : u.back();
+
+  pedal.get_param_update_stats(&stats);
+  k.suppressed = stats.suppressed - suppressed;
+  k.queued = stats.sent + stats.coalesced + stats.pending - queued;
+  gain_1.set_param_deadbands(true);
+  return k;
+}
+
+static bool reached_ends(const KNOB_SWEEP & k) {
+  return (k.end_1 == 0.0 && k.end_2 == 2.0) || (k.end_1 == 2.0 && k.end_2 == 0.0);
+}
+
+static void print_sweep(const char * name, const KNOB_SWEEP & k) {
+  printf("%-28s %5u calls, %4u suppressed, %4u queued, %3u sent sweeping, %3u resting, ends %g %g\n", name,
+         (unsigned) k.calls, (unsigned) k.suppressed, (unsigned) k.queued, (unsigned) k.sweep_updates, (unsigned) k.rest_updates,
+         k.end_1, k.end_2);
+}
+
+// A knob swept through the setter: with the deadband a noisy pot sends
+// fewer updates, a resting one (almost) none, and both ends of the range
+// are still reached exactly
+static void test_setter_knob_sweep(void) {
+  KNOB_SWEEP every_off = sweep_knob(false, false);
+  KNOB_SWEEP every_on = sweep_knob(false, true);
+  KNOB_SWEEP gated_off = sweep_knob(true, false);
+  KNOB_SWEEP gated_on = sweep_knob(true, true);
+  print_sweep("every loop, no deadband", every_off);
+  print_sweep("every loop, deadband", every_on);
+  print_sweep("has_changed(), no deadband", gated_off);
+  print_sweep("has_changed(), deadband", gated_on);
+
+  CHECK(every_on.queued < every_off.queued / 2);
+  CHECK(every_on.sweep_updates <= every_off.sweep_updates);
+  CHECK(every_on.rest_updates < every_off.rest_updates);
+  CHECK(every_on.rest_updates <= 2);
+  CHECK(every_on.suppressed > 0 && every_off.suppressed == 0);
+  CHECK(gated_on.queued <= gated_off.queued);
+  CHECK(gated_on.rest_updates <= 2);
+  CHECK(reached_ends(every_off) && reached_ends(every_on));
+  CHECK(reached_ends(gated_off) && reached_ends(gated_on));
+}
+
+// A resting pot with a few LSB of noise sends (almost) nothing, and the
+// ends of the pot reach the ends of the mapping exactly
+static void test_mod_matrix(void) {
+  FX_PARAM_UPDATE_STATS stats;
+  pedal.get_param_update_stats(&stats);
+  uint32_t suppressed = stats.suppressed;
+
+  pot_adc = 512;
+  pot_noise = 2;
+  run_for_ms(1000);
+  size_t first = dsp.frames.size();
+  run_for_ms(2000);
+  std::vector<float> u = gain_updates(first);
+  CHECK(u.size() <= 2);
+  printf("resting pot: %u updates in 2 s\n", (unsigned) u.size());
+
+  // Which end is which depends on how the board wires its pots
+  pot_noise = 0;
+  pot_adc = 0;
+  run_for_ms(1000);
+  u = gain_updates(first);
+  float end_stop = u.empty() ? 0.0 : u.back();
+  CHECK(end_stop == 0.25 || end_stop == 2.0);
+
+  pot_adc = 1023;
+  run_for_ms(1000);
+  u = gain_updates(first);
+  CHECK(!u.empty() && u.back() == (end_stop == 2.0 ? 0.25 : 2.0));
+
+  pedal.get_param_update_stats(&stats);
+  printf("mod matrix: %u updates suppressed by the deadband\n", (unsigned) (stats.suppressed - suppressed));
+}
+
+int main(void) {
+  dsp.attach();
+  dsp.firmware_ver = API_VERSION;
+  host_serial_echo = getenv("ECHO") != NULL;
+  host_analog_read_hook = read_pots;
+  srand(1);
+
+  pedal.init();
+  pedal.route_audio(pedal.instr_in, gain_1.input);
+  pedal.route_audio(gain_1.output, pedal.amp_out);
+  CHECK(pedal.run());
+  run_for_ms(100);
+
+  test_setter_small_change();
+  test_setter_knob_sweep();
+
+  mods.map(&pedal.pot_left, gain_1.gain, 0.25, 2.0);
+  pedal.add_mod_matrix(&mods);
+  test_mod_matrix();
+
+  return host_test_result("parameter deadbands");
+}
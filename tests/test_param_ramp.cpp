@@ -0,0 +1,190 @@
+// Parameter ramps: the stream of updates a ramp sends to the DSP from
+// service(), and what stops a ramp
+#include "dreammakerfx.h"
+#include "host_arduino.h"
+#include "mock_dsp.h"
+
+static mock_dsp dsp;
+
+fx_gain     gain_1(0.0);
+fx_delay    delay_1(500.0, 0.5);
+
+struct RAMP_UPDATE {
+  uint64_t  us;
+  float     value;
+  bool      scheduled;
+  uint32_t  block;          // DSP block a scheduled update applies at
+};
+
+// Values of one parameter sent since frame first
+static std::vector<RAMP_UPDATE> param_updates(size_t first, EFFECT_TYPE type, uint8_t param_id) {
+  std::vector<RAMP_UPDATE> updates;
+  for (size_t i=first;i<dsp.frames.size();i++) {
+    const std::vector<uint16_t> & w = dsp.frames[i].words;
+    bool single = w.size() >= 7 && w[0] == HEADER_SINGLE_PARAMETER;
+    bool scheduled = w.size() >= 9 && w[0] == HEADER_SCHEDULED_PARAMETER;
+    if ((single || scheduled) && w[1] == type && w[4] == param_id) {
+      uint32_t raw = ((uint32_t) w[5] << 16) | w[6];
+      RAMP_UPDATE u;
+      u.us = dsp.frames[i].us;
+      memcpy(&u.value, &raw, sizeof(float));
+      u.scheduled = scheduled;
+      u.block = scheduled ? ((uint32_t) w[7] << 16) | w[8] : 0;
+      updates.push_back(u);
+    }
+  }
+  return updates;
+}
+
+// The block the mock DSP is processing at a time
+static uint32_t dsp_block_at(uint64_t us) {
+  return (uint32_t) (us * DSP_SAMPLE_RATE_HZ / DSP_BLOCK_SAMPLES / 1000000);
+}
+
+static void run_for_ms(uint32_t ms) {
+  uint64_t end = host_us + (uint64_t) ms * 1000;
+  while (host_us < end) {
+    host_advance_us(1000);
+    pedal.service();
+  }
+}
+
+// Steps of a 300 ms ramp to 1.0 that started at start_us
+static std::vector<RAMP_UPDATE> check_ramp_steps(size_t first, uint64_t start_us) {
+  std::vector<RAMP_UPDATE> u = param_updates(first, FX_GAIN, FX_GAIN_PARAM_ID_GAIN);
+  CHECK(u.size() >= 300 / SERVICE_INTERVAL_MS / 2);
+  CHECK(u.size() <= 300 / SERVICE_INTERVAL_MS + 2);
+  for (size_t i=1;i<u.size();i++) {
+    CHECK(u[i].value > u[i - 1].value);
+  }
+  CHECK(!u.empty() && u.back().value == 1.0);
+
+  // Roughly linear: halfway through the ramp is about halfway there
+  for (size_t i=0;i<u.size();i++) {
+    double t = (double) (u[i].us - start_us) / 300000.0;
+    if (t < 1.0) {
+      CHECK_NEAR(u[i].value, t, 0.15);
+    }
+  }
+  return u;
+}
+
+// With the DSP clock synced the target is sent ahead of the end of the ramp 
+// and applies at the block the ramp ends in
+static void test_single_ramp(void) {
+  gain_1.set_gain(0.0);
+  run_for_ms(100);
+  size_t first = dsp.frames.size();
+  uint64_t start = host_us;
+  gain_1.set_gain_ramped(1.0, 300);
+  run_for_ms(500);
+
+  std::vector<RAMP_UPDATE> u = check_ramp_steps(first, start);
+  uint32_t end_block = dsp_block_at(start + 300000);
+  CHECK(!u.empty() && u.back().scheduled);
+  CHECK(!u.empty() && u.back().us - start <= 300 * 1000);
+  // Within a block of the end, the resolution of the MCU's DSP clock model
+  CHECK(!u.empty() && u.back().block + 1 >= end_block && u.back().block <= end_block + 1);
+  for (size_t i=0;i + 1<u.size();i++) {
+    CHECK(!u[i].scheduled);
+  }
+
+  printf("300 ms ramp: %u updates, last sent at %.1f ms for block %d from the end\n", (unsigned) u.size(),
+         u.empty() ? 0.0 : (u.back().us - start) / 1000.0, u.empty() ? 0 : (int) (u.back().block - end_block));
+}
+
+// Firmware without a block counter: the target goes out on the first link 
+// tick after the end of the ramp, at most one link period late
+static void test_single_ramp_no_clock(void) {
+  size_t first = dsp.frames.size();
+  uint64_t start = host_us;
+  gain_1.set_gain_ramped(1.0, 300);
+  run_for_ms(500);
+
+  std::vector<RAMP_UPDATE> u = check_ramp_steps(first, start);
+  for (size_t i=0;i<u.size();i++) {
+    CHECK(!u[i].scheduled);
+  }
+  CHECK(!u.empty() && u.back().us - start >= 300 * 1000);
+  CHECK(!u.empty() && u.back().us - start <= (300 + SERVICE_INTERVAL_MS) * 1000);
+
+  printf("300 ms ramp without the DSP clock: %u updates, last at %.1f ms\n", (unsigned) u.size(),
+         u.empty() ? 0.0 : (u.back().us - start) / 1000.0);
+}
+
+// Several ramps share the link budget and each still reaches its target
+static void test_parallel_ramps(void) {
+  size_t first = dsp.frames.size();
+  delay_1.set_feedback_ramped(0.1, 1000);
+  delay_1.set_dry_mix_ramped(0.2, 1000);
+  delay_1.set_wet_mix_ramped(0.3, 1000);
+  gain_1.set_gain_ramped(0.5, 1000);
+  run_for_ms(1200);
+
+  std::vector<RAMP_UPDATE> u = param_updates(first, FX_GAIN, FX_GAIN_PARAM_ID_GAIN);
+  CHECK(!u.empty() && u.back().value == 0.5);
+  std::vector<RAMP_UPDATE> fb = param_updates(first, FX_DELAY, FX_DELAY_PARAM_ID_FEEDBACK);
+  CHECK(!fb.empty() && fb.back().value == (float) 0.1);
+  std::vector<RAMP_UPDATE> dry = param_updates(first, FX_DELAY, FX_DELAY_PARAM_ID_DRY_MIX);
+  CHECK(!dry.empty() && dry.back().value == (float) 0.2);
+  std::vector<RAMP_UPDATE> wet = param_updates(first, FX_DELAY, FX_DELAY_PARAM_ID_WET_MIX);
+  CHECK(!wet.empty() && wet.back().value == (float) 0.3);
+
+  // Four ramps together stay within the link budget, so each is updated 
+  // less often than a ramp on its own: at most one step an interval before 
+  // the target at the end
+  uint32_t interval_ms = 4 * SPI_SINGLE_PARAM_FRAME_WORDS * 1000 / RAMP_LINK_BUDGET_WORDS_PER_SEC;
+  CHECK(u.size() >= 2);
+  CHECK(u.size() - 1 <= 1000 / interval_ms + 1);
+  if (u.size() >= 2) {
+    uint64_t mean_us = (u.back().us - u.front().us) / (u.size() - 1);
+    printf("4 ramps: %u updates each, %.1f ms apart\n", (unsigned) u.size(), mean_us / 1000.0);
+  }
+}
+
+// A plain setter stops the ramp; the setter's value is the last one sent
+static void test_setter_stops_ramp(void) {
+  gain_1.set_gain_ramped(0.0, 1000);
+  run_for_ms(200);
+  size_t first = dsp.frames.size();
+  gain_1.set_gain(0.7);
+  run_for_ms(1000);
+
+  std::vector<RAMP_UPDATE> u = param_updates(first, FX_GAIN, FX_GAIN_PARAM_ID_GAIN);
+  CHECK(u.size() == 1);
+  CHECK(!u.empty() && u.back().value == (float) 0.7);
+}
+
+// A zero length ramp is a plain set
+static void test_zero_length_ramp(void) {
+  size_t first = dsp.frames.size();
+  gain_1.set_gain_ramped(0.2, 0);
+  run_for_ms(100);
+
+  std::vector<RAMP_UPDATE> u = param_updates(first, FX_GAIN, FX_GAIN_PARAM_ID_GAIN);
+  CHECK(u.size() == 1);
+  CHECK(!u.empty() && u.back().value == (float) 0.2);
+}
+
+int main(void) {
+  dsp.attach();
+  dsp.firmware_ver = API_VERSION;
+  host_serial_echo = getenv("ECHO") != NULL;
+
+  dsp.status_words = SPI_DSP_STAT_BLOCK_COUNT_HI;
+  pedal.init();
+  pedal.route_audio(pedal.instr_in, gain_1.input);
+  pedal.route_audio(gain_1.output, delay_1.input);
+  pedal.route_audio(delay_1.output, pedal.amp_out);
+  CHECK(pedal.run());
+  run_for_ms(100);
+
+  test_single_ramp_no_clock();
+  dsp.status_words = SPI_DSP_STAT_FRAME_SIZE;
+  test_single_ramp();
+  test_parallel_ramps();
+  test_setter_stops_ramp();
+  test_zero_length_ramp();
+
+  return host_test_result("parameter ramps");
+}
@@ -0,0 +1,168 @@
+// Pot ADC: replays ADC traces through pot_adc_read() as the host build reads
+// the pots (analogRead(), at most one conversion per input per millisecond)
+// and checks the scaling, the rate limit and the pots the pedal reports
+#include "dreammakerfx.h"
+#include "host_arduino.h"
+#include "mock_dsp.h"
+
+static mock_dsp dsp;
+
+// An ADC trace: analogRead() values (10 bits) at points in time, with
+// straight lines between the points
+struct TRACE_POINT {
+  uint32_t  ms;
+  int       adc;
+};
+
+// Knob at rest, turned across most of its range in 250 ms, at rest again
+static const TRACE_POINT trace_turn[] = {
+  { 0, 120 }, { 200, 120 }, { 450, 880 }, { 1000, 880 }
+};
+
+// Knob snapped from one end stop to the other
+static const TRACE_POINT trace_snap[] = {
+  { 0, 0 }, { 300, 0 }, { 310, 1023 }, { 1000, 1023 }
+};
+
+static const TRACE_POINT * trace = NULL;
+static int      trace_len = 0;
+static uint64_t trace_start_us = 0;
+static int      trace_noise = 0;
+static uint32_t reads[POT_ADC_CHANNELS];
+
+static int trace_value(uint32_t ms) {
+  if (trace == NULL) {
+    return 512;
+  }
+  for (int i=1;i<trace_len;i++) {
+    if (ms < trace[i].ms) {
+      const TRACE_POINT * a = &trace[i - 1];
+      const TRACE_POINT * b = &trace[i];
+      return a->adc + (int) (((int64_t) (b->adc - a->adc) * (ms - a->ms)) / (b->ms - a->ms));
+    }
+  }
+  return trace[trace_len - 1].adc;
+}
+
+static int read_adc(uint32_t pin) {
+  if (pin >= A0 && pin < A0 + POT_ADC_CHANNELS) {
+    reads[pin - A0]++;
+  }
+  int adc = trace_value((host_us - trace_start_us) / 1000);
+  if (trace_noise) {
+    adc += (rand() % (2 * trace_noise + 1)) - trace_noise;
+  }
+  return adc < 0 ? 0 : (adc > 1023 ? 1023 : adc);
+}
+
+static void replay(const TRACE_POINT * t, int len, int noise) {
+  trace = t;
+  trace_len = len;
+  trace_noise = noise;
+  trace_start_us = host_us - host_us % 1000;   // millis() ticks with the trace
+  memset(reads, 0, sizeof(reads));
+}
+
+// analogRead() values are scaled to the 12 bit range of the DMA scan
+static void test_scaling(void) {
+  const TRACE_POINT flat_lo[] = { { 0, 0 } };
+  const TRACE_POINT flat_mid[] = { { 0, 512 } };
+  const TRACE_POINT flat_hi[] = { { 0, 1023 } };
+
+  replay(flat_lo, 1, 0);
+  host_advance_us(1000);
+  CHECK(pot_adc_read(0) == 0);
+  replay(flat_mid, 1, 0);
+  host_advance_us(1000);
+  CHECK(pot_adc_read(0) == 512 * POT_ADC_FULL_SCALE / 1023);
+  replay(flat_hi, 1, 0);
+  host_advance_us(1000);
+  CHECK(pot_adc_read(0) == POT_ADC_FULL_SCALE);
+
+  // Inputs that do not exist read as 0 without a conversion
+  memset(reads, 0, sizeof(reads));
+  CHECK(pot_adc_read(-1) == 0);
+  CHECK(pot_adc_read(POT_ADC_CHANNELS) == 0);
+  uint32_t total = 0;
+  for (int i=0;i<POT_ADC_CHANNELS;i++) {
+    total += reads[i];
+  }
+  CHECK(total == 0);
+}
+
+// Reading every 100 us converts each input once per millisecond and every
+// reading follows the trace
+static void test_trace_replay(void) {
+  // Time only moves between the reads
+  uint32_t step_us = host_call_step_us;
+  host_call_step_us = 0;
+  host_advance_us(1000 - host_us % 1000);
+  replay(trace_turn, sizeof(trace_turn) / sizeof(trace_turn[0]), 0);
+  int errors = 0;
+  for (int i=0;i<10000;i++) {
+    host_advance_us(100);
+    uint16_t v = pot_adc_read(0);
+    // The value is at most one millisecond old
+    uint32_t ms = (host_us - trace_start_us) / 1000;
+    int lo = trace_value(ms > 0 ? ms - 1 : 0) * POT_ADC_FULL_SCALE / 1023;
+    int hi = trace_value(ms) * POT_ADC_FULL_SCALE / 1023;
+    if (v < (lo < hi ? lo : hi) || v > (lo > hi ? lo : hi)) {
+      errors++;
+    }
+  }
+  host_call_step_us = step_us;
+  CHECK(errors == 0);
+  CHECK(reads[0] >= 999 && reads[0] <= 1001);
+  printf("trace replay: %u conversions for 10000 reads over 1 s\n", (unsigned) reads[0]);
+}
+
+static float pot_val(fx_pot * pot) {
+  #if defined (DM_FX_TWO)
+    return 1.0f - pot->val;     // DM_FX_TWO pots read inverted
+  #else
+    return pot->val;
+  #endif
+}
+
+// The pots the pedal reports follow a noisy knob turn, and the pedal's
+// service loop stays within the conversion rate limit
+static void test_pedal_pots(const TRACE_POINT * t, int len, uint32_t move_start_ms, uint32_t move_end_ms) {
+  replay(t, len, 2);
+  float target = (float) t[len - 1].adc / 1023.0f;
+  int settled_ms = -1;
+  for (uint32_t ms=0;ms<1000;ms++) {
+    for (int i=0;i<4;i++) {
+      host_advance_us(250);
+      pedal.service();
+    }
+    if (ms >= move_end_ms && settled_ms < 0 && fabsf(pot_val(&pedal.pot_left) - target) < 0.02f) {
+      settled_ms = ms - move_end_ms;
+    }
+  }
+  CHECK(settled_ms >= 0 && settled_ms < 100);
+  CHECK_NEAR(pot_val(&pedal.pot_left), target, 0.01);
+  for (int i=0;i<POT_ADC_CHANNELS;i++) {
+    CHECK(reads[i] <= 1001);
+  }
+  printf("knob moved %u - %u ms: within 2%% of the end %d ms later\n", (unsigned) move_start_ms,
+         (unsigned) move_end_ms, settled_ms);
+}
+
+int main(void) {
+  dsp.attach();
+  dsp.firmware_ver = API_VERSION;
+  host_serial_echo = getenv("ECHO") != NULL;
+  host_analog_read_hook = read_adc;
+  srand(1);
+
+  pot_adc_init();
+  test_scaling();
+  test_trace_replay();
+
+  replay(trace_turn, 1, 0);
+  pedal.init();
+  test_pedal_pots(trace_turn, sizeof(trace_turn) / sizeof(trace_turn[0]), 200, 450);
+  test_pedal_pots(trace_snap, sizeof(trace_snap) / sizeof(trace_snap[0]), 300, 310);
+
+  return host_test_result("pot ADC");
+}
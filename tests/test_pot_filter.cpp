@@ -0,0 +1,137 @@
+// Pot filter: replays noisy knob traces (1 kHz, 10 bits) into one pot and
+// checks the one-euro filter keeps a resting knob quiet, follows turns with
+// little lag and reports each turn through has_changed() without late events
+#include "dreammakerfx.h"
+#include "host_arduino.h"
+
+static fx_pot pot(0);
+static int    pot_adc = 512;
+
+static int read_adc(uint32_t) {
+  return pot_adc;
+}
+
+// One millisecond of the knob at pos, with +/-4 LSB of noise and the odd
+// larger spike
+static void step(float pos) {
+  int adc = (int) lround(pos * 1023.0) + (rand() % 9) - 4;
+  if (rand() % 200 == 0) {
+    adc += (rand() & 1) ? 6 : -6;
+  }
+  pot_adc = adc < 0 ? 0 : (adc > 1023 ? 1023 : adc);
+  host_advance_us(1000);
+  pot.read_pot();
+}
+
+static float pot_val(void) {
+  #if defined (DM_FX_TWO)
+    return 1.0f - pot.val;      // DM_FX_TWO pots read inverted
+  #else
+    return pot.val;
+  #endif
+}
+
+static void test_rest(void) {
+  for (int i=0;i<1000;i++) {
+    step(0.5);
+  }
+  pot.has_changed();
+
+  int events = 0;
+  float lo = 1.0, hi = 0.0;
+  for (int i=0;i<20000;i++) {
+    step(0.5);
+    events += pot.has_changed() ? 1 : 0;
+    lo = fminf(lo, pot_val());
+    hi = fmaxf(hi, pot_val());
+  }
+  CHECK(events == 0);
+  CHECK(hi - lo < 0.005);     // the raw readings span 0.008
+  printf("rest 20 s: %d changes, value moved %.4f\n", events, hi - lo);
+}
+
+// Turns of several sizes and speeds
+static void test_turns(void) {
+  const float sizes[] = { 0.02, 0.05, 0.1, 0.3 };
+  const int   durations_ms[] = { 30, 200, 1000 };
+  float pos = 0.5;
+
+  // The long history still shows the turn for one window after the knob 
+  // stops, and the final change comes at the latest one interval later
+  const int late_ms = (POT_LONG_HIST_LEN + 1) * POT_HIST_INTERVAL_MS;
+
+  for (int s=0;s<4;s++) {
+    for (int d=0;d<3;d++) {
+      float target = (pos > 0.5) ? pos - sizes[s] : pos + sizes[s];
+      int first_ms = -1, late = 0, settled_ms = -1, changes = 0;
+      float max_lag = 0.0;
+      for (int i=0;i<durations_ms[d];i++) {
+        float x = pos + (target - pos) * (i + 1) / durations_ms[d];
+        step(x);
+        max_lag = fmaxf(max_lag, fabsf(pot_val() - x));
+        if (pot.has_changed()) {
+          changes++;
+          first_ms = (first_ms < 0) ? i : first_ms;
+        }
+      }
+      for (int i=0;i<1500;i++) {
+        step(target);
+        if (pot.has_changed()) {
+          changes++;
+          first_ms = (first_ms < 0) ? durations_ms[d] + i : first_ms;
+          late += (i > late_ms) ? 1 : 0;
+        }
+        if (settled_ms < 0 && fabsf(pot_val() - target) < 0.003) {
+          settled_ms = i;
+        }
+      }
+
+      // Reported before the knob is halfway there, never after the history
+      // has forgotten the turn, and the value ends up on the knob
+      CHECK(first_ms >= 0 && first_ms < durations_ms[d] / 2 + 50);
+      CHECK(late == 0);
+      CHECK(settled_ms >= 0 && settled_ms < 300);
+      CHECK(fabsf(pot_val() - target) < 0.003);
+      printf("turn %.2f in %4d ms: first change %3d ms, %2d changes (%d late), lag %.3f, settled %3d ms after\n",
+             sizes[s], durations_ms[d], first_ms, changes, late, max_lag, settled_ms);
+      pos = target;
+    }
+  }
+}
+
+// A fast turn is followed closely: the cutoff rises with the knob speed
+static void test_fast_turn_lag(void) {
+  for (int i=0;i<1000;i++) {
+    step(0.2);
+  }
+  float max_lag = 0.0;
+  for (int i=0;i<50;i++) {
+    float x = 0.2 + 0.6 * (i + 1) / 50;
+    step(x);
+    max_lag = fmaxf(max_lag, fabsf(pot_val() - x));
+  }
+  int within_ms = -1;
+  for (int i=0;i<200 && within_ms < 0;i++) {
+    step(0.8);
+    if (fabsf(pot_val() - 0.8) < 0.01) {
+      within_ms = i;
+    }
+  }
+  CHECK(max_lag < 0.1);
+  CHECK(within_ms >= 0 && within_ms < 20);
+  printf("fast turn: lag %.3f, within 1%% %d ms after\n", max_lag, within_ms);
+}
+
+int main(void) {
+  host_serial_echo = getenv("ECHO") != NULL;
+  host_analog_read_hook = read_adc;
+  host_call_step_us = 0;
+  srand(5);
+
+  pot_adc_init();
+  test_rest();
+  test_turns();
+  test_fast_turn_lag();
+
+  return host_test_result("pot filter");
+}
@@ -0,0 +1,90 @@
+// DSP status frames: the block count and parameter readbacks are only taken
+// from the words that actually arrived, so a short frame from older firmware
+// never reuses values left over from an earlier, longer frame
+#include "dreammakerfx.h"
+#include "host_arduino.h"
+#include "mock_dsp.h"
+
+static mock_dsp dsp;
+
+// Clocks status frames out of the DSP
+static void exchange_status(void) {
+  for (int i=0;i<2;i++) {
+    spi_fifo_push_emptry_frame();
+    host_advance_us(50000);
+    spi_transmit_buffered_frames(false);
+  }
+}
+
+static void set_readbacks(int count) {
+  dsp.readbacks.clear();
+  for (int i=0;i<count;i++) {
+    dsp.readbacks.push_back(0x0100 + i);
+    dsp.readbacks.push_back(0x1234);
+    dsp.readbacks.push_back(0x5670 + i);
+  }
+}
+
+static void test_full_frame(void) {
+  dsp.status_words = SPI_DSP_STAT_FRAME_SIZE;
+  set_readbacks(2);
+  exchange_status();
+
+  CHECK(dsp_status.firmware_valid);
+  CHECK(dsp_status.block_count != 0);
+  CHECK(dsp_status.readback_count == 2);
+  CHECK(dsp_status.readback_key[1] == 0x0101);
+  CHECK(dsp_status.readback_value[1] == 0x12345671);
+}
+
+// Older firmware stops after the note words
+static void test_legacy_frame(void) {
+  set_readbacks(2);
+  dsp.status_words = SPI_DSP_STAT_BLOCK_COUNT_HI;
+  exchange_status();
+
+  CHECK(dsp_status.firmware_valid);
+  CHECK(dsp_status.state_booted);
+  CHECK(dsp_status.block_count == 0);
+  CHECK(dsp_status.readback_count == 0);
+}
+
+// A frame that ends part way through the readbacks only reports the
+// complete ones
+static void test_truncated_readbacks(void) {
+  set_readbacks(SPI_READBACK_SLOTS);
+  dsp.status_words = SPI_DSP_STAT_READBACK_START + 4;
+  exchange_status();
+
+  CHECK(dsp_status.block_count != 0);
+  CHECK(dsp_status.readback_count == 1);
+  CHECK(dsp_status.readback_key[0] == 0x0100);
+  CHECK(dsp_status.readback_value[0] == 0x12345670);
+}
+
+// Words past the end of the expected frame are dropped, not written over
+// the last readback
+static void test_long_frame(void) {
+  set_readbacks(SPI_READBACK_SLOTS);
+  dsp.status_words = SPI_DSP_STAT_FRAME_SIZE + 2;
+  exchange_status();
+
+  CHECK(dsp_status.readback_count == SPI_READBACK_SLOTS);
+  CHECK(dsp_status.readback_value[SPI_READBACK_SLOTS - 1] == 0x12345670 + SPI_READBACK_SLOTS - 1);
+}
+
+int main(void) {
+  dsp.attach();
+  dsp.firmware_ver = API_VERSION;
+  host_serial_echo = getenv("ECHO") != NULL;
+
+  spi_start();
+  spi_fifo_reset();
+
+  test_full_frame();
+  test_legacy_frame();
+  test_truncated_readbacks();
+  test_long_frame();
+
+  return host_test_result("status frames");
+}
@@ -0,0 +1,201 @@
+// Tap tempo: feeds tap sequences to the beat grid fit and checks the tempo
+// it settles on.  Each scenario is a sequence the way a player taps it: a
+// steady tempo with Gaussian timing jitter, optionally one sloppy tap or a
+// change of tempo part way through, replayed for many trials.  Each scenario
+// has limits on the mean and largest error of the tempo and of the beat
+// predicted four beats on.
+#include "dreammakerfx.h"
+#include "host_arduino.h"
+#include "mock_dsp.h"
+
+static mock_dsp dsp;
+
+struct TAP_SCENARIO {
+  const char *  name;
+  double        period_ms;
+  int           taps;
+  double        jitter_ms;        // standard deviation of each tap
+  int           sloppy_at;        // tap that is off by sloppy_ms (-1 for none)
+  double        sloppy_ms;
+  int           change_at;        // tap the tempo changes at (-1 for none)
+  double        change_period_ms;
+  double        ramp_ms;          // change of the period on each tap after that
+};
+
+struct TAP_RESULT {
+  double        period_err_mean;
+  double        period_err_max;
+  double        beat_err_mean;    // error of the beat predicted 4 beats on
+  double        beat_err_max;
+  int           locked;
+  int           restarts;         // trials with a sequence cut short
+};
+
+static double gauss(void) {
+  double u = (rand() + 1.0) / (RAND_MAX + 2.0);
+  double v = (rand() + 1.0) / (RAND_MAX + 2.0);
+  return sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * v);
+}
+
+static TAP_RESULT replay(const TAP_SCENARIO * s, int trials) {
+  TAP_RESULT r;
+  memset(&r, 0, sizeof(r));
+
+  for (int tr=0;tr<trials;tr++) {
+    // A pause longer than TAP_TIMEOUT_MS starts each trial afresh
+    host_advance_us((TAP_TIMEOUT_MS + 1000) * 1000ULL);
+    FX_INPUT_STATS before;
+    pedal.get_input_stats(&before);
+
+    double t = (double) (host_us / 1000);
+    double period = s->period_ms;
+    uint32_t last = 0;
+    for (int i=0;i<s->taps;i++) {
+      if (i == s->change_at) {
+        period = s->change_period_ms;
+      } else if (s->change_at >= 0 && i > s->change_at) {
+        period += s->ramp_ms;
+      }
+      double tap = t + s->jitter_ms * gauss() + (i == s->sloppy_at ? s->sloppy_ms : 0.0);
+      last = (uint32_t) lround(tap);
+      if (last * 1000ULL > host_us) {
+        host_advance_us(last * 1000ULL - host_us);
+      }
+      pedal.register_tap(last);
+      t += period;
+    }
+
+    FX_INPUT_STATS after;
+    pedal.get_input_stats(&after);
+    if (after.tap_restarts != before.tap_restarts) {
+      r.restarts++;
+    }
+    if (pedal.get_tap_confidence() > 0.0) {
+      r.locked++;
+    }
+
+    double err = fabs(pedal.get_tap_interval_ms() - period);
+    r.period_err_mean += err / trials;
+    r.period_err_max = fmax(r.period_err_max, err);
+
+    // Where the grid puts the beat four beats after the last one
+    uint32_t now = last + (uint32_t) (pedal.get_tap_interval_ms() / 2);
+    host_advance_us(now * 1000ULL - host_us);
+    double beat = (double) now - pedal.get_tap_phase() * pedal.get_tap_interval_ms();
+    double predicted = beat + 4.0 * pedal.get_tap_interval_ms();
+    double truth = (t - period) + 4.0 * period;
+    r.beat_err_mean += fabs(predicted - truth) / trials;
+    r.beat_err_max = fmax(r.beat_err_max, fabs(predicted - truth));
+  }
+
+  printf("%-38s period err mean %5.2f max %6.2f ms, beat +4 err mean %6.2f max %6.2f ms, locked %d/%d, restarted %d\n",
+         s->name, r.period_err_mean, r.period_err_max, r.beat_err_mean, r.beat_err_max, r.locked, trials, r.restarts);
+  return r;
+}
+
+// Largest errors a scenario may show over all its trials
+struct TAP_LIMITS {
+  double        period_err_mean;
+  double        period_err_max;
+  double        beat_err_mean;
+  double        beat_err_max;
+};
+
+static bool within(const TAP_RESULT & r, const TAP_LIMITS & l) {
+  bool ok = r.period_err_mean <= l.period_err_mean && r.period_err_max <= l.period_err_max &&
+            r.beat_err_mean <= l.beat_err_mean && r.beat_err_max <= l.beat_err_max;
+  if (!ok) {
+    printf("  outside the limits of period err mean %.2f max %.2f ms, beat +4 err mean %.2f max %.2f ms\n",
+           l.period_err_mean, l.period_err_max, l.beat_err_mean, l.beat_err_max);
+  }
+  return ok;
+}
+
+static const int trials = 1000;
+
+static void test_steady(void) {
+  const TAP_SCENARIO s = { "steady 500 ms, 15 ms jitter, 8 taps", 500, 8, 15, -1, 0, -1, 0, 0 };
+  const TAP_LIMITS s_limits = { 3.0, 15.0, 25.0, 100.0 };
+  TAP_RESULT r = replay(&s, trials);
+  CHECK(r.locked == trials);
+  CHECK(within(r, s_limits));
+  CHECK(r.restarts <= trials / 100);
+
+  // A fit long enough to look for a change of tempo that is not there
+  const TAP_SCENARIO longer = { "steady 500 ms, 15 ms jitter, 16 taps", 500, 16, 15, -1, 0, -1, 0, 0 };
+  const TAP_LIMITS longer_limits = { 1.5, 15.0, 15.0, 90.0 };
+  r = replay(&longer, trials);
+  CHECK(r.locked == trials);
+  CHECK(within(r, longer_limits));
+  CHECK(r.restarts <= trials / 100);
+}
+
+// A lone sloppy tap is left out of the fit and never restarts the sequence
+static void test_sloppy_tap(void) {
+  const TAP_SCENARIO late = { "one sloppy tap (+90 ms) of 8", 500, 8, 15, 4, 90, -1, 0, 0 };
+  const TAP_LIMITS late_limits = { 3.5, 30.0, 25.0, 300.0 };
+  TAP_RESULT r = replay(&late, trials);
+  CHECK(r.locked == trials);
+  CHECK(r.restarts == 0);
+  CHECK(within(r, late_limits));
+
+  const TAP_SCENARIO early = { "one sloppy tap (-90 ms) of 10", 500, 10, 15, 5, -90, -1, 0, 0 };
+  const TAP_LIMITS early_limits = { 2.5, 35.0, 20.0, 160.0 };
+  r = replay(&early, trials);
+  CHECK(r.locked == trials);
+  CHECK(r.restarts == 0);
+  CHECK(within(r, early_limits));
+
+  const TAP_SCENARIO last = { "sloppy last tap (-80 ms)", 500, 8, 15, 7, -80, -1, 0, 0 };
+  const TAP_LIMITS last_limits = { 5.0, 30.0, 45.0, 250.0 };
+  r = replay(&last, trials);
+  CHECK(r.locked == trials);
+  CHECK(within(r, last_limits));
+}
+
+// A clear change of tempo is followed
+static void test_tempo_change(void) {
+  const TAP_SCENARIO s = { "500 -> 400 ms after 6 taps, 12 taps", 500, 12, 15, -1, 0, 6, 400, 0 };
+  const TAP_LIMITS s_limits = { 5.5, 30.0, 35.0, 160.0 };
+  TAP_RESULT r = replay(&s, trials);
+  CHECK(r.locked == trials);
+  CHECK(within(r, s_limits));
+
+  // Only four taps at the new tempo, which are all fitted
+  const TAP_SCENARIO jump = { "500 -> 300 ms after 6 taps, 10 taps", 500, 10, 15, -1, 0, 6, 300, 0 };
+  const TAP_LIMITS jump_limits = { 8.0, 40.0, 45.0, 200.0 };
+  r = replay(&jump, trials);
+  CHECK(r.locked == trials);
+  CHECK(within(r, jump_limits));
+
+  // A tempo that keeps slowing is followed once the taps show the trend; 
+  // until then (and in trials where a drift restart left too few taps for 
+  // it) the grid trails by about the change over the taps it fits
+  const TAP_SCENARIO slowing = { "500 ms slowing 10 ms a tap, 16 taps", 500, 16, 15, -1, 0, 4, 510, 10 };
+  const TAP_LIMITS slowing_limits = { 25.0, 75.0, 130.0, 450.0 };
+  r = replay(&slowing, trials);
+  CHECK(r.locked == trials);
+  CHECK(within(r, slowing_limits));
+
+  const TAP_SCENARIO fast = { "fast 250 ms, 8 ms jitter, 6 taps", 250, 6, 8, -1, 0, -1, 0, 0 };
+  const TAP_LIMITS fast_limits = { 2.5, 12.0, 15.0, 80.0 };
+  r = replay(&fast, trials);
+  CHECK(r.locked == trials);
+  CHECK(within(r, fast_limits));
+}
+
+int main(void) {
+  dsp.attach();
+  dsp.firmware_ver = API_VERSION;
+  host_serial_echo = getenv("ECHO") != NULL;
+  host_us_limit = 24ULL * 3600ULL * 1000000ULL;    // every trial starts with a pause
+  srand(1);
+
+  pedal.init();
+
+  test_steady();
+  test_sloppy_tap();
+  test_tempo_change();
+
+  return host_test_result("tap tempo");
+}
@@ -0,0 +1,119 @@
+// Inspects and converts canvas images (see dm_fx_canvas_image.h) on a 
+// Linux host.  Built against the library with the stand-ins in tests/host.
+//
+//   dmfx_canvas inspect <image.bin>             print the contents, check the CRC
+//   dmfx_canvas to-c <image.bin> <name>         write a C array for a sketch
+//   dmfx_canvas to-hex <image.bin>              write hex text (16 bytes a line)
+//   dmfx_canvas from-hex <image.hex> <out.bin>  read hex text, e.g. captured 
+//                                               from the Serial console
+#include "dreammakerfx.h"
+#include "host_arduino.h"
+
+#include <ctype.h>
+#include <vector>
+
+static const char * status_names[] = {
+  "ok (truncated)", "complete", "not a canvas image", "unsupported version", 
+  "too large for this build", "corrupt", "CRC mismatch", "bad state", 
+  "parameter record does not match its effect", "DSP has no shadow canvas slot"
+};
+
+static bool read_file(const char * path, std::vector<uint8_t> * data) {
+  FILE * f = fopen(path, "rb");
+  if (f == NULL) {
+    perror(path);
+    return false;
+  }
+  int c;
+  while ((c = fgetc(f)) != EOF) {
+    data->push_back((uint8_t) c);
+  }
+  fclose(f);
+  return true;
+}
+
+static int inspect(const std::vector<uint8_t> & image) {
+  fx_canvas_reader reader(NULL);
+
+  host_serial_echo = true;
+  reader.begin();
+  CANVAS_IMAGE_STATUS res = reader.feed(image.data(), image.size());
+  host_serial_echo = false;
+
+  if (res != CANVAS_IMAGE_COMPLETE) {
+    fprintf(stderr, "invalid image: %s\n", status_names[res]);
+    return 1;
+  }
+  printf("%u bytes\n", (unsigned) image.size());
+  return 0;
+}
+
+static int to_c(const std::vector<uint8_t> & image, const char * name) {
+  printf("const uint8_t %s[] = {", name);
+  for (size_t i=0;i<image.size();i++) {
+    printf("%s0x%02x,", (i % 12) ? " " : "\n  ", image[i]);
+  }
+  printf("\n};\nconst uint32_t %s_len = %u;\n", name, (unsigned) image.size());
+  return 0;
+}
+
+static int to_hex(const std::vector<uint8_t> & image) {
+  for (size_t i=0;i<image.size();i++) {
+    printf("%02x%s", image[i], (i % 16 == 15 || i + 1 == image.size()) ? "\n" : " ");
+  }
+  return 0;
+}
+
+static int from_hex(const std::vector<uint8_t> & text, const char * out_path) {
+  std::vector<uint8_t> image;
+  int nibbles = 0;
+  uint8_t b = 0;
+
+  for (size_t i=0;i<text.size();i++) {
+    int c = text[i];
+    if (isxdigit(c)) {
+      b = (b << 4) | (isdigit(c) ? c - '0' : tolower(c) - 'a' + 10);
+      if (++nibbles == 2) {
+        image.push_back(b);
+        nibbles = 0;
+      }
+    } else if (nibbles) {
+      fprintf(stderr, "odd number of hex digits at offset %u\n", (unsigned) i);
+      return 1;
+    }
+  }
+
+  FILE * f = fopen(out_path, "wb");
+  if (f == NULL) {
+    perror(out_path);
+    return 1;
+  }
+  fwrite(image.data(), 1, image.size(), f);
+  fclose(f);
+  return inspect(image);
+}
+
+int main(int argc, char ** argv) {
+  std::vector<uint8_t> data;
+
+  if (argc >= 3 && read_file(argv[2], &data)) {
+    if (!strcmp(argv[1], "inspect") && argc == 3) {
+      return inspect(data);
+    } else if (!strcmp(argv[1], "to-c") && argc == 4) {
+      return to_c(data, argv[3]);
+    } else if (!strcmp(argv[1], "to-hex") && argc == 3) {
+      return to_hex(data);
+    } else if (!strcmp(argv[1], "from-hex") && argc == 4) {
+      return from_hex(data, argv[3]);
+    }
+  } else if (argc >= 3) {
+    return 1;
+  }
+
+  fprintf(stderr, 
+    "usage: dmfx_canvas inspect <image.bin>\n"
+    "       dmfx_canvas to-c <image.bin> <name>\n"
+    "       dmfx_canvas to-hex <image.bin>\n"
+    "       dmfx_canvas from-hex <image.hex> <out.bin>\n");
+  return 2;
+}